@@ -0,0 +1,603 @@
+// Benchmark suite covering data loading, cross section lookups, vector maths,
+// random sampling and end to end slab transport
+// Every case reports ns and heap allocations per operation, allocations being
+// counted by replacing the global operator new. Results can be written as CSV
+// and compared against an earlier CSV, cases slower than the baseline by more
+// than the tolerance being flagged and making the exit code nonzero.
+//
+// Usage: BenchmarkSuite [--csv results.csv] [--baseline old.csv]
+//                       [--tolerance 0.1] [--quick]
+//                       [--counters counters.json] [--numa]
+// Run from the repository root so that data/photon/ is found. --counters
+// dumps the instrumentation totals, which are only filled in builds with
+// NSE_INSTRUMENT. --numa enables NumaReplicas, comparing against a baseline
+// run without it shows the gain of the lookup cases on multi-socket machines,
+// lookup/material_total_threads running a lookup thread per CPU.
+
+#include "DataProcessor.hpp"
+#include "Instrumentation.hpp"
+#include "Material.hpp"
+#include "NumaReplicas.hpp"
+#include "PhotonPhysics.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+#include "Vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+std::atomic<long long> allocations{0};
+
+const int NoElements{100};
+const size_t NoQueries{4096};
+
+// Folded into the output so the compiler keeps every measured operation
+double checksum{0.0};
+
+struct BenchResult
+{
+  std::string name;
+  double ns_per_op;
+  double allocations_per_op;
+};
+
+struct BenchSettings
+{
+  int repetitions{5};
+  double repetition_seconds{0.2};
+};
+
+struct Query
+{
+  ElementConversion::Element element;
+  ParticleConstants::ReactionType reaction;
+  double energy; // MeV
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Median time of repeated calls of operation, each doing ops_per_call
+// operations, with the number of calls per repetition calibrated to last
+// repetition_seconds
+template <typename Operation>
+BenchResult measure(const std::string &name, long long ops_per_call,
+                    const BenchSettings &settings, Operation operation)
+{
+  operation(); // Warm up
+
+  long long calls{1};
+
+  while(true)
+  {
+    auto start{std::chrono::steady_clock::now()};
+
+    for(long long call{0}; call < calls; call++)
+    {
+      operation();
+    }
+
+    if(secondsSince(start) >= settings.repetition_seconds)
+    {
+      break;
+    }
+
+    calls *= 2;
+  }
+
+  std::vector<double> seconds;
+  seconds.reserve(settings.repetitions);
+  long long allocations_before{allocations.load()};
+
+  for(int repetition{0}; repetition < settings.repetitions; repetition++)
+  {
+    auto start{std::chrono::steady_clock::now()};
+
+    for(long long call{0}; call < calls; call++)
+    {
+      operation();
+    }
+
+    seconds.push_back(secondsSince(start));
+  }
+
+  double no_ops{static_cast<double>(settings.repetitions) * calls *
+                ops_per_call};
+  std::sort(seconds.begin(), seconds.end());
+
+  return {name, 1e9 * seconds[seconds.size() / 2] / (calls * ops_per_call),
+          (allocations.load() - allocations_before) / no_ops};
+}
+
+// Log uniform energies over the data range with every allowed reaction of
+// every element
+std::vector<Query> randomQueries(RandomNumberGenerator &rng)
+{
+  const auto &allowed{ParticleConstants::AllowedReactions.at(
+      ParticleConstants::ParticleType::GAMMA)};
+  std::vector<ParticleConstants::ReactionType> reactions(allowed.begin(),
+                                                         allowed.end());
+  std::vector<Query> queries;
+
+  for(size_t i{0}; i < NoQueries; i++)
+  {
+    queries.push_back(
+        {static_cast<ElementConversion::Element>(i % NoElements + 1),
+         reactions[i % reactions.size()],
+         std::pow(10.0, -3.0 + 8.0 * rng.getUniform())});
+  }
+
+  return queries;
+}
+
+// Photoelectric lookups at and either side of every absorption edge
+std::vector<Query> edgeQueries()
+{
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  std::vector<Query> queries;
+
+  for(int z{1}; z <= NoElements; z++)
+  {
+    auto element{static_cast<ElementConversion::Element>(z)};
+    std::shared_ptr<const std::vector<std::vector<double>>> data{
+        data_processor.getData(ParticleConstants::ParticleType::GAMMA,
+                               element)};
+    const std::vector<std::vector<double>> &rows{*data};
+
+    for(size_t i{1}; i < rows.size(); i++)
+    {
+      double energy{rows[i][FileConstants::EnergyColumn]};
+
+      if(energy != rows[i - 1][FileConstants::EnergyColumn])
+      {
+        continue;
+      }
+
+      for(double factor : {1.0 - 1e-3, 1.0, 1.0 + 1e-3})
+      {
+        queries.push_back(
+            {element,
+             ParticleConstants::ReactionType::PHOTOELECTRIC_ABSORPTION,
+             energy * factor});
+      }
+    }
+  }
+
+  return queries;
+}
+
+std::vector<BenchResult> runSuite(const BenchSettings &settings)
+{
+  std::vector<BenchResult> results;
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  // Files are parsed once per process, so loading is timed over one pass
+  {
+    long long allocations_before{allocations.load()};
+    auto start{std::chrono::steady_clock::now()};
+
+    for(int z{1}; z <= NoElements; z++)
+    {
+      data_processor.addDataSingleFile(
+          ParticleConstants::ParticleType::GAMMA,
+          static_cast<ElementConversion::Element>(z));
+    }
+
+    results.push_back(
+        {"load/element_file", 1e9 * secondsSince(start) / NoElements,
+         static_cast<double>(allocations.load() - allocations_before) /
+             NoElements});
+  }
+
+  RandomNumberGenerator rng(12345);
+  std::vector<Query> queries{randomQueries(rng)};
+  std::vector<Query> edge_queries{edgeQueries()};
+
+  results.push_back(measure(
+      "lookup/getAttenCoef", static_cast<long long>(queries.size()), settings,
+      [&]
+      {
+        for(const Query &query : queries)
+        {
+          checksum += data_processor.getAttenCoef(
+              query.energy, query.reaction,
+              ParticleConstants::ParticleType::GAMMA, query.element);
+        }
+      }));
+
+  results.push_back(measure(
+      "lookup/getAllAttenCoefs", static_cast<long long>(queries.size()),
+      settings,
+      [&]
+      {
+        for(const Query &query : queries)
+        {
+          checksum += data_processor
+                          .getAllAttenCoefs(
+                              query.energy,
+                              ParticleConstants::ParticleType::GAMMA,
+                              query.element)
+                          .front();
+        }
+      }));
+
+  results.push_back(measure(
+      "lookup/getAttenCoef_edges", static_cast<long long>(edge_queries.size()),
+      settings,
+      [&]
+      {
+        for(const Query &query : edge_queries)
+        {
+          checksum += data_processor.getAttenCoef(
+              query.energy, query.reaction,
+              ParticleConstants::ParticleType::GAMMA, query.element);
+        }
+      }));
+
+  using ElementConversion::Element;
+
+  Material water{Material::fromFormula("water", 1.0,
+                                       {{Element::H, 2.0}, {Element::O, 1.0}})};
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+
+  results.push_back(measure(
+      "lookup/material_total", static_cast<long long>(queries.size()),
+      settings,
+      [&]
+      {
+        for(const Query &query : queries)
+        {
+          checksum += lead.getTotalLinearAttenCoef(
+              query.energy, ParticleConstants::ParticleType::GAMMA);
+        }
+      }));
+
+  // Every CPU looking up at once, as transport threads do. Each thread binds
+  // to its NUMA node as RunDriver workers do when replicas are enabled.
+  const int no_threads{
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+
+  results.push_back(measure(
+      "lookup/material_total_threads",
+      static_cast<long long>(queries.size()) * no_threads, settings,
+      [&]
+      {
+        std::vector<std::thread> threads;
+        std::vector<double> sums(no_threads, 0.0);
+
+        for(int thread{0}; thread < no_threads; thread++)
+        {
+          threads.emplace_back(
+              [&, thread]
+              {
+                NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
+                double sum{0.0};
+
+                if(numa_replicas.isEnabled())
+                {
+                  numa_replicas.bindThread(thread);
+                }
+
+                for(const Query &query : queries)
+                {
+                  sum += lead.getTotalLinearAttenCoef(
+                      query.energy, ParticleConstants::ParticleType::GAMMA);
+                  sum += data_processor.getAttenCoef(
+                      query.energy, query.reaction,
+                      ParticleConstants::ParticleType::GAMMA, query.element);
+                }
+
+                sums[thread] = sum;
+              });
+        }
+
+        for(int thread{0}; thread < no_threads; thread++)
+        {
+          threads[thread].join();
+          checksum += sums[thread];
+        }
+      }));
+
+  std::vector<Vector3D> vectors;
+
+  for(size_t i{0}; i < NoQueries; i++)
+  {
+    vectors.push_back(rng.getIsotropicDirection());
+  }
+
+  results.push_back(measure(
+      "vector/cross_normalise_dot", static_cast<long long>(vectors.size()),
+      settings,
+      [&]
+      {
+        Vector3D previous{Vector3D::UNITZ};
+
+        for(const Vector3D &vector : vectors)
+        {
+          checksum += vector.cross(previous).normalise().dot(Vector3D::UNITX);
+          previous = vector;
+        }
+      }));
+
+  results.push_back(measure("vector/move", static_cast<long long>(
+                                               vectors.size()),
+                            settings,
+                            [&]
+                            {
+                              Vector3D position{Vector3D::ZERO};
+
+                              for(const Vector3D &vector : vectors)
+                              {
+                                position += vector * 0.5;
+                              }
+
+                              checksum += position.getZ();
+                            }));
+
+  const long long rng_ops{static_cast<long long>(NoQueries)};
+
+  results.push_back(measure("rng/uniform", rng_ops, settings,
+                            [&]
+                            {
+                              for(long long i{0}; i < rng_ops; i++)
+                              {
+                                checksum += rng.getUniform();
+                              }
+                            }));
+
+  results.push_back(measure("rng/isotropic_direction", rng_ops, settings,
+                            [&]
+                            {
+                              for(long long i{0}; i < rng_ops; i++)
+                              {
+                                checksum += rng.getIsotropicDirection().getZ();
+                              }
+                            }));
+
+  results.push_back(measure("rng/random_step", rng_ops, settings,
+                            [&]
+                            {
+                              for(long long i{0}; i < rng_ops; i++)
+                              {
+                                checksum += rng.getRandomStep(0.1);
+                              }
+                            }));
+
+  // 1 MeV beam on 10 cm of water backed by 1 cm of lead, on one thread
+  SlabGeometry geometry({{&water, 10.0}, {&lead, 1.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+  const long long histories{2000};
+
+  results.push_back(measure(
+      "transport/slab_history", histories, settings,
+      [&]
+      {
+        TallySet tally_set;
+        tally_set.addTally(std::make_unique<SurfaceTally>(
+            "behind", Vector3D::UNITZ, 12.0,
+            std::vector<double>{1e-3, 1.01}));
+
+        RunSettings run_settings;
+        run_settings.max_histories = histories;
+        run_settings.histories_per_batch = histories;
+
+        RunDriver driver(
+            transport, physics, tally_set,
+            [](RandomNumberGenerator &)
+            {
+              return Particle(ParticleConstants::ParticleType::GAMMA, 1.0,
+                              Vector3D::ZERO, Vector3D::UNITZ);
+            },
+            run_settings);
+        driver.run();
+
+        checksum += driver.getStatistics(0).getMean(0);
+      }));
+
+  return results;
+}
+
+void writeCsv(const std::string &path, const std::vector<BenchResult> &results)
+{
+  std::ofstream file(path);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  file << "name,ns_per_op,ops_per_second,allocations_per_op\n";
+  file << std::setprecision(6);
+
+  for(const BenchResult &result : results)
+  {
+    file << result.name << "," << result.ns_per_op << ","
+         << 1e9 / result.ns_per_op << "," << result.allocations_per_op << "\n";
+  }
+}
+
+// ns per op of every case in a CSV written by writeCsv
+std::map<std::string, double> readCsv(const std::string &path)
+{
+  std::ifstream file(path);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  std::map<std::string, double> ns_per_op;
+  std::string line;
+  std::getline(file, line); // Header
+
+  while(std::getline(file, line))
+  {
+    std::istringstream fields(line);
+    std::string name;
+    std::string value;
+
+    if(std::getline(fields, name, ',') && std::getline(fields, value, ','))
+    {
+      ns_per_op[name] = std::stod(value);
+    }
+  }
+
+  return ns_per_op;
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if(void *pointer{std::malloc(size == 0 ? 1 : size)})
+  {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+int main(int argc, char *argv[])
+{
+  BenchSettings settings;
+  std::string csv_path;
+  std::string baseline_path;
+  std::string counters_path;
+  double tolerance{0.1};
+
+  for(int i{1}; i < argc; i++)
+  {
+    std::string argument{argv[i]};
+
+    if(argument == "--quick")
+    {
+      settings = {3, 0.05};
+    }
+    else if(argument == "--csv" && i + 1 < argc)
+    {
+      csv_path = argv[++i];
+    }
+    else if(argument == "--baseline" && i + 1 < argc)
+    {
+      baseline_path = argv[++i];
+    }
+    else if(argument == "--tolerance" && i + 1 < argc)
+    {
+      tolerance = std::stod(argv[++i]);
+    }
+    else if(argument == "--counters" && i + 1 < argc)
+    {
+      counters_path = argv[++i];
+    }
+    else if(argument == "--numa")
+    {
+      // Before anything is loaded so that every table is replicated
+      NumaReplicas::getInstance().enable();
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " [--csv results.csv] [--baseline old.csv]"
+                   " [--tolerance 0.1] [--quick] [--counters counters.json]"
+                   " [--numa]\n";
+      return 2;
+    }
+  }
+
+  std::vector<BenchResult> results{runSuite(settings)};
+
+  std::map<std::string, double> baseline;
+
+  if(!baseline_path.empty())
+  {
+    baseline = readCsv(baseline_path);
+  }
+
+  bool regressed{false};
+
+  std::cout << std::left << std::setw(30) << "case" << std::right
+            << std::setw(14) << "ns/op" << std::setw(14) << "ops/s"
+            << std::setw(12) << "allocs/op"
+            << (baseline.empty() ? "" : "   vs baseline") << "\n";
+
+  for(const BenchResult &result : results)
+  {
+    std::cout << std::left << std::setw(30) << result.name << std::right
+              << std::setw(14) << result.ns_per_op << std::setw(14)
+              << 1e9 / result.ns_per_op << std::setw(12)
+              << result.allocations_per_op;
+
+    auto old{baseline.find(result.name)};
+
+    if(old != baseline.end())
+    {
+      double ratio{result.ns_per_op / old->second};
+      bool slower{ratio > 1.0 + tolerance};
+      regressed = regressed || slower;
+
+      std::cout << std::setw(10) << ratio << "x"
+                << (slower ? " REGRESSION" : "");
+    }
+
+    std::cout << "\n";
+  }
+
+  std::cout << "(checksum " << checksum << ")\n";
+
+  NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
+
+  if(numa_replicas.isEnabled())
+  {
+    std::cout << "(replicas on " << numa_replicas.getNoNodes() << " nodes, "
+              << numa_replicas.getReplicatedBytes() / 1024 << " kB copied, "
+              << NumaReplicas::getMappedBytes() / 1024 << " kB mapped, "
+              << numa_replicas.getHugePageBytes() / 1024
+              << " kB of huge pages)\n";
+  }
+
+  if(!csv_path.empty())
+  {
+    writeCsv(csv_path, results);
+  }
+
+  if(!counters_path.empty())
+  {
+    std::ofstream counters_file(counters_path);
+    Instrumentation::writeJson(counters_file, Instrumentation::getTotals());
+  }
+
+  return regressed ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// Checkpoint/restart benchmark
+// Transports a 1 MeV pencil beam through a 5 cm lead slab, scoring the
+// transmitted current and the dose on a mesh over the slab. A run stopped
+// half way and restarted from its checkpoint is compared bin by bin with the
+// uninterrupted run, and the checkpoint is checked to be rejected by a run
+// with a different mesh. Then the cost of taking and writing a checkpoint is
+// timed for growing mesh sizes.
+
+#include "Checkpoint.hpp"
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// A fresh tally set for the problem, the mesh having n^3 voxels
+TallySet makeTallies(int n)
+{
+  TallySet tally_set;
+  tally_set.addTally(std::make_unique<SurfaceTally>(
+      "behind", Vector3D::UNITZ, 10.0, std::vector<double>{1e-3, 1.01}));
+  tally_set.addTally(std::make_unique<MeshTally>(
+      "dose",
+      CartesianMesh({Vector3D(-5.0, -5.0, 0.0), Vector3D(5.0, 5.0, 5.0)},
+                    {n, n, n})));
+
+  return tally_set;
+}
+
+// Bins whose mean or relative error is not bit for bit the same
+size_t countMismatches(const RunDriver &first, const RunDriver &second)
+{
+  size_t mismatches{0};
+
+  for(int tally{0}; tally < 2; tally++)
+  {
+    const TallyStatistics &a{first.getStatistics(tally)};
+    const TallyStatistics &b{second.getStatistics(tally)};
+
+    for(size_t bin{0}; bin < a.getNoBins(); bin++)
+    {
+      if(a.getMean(bin) != b.getMean(bin) ||
+         a.getRelativeError(bin) != b.getRelativeError(bin))
+      {
+        mismatches += 1;
+      }
+    }
+  }
+
+  return mismatches;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  SlabGeometry geometry({{&lead, 5.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  Source beam{[](RandomNumberGenerator &)
+              {
+                return Particle(ParticleConstants::ParticleType::GAMMA, 1.0,
+                                Vector3D::ZERO, Vector3D::UNITZ);
+              }};
+
+  std::string path{(std::filesystem::temp_directory_path() /
+                    "nse_checkpoint_bench.chk")
+                       .string()};
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 10000;
+  settings.max_histories = 200000;
+
+  // Uninterrupted reference
+  TallySet reference_tallies{makeTallies(20)};
+  RunDriver reference(transport, physics, reference_tallies, beam, settings);
+  reference.run();
+
+  // Stopped after half the histories, checkpointing every batch
+  RunSettings first_settings{settings};
+  first_settings.max_histories = settings.max_histories / 2;
+  first_settings.checkpoint_path = path;
+  first_settings.checkpoint_interval = 0.0;
+
+  {
+    TallySet first_tallies{makeTallies(20)};
+    RunDriver first(transport, physics, first_tallies, beam, first_settings);
+    first.run();
+  }
+
+  // Resumed in a new driver as after a restart of the process
+  TallySet resumed_tallies{makeTallies(20)};
+  Checkpoint checkpoint{Checkpoint::read(path, resumed_tallies)};
+  RunDriver resumed(transport, physics, resumed_tallies, beam, settings);
+  resumed.restart(checkpoint);
+  resumed.run();
+
+  std::cout << "restart after " << checkpoint.histories_run << " of "
+            << settings.max_histories << " histories ("
+            << checkpoint.batches_run << " batches): "
+            << resumed.getHistoriesRun() << " histories, "
+            << countMismatches(reference, resumed)
+            << " mismatching bins against the uninterrupted run\n";
+  std::cout << "transmitted current " << reference.getStatistics(0).getMean(0)
+            << " / " << resumed.getStatistics(0).getMean(0) << "\n";
+
+  // A run configured differently must not take the file's counts
+  bool rejected{false};
+
+  try
+  {
+    Checkpoint::read(path, makeTallies(10));
+  }
+  catch(const std::runtime_error &)
+  {
+    rejected = true;
+  }
+
+  std::cout << "read by a run with a 10^3 mesh: "
+            << (rejected ? "rejected (ok)" : "accepted (FAIL)") << "\n\n";
+
+  // Cost against tally size, independent of the histories behind the state
+  std::cout << std::setw(12) << "bins" << std::setw(14) << "bytes"
+            << std::setw(14) << "snapshot s" << std::setw(14) << "write s"
+            << std::setw(14) << "submit s" << "\n";
+
+  long long no_written{0};
+
+  for(int n : {10, 25, 50, 100})
+  {
+    RunSettings cost_settings{settings};
+    cost_settings.max_histories = settings.histories_per_batch;
+
+    TallySet tally_set{makeTallies(n)};
+    RunDriver driver(transport, physics, tally_set, beam, cost_settings);
+    driver.run();
+
+    // Taken on the transport thread between batches
+    auto start{std::chrono::steady_clock::now()};
+    Checkpoint snapshot{driver.getCheckpoint()};
+    double snapshot_seconds{secondsSince(start)};
+
+    // Done by the background writer
+    start = std::chrono::steady_clock::now();
+    snapshot.write(path);
+    double write_seconds{secondsSince(start)};
+
+    // What the batch loop waits for with a writer
+    CheckpointWriter writer(path);
+    start = std::chrono::steady_clock::now();
+    writer.submit(driver.getCheckpoint());
+    double submit_seconds{secondsSince(start)};
+    writer.flush();
+    no_written += writer.getNoWritten();
+
+    std::cout << std::setw(12) << driver.getStatistics(1).getNoBins()
+              << std::setw(14) << std::filesystem::file_size(path)
+              << std::setw(14) << snapshot_seconds << std::setw(14)
+              << write_seconds << std::setw(14) << submit_seconds << "\n";
+  }
+
+  std::cout << "\n" << no_written << " checkpoints written in the background\n";
+
+  std::remove(path.c_str());
+
+  return rejected ? 0 : 1;
+}
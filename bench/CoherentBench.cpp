@@ -0,0 +1,277 @@
+// Coherent sampler benchmark
+// Checks CoherentSampler cross sections, scaled and of the fitted model
+// alone, against the tabulated coherent column, the hydrogen fit against the
+// exact hydrogen form factor, and sampled cos theta histograms against
+// (1 + cos^2 theta) F^2 from the fitted form factor, integrated numerically,
+// for a few elements and energies. Also times loading an element and its
+// first coherent use, which fits the form factor, and checks that later uses
+// share that sampler.
+
+#include "CoherentSampler.hpp"
+#include "DataProcessor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+namespace
+{
+
+using ElementConversion::Element;
+using ParticleConstants::ParticleType;
+using ParticleConstants::ReactionType;
+
+const int NoBins{40};
+const long long NoSamples{2000000};
+
+// chi^2 per degree of freedom above which a histogram fails. With 39 degrees
+// of freedom its standard deviation is about 0.23.
+const double MaxChiSquaredPerDof{2.0};
+
+// Largest relative difference from the tabulated cross section
+const double MaxCrossSectionError{1e-12};
+
+// Largest relative difference of the fitted model before scaling. Two shells
+// miss the tabulated cross sections of heavy elements by up to about 12%, a
+// failed fit by far more.
+const double MaxModelCrossSectionError{0.15};
+
+// Largest difference from the exact hydrogen form factor, as a share of Z
+const double MaxHydrogenFormFactorError{0.02};
+
+// Bohr radius (Angstrom)
+const double BohrRadius{0.529177210903};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Simpson integral of f over [a, b]
+template <typename F> double integrate(F f, double a, double b)
+{
+  const int no_intervals{2000};
+  double h{(b - a) / no_intervals};
+  double sum{f(a) + f(b)};
+
+  for(int i{1}; i < no_intervals; i++)
+  {
+    sum += (i % 2 == 0 ? 2.0 : 4.0) * f(a + i * h);
+  }
+
+  return sum * h / 3.0;
+}
+
+// Fitted F / Z at momentum transfer x (1/Angstrom)
+double modelFormFactor(const FormFactor &form_factor, double x)
+{
+  double outer{1.0 + x * x / (form_factor.outer_scale *
+                              form_factor.outer_scale)};
+  double core{1.0 + x * x / (form_factor.core_scale * form_factor.core_scale)};
+
+  return (1.0 - form_factor.core_fraction) / (outer * outer) +
+         form_factor.core_fraction / (core * core);
+}
+
+// Density in t = 1 - cos theta, not normalised
+double modelDensity(const FormFactor &form_factor, double energy,
+                    double one_minus_cos)
+{
+  double x_squared{energy * energy * one_minus_cos /
+                   (2.0 * ParticleConstants::PlanckTimesC *
+                    ParticleConstants::PlanckTimesC)};
+  double shells{modelFormFactor(form_factor, std::sqrt(x_squared))};
+  double cos_theta{1.0 - one_minus_cos};
+
+  return (1.0 + cos_theta * cos_theta) * shells * shells;
+}
+
+bool check(bool passed)
+{
+  std::cout << (passed ? " (ok)" : " (FAIL)");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  RandomNumberGenerator rng(1);
+  bool passed{true};
+
+  for(Element element : {Element::H, Element::O, Element::Fe, Element::Pb})
+  {
+    auto start{std::chrono::steady_clock::now()};
+    data_processor.addDataSingleFile(ParticleType::GAMMA, element);
+    double load_ms{secondsSince(start) * 1e3};
+
+    std::shared_ptr<const std::vector<std::vector<double>>> data{
+        data_processor.getData(ParticleType::GAMMA, element)};
+    const std::vector<std::vector<double>> &rows{*data};
+
+    start = std::chrono::steady_clock::now();
+    const CoherentSampler &sampler{data_processor.getCoherentSampler(element)};
+    double fit_ms{secondsSince(start) * 1e3};
+
+    start = std::chrono::steady_clock::now();
+    const CoherentSampler &shared{data_processor.getCoherentSampler(element)};
+    double shared_ms{secondsSince(start) * 1e3};
+
+    const FormFactor &form_factor{sampler.getFormFactor()};
+
+    std::cout << ElementConversion::ElementToSymbol.at(element) << ": load "
+              << load_ms << " ms, first use with fit " << fit_ms
+              << " ms, second use " << shared_ms << " ms, x_o "
+              << form_factor.outer_scale << ", x_c " << form_factor.core_scale
+              << ", c " << form_factor.core_fraction;
+    passed &= check(&shared == &sampler);
+    std::cout << "\n";
+
+    // Cross sections at and between the tabulated energies
+    double atomic_mass{ElementConversion::ElementalMasses.at(element)};
+    auto tabulated{[&](double energy)
+                   {
+                     return data_processor.getAttenCoef(
+                                energy, ReactionType::COHERENT_SCATTERING,
+                                ParticleType::GAMMA, element) *
+                            atomic_mass / ParticleConstants::Avogadro;
+                   }};
+
+    double error{0.0};
+    double model_error{0.0};
+
+    for(size_t row{0}; row < rows.size(); row++)
+    {
+      double energy{rows[row][FileConstants::EnergyColumn]};
+      std::vector<double> energies{energy};
+
+      if(row + 1 < rows.size() &&
+         rows[row + 1][FileConstants::EnergyColumn] > energy)
+      {
+        energies.push_back(
+            std::sqrt(energy * rows[row + 1][FileConstants::EnergyColumn]));
+      }
+
+      for(double point : energies)
+      {
+        error = std::max(error, std::abs(sampler.getCrossSection(point) /
+                                             tabulated(point) -
+                                         1.0));
+        model_error = std::max(
+            model_error,
+            std::abs(sampler.getModelCrossSection(point) / tabulated(point) -
+                     1.0));
+      }
+    }
+
+    std::cout << "  sigma relative error " << error
+              << ", of the model before scaling " << model_error;
+    passed &= check(error < MaxCrossSectionError &&
+                    model_error < MaxModelCrossSectionError);
+    std::cout << "\n";
+
+    // Hydrogen's form factor is known exactly, 1 / (1 + (2 pi a_0 x)^2)^2
+    if(element == Element::H)
+    {
+      double form_factor_error{0.0};
+
+      for(double x{0.0}; x <= 4.0; x += 0.01)
+      {
+        double scaled{2.0 * std::numbers::pi * BohrRadius * x};
+        double exact{1.0 / ((1.0 + scaled * scaled) * (1.0 + scaled * scaled))};
+
+        form_factor_error =
+            std::max(form_factor_error,
+                     std::abs(modelFormFactor(form_factor, x) - exact));
+      }
+
+      std::cout << "  largest difference from the exact form factor "
+                << form_factor_error;
+      passed &= check(form_factor_error < MaxHydrogenFormFactorError);
+      std::cout << "\n";
+    }
+
+    // Bins in t = 1 - cos theta, the first from 0 to where about a thousandth
+    // of the scattering is and the rest geometric from there to 2
+    for(double energy : {0.01, 0.1, 1.0})
+    {
+      auto pdf{[&](double one_minus_cos)
+               { return modelDensity(form_factor, energy, one_minus_cos); }};
+      auto log_pdf{[&](double log_t)
+                   {
+                     double t{std::exp(log_t)};
+                     return pdf(t) * t;
+                   }};
+
+      double outer_k{energy / (ParticleConstants::PlanckTimesC *
+                               form_factor.outer_scale)};
+      double first_edge{1e-3 * std::min(2.0, 2.0 / (outer_k * outer_k))};
+      double log_first{std::log(first_edge)};
+      double log_step{(std::log(2.0) - log_first) / (NoBins - 1)};
+
+      std::vector<double> expected(NoBins);
+      expected[0] = integrate(pdf, 0.0, first_edge);
+
+      for(int bin{1}; bin < NoBins; bin++)
+      {
+        expected[bin] = integrate(log_pdf, log_first + (bin - 1) * log_step,
+                                  log_first + bin * log_step);
+      }
+
+      double norm{0.0};
+
+      for(double probability : expected)
+      {
+        norm += probability;
+      }
+
+      std::vector<long long> counts(NoBins, 0);
+
+      start = std::chrono::steady_clock::now();
+      for(long long sample{0}; sample < NoSamples; sample++)
+      {
+        double one_minus_cos{1.0 - sampler.sample(energy, rng.getUniform())};
+        int bin{0};
+
+        if(one_minus_cos >= first_edge)
+        {
+          bin = std::clamp(
+              1 + static_cast<int>((std::log(one_minus_cos) - log_first) /
+                                   log_step),
+              1, NoBins - 1);
+        }
+
+        counts[bin] += 1;
+      }
+      double sample_ns{secondsSince(start) * 1e9 / NoSamples};
+
+      double chi_squared{0.0};
+
+      for(int bin{0}; bin < NoBins; bin++)
+      {
+        double mean{NoSamples * expected[bin] / norm};
+        double difference{counts[bin] - mean};
+
+        chi_squared += difference * difference / mean;
+      }
+
+      double chi_squared_per_dof{chi_squared / (NoBins - 1)};
+
+      std::cout << "  " << std::setw(6) << energy << " MeV, chi2/dof "
+                << std::setw(10) << chi_squared_per_dof << ", " << sample_ns
+                << " ns per sample";
+      passed &= check(chi_squared_per_dof < MaxChiSquaredPerDof);
+      std::cout << "\n";
+    }
+  }
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// Compton sampler benchmark
+// Checks sampled cos theta histograms and mean energy losses against the
+// Klein-Nishina distribution integrated numerically at a few energies, checks
+// that scatterBatch gives the same particles as scatter from the same random
+// numbers, and times both.
+
+#include "ComptonSampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+const int NoBins{40};
+const long long NoSamples{2000000};
+
+// chi^2 per degree of freedom above which a histogram fails. With 39 degrees
+// of freedom its standard deviation is about 0.23.
+const double MaxChiSquaredPerDof{2.0};
+
+// Standard errors the mean energy loss may be off by
+const double MaxStandardErrors{4.0};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Simpson integral of f over [a, b]
+template <typename F> double integrate(F f, double a, double b)
+{
+  const int no_intervals{2000};
+  double h{(b - a) / no_intervals};
+  double sum{f(a) + f(b)};
+
+  for(int i{1}; i < no_intervals; i++)
+  {
+    sum += (i % 2 == 0 ? 2.0 : 4.0) * f(a + i * h);
+  }
+
+  return sum * h / 3.0;
+}
+
+bool check(bool passed)
+{
+  std::cout << (passed ? " (ok)" : " (FAIL)");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  ComptonSampler sampler;
+  RandomNumberGenerator rng(1);
+  bool passed{true};
+
+  std::cout << "Klein-Nishina, " << NoSamples << " samples per energy, "
+            << NoBins << " bins in cos theta\n";
+  std::cout << std::setw(10) << "E (MeV)" << std::setw(14) << "chi2/dof"
+            << std::setw(16) << "<dE/E> sampled" << std::setw(16)
+            << "<dE/E> exact" << std::setw(12) << "std errs" << "\n";
+
+  for(double energy : {0.01, 0.1, 0.662, 2.0, 10.0})
+  {
+    double k{energy / ParticleConstants::ElectronMass};
+    auto pdf{[energy](double one_minus_cos)
+             { return ComptonSampler::kleinNishina(energy, one_minus_cos); }};
+    auto loss{[energy, k](double one_minus_cos)
+              {
+                return ComptonSampler::kleinNishina(energy, one_minus_cos) *
+                       k * one_minus_cos / (1.0 + k * one_minus_cos);
+              }};
+
+    double norm{integrate(pdf, 0.0, 2.0)};
+    double exact_loss{integrate(loss, 0.0, 2.0) / norm};
+
+    std::vector<long long> counts(NoBins, 0);
+    double loss_sum{0.0};
+    double loss_squares{0.0};
+
+    for(long long sample{0}; sample < NoSamples; sample++)
+    {
+      auto [scattered, cos_theta]{sampler.sample(energy, rng.getUniform())};
+      int bin{std::clamp(static_cast<int>((cos_theta + 1.0) * 0.5 * NoBins),
+                         0, NoBins - 1)};
+      double fraction{1.0 - scattered / energy};
+
+      counts[bin] += 1;
+      loss_sum += fraction;
+      loss_squares += fraction * fraction;
+    }
+
+    // Bins run up in cos theta, so down in 1 - cos theta
+    double chi_squared{0.0};
+
+    for(int bin{0}; bin < NoBins; bin++)
+    {
+      double high{2.0 - 2.0 * bin / NoBins};
+      double low{2.0 - 2.0 * (bin + 1) / NoBins};
+      double expected{NoSamples * integrate(pdf, low, high) / norm};
+      double difference{counts[bin] - expected};
+
+      chi_squared += difference * difference / expected;
+    }
+
+    double mean_loss{loss_sum / NoSamples};
+    double standard_error{
+        std::sqrt((loss_squares / NoSamples - mean_loss * mean_loss) /
+                  NoSamples)};
+    double errors{std::abs(mean_loss - exact_loss) / standard_error};
+    double chi_squared_per_dof{chi_squared / (NoBins - 1)};
+
+    std::cout << std::setw(10) << energy << std::setw(14)
+              << chi_squared_per_dof << std::setw(16) << mean_loss
+              << std::setw(16) << exact_loss << std::setw(12) << errors;
+    passed &= check(chi_squared_per_dof < MaxChiSquaredPerDof &&
+                    errors < MaxStandardErrors);
+    std::cout << "\n";
+  }
+
+  // Batched against scalar from the same random numbers
+  const size_t no_particles{100000};
+  std::vector<Particle> scalar;
+  RandomNumberGenerator setup_rng(2);
+
+  for(size_t i{0}; i < no_particles; i++)
+  {
+    scalar.emplace_back(ParticleConstants::ParticleType::GAMMA,
+                        0.01 + 5.0 * setup_rng.getUniform(), Vector3D::ZERO,
+                        setup_rng.getIsotropicDirection());
+  }
+
+  // Straight along and against z, which the rotations treat separately
+  scalar[0].setUnitDirection(Vector3D::UNITZ);
+  scalar[1].setUnitDirection(Vector3D(0.0, 0.0, -1.0));
+
+  std::vector<Particle> batched{scalar};
+  std::vector<double> scalar_deposits(no_particles);
+  std::vector<double> batched_deposits(no_particles);
+  RandomNumberGenerator scalar_rng(3);
+  RandomNumberGenerator batched_rng(3);
+
+  auto start{std::chrono::steady_clock::now()};
+  for(size_t i{0}; i < no_particles; i++)
+  {
+    scalar_deposits[i] = sampler.scatter(scalar[i], scalar_rng);
+  }
+  double scalar_ns{secondsSince(start) * 1e9 / no_particles};
+
+  start = std::chrono::steady_clock::now();
+  sampler.scatterBatch(batched, batched_rng, batched_deposits);
+  double batched_ns{secondsSince(start) * 1e9 / no_particles};
+
+  double energy_difference{0.0};
+  double direction_difference{0.0};
+  double deposit_difference{0.0};
+
+  for(size_t i{0}; i < no_particles; i++)
+  {
+    energy_difference =
+        std::max(energy_difference,
+                 std::abs(scalar[i].getEnergy() - batched[i].getEnergy()));
+    direction_difference = std::max(
+        direction_difference,
+        scalar[i].getDirection().distance(batched[i].getDirection()));
+    deposit_difference =
+        std::max(deposit_difference,
+                 std::abs(scalar_deposits[i] - batched_deposits[i]));
+  }
+
+  std::cout << "\nscatter " << scalar_ns << " ns, scatterBatch " << batched_ns
+            << " ns, largest differences: energy " << energy_difference
+            << ", deposit " << deposit_difference << ", direction "
+            << direction_difference;
+  passed &= check(energy_difference == 0.0 && deposit_difference == 0.0 &&
+                  direction_difference < 1e-14);
+  std::cout << "\n";
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Convergence-driven run benchmark
+// Transports a 1 MeV pencil beam through a 5 cm lead slab and scores the
+// transmitted current on a plane 5 cm behind it. Each run stops on its own
+// once its relative error target is met, reporting the histories it needed
+// and its figure of merit. Also checks that a short last batch is weighted by
+// the histories it ran.
+
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+bool check(bool passed)
+{
+  std::cout << (passed ? " (ok)\n" : " (FAIL)\n");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  SlabGeometry geometry({{&lead, 5.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  Source beam{[](RandomNumberGenerator &)
+              {
+                return Particle(ParticleConstants::ParticleType::GAMMA, 1.0,
+                                Vector3D::ZERO, Vector3D::UNITZ);
+              }};
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 20000;
+  settings.max_histories = 20000000;
+
+  std::cout << std::setw(12) << "target" << std::setw(12) << "histories"
+            << std::setw(10) << "batches" << std::setw(14) << "current"
+            << std::setw(12) << "rel error" << std::setw(12) << "seconds"
+            << std::setw(12) << "FOM" << "\n";
+
+  for(double target : {0.05, 0.02, 0.01, 0.005})
+  {
+    TallySet tally_set;
+    int behind{tally_set.addTally(std::make_unique<SurfaceTally>(
+        "behind", Vector3D::UNITZ, 10.0,
+        std::vector<double>{1e-3, 1.01}))};
+
+    RunDriver driver(transport, physics, tally_set, beam, settings);
+    driver.addTarget({behind, TallyStatistics::TotalBin, target});
+
+    bool converged{driver.run()};
+
+    // Bin 0 is the net current of the only energy bin
+    const TallyStatistics &statistics{driver.getStatistics(behind)};
+
+    std::cout << std::setw(12) << target << std::setw(12)
+              << driver.getHistoriesRun() << std::setw(10)
+              << driver.getBatchesRun() << std::setw(14)
+              << statistics.getMean(0) << std::setw(12)
+              << statistics.getRelativeError(0) << std::setw(12)
+              << driver.getElapsedSeconds() << std::setw(12)
+              << statistics.getFigureOfMerit(0, driver.getElapsedSeconds())
+              << (converged ? "" : "  (not converged)") << "\n";
+  }
+
+  // Two full batches scoring 1 and 3 per history, then one history scoring
+  // 10, which must not count as much as a full batch
+  TallyStatistics uneven(1);
+  TallyBuffer batch(1, TallyStorage::DENSE);
+
+  for(auto [score, histories] : {std::pair{1000.0, 1000LL},
+                                 std::pair{3000.0, 1000LL},
+                                 std::pair{10.0, 1LL}})
+  {
+    batch.clear();
+    batch.add(0, score);
+    uneven.addBatch(batch, histories);
+  }
+
+  double expected{4010.0 / 2001.0};
+
+  std::cout << "\nshort last batch: mean " << uneven.getMean(0)
+            << ", per history " << expected;
+  bool passed{check(std::abs(uneven.getMean(0) / expected - 1.0) < 1e-12 &&
+                    uneven.getNoHistories() == 2001)};
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// Cross section cache benchmark
+// Checks cached total attenuation coefs against summing the reaction coefs,
+// times lookups that hit the per-thread cache against ones that miss, and
+// reports the hit rate of surface and delta tracking runs through a layered
+// shield. Also checks that a material built where a freed one was does not
+// get the freed one's coefs.
+
+#include "CrossSectionCache.hpp"
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+// Nanoseconds per lookup cycling through energies
+double timeLookups(const Material &material,
+                   const std::vector<double> &energies, int repeats)
+{
+  double sum{0.0};
+  auto start{std::chrono::steady_clock::now()};
+
+  for(int repeat{0}; repeat < repeats; repeat++)
+  {
+    for(double energy : energies)
+    {
+      sum += material.getTotalLinearAttenCoef(
+          energy, ParticleConstants::ParticleType::GAMMA);
+    }
+  }
+
+  double seconds{std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()};
+
+  // Keeps the loop from being optimised away
+  if(sum < 0.0)
+  {
+    std::cout << sum;
+  }
+
+  return 1e9 * seconds / (static_cast<double>(repeats) * energies.size());
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+  const auto gamma{ParticleConstants::ParticleType::GAMMA};
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+
+  // Accuracy against the uncached sum of reaction coefs
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> log_energy(std::log(1e-3),
+                                                    std::log(1e2));
+  double max_error{0.0};
+
+  for(int i{0}; i < 100000; i++)
+  {
+    // Nearby energies exercise the bin reuse
+    double energy{std::exp(log_energy(rng))};
+
+    for(double query : {energy, energy * 1.001, energy})
+    {
+      double reference{0.0};
+
+      for(const auto &reaction : ParticleConstants::AllowedReactions.at(gamma))
+      {
+        reference += lead.getLinearAttenCoef(query, reaction, gamma);
+      }
+
+      max_error =
+          std::max(max_error,
+                   std::abs(lead.getTotalLinearAttenCoef(query, gamma) -
+                            reference) /
+                       reference);
+    }
+  }
+
+  std::cout << "Max relative error of cached coefs " << max_error << "\n";
+
+  // A material in the storage of a freed one, at the last energy asked of it
+  std::optional<Material> slot;
+  slot.emplace("lead", 11.35, std::vector<std::pair<Element, double>>{
+                                  {Element::Pb, 1.0}});
+  const Material *freed_address{&*slot};
+  double freed_coef{slot->getTotalLinearAttenCoef(0.662, gamma)};
+
+  slot.emplace("iron", 7.87, std::vector<std::pair<Element, double>>{
+                                 {Element::Fe, 1.0}});
+  double reused_coef{slot->getTotalLinearAttenCoef(0.662, gamma)};
+  double reference{0.0};
+
+  for(const auto &reaction : ParticleConstants::AllowedReactions.at(gamma))
+  {
+    reference += slot->getLinearAttenCoef(0.662, reaction, gamma);
+  }
+
+  bool passed{std::abs(reused_coef / reference - 1.0) < 1e-12 &&
+              reused_coef != freed_coef};
+
+  std::cout << "Material at a "
+            << ((&*slot == freed_address) ? "reused" : "new")
+            << " address, coef " << reused_coef << " against " << reference
+            << ((passed) ? " (ok)" : " (FAIL)") << "\n\n";
+
+  // Hits repeat one energy, misses cycle through more energies than entries
+  std::vector<double> one_energy{0.662};
+  std::vector<double> many_energies;
+
+  for(int i{0}; i < 64; i++)
+  {
+    many_energies.push_back(std::exp(log_energy(rng)));
+  }
+
+  std::cout << "Lookup cost, ns: hit "
+            << timeLookups(concrete, one_energy, 10000000) << ", miss "
+            << timeLookups(concrete, many_energies, 100000) << "\n\n";
+
+  // Hit rates in transport
+  Material water{Material::fromFormula("water", 1.0,
+                                       {{Element::H, 2.0}, {Element::O, 1.0}})};
+  std::vector<std::pair<const Material *, double>> layers;
+
+  for(int i{0}; i < 5; i++)
+  {
+    layers.push_back({&concrete, 4.0});
+    layers.push_back({&lead, 0.5});
+    layers.push_back({&water, 2.0});
+  }
+
+  SlabGeometry geometry(layers);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 20000;
+  settings.max_histories = 200000;
+
+  std::cout << std::setw(10) << "tracking" << std::setw(14) << "lookups"
+            << std::setw(12) << "hit rate" << std::setw(12) << "seconds"
+            << "\n";
+
+  for(TrackingMode mode : {TrackingMode::SURFACE, TrackingMode::DELTA})
+  {
+    Transport transport(geometry, gamma, mode);
+    TallySet tally_set;
+    tally_set.addTally(std::make_unique<SurfaceTally>(
+        "behind", Vector3D::UNITZ, geometry.getTotalThickness(),
+        std::vector<double>{1e-3, 1.01}));
+
+    RunDriver driver(transport, physics, tally_set,
+                     [gamma](RandomNumberGenerator &)
+                     {
+                       return Particle(gamma, 1.0, Vector3D::ZERO,
+                                       Vector3D::UNITZ);
+                     },
+                     settings);
+
+    CrossSectionCache::resetStatistics();
+    driver.run();
+    CrossSectionCacheStatistics statistics{
+        CrossSectionCache::getStatistics()};
+
+    std::cout << std::setw(10)
+              << ((mode == TrackingMode::SURFACE) ? "surface" : "delta")
+              << std::setw(14) << statistics.hits + statistics.misses
+              << std::setw(12) << statistics.getHitRate() << std::setw(12)
+              << driver.getElapsedSeconds() << "\n";
+  }
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// Scaling benchmark of CsgGeometry cell lookup
+// Builds voxel lattices of box cells with a spherical inclusion in each voxel
+// and reports build time and ns per findRegion as the cell count grows, along
+// with a linear scan over all cells for comparison
+
+#include "CsgGeometry.hpp"
+#include "Material.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+// n x n x n unit voxels, each split into a sphere and the box around it
+CsgGeometry makeLattice(int n, const Material *outer, const Material *inner)
+{
+  CsgGeometry geometry;
+
+  for(int i{0}; i < n; i++)
+  {
+    for(int j{0}; j < n; j++)
+    {
+      for(int k{0}; k < n; k++)
+      {
+        Vector3D corner(i, j, k);
+
+        int box{geometry.addSurface(
+            std::make_unique<Box>(corner, corner + Vector3D(1.0)))};
+        int sphere{geometry.addSurface(
+            std::make_unique<Sphere>(corner + Vector3D(0.5), 0.4))};
+
+        geometry.addCell({{box, Sense::INSIDE}, {sphere, Sense::OUTSIDE}},
+                         outer);
+        geometry.addCell({{sphere, Sense::INSIDE}}, inner);
+      }
+    }
+  }
+
+  return geometry;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material iron("iron", 7.874, {{Element::Fe, 1.0}});
+  Material water =
+      Material::fromFormula("water", 1.0, {{Element::H, 2}, {Element::O, 1}});
+
+  RandomNumberGenerator rng(12345);
+  const int lookups{200000};
+
+  std::cout << std::setw(10) << "cells" << std::setw(14) << "build ms"
+            << std::setw(14) << "bvh ns" << std::setw(14) << "linear ns"
+            << "\n";
+
+  for(int n{2}; n <= 64; n *= 2)
+  {
+    auto build_start{std::chrono::steady_clock::now()};
+
+    CsgGeometry geometry{makeLattice(n, &iron, &water)};
+    geometry.build();
+
+    auto build_end{std::chrono::steady_clock::now()};
+
+    std::vector<Vector3D> points;
+
+    for(int i{0}; i < lookups; i++)
+    {
+      points.emplace_back(n * rng.getUniform(), n * rng.getUniform(),
+                          n * rng.getUniform());
+    }
+
+    long long found{0};
+
+    auto bvh_start{std::chrono::steady_clock::now()};
+
+    for(const Vector3D &point : points)
+    {
+      found += geometry.findRegion(point);
+    }
+
+    auto bvh_end{std::chrono::steady_clock::now()};
+
+    // Linear reference over a subset of points as it gets slow
+    int linear_lookups{
+        std::min(lookups, 2000000 / geometry.getNumberRegions())};
+
+    auto linear_start{std::chrono::steady_clock::now()};
+
+    for(int i{0}; i < linear_lookups; i++)
+    {
+      for(int region{0}; region < geometry.getNumberRegions(); region++)
+      {
+        if(geometry.cellContains(region, points[i]))
+        {
+          found += region;
+          break;
+        }
+      }
+    }
+
+    auto linear_end{std::chrono::steady_clock::now()};
+
+    std::cout << std::setw(10) << geometry.getNumberRegions() << std::fixed
+              << std::setprecision(2) << std::setw(14)
+              << std::chrono::duration<double, std::milli>(build_end -
+                                                           build_start)
+                     .count()
+              << std::setw(14)
+              << std::chrono::duration<double, std::nano>(bvh_end - bvh_start)
+                         .count() /
+                     lookups
+              << std::setw(14)
+              << std::chrono::duration<double, std::nano>(linear_end -
+                                                          linear_start)
+                         .count() /
+                     linear_lookups
+              << "\n";
+    std::cout.unsetf(std::ios::fixed);
+
+    if(found < 0)
+    {
+      std::cout << "Lookup failed\n";
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Crossover benchmark of delta tracking against surface tracking
+// Runs first-flight transport through alternating two-material slab stacks of
+// fixed total thickness with an increasing number of layers and reports the
+// time per history for each tracking mode, along with the collision probability
+// from each mode as a consistency check
+
+#include "Material.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SlabGeometry.hpp"
+#include "Transport.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Average ns per history to move a normally incident beam particle to its first
+// collision or out of the stack
+double timeTracking(const SlabGeometry &geometry, TrackingMode tracking_mode,
+                    double energy, int histories, int &collisions)
+{
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      tracking_mode);
+  RandomNumberGenerator rng(12345);
+
+  collisions = 0;
+
+  auto start{std::chrono::steady_clock::now()};
+
+  for(int i{0}; i < histories; i++)
+  {
+    Particle particle(ParticleConstants::ParticleType::GAMMA, energy,
+                      Vector3D::ZERO, Vector3D::UNITZ);
+
+    if(transport.moveToCollision(particle, rng) != -1)
+    {
+      collisions += 1;
+    }
+  }
+
+  auto end{std::chrono::steady_clock::now()};
+
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         histories;
+}
+
+void runCrossover(const Material &material_a, const Material &material_b,
+                  double total_thickness, double energy, int histories)
+{
+  std::cout << material_a.getName() << "/" << material_b.getName() << ", "
+            << total_thickness << " cm, " << energy << " MeV\n";
+  std::cout << std::setw(8) << "layers" << std::setw(14) << "surface ns"
+            << std::setw(14) << "delta ns" << std::setw(12) << "speedup"
+            << std::setw(14) << "P(surface)" << std::setw(14) << "P(delta)"
+            << "\n";
+
+  int crossover{-1};
+
+  for(int layers{1}; layers <= 512; layers *= 2)
+  {
+    std::vector<std::pair<const Material *, double>> stack;
+
+    for(int i{0}; i < layers; i++)
+    {
+      stack.push_back({(i % 2 == 0) ? &material_a : &material_b,
+                       total_thickness / layers});
+    }
+
+    SlabGeometry geometry(stack);
+
+    int surface_collisions{0};
+    int delta_collisions{0};
+    double surface_ns{timeTracking(geometry, TrackingMode::SURFACE, energy,
+                                   histories, surface_collisions)};
+    double delta_ns{timeTracking(geometry, TrackingMode::DELTA, energy,
+                                 histories, delta_collisions)};
+
+    // Crossover is where delta tracking becomes and stays faster
+    if(delta_ns >= surface_ns)
+    {
+      crossover = -1;
+    }
+    else if(crossover == -1)
+    {
+      crossover = layers;
+    }
+
+    std::cout << std::setw(8) << layers << std::setw(14) << std::fixed
+              << std::setprecision(1) << surface_ns << std::setw(14)
+              << delta_ns << std::setw(12) << std::setprecision(2)
+              << surface_ns / delta_ns << std::setw(14) << std::setprecision(4)
+              << static_cast<double>(surface_collisions) / histories
+              << std::setw(14)
+              << static_cast<double>(delta_collisions) / histories << "\n";
+    std::cout.unsetf(std::ios::fixed);
+  }
+
+  if(crossover == -1)
+  {
+    std::cout << "Surface tracking faster throughout\n\n";
+  }
+  else
+  {
+    std::cout << "Delta tracking faster from " << crossover << " layers\n\n";
+  }
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  Material iron("iron", 7.874, {{Element::Fe, 1.0}});
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+
+  const int histories{20000};
+
+  runCrossover(iron, concrete, 20.0, 1.0, histories);
+  runCrossover(lead, concrete, 20.0, 1.0, histories);
+  runCrossover(lead, concrete, 10.0, 5.0, histories);
+
+  return 0;
+}
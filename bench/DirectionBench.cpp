@@ -0,0 +1,236 @@
+// Direction kernel benchmark
+// Times isotropic sampling and rotations through the trig free kernels
+// against the spherical angle forms, checks that rotations turn by the
+// sampled angle, and follows directions through long chains of rotations to
+// check that they stay unit length, with and without keepUnit and in the
+// batched kernel.
+
+#include "DirectionKernels.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <vector>
+
+namespace
+{
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+double lengthError(const Vector3D &direction)
+{
+  return std::abs(direction.magnitude() - 1.0);
+}
+
+// Tolerance on |direction| after the longest chain below
+const double UnitTolerance{1e-14};
+
+} // namespace
+
+int main()
+{
+  using namespace DirectionKernels;
+
+  RandomNumberGenerator rng(1);
+  const long long no_samples{10000000};
+  double checksum{0.0};
+
+  // Isotropic directions, spherical angles against Marsaglia
+  auto start{std::chrono::steady_clock::now()};
+  for(long long sample{0}; sample < no_samples; sample++)
+  {
+    double cos_theta{2.0 * rng.getUniform() - 1.0};
+    double sin_theta{std::sqrt(std::max(0.0, 1.0 - cos_theta * cos_theta))};
+    double phi{2.0 * std::numbers::pi * rng.getUniform()};
+    checksum += sin_theta * std::cos(phi) + sin_theta * std::sin(phi);
+  }
+  double trig_isotropic_ns{secondsSince(start) * 1e9 / no_samples};
+
+  Vector3D mean;
+  double mean_z2{0.0};
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < no_samples; sample++)
+  {
+    Vector3D direction{rng.getIsotropicDirection()};
+    mean += direction / no_samples;
+    mean_z2 += direction.getZ() * direction.getZ() / no_samples;
+  }
+  double isotropic_ns{secondsSince(start) * 1e9 / no_samples};
+
+  std::cout << "isotropic  sin/cos " << trig_isotropic_ns << " ns, Marsaglia "
+            << isotropic_ns << " ns, mean " << mean << ", mean z^2 "
+            << mean_z2 << " (expected 1/3)\n";
+
+  // Azimuths, one uniform and a sincos against a point in the unit disc as
+  // getAzimuth draws them
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < no_samples; sample++)
+  {
+    double phi{2.0 * std::numbers::pi * rng.getUniform()};
+    checksum += std::cos(phi) + std::sin(phi);
+  }
+  double azimuth_ns{secondsSince(start) * 1e9 / no_samples};
+
+  double mean_cos2{0.0};
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < no_samples; sample++)
+  {
+    Azimuth azimuth{rng.getAzimuth()};
+    mean_cos2 += azimuth.cos_phi * azimuth.cos_phi / no_samples;
+    checksum += azimuth.sin_phi;
+  }
+  double disc_azimuth_ns{secondsSince(start) * 1e9 / no_samples};
+
+  std::cout << "azimuth    sin/cos " << azimuth_ns << " ns, disc "
+            << disc_azimuth_ns << " ns, mean cos^2 " << mean_cos2
+            << " (expected 1/2)\n";
+
+  // Rotations from pre-drawn angles, phi against its cosine and sine
+  const size_t no_directions{4096};
+  std::vector<double> cos_thetas;
+  std::vector<double> phis;
+  std::vector<double> cos_phis;
+  std::vector<double> sin_phis;
+  std::vector<Vector3D> directions;
+
+  for(size_t i{0}; i < no_directions; i++)
+  {
+    cos_thetas.push_back(2.0 * rng.getUniform() - 1.0);
+    phis.push_back(2.0 * std::numbers::pi * rng.getUniform());
+    cos_phis.push_back(std::cos(phis.back()));
+    sin_phis.push_back(std::sin(phis.back()));
+    directions.push_back(rng.getIsotropicDirection());
+  }
+
+  const int no_passes{1000};
+  const double no_rotations{static_cast<double>(no_passes) * no_directions};
+  std::vector<Vector3D> rotated{directions};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    for(size_t i{0}; i < no_directions; i++)
+    {
+      rotated[i] = rotateDirection(rotated[i], cos_thetas[i], phis[i]);
+    }
+  }
+  double trig_rotate_ns{secondsSince(start) * 1e9 / no_rotations};
+
+  rotated = directions;
+  double angle_error{0.0};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    for(size_t i{0}; i < no_directions; i++)
+    {
+      rotated[i] = keepUnit(rotateDirection(rotated[i], cos_thetas[i],
+                                            {cos_phis[i], sin_phis[i]}));
+    }
+  }
+  double rotate_ns{secondsSince(start) * 1e9 / no_rotations};
+
+  for(size_t i{0}; i < no_directions; i++)
+  {
+    Vector3D turned{keepUnit(rotateDirection(directions[i], cos_thetas[i],
+                                             {cos_phis[i], sin_phis[i]}))};
+    angle_error = std::max(angle_error, std::abs(turned.dot(directions[i]) -
+                                                 cos_thetas[i]));
+  }
+
+  std::vector<double> u;
+  std::vector<double> v;
+  std::vector<double> w;
+
+  for(const Vector3D &direction : directions)
+  {
+    u.push_back(direction.getX());
+    v.push_back(direction.getY());
+    w.push_back(direction.getZ());
+  }
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    rotateDirections(u, v, w, cos_thetas, cos_phis, sin_phis);
+  }
+  double batch_ns{secondsSince(start) * 1e9 / no_rotations};
+
+  // After the same rotations, scalar and batched should agree to rounding
+  double batch_difference{0.0};
+
+  for(size_t i{0}; i < no_directions; i++)
+  {
+    batch_difference =
+        std::max(batch_difference,
+                 rotated[i].distance(Vector3D(u[i], v[i], w[i])));
+  }
+
+  std::cout << "rotation   phi " << trig_rotate_ns << " ns, cos/sin "
+            << rotate_ns << " ns, batched (" << Simd::InstructionSet << ") "
+            << batch_ns << " ns, largest |d.d' - cos theta| " << angle_error
+            << ", scalar vs batched after " << no_passes << " rotations "
+            << batch_difference << "\n\n";
+
+  // One direction through a long history of scatters, raw and kept unit
+  const long long chain_length{20000000};
+  Vector3D raw{Vector3D::UNITZ};
+  Vector3D kept{Vector3D::UNITZ};
+  double raw_error{0.0};
+  double kept_error{0.0};
+
+  for(long long step{0}; step < chain_length; step++)
+  {
+    double cos_theta{2.0 * rng.getUniform() - 1.0};
+    Azimuth azimuth{rng.getAzimuth()};
+
+    raw = rotateDirection(raw, cos_theta, azimuth);
+    kept = keepUnit(rotateDirection(kept, cos_theta, azimuth));
+    raw_error = std::max(raw_error, lengthError(raw));
+    kept_error = std::max(kept_error, lengthError(kept));
+  }
+
+  // Many directions through the batched kernel, which keeps them unit
+  const int batch_chain_length{5000};
+  double batch_error{0.0};
+
+  for(int step{0}; step < batch_chain_length; step++)
+  {
+    for(size_t i{0}; i < no_directions; i++)
+    {
+      cos_thetas[i] = 2.0 * rng.getUniform() - 1.0;
+      Azimuth azimuth{rng.getAzimuth()};
+      cos_phis[i] = azimuth.cos_phi;
+      sin_phis[i] = azimuth.sin_phi;
+    }
+
+    rotateDirections(u, v, w, cos_thetas, cos_phis, sin_phis);
+
+    for(size_t i{0}; i < no_directions; i++)
+    {
+      batch_error =
+          std::max(batch_error, lengthError(Vector3D(u[i], v[i], w[i])));
+    }
+  }
+
+  std::cout << "largest ||d| - 1| over " << chain_length
+            << " chained rotations: raw " << raw_error << ", keepUnit "
+            << kept_error << (kept_error < UnitTolerance ? " (ok)" : " (FAIL)")
+            << "\n";
+  std::cout << "largest ||d| - 1| over " << no_directions << " x "
+            << batch_chain_length << " batched rotations: " << batch_error
+            << (batch_error < UnitTolerance ? " (ok)" : " (FAIL)") << "\n";
+  std::cout << "(checksum " << checksum << ")\n";
+
+  return 0;
+}
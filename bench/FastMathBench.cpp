@@ -0,0 +1,302 @@
+// FastMath accuracy and speed benchmark
+// Checks log2 and exp2 against std over their domains, then interpolates every
+// column at the midpoint of every grid interval of all 100 photon files with
+// each precision against the std::log/std::exp path, and times the lookups.
+
+#include "DataProcessor.hpp"
+#include "FastMath.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using FastMath::Precision;
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+double relativeError(double value, double reference)
+{
+  return reference == 0.0 ? std::abs(value)
+                          : std::abs(value - reference) / std::abs(reference);
+}
+
+// Grid interval midpoint and the values interpolated between
+struct Midpoint
+{
+  double energy;
+  double a1;
+  double a2;
+  double b1;
+  double b2;
+  ElementConversion::Element element;
+  size_t column;
+};
+
+template <Precision P> void checkFunctions(const std::string &name)
+{
+  const double bound{P == Precision::HIGH ? 1e-12 : 1e-7};
+  double log_error{0.0};
+  double exp_error{0.0};
+
+  // Whole normal range, and ratios close to 1 as interpolation takes them
+  for(int i{0}; i <= 2000000; i++)
+  {
+    double x{std::pow(2.0, -1000.0 + 2000.0 * i / 2000000.0)};
+    double ratio{1.0 + (i - 1000000) * 1e-7};
+
+    log_error = std::max(log_error,
+                         relativeError(FastMath::log2<P>(x), std::log2(x)));
+
+    if(ratio != 1.0)
+    {
+      log_error =
+          std::max(log_error, relativeError(FastMath::log2<P>(ratio),
+                                            std::log2(ratio)));
+    }
+  }
+
+  for(int i{0}; i <= 2000000; i++)
+  {
+    double x{-1000.0 + 2000.0 * i / 2000000.0};
+    double small{-1.0 + 2.0 * i / 2000000.0};
+
+    exp_error = std::max(exp_error,
+                         relativeError(FastMath::exp2<P>(x), std::exp2(x)));
+    exp_error = std::max(
+        exp_error, relativeError(FastMath::exp2<P>(small), std::exp2(small)));
+  }
+
+  std::cout << std::setw(10) << name << "  log2 " << std::setw(12)
+            << log_error << "  exp2 " << std::setw(12) << exp_error
+            << "  bound " << bound
+            << (std::max(log_error, exp_error) < bound ? " (ok)" : " (FAIL)")
+            << "\n";
+}
+
+double interpolate(const Midpoint &midpoint)
+{
+  return Interpolation::interpolateBetween(midpoint.energy, midpoint.a1,
+                                           midpoint.a2, midpoint.b1,
+                                           midpoint.b2);
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  const ParticleConstants::ParticleType gamma{
+      ParticleConstants::ParticleType::GAMMA};
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  for(int z{1}; z <= 100; z++)
+  {
+    data_processor.addDataSingleFile(gamma, static_cast<Element>(z));
+  }
+
+  std::cout << "Function accuracy (largest relative error against std)\n";
+  checkFunctions<Precision::HIGH>("HIGH");
+  checkFunctions<Precision::FAST>("FAST");
+
+  std::vector<Midpoint> midpoints;
+
+  for(int z{1}; z <= 100; z++)
+  {
+    std::shared_ptr<const std::vector<std::vector<double>>> data{
+        data_processor.getData(gamma, static_cast<Element>(z))};
+    const std::vector<std::vector<double>> &rows{*data};
+
+    for(size_t row{0}; row + 1 < rows.size(); row++)
+    {
+      double a1{rows[row][FileConstants::EnergyColumn]};
+      double a2{rows[row + 1][FileConstants::EnergyColumn]};
+      double energy{0.5 * (a1 + a2)};
+
+      // k-edges have no interval between their rows
+      if(!(energy > a1 && energy < a2))
+      {
+        continue;
+      }
+
+      for(size_t column{1}; column < rows[row].size(); column++)
+      {
+        midpoints.push_back({energy, a1, a2, rows[row][column],
+                             rows[row + 1][column], static_cast<Element>(z),
+                             column});
+      }
+    }
+  }
+
+  FastMath::setPrecision(Precision::STANDARD);
+  std::vector<double> reference;
+
+  for(const Midpoint &midpoint : midpoints)
+  {
+    reference.push_back(interpolate(midpoint));
+  }
+
+  std::cout << "\nInterpolation at " << midpoints.size()
+            << " grid midpoints of 100 elements x 7 columns\n";
+  std::cout << std::setw(10) << "precision" << std::setw(14) << "max rel err"
+            << std::setw(14) << "mean rel err" << std::setw(10) << "worst Z"
+            << std::setw(8) << "column" << std::setw(14) << "ns/interp"
+            << std::setw(14) << "ns/lookup" << "\n";
+
+  for(Precision precision :
+      {Precision::STANDARD, Precision::HIGH, Precision::FAST})
+  {
+    FastMath::setPrecision(precision);
+
+    double max_error{0.0};
+    double total_error{0.0};
+    size_t worst{0};
+
+    for(size_t i{0}; i < midpoints.size(); i++)
+    {
+      double error{relativeError(interpolate(midpoints[i]), reference[i])};
+      total_error += error;
+
+      if(error > max_error)
+      {
+        max_error = error;
+        worst = i;
+      }
+    }
+
+    // Interpolation alone, then whole lookups including the search
+    const int no_passes{20};
+    double checksum{0.0};
+
+    auto start{std::chrono::steady_clock::now()};
+    for(int pass{0}; pass < no_passes; pass++)
+    {
+      for(const Midpoint &midpoint : midpoints)
+      {
+        checksum += interpolate(midpoint);
+      }
+    }
+    double interpolate_ns{secondsSince(start) * 1e9 /
+                          (no_passes * midpoints.size())};
+
+    start = std::chrono::steady_clock::now();
+    for(int pass{0}; pass < no_passes; pass++)
+    {
+      for(const Midpoint &midpoint : midpoints)
+      {
+        checksum += data_processor.getAttenCoef(
+            midpoint.energy,
+            ParticleConstants::ReactionType::INCOHERENT_SCATTERING, gamma,
+            midpoint.element);
+      }
+    }
+    double lookup_ns{secondsSince(start) * 1e9 /
+                     (no_passes * midpoints.size())};
+
+    const char *name{precision == Precision::STANDARD ? "STANDARD"
+                     : precision == Precision::HIGH   ? "HIGH"
+                                                      : "FAST"};
+
+    std::cout << std::setw(10) << name << std::setw(14) << max_error
+              << std::setw(14) << total_error / midpoints.size()
+              << std::setw(10)
+              << static_cast<int>(midpoints[worst].element) << std::setw(8)
+              << midpoints[worst].column << std::setw(14) << interpolate_ns
+              << std::setw(14) << lookup_ns << "  (checksum " << checksum
+              << ")\n";
+  }
+
+  FastMath::setPrecision(FastMath::BuildPrecision);
+
+  // Array versions against std over the same number of values
+  const size_t no_values{1 << 20};
+  std::vector<double> values;
+  std::vector<double> exponents;
+  std::vector<double> results(no_values);
+
+  for(size_t i{0}; i < no_values; i++)
+  {
+    values.push_back(std::exp(-20.0 + 40.0 * i / no_values));
+    exponents.push_back(-20.0 + 40.0 * i / no_values);
+  }
+
+  const int no_passes{20};
+  double checksum{0.0};
+
+  auto start{std::chrono::steady_clock::now()};
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    for(size_t i{0}; i < no_values; i++)
+    {
+      results[i] = std::log2(values[i]);
+    }
+    checksum += results[pass];
+  }
+  double std_log_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    FastMath::log2<Precision::HIGH>(values, results);
+    checksum += results[pass];
+  }
+  double high_log_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    FastMath::log2<Precision::FAST>(values, results);
+    checksum += results[pass];
+  }
+  double fast_log_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    for(size_t i{0}; i < no_values; i++)
+    {
+      results[i] = std::exp2(exponents[i]);
+    }
+    checksum += results[pass];
+  }
+  double std_exp_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    FastMath::exp2<Precision::HIGH>(exponents, results);
+    checksum += results[pass];
+  }
+  double high_exp_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  start = std::chrono::steady_clock::now();
+  for(int pass{0}; pass < no_passes; pass++)
+  {
+    FastMath::exp2<Precision::FAST>(exponents, results);
+    checksum += results[pass];
+  }
+  double fast_exp_ns{secondsSince(start) * 1e9 / (no_passes * no_values)};
+
+  std::cout << "\nArrays (" << Simd::InstructionSet << "), ns per value\n";
+  std::cout << "log2  std " << std_log_ns << ", HIGH " << high_log_ns
+            << ", FAST " << fast_log_ns << "\n";
+  std::cout << "exp2  std " << std_exp_ns << ", HIGH " << high_exp_ns
+            << ", FAST " << fast_exp_ns << "\n";
+  std::cout << "(checksum " << checksum << ")\n";
+
+  return 0;
+}
@@ -0,0 +1,226 @@
+// Path biasing benchmark
+// Transports pencil beams of 1, 3 and 10 MeV through lead and concrete
+// shields 8 mean free paths thick, with a thin water detector behind. The
+// transmitted current and the energy deposited in the detector are scored
+// analog, with the exponential transform in the shield, with forced
+// collisions in the detector and with both, running the same number of
+// histories and comparing figures of merit. Also checks that forced
+// collisions split weight without bias in slabs up to 800 mean free paths
+// thick, where the uncollided part is rouletted or has no weight at all, and
+// that the uncollided part gets an id of its own.
+
+#include "CartesianMesh.hpp"
+#include "Material.hpp"
+#include "PathBiasing.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+const int NoShieldLayers{8};
+const double ShieldMeanFreePaths{8.0};
+const double DetectorThickness{0.5}; // cm
+const double Stretch{0.7};
+const long long BenchHistories{100000};
+const long long ForcedTrials{1000000};
+
+// Standard errors the mean uncollided weight may be off by
+const double MaxStandardErrors{4.0};
+
+// Forces collisions in a slab mean_free_paths thick and compares the mean
+// collided and uncollided weights with 1 - exp(-mean_free_paths) and
+// exp(-mean_free_paths)
+bool checkForcedWeights(const Material &material, double energy,
+                        double mean_free_paths)
+{
+  double atten_coef{material.getTotalLinearAttenCoef(
+      energy, ParticleConstants::ParticleType::GAMMA)};
+  SlabGeometry geometry({{&material, mean_free_paths / atten_coef}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  RandomNumberGenerator rng(1);
+
+  double collided_sum{0.0};
+  double uncollided_sum{0.0};
+  long long no_uncollided{0};
+  long long no_shared_ids{0};
+
+  for(long long trial{0}; trial < ForcedTrials; trial++)
+  {
+    Particle particle(ParticleConstants::ParticleType::GAMMA, energy,
+                      Vector3D::ZERO, Vector3D::UNITZ);
+    particle.setID(trial);
+    Particle uncollided{particle};
+
+    if(transport.forceCollision(particle, uncollided, 0, rng))
+    {
+      uncollided_sum += uncollided.getWeight();
+      no_uncollided += 1;
+      no_shared_ids += (uncollided.getID() == particle.getID() ||
+                        uncollided.getParentID() != particle.getID());
+    }
+
+    collided_sum += particle.getWeight();
+  }
+
+  // Uncollided parts below the cutoff weight survive roulette with
+  // probability crossing / survival weight, otherwise they are exact
+  double crossing{std::exp(-mean_free_paths)};
+  double survival_weight{VarianceReductionConstants::CutoffSurvivalWeight};
+  double standard_error{
+      (crossing < VarianceReductionConstants::CutoffWeight)
+          ? std::sqrt(crossing * (survival_weight - crossing) / ForcedTrials)
+          : 0.0};
+  double mean_uncollided{uncollided_sum / ForcedTrials};
+  double mean_collided{collided_sum / ForcedTrials};
+
+  bool passed{
+      no_shared_ids == 0 &&
+      std::abs(mean_collided + std::expm1(-mean_free_paths)) <= 1e-9 &&
+      std::abs(mean_uncollided - crossing) <=
+          std::max(MaxStandardErrors * standard_error, 1e-9 * crossing)};
+
+  std::cout << std::setw(10) << mean_free_paths << std::setw(16)
+            << mean_uncollided << std::setw(16) << crossing << std::setw(14)
+            << no_uncollided << (passed ? " (ok)\n" : " (FAIL)\n");
+
+  return passed;
+}
+
+void runCase(const std::string &label, const Material &shield,
+             const Material &detector, double energy, bool stretched,
+             bool forced)
+{
+  double layer_thickness{
+      ShieldMeanFreePaths / NoShieldLayers /
+      shield.getTotalLinearAttenCoef(energy,
+                                     ParticleConstants::ParticleType::GAMMA)};
+
+  std::vector<std::pair<const Material *, double>> layers(
+      NoShieldLayers, {&shield, layer_thickness});
+  layers.push_back({&detector, DetectorThickness});
+
+  SlabGeometry geometry(layers);
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  std::vector<RegionBiasing> regions(geometry.getNumberRegions());
+
+  for(int i{0}; i < NoShieldLayers; i++)
+  {
+    regions[i].stretch = stretched ? Stretch : 0.0;
+  }
+
+  regions.back().forced_collision = forced;
+  PathBiasing biasing(regions);
+
+  // Current just behind the shield and deposit in the detector
+  double shield_back{NoShieldLayers * layer_thickness};
+  TallySet tally_set;
+  int current{tally_set.addTally(std::make_unique<SurfaceTally>(
+      "current", Vector3D::UNITZ, shield_back,
+      std::vector<double>{1e-3, energy + 0.01}))};
+  int deposit{tally_set.addTally(std::make_unique<MeshTally>(
+      "deposit",
+      CartesianMesh({Vector3D(-1e3, -1e3, shield_back),
+                     Vector3D(1e3, 1e3, shield_back + DetectorThickness)},
+                    {1, 1, 1})))};
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 10000;
+  settings.max_histories = BenchHistories;
+  settings.path_biasing = &biasing;
+
+  RunDriver driver(transport, physics, tally_set,
+                   [energy](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     energy, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   settings);
+  driver.run();
+
+  double seconds{driver.getElapsedSeconds()};
+  std::cout << std::setw(10) << shield.getName() << std::setw(8) << energy
+            << std::setw(14) << label;
+
+  // Bin 0 is the net current of the only energy bin and the only voxel
+  for(int tally : {current, deposit})
+  {
+    const TallyStatistics &statistics{driver.getStatistics(tally)};
+
+    std::cout << std::setw(14) << statistics.getMean(0) << std::setw(10)
+              << statistics.getRelativeError(0) << std::setw(12)
+              << statistics.getFigureOfMerit(0, seconds);
+  }
+
+  std::cout << std::setw(10) << seconds << "\n";
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+  Material water{Material::fromFormula("water", 1.0,
+                                       {{Element::H, 2.0}, {Element::O, 1.0}})};
+
+  std::cout << std::setw(10) << "shield" << std::setw(8) << "MeV"
+            << std::setw(14) << "method" << std::setw(14) << "current"
+            << std::setw(10) << "rel err" << std::setw(12) << "FOM"
+            << std::setw(14) << "deposit" << std::setw(10) << "rel err"
+            << std::setw(12) << "FOM" << std::setw(10) << "seconds" << "\n";
+
+  for(const Material *shield : {&lead, &concrete})
+  {
+    for(double energy : {1.0, 3.0, 10.0})
+    {
+      runCase("analog", *shield, water, energy, false, false);
+      runCase("exp transform", *shield, water, energy, true, false);
+      runCase("forced", *shield, water, energy, false, true);
+      runCase("both", *shield, water, energy, true, true);
+    }
+  }
+
+  std::cout << "\nForced collisions in lead at 1 MeV, " << ForcedTrials
+            << " trials\n"
+            << std::setw(10) << "mfp" << std::setw(16) << "<w uncollided>"
+            << std::setw(16) << "exp(-mfp)" << std::setw(14) << "uncollided"
+            << "\n";
+
+  bool passed{true};
+
+  for(double mean_free_paths : {1.0, 6.0, 30.0, 800.0})
+  {
+    passed &= checkForcedWeights(lead, 1.0, mean_free_paths);
+  }
+
+  return passed ? 0 : 1;
+}
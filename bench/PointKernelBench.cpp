@@ -0,0 +1,155 @@
+// Point-kernel shielding benchmark
+// Checks the SIMD ray mean free paths of PointKernel against a per layer
+// overlap calculation for random detectors around an iron, void and concrete
+// shield, then times flux evaluations over a large detector grid with and
+// without buildup. The GP coefficients used for timing are arbitrary values
+// exercising the full formula, not data for any material.
+
+#include "GPBuildup.hpp"
+#include "Material.hpp"
+#include "PointKernel.hpp"
+#include "Simd.hpp"
+#include "SlabGeometry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+
+namespace
+{
+
+// Mean free paths from the z overlap of the ray with every layer
+double referenceMeanFreePaths(const SlabGeometry &shield,
+                              const std::vector<double> &coefs,
+                              const Vector3D &source, const Vector3D &detector)
+{
+  const std::vector<double> &boundaries{shield.getBoundaries()};
+  double low{std::min(source.getZ(), detector.getZ())};
+  double high{std::max(source.getZ(), detector.getZ())};
+  double secant{(detector - source).magnitude() / (high - low)};
+  double mean_free_paths{0.0};
+
+  for(size_t layer{0}; layer < coefs.size(); layer++)
+  {
+    double overlap{std::min(high, boundaries[layer + 1]) -
+                   std::max(low, boundaries[layer])};
+
+    mean_free_paths += coefs[layer] * std::max(0.0, overlap) * secant;
+  }
+
+  return mean_free_paths;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material iron("iron", 7.874, {{Element::Fe, 1.0}});
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+
+  SlabGeometry shield({{&iron, 5.0}, {nullptr, 2.0}, {&concrete, 20.0}});
+  PointKernel kernel(shield);
+
+  const double energy{1.25};
+  const Vector3D source(0.0, 0.0, -10.0);
+
+  // Accuracy against the overlap calculation
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> lateral(-100.0, 100.0);
+  std::uniform_real_distribution<double> depth(-5.0, 60.0);
+
+  DetectorPoints detectors;
+
+  for(int i{0}; i < 100003; i++)
+  {
+    detectors.add(Vector3D(lateral(rng), lateral(rng), depth(rng)));
+  }
+
+  std::vector<double> coefs{kernel.getLayerCoefs(energy)};
+  std::vector<double> fluxes;
+  kernel.evaluate(source, energy, detectors, fluxes, false);
+
+  double max_error{0.0};
+
+  for(size_t i{0}; i < detectors.size(); i++)
+  {
+    Vector3D detector(detectors.x[i], detectors.y[i], detectors.z[i]);
+    double distance_squared{(detector - source).dot(detector - source)};
+    double reference{
+        std::exp(-referenceMeanFreePaths(shield, coefs, source, detector)) /
+        (4.0 * std::numbers::pi * distance_squared)};
+
+    max_error =
+        std::max(max_error, std::abs(fluxes[i] - reference) / reference);
+  }
+
+  std::cout << "Instruction set " << Simd::InstructionSet
+            << ", max relative flux error vs overlap calculation "
+            << max_error << "\n\n";
+
+  // Throughput on a detector grid behind the shield
+  GPCoefficients low{0.5, 2.0, 1.4, -0.1, 14.0, -0.05};
+  GPCoefficients high{2.0, 1.8, 1.2, -0.05, 14.0, -0.02};
+  kernel.setBuildup(iron, GPBuildup({low, high}));
+  kernel.setBuildup(concrete, GPBuildup({low, high}));
+
+  DetectorPoints grid;
+
+  for(int i{0}; i < 1000; i++)
+  {
+    for(int j{0}; j < 100; j++)
+    {
+      grid.add(Vector3D(-50.0 + 0.1 * i, -50.0 + j, 30.0));
+    }
+  }
+
+  std::cout << std::setw(10) << "buildup" << std::setw(14) << "detectors"
+            << std::setw(14) << "ms" << std::setw(16) << "pairs per ms"
+            << "\n";
+
+  for(bool with_buildup : {false, true})
+  {
+    const int repeats{20};
+    auto start{std::chrono::steady_clock::now()};
+
+    for(int repeat{0}; repeat < repeats; repeat++)
+    {
+      kernel.evaluate(source, energy, grid, fluxes, with_buildup);
+    }
+
+    double ms{std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count() /
+              repeats};
+
+    std::cout << std::setw(10) << (with_buildup ? "GP" : "none")
+              << std::setw(14) << grid.size() << std::setw(14) << ms
+              << std::setw(16) << grid.size() / ms << "\n";
+  }
+
+  // Single detector on axis, uncollided and with buildup
+  Vector3D on_axis(0.0, 0.0, 30.0);
+
+  std::cout << "\nOn axis flux: uncollided "
+            << kernel.getFlux(source, on_axis, energy, false)
+            << ", with buildup " << kernel.getFlux(source, on_axis, energy)
+            << "\n";
+
+  return 0;
+}
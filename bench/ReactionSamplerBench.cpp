@@ -0,0 +1,144 @@
+// Reaction channel selection benchmark
+// Reports the accuracy of the per interval alias tables against exactly
+// interpolated branching ratios for every photon data file, then times alias
+// sampling against evaluating every partial and walking the cumulative sum
+
+#include "DataProcessor.hpp"
+#include "Interpolation.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "ReactionSampler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+int main()
+{
+  using ParticleConstants::ParticleType;
+
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  std::cout << "Max |tabulated - exact| branching ratio per channel\n";
+  std::cout << std::setw(4) << "Z" << std::setw(12) << "coherent"
+            << std::setw(12) << "incoherent" << std::setw(12) << "photoel."
+            << std::setw(14) << "mean" << "\n";
+
+  double worst{0.0};
+  double worst_energy{0.0};
+  int worst_z{0};
+
+  for(int z{1}; z <= 100; z++)
+  {
+    auto element{static_cast<ElementConversion::Element>(z)};
+    data_processor.addDataSingleFile(ParticleType::GAMMA, element);
+
+    ReactionSampler sampler(
+        *data_processor.getData(ParticleType::GAMMA, element),
+        ParticleType::GAMMA);
+    ReactionSamplerAccuracy accuracy{sampler.getAccuracy()};
+
+    std::cout << std::setw(4) << z << std::scientific << std::setprecision(2);
+
+    for(size_t channel{0}; channel < accuracy.channels.size(); channel++)
+    {
+      std::cout << std::setw(12) << accuracy.max_abs_error[channel];
+
+      if(accuracy.max_abs_error[channel] > worst)
+      {
+        worst = accuracy.max_abs_error[channel];
+        worst_energy = accuracy.max_error_energy[channel];
+        worst_z = z;
+      }
+    }
+
+    std::cout << std::setw(14) << accuracy.mean_abs_error << "\n";
+    std::cout.unsetf(std::ios::scientific);
+  }
+
+  std::cout << "Worst " << worst << " for Z = " << worst_z << " at "
+            << worst_energy << " MeV\n\n";
+
+  // Timing on lead over log uniform energies
+  std::shared_ptr<const std::vector<std::vector<double>>> data{
+      data_processor.getData(ParticleType::GAMMA,
+                             ElementConversion::Element::Pb)};
+  const std::vector<std::vector<double>> &rows{*data};
+  ReactionSampler sampler(rows, ParticleType::GAMMA);
+  RandomNumberGenerator rng(12345);
+
+  const int samples{1000000};
+  std::vector<double> energies(samples);
+  std::vector<double> uniforms(samples);
+
+  for(int i{0}; i < samples; i++)
+  {
+    energies[i] = std::exp(std::log(1e-3) + std::log(1e8) * rng.getUniform());
+    energies[i] = std::min(energies[i], 1e5);
+    uniforms[i] = rng.getUniform();
+  }
+
+  long long checksum{0};
+
+  auto alias_start{std::chrono::steady_clock::now()};
+
+  for(int i{0}; i < samples; i++)
+  {
+    checksum += static_cast<int>(sampler.sample(energies[i], uniforms[i]));
+  }
+
+  auto alias_end{std::chrono::steady_clock::now()};
+
+  std::vector<size_t> columns;
+
+  for(const auto &reaction : sampler.getChannels())
+  {
+    columns.push_back(FileConstants::ReactionToColumn.at(ParticleType::GAMMA)
+                          .at(reaction));
+  }
+
+  std::vector<double> partials(columns.size());
+
+  auto walk_start{std::chrono::steady_clock::now()};
+
+  for(int i{0}; i < samples; i++)
+  {
+    double total{0.0};
+
+    for(size_t channel{0}; channel < columns.size(); channel++)
+    {
+      partials[channel] =
+          Interpolation::interpolateColumn(energies[i], rows, columns[channel]);
+      total += partials[channel];
+    }
+
+    double target{uniforms[i] * total};
+    size_t channel{0};
+
+    while(channel + 1 < columns.size() && target > partials[channel])
+    {
+      target -= partials[channel];
+      channel += 1;
+    }
+
+    checksum += static_cast<int>(sampler.getChannels()[channel]);
+  }
+
+  auto walk_end{std::chrono::steady_clock::now()};
+
+  std::cout << "Pb alias table   "
+            << std::chrono::duration<double, std::nano>(alias_end - alias_start)
+                       .count() /
+                   samples
+            << " ns/sample\n";
+  std::cout << "Pb CDF walk      "
+            << std::chrono::duration<double, std::nano>(walk_end - walk_start)
+                       .count() /
+                   samples
+            << " ns/sample\n";
+  std::cout << "(checksum " << checksum << ")\n";
+
+  return 0;
+}
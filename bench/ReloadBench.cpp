@@ -0,0 +1,364 @@
+// Incremental reload benchmark
+// Works on a copy of data/photon in a temporary directory. Times a full load
+// against reloads with nothing, a touched file, one and ten changed files, and
+// checks that only changed elements are reparsed, that only the registered
+// materials made of them are rebuilt, that queries holding the old version
+// keep getting old values and free it when done, that a thread left idle
+// after a run does not keep a replaced version, and that a file cut short
+// keeps its old data.
+// Finishes with reader threads querying while a background reloader picks up
+// files being rewritten.
+
+#include "DataProcessor.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+
+using ElementConversion::Element;
+using ParticleConstants::ParticleType;
+using ParticleConstants::ReactionType;
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+std::string filePath(Element element)
+{
+  std::ostringstream path;
+  path << "data/photon/element_" << std::setw(3) << std::setfill('0')
+       << static_cast<int>(element) << "_"
+       << ElementConversion::ElementToSymbol.at(element) << ".txt";
+
+  return path.str();
+}
+
+std::string readAll(const std::string &path)
+{
+  std::ifstream file(path);
+  std::ostringstream contents;
+  contents << file.rdbuf();
+
+  return contents.str();
+}
+
+// Rewrites the file of element with every coef times factor, in the layout
+// of the data files
+void scaleCoefs(Element element, double factor)
+{
+  std::istringstream contents(readAll(filePath(element)));
+  std::ostringstream scaled;
+  std::string line;
+  int line_number{0};
+
+  while(std::getline(contents, line))
+  {
+    line_number += 1;
+
+    if(line_number < FileConstants::ParticleToDataStartLine.at(
+                         ParticleType::GAMMA))
+    {
+      scaled << line << "\n";
+      continue;
+    }
+
+    std::istringstream values(line);
+    double value;
+    int column{0};
+
+    while(values >> value)
+    {
+      scaled << std::scientific << std::setprecision(3)
+             << (column == FileConstants::EnergyColumn ? value
+                                                       : value * factor)
+             << " ";
+      column += 1;
+    }
+
+    scaled << "\n";
+  }
+
+  // Written aside and renamed, so that readers never see half a file
+  std::string path{filePath(element)};
+  std::ofstream(path + ".tmp") << scaled.str();
+  std::filesystem::rename(path + ".tmp", path);
+}
+
+double coef(const XsLibrary &library, Element element)
+{
+  return library.getAttenCoef(0.1, ReactionType::INCOHERENT_SCATTERING,
+                              ParticleType::GAMMA, element);
+}
+
+bool check(bool passed)
+{
+  std::cout << (passed ? " (ok)\n" : " (FAIL)\n");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  namespace fs = std::filesystem;
+
+  // Programs find data relative to the working directory
+  fs::path source{fs::current_path()};
+  fs::path scratch{fs::temp_directory_path() /
+                   ("nse_reload_" + std::to_string(::getpid()))};
+  fs::create_directories(scratch / "data");
+  fs::copy(source / "data/photon", scratch / "data/photon",
+           fs::copy_options::recursive);
+  fs::current_path(scratch);
+
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  bool passed{true};
+
+  auto start{std::chrono::steady_clock::now()};
+  for(int z{1}; z <= 100; z++)
+  {
+    data_processor.addDataSingleFile(ParticleType::GAMMA,
+                                     static_cast<Element>(z));
+  }
+  double load_ms{secondsSince(start) * 1e3};
+
+  Material water{Material::fromFormula(
+      "water", 1.0, {{Element::H, 2.0}, {Element::O, 1.0}})};
+  Material lead{"lead", 11.35, {{Element::Pb, 1.0}}};
+  data_processor.addMaterial(water);
+  data_processor.addMaterial(lead);
+
+  std::cout << "Full load of 100 elements: " << load_ms << " ms\n\n";
+
+  // Nothing changed, then a file rewritten with the same contents
+  start = std::chrono::steady_clock::now();
+  ReloadReport unchanged{data_processor.reload()};
+  double unchanged_ms{secondsSince(start) * 1e3};
+
+  std::cout << "reload, nothing changed: " << unchanged_ms << " ms, "
+            << unchanged.reparsed.size() << " reparsed";
+  passed &= check(unchanged.reparsed.empty() && unchanged.errors.empty());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::string lead_contents{readAll(filePath(Element::Pb))};
+  std::ofstream(filePath(Element::Pb)) << lead_contents;
+
+  start = std::chrono::steady_clock::now();
+  ReloadReport touched{data_processor.reload()};
+  double touched_ms{secondsSince(start) * 1e3};
+
+  std::cout << "reload, lead touched: " << touched_ms << " ms, "
+            << touched.reparsed.size() << " reparsed";
+  passed &= check(touched.reparsed.empty() &&
+                  touched.version == unchanged.version);
+
+  // Lead changed while a query holds the old version
+  std::shared_ptr<const XsLibrary> old_library{data_processor.getLibrary()};
+  scaleCoefs(Element::Pb, 2.0);
+
+  start = std::chrono::steady_clock::now();
+  ReloadReport one{data_processor.reload()};
+  double one_ms{secondsSince(start) * 1e3};
+
+  std::shared_ptr<const XsLibrary> new_library{data_processor.getLibrary()};
+
+  std::cout << "reload, lead changed: " << one_ms << " ms, "
+            << one.reparsed.size() << " reparsed, "
+            << one.no_rebuilt_materials << " of 2 materials rebuilt";
+  passed &= check(one.reparsed.size() == 1 && one.no_rebuilt_materials == 1 &&
+                  new_library->getVersion() == old_library->getVersion() + 1);
+
+  double ratio{coef(*new_library, Element::Pb) /
+               coef(*old_library, Element::Pb)};
+  double old_lead_mu{old_library->getMaterial(1).getTotalLinearAttenCoef(
+      0.1, ParticleType::GAMMA)};
+  double new_lead_mu{new_library->getMaterial(1).getTotalLinearAttenCoef(
+      0.1, ParticleType::GAMMA)};
+
+  std::cout << "  lead coef new / held old version " << ratio
+            << ", lead material " << new_lead_mu / old_lead_mu
+            << ", lookups without a held version see the new one";
+  passed &= check(std::abs(ratio - 2.0) < 1e-2 &&
+                  std::abs(new_lead_mu / old_lead_mu - 2.0) < 1e-2 &&
+                  data_processor.getAttenCoef(
+                      0.1, ReactionType::INCOHERENT_SCATTERING,
+                      ParticleType::GAMMA,
+                      Element::Pb) == coef(*new_library, Element::Pb));
+
+  std::cout << "  water and unchanged elements shared with the old version";
+  passed &= check(
+      &old_library->getMaterial(0) == &new_library->getMaterial(0) &&
+      &old_library->getElement(ParticleType::GAMMA, Element::Fe) ==
+          &new_library->getElement(ParticleType::GAMMA, Element::Fe) &&
+      &old_library->getMajorant(ParticleType::GAMMA) !=
+          &new_library->getMajorant(ParticleType::GAMMA));
+
+  std::weak_ptr<const XsLibrary> replaced{old_library};
+  old_library.reset();
+
+  std::cout << "  old version freed once no query holds it";
+  passed &= check(replaced.expired());
+
+  // A run on this thread, which then sits idle while oxygen changes
+  new_library.reset();
+
+  {
+    SlabGeometry geometry({{&water, 10.0}});
+    Transport transport(geometry, ParticleType::GAMMA, TrackingMode::SURFACE);
+    PhotonPhysics physics(geometry.getMaterials());
+    TallySet tally_set;
+    tally_set.addTally(std::make_unique<SurfaceTally>(
+        "behind", Vector3D::UNITZ, 11.0, std::vector<double>{1e-3, 1.01}));
+
+    RunSettings settings;
+    settings.no_threads = 1;
+    settings.histories_per_batch = 1000;
+    settings.max_histories = 1000;
+
+    RunDriver driver(transport, physics, tally_set,
+                     [](RandomNumberGenerator &)
+                     {
+                       return Particle(ParticleType::GAMMA, 1.0, Vector3D::ZERO,
+                                       Vector3D::UNITZ);
+                     },
+                     settings);
+    driver.run();
+  }
+
+  std::weak_ptr<const XsLibrary> used_by_run{data_processor.getLibrary()};
+  scaleCoefs(Element::O, 1.5);
+  ReloadReport idle{data_processor.reload()};
+
+  std::cout << "  version in use by a run freed with its thread idle";
+  passed &= check(idle.reparsed.size() == 1 && used_by_run.expired());
+
+  // Ten elements, none in a material
+  for(int z{20}; z < 30; z++)
+  {
+    scaleCoefs(static_cast<Element>(z), 1.5);
+  }
+
+  start = std::chrono::steady_clock::now();
+  ReloadReport ten{data_processor.reload()};
+  double ten_ms{secondsSince(start) * 1e3};
+
+  std::cout << "reload, 10 elements changed: " << ten_ms << " ms, "
+            << ten.reparsed.size() << " reparsed, "
+            << ten.no_rebuilt_materials << " materials rebuilt";
+  passed &= check(ten.reparsed.size() == 10 && ten.no_rebuilt_materials == 0);
+
+  // Hashing every file instead of trusting modification times
+  start = std::chrono::steady_clock::now();
+  ReloadReport hashed{data_processor.reload(ReloadCheck::CONTENTS)};
+  double hashed_ms{secondsSince(start) * 1e3};
+
+  std::cout << "reload, hashing all files: " << hashed_ms << " ms, "
+            << hashed.reparsed.size() << " reparsed";
+  passed &= check(hashed.reparsed.empty());
+
+  // A file cut short part way through a row
+  std::string iron{readAll(filePath(Element::Fe))};
+  std::ofstream(filePath(Element::Fe)) << iron.substr(0, iron.size() / 2);
+  double iron_coef{coef(*data_processor.getLibrary(), Element::Fe)};
+
+  ReloadReport truncated{data_processor.reload()};
+
+  std::cout << "reload, iron cut short: " << truncated.errors.size()
+            << " error(s), iron keeps its old data";
+  passed &= check(truncated.errors.size() == 1 &&
+                  coef(*data_processor.getLibrary(), Element::Fe) ==
+                      iron_coef);
+
+  std::ofstream(filePath(Element::Fe)) << iron;
+
+  // Readers holding a version per query while files change underneath
+  std::atomic<bool> stop{false};
+  std::atomic<long long> queries{0};
+  std::atomic<long long> mixed{0};
+  std::vector<std::thread> readers;
+
+  data_processor.startReloading(0.005);
+
+  for(int thread{0}; thread < 2; thread++)
+  {
+    readers.emplace_back(
+        [&]
+        {
+          while(!stop)
+          {
+            // Lead and the lead material must agree within one version
+            std::shared_ptr<const XsLibrary> library{
+                data_processor.getLibrary()};
+            double element_mu{
+                11.35 * coef(*library, Element::Pb) +
+                11.35 * library->getAttenCoef(
+                            0.1, ReactionType::COHERENT_SCATTERING,
+                            ParticleType::GAMMA, Element::Pb) +
+                11.35 * library->getAttenCoef(
+                            0.1, ReactionType::PHOTOELECTRIC_ABSORPTION,
+                            ParticleType::GAMMA, Element::Pb)};
+            double material_mu{library->getMaterial(1).getTotalLinearAttenCoef(
+                0.1, ParticleType::GAMMA)};
+
+            if(std::abs(element_mu / material_mu - 1.0) > 1e-9)
+            {
+              mixed += 1;
+            }
+
+            queries += 1;
+          }
+        });
+  }
+
+  long long first_version{data_processor.getLibrary()->getVersion()};
+
+  for(int rewrite{0}; rewrite < 20; rewrite++)
+  {
+    scaleCoefs(Element::Pb, rewrite % 2 == 0 ? 0.5 : 2.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  stop = true;
+
+  for(std::thread &reader : readers)
+  {
+    reader.join();
+  }
+
+  data_processor.stopReloading();
+
+  long long versions{data_processor.getLibrary()->getVersion() -
+                     first_version};
+
+  std::cout << "\nbackground reloads: " << versions << " versions over "
+            << queries << " queries, " << mixed
+            << " queries mixing versions";
+  passed &= check(versions > 0 && mixed == 0);
+
+  fs::current_path(source);
+  fs::remove_all(scratch);
+
+  return passed ? 0 : 1;
+}
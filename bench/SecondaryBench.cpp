@@ -0,0 +1,92 @@
+// Secondary photon benchmark
+// Prints the K shell fluorescence data derived for a few elements, then sends
+// a 10 MeV beam through 2 cm of lead and prints the spectrum of photons
+// crossing a plane behind it, where the lead K alpha line and the 511 keV
+// annihilation line stand out from the scattered continuum.
+
+#include "DataProcessor.hpp"
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material iron("iron", 7.874, {{Element::Fe, 1.0}});
+  Material tungsten("tungsten", 19.3, {{Element::W, 1.0}});
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  Material uranium("uranium", 19.1, {{Element::U, 1.0}});
+  PhotonPhysics physics({&iron, &tungsten, &lead, &uranium});
+
+  std::cout << std::setw(8) << "element" << std::setw(14) << "K edge keV"
+            << std::setw(16) << "K alpha keV" << std::setw(18)
+            << "emission prob" << "\n";
+
+  for(Element element : {Element::Fe, Element::W, Element::Pb, Element::U})
+  {
+    const KShell &k_shell{physics.getKShell(element)};
+
+    std::cout << std::setw(8) << ElementConversion::ElementToSymbol.at(element)
+              << std::setw(14) << 1e3 * k_shell.edge << std::setw(16)
+              << 1e3 * k_shell.line_energy << std::setw(18)
+              << k_shell.emission_probability << "\n";
+  }
+
+  SlabGeometry geometry({{&lead, 2.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+
+  // Narrow bins around the lines, wide ones elsewhere
+  std::vector<double> edges{1e-3,  0.05,  0.07, 0.074, 0.076, 0.09,
+                            0.4,   0.505, 0.51, 0.512, 0.517, 0.6,
+                            1.0,   5.0,   10.01};
+
+  TallySet tally_set;
+  int behind{tally_set.addTally(std::make_unique<SurfaceTally>(
+      "behind", Vector3D::UNITZ, 3.0, edges))};
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 20000;
+  settings.max_histories = 200000;
+
+  RunDriver driver(transport, physics, tally_set,
+                   [](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     10.0, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   settings);
+  driver.run();
+
+  const TallyStatistics &statistics{driver.getStatistics(behind)};
+
+  std::cout << "\n" << driver.getHistoriesRun() << " histories in "
+            << driver.getElapsedSeconds() << " s\n\n";
+  std::cout << std::setw(10) << "low MeV" << std::setw(10) << "high MeV"
+            << std::setw(16) << "current/MeV" << std::setw(12) << "rel error"
+            << "\n";
+
+  // Bin 2e is the net current of energy bin e
+  for(size_t bin{0}; bin + 1 < edges.size(); bin++)
+  {
+    double width{edges[bin + 1] - edges[bin]};
+
+    std::cout << std::setw(10) << edges[bin] << std::setw(10)
+              << edges[bin + 1] << std::setw(16)
+              << statistics.getMean(2 * bin) / width << std::setw(12)
+              << statistics.getRelativeError(2 * bin) << "\n";
+  }
+
+  return 0;
+}
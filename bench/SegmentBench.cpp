@@ -0,0 +1,253 @@
+// Shared cross section segment benchmark
+// Publishes every element into a shared memory segment, checks its lookups
+// against DataProcessor, times attaching against parsing the files, and forks
+// growing numbers of worker processes that attach and read every table. The
+// proportional set size (Pss) of the segment summed over the workers shows
+// whether memory on the node stays constant as workers are added.
+
+#include "DataProcessor.hpp"
+#include "XsSegment.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+const ParticleConstants::ParticleType Gamma{
+    ParticleConstants::ParticleType::GAMMA};
+
+// Pss of the mapping of the segment in this process (kB)
+long long readSegmentPss(const std::string &name)
+{
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  bool in_segment{false};
+
+  while(std::getline(smaps, line))
+  {
+    // Mapping lines start with an address range, attribute lines with a name
+    if(line.find('-') < line.find(' ') && line.find(' ') != std::string::npos)
+    {
+      in_segment = line.ends_with("/dev/shm" + name);
+    }
+    else if(in_segment && line.starts_with("Pss:"))
+    {
+      return std::stoll(line.substr(4));
+    }
+  }
+
+  return -1;
+}
+
+// Attaches, reads every column, then reports its Pss once all siblings have
+// done the same. Stays alive until every sibling has reported too, as the Pss
+// of the others grows once one of them exits.
+[[noreturn]] void runWorker(const std::string &name, int ready_fd,
+                            int release_fd, int exit_fd)
+{
+  XsSegment segment{XsSegment::attach(name)};
+  double sum{0.0};
+
+  for(int z{1}; z <= 100; z++)
+  {
+    auto element{static_cast<ElementConversion::Element>(z)};
+
+    for(size_t column{0}; column < 8; column++)
+    {
+      for(double value : segment.getColumn(Gamma, element, column))
+      {
+        sum += value;
+      }
+    }
+  }
+
+  char byte{sum > 0.0 ? 'r' : 'x'};
+  ::write(ready_fd, &byte, 1);
+
+  // Returns at end of file once the parent closes the other end
+  ::read(release_fd, &byte, 1);
+
+  long long pss{readSegmentPss(segment.getName())};
+  ::write(ready_fd, &pss, sizeof(pss));
+  ::read(exit_fd, &byte, 1);
+  ::_exit(0);
+}
+
+// Sum of the segment Pss of no_workers workers alive together (kB)
+long long measureWorkers(const std::string &name, int no_workers)
+{
+  int ready[2];
+  int release[2];
+  int exit[2];
+
+  if(::pipe(ready) != 0 || ::pipe(release) != 0 || ::pipe(exit) != 0)
+  {
+    throw std::runtime_error("Cannot create pipes");
+  }
+
+  for(int worker{0}; worker < no_workers; worker++)
+  {
+    if(::fork() == 0)
+    {
+      ::close(release[1]);
+      ::close(exit[1]);
+      runWorker(name, ready[1], release[0], exit[0]);
+    }
+  }
+
+  ::close(ready[1]);
+  ::close(release[0]);
+  ::close(exit[0]);
+
+  char byte;
+
+  for(int worker{0}; worker < no_workers; worker++)
+  {
+    ::read(ready[0], &byte, 1);
+  }
+
+  ::close(release[1]);
+
+  long long total{0};
+
+  for(int worker{0}; worker < no_workers; worker++)
+  {
+    long long pss;
+    ::read(ready[0], &pss, sizeof(pss));
+    total += pss;
+  }
+
+  ::close(exit[1]);
+  ::close(ready[0]);
+
+  while(::wait(nullptr) > 0)
+  {
+  }
+
+  return total;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  std::string name{"/nse_segment_bench_" + std::to_string(::getpid())};
+
+  // Parse every file, the cost each process pays without the segment
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  auto start{std::chrono::steady_clock::now()};
+
+  for(int z{1}; z <= 100; z++)
+  {
+    data_processor.addDataSingleFile(Gamma, static_cast<Element>(z));
+  }
+
+  double parse_seconds{std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count()};
+
+  // The segment stays after its publisher unmaps it
+  start = std::chrono::steady_clock::now();
+  size_t size{
+      XsSegment::publish(name, *data_processor.getAllData()).getSize()};
+  double publish_seconds{std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count()};
+
+  std::cout << "Parse 100 files:  " << std::setprecision(4)
+            << 1e3 * parse_seconds << " ms\n"
+            << "Publish segment:  " << 1e3 * publish_seconds << " ms, "
+            << size / 1024 << " kB\n";
+
+  // Attach and detach repeatedly, median of the times
+  std::vector<double> attach_times;
+
+  for(int repeat{0}; repeat < 1001; repeat++)
+  {
+    start = std::chrono::steady_clock::now();
+    XsSegment segment{XsSegment::attach(name)};
+    attach_times.push_back(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+  }
+
+  std::nth_element(attach_times.begin(),
+                   attach_times.begin() + attach_times.size() / 2,
+                   attach_times.end());
+  std::cout << "Attach (median):  "
+            << 1e6 * attach_times[attach_times.size() / 2] << " us\n";
+
+  // Lookups through the segment must match DataProcessor exactly, including
+  // on grid points and k-edges
+  long long mismatches{0};
+  long long lookups{0};
+
+  {
+    XsSegment segment{XsSegment::attach(name)};
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> log_energy(std::log(1.001e-3),
+                                                      std::log(1e4));
+
+    for(int z{1}; z <= 100; z++)
+    {
+      auto element{static_cast<Element>(z)};
+      std::vector<double> energies;
+
+      for(double energy : segment.getColumn(Gamma, element, 0))
+      {
+        energies.push_back(energy);
+      }
+
+      for(int i{0}; i < 1000; i++)
+      {
+        energies.push_back(std::exp(log_energy(rng)));
+      }
+
+      for(auto reaction : ParticleConstants::AllowedReactions.at(Gamma))
+      {
+        for(double energy : energies)
+        {
+          lookups++;
+
+          if(segment.getAttenCoef(energy, reaction, Gamma, element) !=
+             data_processor.getAttenCoef(energy, reaction, Gamma, element))
+          {
+            mismatches++;
+          }
+        }
+      }
+    }
+  }
+
+  std::cout << "Mismatches:       " << mismatches << " of " << lookups
+            << " lookups\n\n";
+
+  std::cout << std::setw(10) << "workers" << std::setw(18) << "segment Pss kB"
+            << std::setw(18) << "per worker kB" << "\n";
+
+  // The parent holds no mapping here, so only the workers share the pages
+  for(int no_workers : {1, 2, 4, 8})
+  {
+    long long total{measureWorkers(name, no_workers)};
+
+    std::cout << std::setw(10) << no_workers << std::setw(18) << total
+              << std::setw(18) << total / no_workers << "\n";
+  }
+
+  XsSegment::remove(name);
+
+  return 0;
+}
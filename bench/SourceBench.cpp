@@ -0,0 +1,273 @@
+// Source sampling benchmark
+// Checks sampled line and bin frequencies of nuclide and continuous spectra
+// against their intensities, and positions and directions against their
+// shapes, then times sampling on its own and against a transport run with the
+// same source.
+
+#include "Material.hpp"
+#include "ParticleSource.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+
+namespace
+{
+
+const long long NoSamples{10000000};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Largest deviation of the sampled component frequencies from their
+// probabilities, in standard deviations. Components are found from the
+// energy, lines first, as the spectrum orders them.
+double maxDeviation(const SourceSpectrum &spectrum,
+                    const std::vector<double> &lines,
+                    const std::vector<double> &edges)
+{
+  RandomNumberGenerator rng(1);
+  std::vector<long long> counts(spectrum.getNoComponents(), 0);
+
+  for(long long sample{0}; sample < NoSamples; sample++)
+  {
+    double energy{spectrum.sample(rng)};
+    auto line{std::find(lines.begin(), lines.end(), energy)};
+
+    if(line != lines.end())
+    {
+      counts[line - lines.begin()] += 1;
+      continue;
+    }
+
+    auto edge{std::upper_bound(edges.begin(), edges.end(), energy)};
+    counts[lines.size() + (edge - edges.begin()) - 1] += 1;
+  }
+
+  double deviation{0.0};
+
+  for(size_t component{0}; component < counts.size(); component++)
+  {
+    double p{spectrum.getProbability(component)};
+    double sigma{std::sqrt(p * (1.0 - p) / NoSamples)};
+    double frequency{static_cast<double>(counts[component]) / NoSamples};
+
+    deviation = std::max(deviation, std::abs(frequency - p) / sigma);
+  }
+
+  return deviation;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  std::cout << std::setw(24) << "spectrum" << std::setw(12) << "components"
+            << std::setw(14) << "mean MeV" << std::setw(14) << "max dev sd"
+            << "\n";
+
+  for(const std::string nuclide : {"Co-60", "Cs-137", "Eu-152"})
+  {
+    SourceSpectrum spectrum{SourceSpectrum::fromNuclide(nuclide)};
+    std::vector<double> lines;
+
+    for(const auto &line : SourceConstants::NuclideLines.at(nuclide))
+    {
+      lines.push_back(line.first);
+    }
+
+    std::cout << std::setw(24) << nuclide << std::setw(12)
+              << spectrum.getNoComponents() << std::setw(14)
+              << spectrum.getMeanEnergy() << std::setw(14)
+              << maxDeviation(spectrum, lines, {}) << "\n";
+  }
+
+  // Co-60 lines on a 1/E continuum of 200 log spaced bins
+  std::vector<double> lines{1.173228, 1.332492};
+  std::vector<double> edges;
+  std::vector<double> continuum;
+
+  for(int edge{0}; edge <= 200; edge++)
+  {
+    edges.push_back(0.01 * std::pow(300.0, edge / 200.0));
+  }
+
+  for(size_t bin{0}; bin + 1 < edges.size(); bin++)
+  {
+    continuum.push_back(std::log(edges[bin + 1] / edges[bin]));
+  }
+
+  SourceSpectrum mixed(lines, {1.0, 1.0}, edges, continuum);
+
+  std::cout << std::setw(24) << "Co-60 + 1/E continuum" << std::setw(12)
+            << mixed.getNoComponents() << std::setw(14)
+            << mixed.getMeanEnergy() << std::setw(14)
+            << maxDeviation(mixed, lines, edges) << "\n\n";
+
+  // Shapes and directions, each against a moment it must reproduce
+  ParticleSource source(ParticleConstants::ParticleType::GAMMA,
+                        SourceSpectrum::fromNuclide("Eu-152"));
+  RandomNumberGenerator rng(2);
+  const long long no_checks{1000000};
+
+  Vector3D disc_centre{1.0, 2.0, 3.0};
+  source.setDisc(disc_centre, {1.0, 1.0, 0.0}, 2.0);
+  double disc_r2{0.0};
+  double disc_off_plane{0.0};
+
+  for(long long check{0}; check < no_checks; check++)
+  {
+    Vector3D offset{source.sample(rng).getPosition() - disc_centre};
+    disc_r2 += offset.squaredMagnitude() / no_checks;
+    disc_off_plane =
+        std::max(disc_off_plane,
+                 std::abs(offset.dot(Vector3D(1.0, 1.0, 0.0).normalise())));
+  }
+
+  source.setBox({{-1.0, 0.0, 2.0}, {1.0, 4.0, 3.0}});
+  Vector3D box_mean;
+  bool box_inside{true};
+
+  for(long long check{0}; check < no_checks; check++)
+  {
+    Vector3D position{source.sample(rng).getPosition()};
+    box_mean += position / no_checks;
+    box_inside = box_inside && position.getX() >= -1.0 &&
+                 position.getX() <= 1.0 && position.getY() >= 0.0 &&
+                 position.getY() <= 4.0 && position.getZ() >= 2.0 &&
+                 position.getZ() <= 3.0;
+  }
+
+  double half_angle{0.3};
+  Vector3D cone_axis{Vector3D(0.0, 1.0, 1.0).normalise()};
+  source.setBeam(cone_axis, half_angle);
+  double cone_mean{0.0};
+  double cone_min{1.0};
+
+  for(long long check{0}; check < no_checks; check++)
+  {
+    double cos_angle{source.sample(rng).getDirection().dot(cone_axis)};
+    cone_mean += cos_angle / no_checks;
+    cone_min = std::min(cone_min, cos_angle);
+  }
+
+  std::cout << "disc   mean r^2 " << disc_r2 << " (expected 2), largest "
+            << "distance off the plane " << disc_off_plane << "\n";
+  std::cout << "box    mean " << box_mean << " (expected (0, 2, 2.5)), "
+            << (box_inside ? "all inside" : "SOME OUTSIDE") << "\n";
+  std::cout << "cone   mean cos " << cone_mean << " (expected "
+            << 0.5 * (1.0 + std::cos(half_angle)) << "), min cos " << cone_min
+            << " (limit " << std::cos(half_angle) << ")\n\n";
+
+  // Energy sampling against a cumulative search over the same lines
+  SourceSpectrum europium{SourceSpectrum::fromNuclide("Eu-152")};
+  std::vector<double> europium_intensities;
+
+  for(const auto &line : SourceConstants::NuclideLines.at("Eu-152"))
+  {
+    europium_intensities.push_back(line.second);
+  }
+
+  std::discrete_distribution<size_t> discrete(europium_intensities.begin(),
+                                              europium_intensities.end());
+  std::mt19937_64 engine(3);
+  double checksum{0.0};
+
+  auto start{std::chrono::steady_clock::now()};
+  for(long long sample{0}; sample < NoSamples; sample++)
+  {
+    checksum += static_cast<double>(discrete(engine));
+  }
+  double discrete_ns{secondsSince(start) * 1e9 / NoSamples};
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < NoSamples; sample++)
+  {
+    checksum += europium.sample(rng);
+  }
+  double alias_ns{secondsSince(start) * 1e9 / NoSamples};
+
+  // Whole particles, one at a time and in batches
+  source.setDisc(Vector3D::ZERO, Vector3D::UNITZ, 1.0);
+  source.setIsotropic();
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < NoSamples; sample++)
+  {
+    checksum += source.sample(rng).getEnergy();
+  }
+  double single_ns{secondsSince(start) * 1e9 / NoSamples};
+
+  std::vector<Particle> particles;
+  const size_t batch_size{4096};
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < NoSamples; sample += batch_size)
+  {
+    particles.clear();
+    source.sample(rng, batch_size, particles);
+    checksum += particles.back().getEnergy();
+  }
+  double batch_ns{secondsSince(start) * 1e9 / NoSamples};
+
+  std::cout << "energy, discrete_distribution " << discrete_ns
+            << " ns, alias table " << alias_ns << " ns\n";
+  std::cout << "particle, single " << single_ns << " ns, batch of "
+            << batch_size << " " << batch_ns << " ns\n";
+
+  // The same source driving transport through 5 cm of lead
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  SlabGeometry geometry({{&lead, 5.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  source.setPoint(Vector3D::ZERO);
+  source.setBeam(Vector3D::UNITZ, 0.5);
+
+  start = std::chrono::steady_clock::now();
+  for(long long sample{0}; sample < NoSamples; sample++)
+  {
+    checksum += source.sample(rng).getEnergy();
+  }
+  double beam_ns{secondsSince(start) * 1e9 / NoSamples};
+
+  TallySet tally_set;
+  int behind{tally_set.addTally(std::make_unique<SurfaceTally>(
+      "behind", Vector3D::UNITZ, 10.0, std::vector<double>{1e-3, 1.5}))};
+
+  RunSettings settings;
+  settings.no_threads = 1;
+  settings.histories_per_batch = 100000;
+  settings.max_histories = 1000000;
+
+  RunDriver driver(transport, physics, tally_set, source.getSource(),
+                   settings);
+  driver.run();
+
+  double history_ns{driver.getElapsedSeconds() * 1e9 /
+                    driver.getHistoriesRun()};
+
+  std::cout << "transport " << history_ns << " ns per history, sampling "
+            << beam_ns << " ns or " << 100.0 * beam_ns / history_ns
+            << "% of it, current "
+            << driver.getStatistics(behind).getMean(0) << "\n";
+  std::cout << "(checksum " << checksum << ")\n";
+
+  return 0;
+}
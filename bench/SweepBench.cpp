@@ -0,0 +1,166 @@
+// Shield design sweep benchmark
+// Runs a point-kernel sweep over about 10^5 two layer designs, comparing its
+// throughput with evaluating the same designs through per configuration
+// material lookups, then a small Monte Carlo sweep whose results are printed
+// as they stream out next to the uncollided transmission.
+
+#include "Material.hpp"
+#include "ShieldSweep.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Uncollided transmission looking every coef up in the material tables
+double lookupTransmission(const SweepConfiguration &configuration)
+{
+  double mean_free_paths{0.0};
+
+  for(const auto &layer : configuration.layers)
+  {
+    mean_free_paths += layer.first->getLinearAttenCoef(
+                           configuration.energy,
+                           ParticleConstants::ReactionType::TOTAL_WITH_COHERENT,
+                           ParticleConstants::ParticleType::GAMMA) *
+                       layer.second;
+  }
+
+  return std::exp(-mean_free_paths);
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material lead("lead", 11.35, {{Element::Pb, 1.0}});
+  Material iron("iron", 7.874, {{Element::Fe, 1.0}});
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+  Material water{Material::fromFormula("water", 1.0,
+                                       {{Element::H, 2.0}, {Element::O, 1.0}})};
+
+  int no_threads{
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
+
+  // Point-kernel sweep
+  SweepSpace space;
+  std::vector<double> thicknesses;
+
+  for(int i{1}; i <= 16; i++)
+  {
+    thicknesses.push_back(0.5 * i);
+  }
+
+  for(int layer{0}; layer < 2; layer++)
+  {
+    space.materials.push_back({&lead, &iron, &concrete, &water});
+    space.thicknesses.push_back(thicknesses);
+  }
+
+  for(int i{0}; i < 25; i++)
+  {
+    space.energies.push_back(0.1 * std::pow(100.0, i / 24.0));
+  }
+
+  SweepSettings settings;
+  settings.no_threads = no_threads;
+
+  ShieldSweep sweep(space, settings);
+  long long no_results{0};
+  double max_difference{0.0};
+
+  auto start{std::chrono::steady_clock::now()};
+  sweep.run([&no_results](const SweepResult &) { no_results++; });
+  double sweep_seconds{secondsSince(start)};
+
+  // Same designs with a lookup per layer, on a subset as it is slow
+  const long long stride{97};
+  long long no_lookups{0};
+  start = std::chrono::steady_clock::now();
+
+  for(long long index{0}; index < sweep.getNoConfigurations();
+      index += stride)
+  {
+    lookupTransmission(sweep.getConfiguration(index));
+    no_lookups++;
+  }
+
+  double lookup_seconds{secondsSince(start)};
+
+  // Check agreement on the subset
+  sweep.run(
+      [&max_difference](const SweepResult &result)
+      {
+        if(result.index % stride == 0)
+        {
+          double reference{lookupTransmission(result.configuration)};
+          max_difference =
+              std::max(max_difference,
+                       std::abs(result.transmission - reference) / reference);
+        }
+      });
+
+  std::cout << "Point-kernel sweep of " << no_results << " designs on "
+            << no_threads << " threads: " << sweep_seconds << " s, "
+            << no_results / sweep_seconds << " designs/s\n";
+  std::cout << "Per configuration lookups, 1 thread: "
+            << no_lookups / lookup_seconds << " designs/s\n";
+  std::cout << "Max relative difference " << max_difference << "\n\n";
+
+  // Monte Carlo sweep, results as they arrive
+  SweepSpace mc_space;
+  mc_space.materials = {{&lead, &concrete}};
+  mc_space.thicknesses = {{1.0, 5.0}};
+  mc_space.energies = {0.5, 2.0};
+
+  SweepSettings mc_settings;
+  mc_settings.method = SweepMethod::MONTE_CARLO;
+  mc_settings.no_threads = no_threads;
+  mc_settings.histories = 20000;
+
+  ShieldSweep mc_sweep(mc_space, mc_settings);
+
+  std::cout << std::setw(6) << "index" << std::setw(10) << "material"
+            << std::setw(8) << "cm" << std::setw(8) << "MeV" << std::setw(14)
+            << "transmission" << std::setw(12) << "rel err" << std::setw(14)
+            << "uncollided" << "\n";
+
+  mc_sweep.run(
+      [](const SweepResult &result)
+      {
+        const auto &layer{result.configuration.layers.front()};
+
+        std::cout << std::setw(6) << result.index << std::setw(10)
+                  << layer.first->getName() << std::setw(8) << layer.second
+                  << std::setw(8) << result.configuration.energy
+                  << std::setw(14) << result.transmission << std::setw(12)
+                  << result.relative_error << std::setw(14)
+                  << lookupTransmission(result.configuration) << "\n";
+      });
+
+  return 0;
+}
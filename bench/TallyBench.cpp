@@ -0,0 +1,172 @@
+// Scoring and reduction benchmark of the thread-local tally system
+// Threads score energy deposits into a 100^3 voxel mesh, with depths drawn
+// from an attenuating beam so that most voxels stay empty, and the buffers
+// are reduced at the end of each batch. Dense and sparse thread buffers are
+// compared with a single shared mesh updated through atomics.
+
+#include "RandomNumberGenerator.hpp"
+#include "TallySet.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+const int MeshSide{100};
+const int EventsPerThread{2000000};
+
+// Deposit position of a beam along z in a 10 cm cube, attenuated over 1 cm
+// and spread over 1 cm around the axis
+Vector3D samplePosition(RandomNumberGenerator &rng)
+{
+  double x{5.0 + (rng.getUniform() - 0.5)};
+  double y{5.0 + (rng.getUniform() - 0.5)};
+  double z{std::min(rng.getRandomStep(1.0), 9.999)};
+
+  return Vector3D(x, y, z);
+}
+
+struct BenchResult
+{
+  double score_ns;
+  double reduce_ms;
+  double memory_mb;
+  double total;
+};
+
+BenchResult runTallySet(int no_threads, TallyStorage storage)
+{
+  TallySet tally_set;
+  tally_set.addTally(std::make_unique<MeshTally>(
+      "dose",
+      CartesianMesh(BoundingBox(Vector3D(0.0), Vector3D(10.0)),
+                    {MeshSide, MeshSide, MeshSide}),
+      storage));
+  tally_set.allocate(no_threads);
+
+  auto score_start{std::chrono::steady_clock::now()};
+
+  std::vector<std::thread> threads;
+
+  for(int thread{0}; thread < no_threads; thread++)
+  {
+    threads.emplace_back(
+        [&tally_set, thread]()
+        {
+          RandomNumberGenerator rng(1000 + thread);
+
+          for(int i{0}; i < EventsPerThread; i++)
+          {
+            tally_set.scoreDeposit(thread, samplePosition(rng), 0, 1.0);
+          }
+        });
+  }
+
+  for(std::thread &thread : threads)
+  {
+    thread.join();
+  }
+
+  auto score_end{std::chrono::steady_clock::now()};
+  double memory_mb{tally_set.getMemoryBytes() / 1e6};
+
+  const std::vector<TallyBuffer> &totals{tally_set.reduce()};
+
+  auto reduce_end{std::chrono::steady_clock::now()};
+
+  double total{0.0};
+  totals[0].forEachScore([&total](size_t, double score) { total += score; });
+
+  return {std::chrono::duration<double, std::nano>(score_end - score_start)
+                  .count() /
+              (static_cast<double>(EventsPerThread) * no_threads),
+          std::chrono::duration<double, std::milli>(reduce_end - score_end)
+              .count(),
+          memory_mb, total};
+}
+
+BenchResult runAtomic(int no_threads)
+{
+  CartesianMesh mesh(BoundingBox(Vector3D(0.0), Vector3D(10.0)),
+                     {MeshSide, MeshSide, MeshSide});
+  std::vector<double> scores(mesh.getSize(), 0.0);
+
+  auto score_start{std::chrono::steady_clock::now()};
+
+  std::vector<std::thread> threads;
+
+  for(int thread{0}; thread < no_threads; thread++)
+  {
+    threads.emplace_back(
+        [&mesh, &scores, thread]()
+        {
+          RandomNumberGenerator rng(1000 + thread);
+
+          for(int i{0}; i < EventsPerThread; i++)
+          {
+            long long voxel{mesh.getVoxel(samplePosition(rng))};
+            std::atomic_ref<double>(scores[voxel]).fetch_add(1.0);
+          }
+        });
+  }
+
+  for(std::thread &thread : threads)
+  {
+    thread.join();
+  }
+
+  auto score_end{std::chrono::steady_clock::now()};
+
+  double total{0.0};
+
+  for(double score : scores)
+  {
+    total += score;
+  }
+
+  return {std::chrono::duration<double, std::nano>(score_end - score_start)
+                  .count() /
+              (static_cast<double>(EventsPerThread) * no_threads),
+          0.0, scores.size() * sizeof(double) / 1e6, total};
+}
+
+void printResult(const char *name, int no_threads, const BenchResult &result)
+{
+  std::cout << std::setw(10) << name << std::setw(10) << no_threads
+            << std::fixed << std::setprecision(2) << std::setw(12)
+            << result.score_ns << std::setw(12) << result.reduce_ms
+            << std::setw(12) << result.memory_mb << std::setw(14)
+            << std::setprecision(0) << result.total << "\n";
+  std::cout.unsetf(std::ios::fixed);
+}
+
+} // namespace
+
+int main()
+{
+  int max_threads{
+      std::max(4, static_cast<int>(std::thread::hardware_concurrency()))};
+
+  std::cout << std::setw(10) << "storage" << std::setw(10) << "threads"
+            << std::setw(12) << "ns/score" << std::setw(12) << "reduce ms"
+            << std::setw(12) << "memory MB" << std::setw(14) << "total"
+            << "\n";
+
+  for(int no_threads{1}; no_threads <= max_threads; no_threads *= 2)
+  {
+    printResult("dense", no_threads,
+                runTallySet(no_threads, TallyStorage::DENSE));
+    printResult("sparse", no_threads,
+                runTallySet(no_threads, TallyStorage::SPARSE));
+    printResult("atomic", no_threads, runAtomic(no_threads));
+  }
+
+  return 0;
+}
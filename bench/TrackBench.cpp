@@ -0,0 +1,115 @@
+// Track recording benchmark
+// Runs the same slab problem without recording and with interaction points
+// streamed to disk, uncompressed and compressed, then reads each file back to
+// check that every record written arrived and that the file carries the
+// number dropped. Transport never waits for the writer thread and the writer
+// never waits for compression while a chunk buffer is free, so the drop rate
+// must stay below MaxDropRate with or without compression.
+
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "TrackRecorder.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+const long long BenchHistories{200000};
+
+// Largest fraction of records that may be dropped in either recording mode
+const double MaxDropRate{0.01};
+
+double runCase(const Transport &transport, const PhotonPhysics &physics,
+               RunSettings settings)
+{
+  TallySet tally_set;
+  tally_set.addTally(std::make_unique<SurfaceTally>(
+      "behind", Vector3D::UNITZ, 11.0, std::vector<double>{1e-3, 1.01}));
+
+  settings.max_histories = BenchHistories;
+
+  RunDriver driver(transport, physics, tally_set,
+                   [](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     1.0, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   settings);
+  driver.run();
+
+  return driver.getElapsedSeconds();
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material water{Material::fromFormula("water", 1.0,
+                                       {{Element::H, 2.0}, {Element::O, 1.0}})};
+  SlabGeometry geometry({{&water, 10.0}});
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 20000;
+
+  std::cout << std::setw(14) << "recording" << std::setw(12) << "seconds"
+            << std::setw(14) << "records" << std::setw(10) << "dropped"
+            << std::setw(12) << "drop rate" << std::setw(14) << "bytes/record"
+            << std::setw(10) << "readback" << "\n";
+
+  std::cout << std::setw(14) << "off" << std::setw(12)
+            << runCase(transport, physics, settings) << "\n";
+
+  std::string path{(std::filesystem::temp_directory_path() / "tracks.bin")
+                       .string()};
+  bool passed{true};
+
+  for(TrackCompression compression :
+      {TrackCompression::NONE, TrackCompression::SHUFFLE_RLE})
+  {
+    TrackRecorder recorder(path, settings.no_threads, compression);
+    settings.track_recorder = &recorder;
+
+    double seconds{runCase(transport, physics, settings)};
+    recorder.close();
+
+    long long records{recorder.getRecordsWritten()};
+    long long dropped{recorder.getDropped()};
+    long long file_dropped;
+    size_t read_back{TrackRecorder::readFile(path, file_dropped).size()};
+    bool complete{read_back == static_cast<size_t>(records) &&
+                  file_dropped == dropped};
+    double drop_rate{static_cast<double>(dropped) /
+                     static_cast<double>(records + dropped)};
+
+    std::cout << std::setw(14)
+              << (compression == TrackCompression::NONE ? "raw" : "compressed")
+              << std::setw(12) << seconds << std::setw(14) << records
+              << std::setw(10) << dropped << std::setw(12) << drop_rate
+              << (drop_rate <= MaxDropRate ? "" : " (FAIL)") << std::setw(14)
+              << static_cast<double>(std::filesystem::file_size(path)) /
+                     static_cast<double>(records)
+              << std::setw(10) << (complete ? "ok" : "FAIL") << "\n";
+    passed &= complete && drop_rate <= MaxDropRate;
+  }
+
+  std::filesystem::remove(path);
+
+  return passed ? 0 : 1;
+}
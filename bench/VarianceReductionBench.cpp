@@ -0,0 +1,219 @@
+// Variance reduction benchmark
+// Transports a 1 MeV pencil beam through a 90 cm concrete shield (about 13 mean
+// free paths) and scores the transmitted current behind it. The same number of
+// histories is run analog, with implicit capture, and with implicit capture
+// plus weight windows from region and mesh importance maps, comparing the
+// figure of merit of each. Also checks that split copies and their
+// secondaries all get ids of their own and that every thread's particle bank
+// has its storage reserved before transport starts.
+
+#include "CartesianMesh.hpp"
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+#include "WeightWindows.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+const int NoLayers{15};
+const double LayerThickness{6.0}; // cm
+const long long BenchHistories{200000};
+
+// Importance ratio between neighbouring layers. Kept below the uncollided
+// attenuation per layer (about 2.4) as the windows do not depend on energy and
+// would otherwise over-split the downscattered flux.
+const double ImportanceGrowth{2.0};
+
+void runCase(const std::string &label, const Transport &transport,
+             const PhotonPhysics &physics, RunSettings settings)
+{
+  TallySet tally_set;
+  int behind{tally_set.addTally(std::make_unique<SurfaceTally>(
+      "behind", Vector3D::UNITZ, NoLayers * LayerThickness + 1.0,
+      std::vector<double>{1e-3, 1.01}))};
+
+  settings.max_histories = BenchHistories;
+
+  RunDriver driver(transport, physics, tally_set,
+                   [](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     1.0, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   settings);
+  driver.run();
+
+  // Bin 0 is the net current of the only energy bin
+  const TallyStatistics &statistics{driver.getStatistics(behind)};
+
+  std::cout << std::setw(22) << label << std::setw(14)
+            << statistics.getMean(0) << std::setw(12)
+            << statistics.getRelativeError(0) << std::setw(12)
+            << driver.getElapsedSeconds() << std::setw(12)
+            << statistics.getFigureOfMerit(0, driver.getElapsedSeconds())
+            << "\n";
+}
+
+// Splits a heavy particle in windows of importance 1 and has the particle
+// and each copy emit two secondaries. Returns true if no id repeats.
+bool checkSplitIds()
+{
+  WeightWindows windows(std::vector<double>{1.0});
+  RandomNumberGenerator rng(1);
+  ParticleBank bank(VarianceReductionConstants::ParticleBankCapacity);
+
+  Particle particle(ParticleConstants::ParticleType::GAMMA, 1.0,
+                    Vector3D::ZERO, Vector3D::UNITZ);
+  particle.setID(1);
+  particle.setWeight(VarianceReductionConstants::MaxSplit);
+  windows.apply(particle, 0, rng, bank);
+
+  std::vector<Particle> particles{particle};
+
+  while(!bank.isEmpty())
+  {
+    bank.pop(particle);
+    particles.push_back(particle);
+  }
+
+  std::set<std::uint64_t> ids;
+  size_t no_ids{0};
+
+  for(Particle &split : particles)
+  {
+    ids.insert(split.getID());
+
+    for(int i{0}; i < 2; i++)
+    {
+      ids.insert(split.createSecondary(ParticleConstants::ParticleType::GAMMA,
+                                       0.5, Vector3D::UNITZ)
+                     .getID());
+    }
+
+    no_ids += 3;
+  }
+
+  std::cout << "Split into " << particles.size() << " particles, "
+            << ids.size() << " distinct ids of " << no_ids;
+  bool passed{particles.size() > 1 && ids.size() == no_ids};
+  std::cout << (passed ? " (ok)\n\n" : " (FAIL)\n\n");
+
+  return passed;
+}
+
+// Constructs a driver and returns true if every thread's bank already holds
+// storage for a full bank, so banking during transport never allocates
+bool checkBankReserved(const Transport &transport,
+                       const PhotonPhysics &physics,
+                       const RunSettings &settings)
+{
+  TallySet tally_set;
+  RunDriver driver(transport, physics, tally_set,
+                   [](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     1.0, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   settings);
+  size_t reserved{VarianceReductionConstants::ParticleBankCapacity};
+
+  for(int thread{0}; thread < settings.no_threads; thread++)
+  {
+    reserved = std::min(reserved, driver.getBank(thread).getReserved());
+  }
+
+  std::cout << "Smallest bank reservation " << reserved << " particles of "
+            << VarianceReductionConstants::ParticleBankCapacity;
+  bool passed{reserved >= VarianceReductionConstants::ParticleBankCapacity};
+  std::cout << (passed ? " (ok)\n\n" : " (FAIL)\n\n");
+
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+
+  Material concrete("concrete", 2.3,
+                    {{Element::H, 0.010},
+                     {Element::O, 0.529},
+                     {Element::Na, 0.016},
+                     {Element::Al, 0.034},
+                     {Element::Si, 0.337},
+                     {Element::Ca, 0.044},
+                     {Element::Fe, 0.014},
+                     {Element::C, 0.001},
+                     {Element::Mg, 0.002},
+                     {Element::K, 0.013}});
+
+  // Layers only serve as importance regions
+  std::vector<std::pair<const Material *, double>> layers(
+      NoLayers, {&concrete, LayerThickness});
+  SlabGeometry geometry(layers);
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+  PhotonPhysics physics(geometry.getMaterials());
+
+  std::vector<double> region_importances;
+
+  for(int i{0}; i < NoLayers; i++)
+  {
+    region_importances.push_back(std::pow(ImportanceGrowth, i));
+  }
+
+  WeightWindows region_windows(region_importances);
+
+  // Finer mesh map with the importance growing continuously through depth
+  const int no_mesh_layers{4 * NoLayers};
+  double depth{NoLayers * LayerThickness};
+  CartesianMesh mesh({Vector3D(-1e3, -1e3, 0.0), Vector3D(1e3, 1e3, depth)},
+                     {1, 1, no_mesh_layers});
+  std::vector<double> voxel_importances;
+
+  for(int i{0}; i < no_mesh_layers; i++)
+  {
+    voxel_importances.push_back(std::pow(
+        ImportanceGrowth, (i + 0.5) * NoLayers / no_mesh_layers - 0.5));
+  }
+
+  WeightWindows mesh_windows(mesh, voxel_importances);
+
+  RunSettings settings;
+  settings.no_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  settings.histories_per_batch = 20000;
+
+  bool passed{checkSplitIds()};
+  passed = checkBankReserved(transport, physics, settings) && passed;
+
+  std::cout << std::setw(22) << "method" << std::setw(14) << "current"
+            << std::setw(12) << "rel error" << std::setw(12) << "seconds"
+            << std::setw(12) << "FOM" << "\n";
+
+  runCase("analog", transport, physics, settings);
+
+  settings.implicit_capture = true;
+  runCase("implicit capture", transport, physics, settings);
+
+  settings.weight_windows = &region_windows;
+  runCase("region windows", transport, physics, settings);
+
+  settings.weight_windows = &mesh_windows;
+  runCase("mesh windows", transport, physics, settings);
+
+  return passed ? 0 : 1;
+}
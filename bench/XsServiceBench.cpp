@@ -0,0 +1,215 @@
+// Cross section query service benchmark
+// Runs a server in process on a temporary socket, checks its answers against
+// direct lookups and a mixture against Material, that a client which stops
+// reading does not hold up another, then measures the rate of coefs served to
+// one pipelined client for several batch sizes and request windows.
+
+#include "DataProcessor.hpp"
+#include "Material.hpp"
+#include "XsClient.hpp"
+#include "XsServer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include <unistd.h>
+
+namespace
+{
+
+// Coefs per second served to a client keeping window requests in flight
+double timeQueries(XsClient &client, const std::vector<double> &energies,
+                   size_t batch, int window, int no_requests)
+{
+  std::mt19937_64 rng(11);
+  std::uniform_int_distribution<int> atomic_number(1, 100);
+  int sent{0};
+  int received{0};
+  auto start{std::chrono::steady_clock::now()};
+
+  while(received < no_requests)
+  {
+    while(sent < no_requests && sent - received < window)
+    {
+      size_t offset{(static_cast<size_t>(sent) * batch) %
+                    (energies.size() - batch)};
+      XsQuery query{
+          {{static_cast<ElementConversion::Element>(atomic_number(rng)), 1.0}},
+          1.0,
+          ParticleConstants::ReactionType::TOTAL_WITH_COHERENT,
+          std::span<const double>(energies).subspan(offset, batch)};
+      client.send(query);
+      sent++;
+    }
+
+    if(!client.receive().ok)
+    {
+      std::cout << "Unexpected error response\n";
+    }
+
+    received++;
+  }
+
+  double seconds{std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()};
+
+  return static_cast<double>(no_requests) * batch / seconds;
+}
+
+} // namespace
+
+int main()
+{
+  using ElementConversion::Element;
+  using ParticleConstants::ReactionType;
+  const auto gamma{ParticleConstants::ParticleType::GAMMA};
+
+  int no_workers{
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+  std::string socket_path{"/tmp/nse_xs_bench_" + std::to_string(::getpid()) +
+                          ".sock"};
+
+  auto start{std::chrono::steady_clock::now()};
+  XsServer server(socket_path, no_workers);
+  double startup{std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()};
+
+  std::cout << "Server on " << socket_path << " with " << no_workers
+            << " workers, loaded in " << std::setprecision(3) << startup
+            << " s\n\n";
+
+  XsClient client(socket_path);
+
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> log_energy(std::log(1e-3),
+                                                    std::log(1e2));
+  std::vector<double> energies(1 << 20);
+
+  for(double &energy : energies)
+  {
+    energy = std::exp(log_energy(rng));
+  }
+
+  // Single elements must match direct lookups exactly
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  std::span<const double> check_energies(energies.data(), 4096);
+  long long mismatches{0};
+
+  for(Element element : {Element::H, Element::Fe, Element::Pb, Element::U})
+  {
+    for(ReactionType reaction :
+        ParticleConstants::AllowedReactions.at(gamma))
+    {
+      std::vector<double> values{
+          client.query({{{element, 1.0}}, 1.0, reaction, check_energies})};
+
+      for(size_t i{0}; i < values.size(); i++)
+      {
+        if(values[i] != data_processor.getAttenCoef(check_energies[i],
+                                                    reaction, gamma, element))
+        {
+          mismatches++;
+        }
+      }
+    }
+  }
+
+  std::cout << "Element mismatches against DataProcessor: " << mismatches
+            << "\n";
+
+  // Mixtures against Material, which interpolates on its union grid
+  Material water("water", 1.0,
+                 {{Element::H, 0.111894}, {Element::O, 0.888106}});
+  double max_error{0.0};
+
+  for(ReactionType reaction : ParticleConstants::AllowedReactions.at(gamma))
+  {
+    std::vector<double> values{client.query({water.getComposition(),
+                                             water.getDensity(), reaction,
+                                             check_energies})};
+
+    for(size_t i{0}; i < values.size(); i++)
+    {
+      double expected{
+          water.getLinearAttenCoef(check_energies[i], reaction, gamma)};
+
+      if(expected > 0.0)
+      {
+        max_error = std::max(max_error, std::abs(values[i] / expected - 1.0));
+      }
+    }
+  }
+
+  std::cout << "Water max relative error against Material: " << max_error
+            << "\n";
+
+  // Invalid requests are answered with an error
+  double energy{1.0};
+  client.send({{{Element::Pb, 1.0}},
+               1.0,
+               static_cast<ReactionType>(99),
+               std::span<const double>(&energy, 1)});
+  XsResponse response{client.receive()};
+  std::cout << "Invalid reaction: " << (response.ok ? "ok" : response.error)
+            << "\n";
+
+  // Responses to a client that stops reading fill its socket buffer. Workers
+  // writing them directly would block and, with one worker, never answer
+  // anyone else.
+  {
+    XsClient stalled(socket_path);
+    std::span<const double> large(energies.data(), 1 << 16);
+
+    for(int request{0}; request < 32; request++)
+    {
+      stalled.send({{{Element::Pb, 1.0}},
+                    1.0,
+                    ReactionType::TOTAL_WITH_COHERENT,
+                    large});
+    }
+
+    start = std::chrono::steady_clock::now();
+    client.query({{{Element::Fe, 1.0}},
+                  1.0,
+                  ReactionType::TOTAL_WITH_COHERENT,
+                  check_energies});
+    double stalled_ms{std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count() *
+                      1e3};
+
+    std::cout << "Query while another client stops reading: " << stalled_ms
+              << " ms\n\n";
+  }
+
+  std::cout << std::setw(8) << "batch" << std::setw(8) << "window"
+            << std::setw(16) << "Mcoefs/s" << "\n";
+
+  for(size_t batch : {1, 64, 1024, 16384})
+  {
+    for(int window : {1, 16})
+    {
+      int no_requests{static_cast<int>(
+          std::clamp<size_t>((1 << 22) / batch, 64, 20000))};
+      double rate{timeQueries(client, energies, batch, window, no_requests)};
+
+      std::cout << std::setw(8) << batch << std::setw(8) << window
+                << std::setw(16) << std::setprecision(4) << rate / 1e6
+                << "\n";
+    }
+  }
+
+  server.stop();
+
+  std::cout << "\nServed " << server.getRequestsServed() << " requests, "
+            << server.getValuesServed() << " coefs\n";
+
+  return 0;
+}
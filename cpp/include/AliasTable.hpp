@@ -0,0 +1,62 @@
+// Walker alias table for O(1) sampling from a discrete distribution
+// Built with Vose's method. Each column holds an acceptance probability and
+// an alias, so a sample costs one uniform random number and one compare.
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct AliasEntry
+{
+  float probability;   // Probability of keeping the column's own index
+  std::uint32_t alias; // Index returned otherwise
+};
+
+class AliasTable
+{
+private:
+  std::vector<AliasEntry> entries;
+
+public:
+  // Empty table, must be assigned before sampling
+  AliasTable() = default;
+
+  // Constructor from weights, which need not be normalised
+  AliasTable(const std::vector<double> &weights);
+
+  // Getters
+  size_t size() const { return entries.size(); }
+  const std::vector<AliasEntry> &getEntries() const { return entries; }
+
+  // Samples an index from a uniform random number in [0, 1]
+  size_t sample(double uniform) const { return sample(entries, uniform); }
+
+  // Probability that index is sampled, reconstructed from the table
+  double getProbability(size_t index) const
+  {
+    return getProbability(entries, index);
+  }
+
+  // Flat storage versions so many small tables can share one array
+  static void build(std::span<const double> weights,
+                    std::span<AliasEntry> entries);
+  static size_t sample(std::span<const AliasEntry> entries, double uniform)
+  {
+    // Column from the integer part, accept or alias from the fractional part
+    double position{uniform * entries.size()};
+    size_t column{static_cast<size_t>(position)};
+
+    if(column >= entries.size())
+    {
+      column = entries.size() - 1;
+    }
+
+    return (position - column < entries[column].probability)
+               ? column
+               : entries[column].alias;
+  }
+  static double getProbability(std::span<const AliasEntry> entries,
+                               size_t index);
+};
@@ -0,0 +1,42 @@
+// Allocator returning storage aligned to a fixed boundary, used to keep
+// buffers written by different threads on separate cache lines
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+template <typename T, size_t Alignment> class AlignedAllocator
+{
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &)
+  {}
+
+  T *allocate(size_t n)
+  {
+    // Round up so the block also ends on a boundary
+    size_t bytes{(n * sizeof(T) + Alignment - 1) / Alignment * Alignment};
+
+    return static_cast<T *>(::operator new(bytes, std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T *pointer, size_t)
+  {
+    ::operator delete(pointer, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const
+  {
+    return true;
+  }
+};
@@ -0,0 +1,73 @@
+// Axis aligned bounding box used to accelerate geometry queries
+// Unbounded directions are represented with infinite extents
+
+#pragma once
+
+#include "Vector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+struct BoundingBox
+{
+  Vector3D min;
+  Vector3D max;
+
+  // Default constructed box is infinite
+  BoundingBox()
+      : min{-std::numeric_limits<double>::infinity()},
+        max{std::numeric_limits<double>::infinity()}
+  {}
+  BoundingBox(const Vector3D &min_, const Vector3D &max_)
+      : min{min_}, max{max_}
+  {}
+
+  static BoundingBox empty()
+  {
+    return {Vector3D(std::numeric_limits<double>::infinity()),
+            Vector3D(-std::numeric_limits<double>::infinity())};
+  }
+
+  bool isBounded() const
+  {
+    return std::isfinite(min.getX()) && std::isfinite(min.getY()) &&
+           std::isfinite(min.getZ()) && std::isfinite(max.getX()) &&
+           std::isfinite(max.getY()) && std::isfinite(max.getZ());
+  }
+
+  bool contains(const Vector3D &position) const
+  {
+    return position.getX() >= min.getX() && position.getX() <= max.getX() &&
+           position.getY() >= min.getY() && position.getY() <= max.getY() &&
+           position.getZ() >= min.getZ() && position.getZ() <= max.getZ();
+  }
+
+  Vector3D centroid() const { return (min + max) * 0.5; }
+
+  // Smallest box containing both boxes
+  BoundingBox merge(const BoundingBox &other) const
+  {
+    return {Vector3D(std::min(min.getX(), other.min.getX()),
+                     std::min(min.getY(), other.min.getY()),
+                     std::min(min.getZ(), other.min.getZ())),
+            Vector3D(std::max(max.getX(), other.max.getX()),
+                     std::max(max.getY(), other.max.getY()),
+                     std::max(max.getZ(), other.max.getZ()))};
+  }
+  BoundingBox merge(const Vector3D &point) const
+  {
+    return merge(BoundingBox(point, point));
+  }
+
+  // Overlap of both boxes
+  BoundingBox intersect(const BoundingBox &other) const
+  {
+    return {Vector3D(std::max(min.getX(), other.min.getX()),
+                     std::max(min.getY(), other.min.getY()),
+                     std::max(min.getZ(), other.min.getZ())),
+            Vector3D(std::min(max.getX(), other.max.getX()),
+                     std::min(max.getY(), other.max.getY()),
+                     std::min(max.getZ(), other.max.getZ()))};
+  }
+};
@@ -0,0 +1,35 @@
+// Regular Cartesian mesh overlaid on the geometry, used by mesh tallies and
+// mesh based importance maps
+// Voxel (i, j, k) has index (k * no_y + j) * no_x + i
+
+#pragma once
+
+#include "BoundingBox.hpp"
+#include "Vector.hpp"
+
+#include <array>
+#include <cstddef>
+
+class CartesianMesh
+{
+private:
+  BoundingBox bounds;
+  std::array<int, 3> no_voxels;
+  Vector3D inverse_voxel_size;
+
+public:
+  // Constructor
+  CartesianMesh(const BoundingBox &bounds_,
+                const std::array<int, 3> &no_voxels_);
+
+  // Getters
+  const BoundingBox &getBounds() const { return bounds; }
+  const std::array<int, 3> &getNoVoxels() const { return no_voxels; }
+  size_t getSize() const
+  {
+    return static_cast<size_t>(no_voxels[0]) * no_voxels[1] * no_voxels[2];
+  }
+
+  // Index of the voxel containing position, -1 if outside the mesh
+  long long getVoxel(const Vector3D &position) const;
+};
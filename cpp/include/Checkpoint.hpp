@@ -0,0 +1,86 @@
+// Checkpoint/restart of transport runs
+// RunDriver checkpoints at batch boundaries, where every thread buffer has
+// been reduced into the tally statistics and the random number stream of each
+// thread in the next batch follows from the seed and batch number alone. The
+// state is then the statistics of every tally plus the history cursor and
+// batch counter, so a checkpoint grows with the number of tally bins and not
+// with the histories run. Resuming from one reproduces the uninterrupted run
+// bit for bit given the same seed, threads and batch size.
+//
+// File layout, in native byte order: FileMagic, uint32 version, the run
+// counters and settings below, uint32 number of tallies, then per tally the
+// uint64 number of bins followed by its TallyStatistics state.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "TallySet.hpp"
+#include "TallyStatistics.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Checkpoint
+{
+  // Settings the random number streams depend on
+  std::uint64_t seed;
+  std::int32_t no_threads;
+  std::int64_t histories_per_batch;
+
+  std::int64_t histories_run; // Source history cursor
+  std::int32_t batches_run;   // Random number stream counter
+  double elapsed_seconds;
+  std::vector<TallyStatistics> statistics; // Per tally
+
+  // Writes to a temporary file, syncs it to disk and renames it over path,
+  // then syncs the directory, so an interrupted write or a crash leaves the
+  // previous checkpoint intact
+  void write(const std::string &path) const;
+
+  // Throws if the file is missing, truncated or of another version, or if its
+  // tallies and their bins differ from those of tally_set. Counts in the file
+  // are checked before anything is sized from them.
+  static Checkpoint read(const std::string &path, const TallySet &tally_set);
+};
+
+// Writes checkpoints on a background thread so that transport never waits on
+// the disk. A checkpoint submitted while an earlier one is still waiting
+// replaces it, only the latest state being worth writing.
+class CheckpointWriter
+{
+private:
+  std::string path;
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::optional<Checkpoint> pending;
+  bool writing{false};
+  bool stopping{false};
+  long long no_written{0};
+  std::exception_ptr writer_error;
+
+  void runWriter();
+
+public:
+  // Constructor, starts the writer thread
+  explicit CheckpointWriter(const std::string &path_);
+  CheckpointWriter(const CheckpointWriter &) = delete;
+  CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+  ~CheckpointWriter(); // Writes whatever is pending
+
+  // Getters
+  const std::string &getPath() const { return path; }
+  long long getNoWritten();
+
+  // Queues a checkpoint and returns at once
+  void submit(Checkpoint checkpoint);
+
+  // Waits until everything submitted is on disk, rethrowing a write failure
+  void flush();
+};
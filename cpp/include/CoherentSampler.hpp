@@ -0,0 +1,102 @@
+// Coherent (Rayleigh) scattering kernel for a single element
+// The angular distribution is (1 + cos^2 theta) F(x)^2 with a two shell
+// hydrogenic form factor
+// F = Z [(1 - c) / (1 + (x / x_o)^2)^2 + c / (1 + (x / x_c)^2)^2]
+// and momentum transfer x = E sin(theta / 2) / hc. The outer and core shell
+// scales and the core share c are fitted to the coherent column of the
+// element's photon data when the sampler is built. The fit fixes the shape of
+// the distribution only, the model being scaled at each energy so that it
+// integrates to the tabulated cross section. XsLibrary builds an element's
+// sampler on its first coherent scatter and shares it between every version
+// keeping the element's tables, so reloads only refit elements whose files
+// changed.
+// The core shell factor is inverted analytically through
+// w = (1 - s(t)) / (1 - s(2)) with s(t) = (1 + k^2 t / 2)^-3, k = E / (hc x_c)
+// and t = 1 - cos theta. What remains is a bounded, smooth density in w, which
+// is tabulated, so the table is small and sampling is a lookup with no
+// rejection.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "InverseCdfTable.hpp"
+#include "Particle.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <span>
+#include <utility>
+#include <vector>
+
+struct FormFactor
+{
+  double outer_scale;   // 1/Angstrom
+  double core_scale;    // 1/Angstrom, not less than outer_scale
+  double core_fraction; // Share of Z in the core shell
+};
+
+class CoherentSampler
+{
+private:
+  double atomic_number;
+  FormFactor form_factor;
+  InverseCdfTable table; // w against energy
+
+  // Rows of {energy, tabulated cross section in cm^2 per atom}
+  std::vector<std::vector<double>> cross_sections;
+
+  // Returns std::pair(k^2, 1 - s(2)) of the core shell at energy
+  static std::pair<double, double> coreScreening(const FormFactor &form_factor,
+                                                 double energy);
+
+  // 1 - cos(theta) at w
+  static double oneMinusCos(double scaled_squared, double range, double w);
+
+  // Density of w, (1 + cos^2 theta) (F / Z)^2 over the core shell factor
+  // squared, not normalised
+  static double density(const FormFactor &form_factor, double scaled_squared,
+                        double range, double w);
+
+  // Integral of (1 + cos^2 theta) (F / Z)^2 over cos theta, equal to
+  // sigma / (pi r_e^2 Z^2)
+  static double angularIntegral(const FormFactor &form_factor, double energy);
+
+  // Least squares fit to the tabulated coherent cross section
+  static FormFactor
+  fitFormFactor(const std::vector<std::vector<double>> &rows,
+                ElementConversion::Element element);
+
+public:
+  // Constructor from an element's photon data, fits the form factor and
+  // builds the table
+  CoherentSampler(const std::vector<std::vector<double>> &rows,
+                  ElementConversion::Element element);
+
+  // Getters
+  const FormFactor &getFormFactor() const { return form_factor; }
+  const InverseCdfTable &getTable() const { return table; }
+
+  // Coherent cross section of the fitted model in cm^2 per atom, before
+  // scaling
+  double getModelCrossSection(double energy) const;
+
+  // Coherent cross section of the scaled model in cm^2 per atom, which is
+  // the tabulated one
+  double getCrossSection(double energy) const;
+
+  // Samples cos theta from a uniform random number
+  double sample(double energy, double uniform) const
+  {
+    std::pair<double, double> screening{coreScreening(form_factor, energy)};
+
+    return 1.0 - oneMinusCos(screening.first, screening.second,
+                             table.sample(energy, uniform));
+  }
+
+  // Scatters the particle in place, the energy is unchanged
+  void scatter(Particle &particle, RandomNumberGenerator &rng) const;
+
+  // Batched variant. Arrays must all have the same size.
+  void sampleBatch(std::span<const double> energies,
+                   std::span<const double> uniforms,
+                   std::span<double> cos_thetas) const;
+};
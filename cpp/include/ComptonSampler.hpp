@@ -0,0 +1,46 @@
+// Compton (incoherent) scattering kernel sampling the Klein-Nishina
+// distribution for free electrons at rest
+// The angular distribution is precomputed into an InverseCdfTable over
+// 1 - cos(theta), from which the scattered energy follows by the Compton
+// formula
+
+#pragma once
+
+#include "InverseCdfTable.hpp"
+#include "Particle.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <span>
+#include <utility>
+
+class ComptonSampler
+{
+private:
+  InverseCdfTable table;
+
+public:
+  // Constructor, builds the table
+  ComptonSampler();
+
+  // Getters
+  const InverseCdfTable &getTable() const { return table; }
+
+  // Klein-Nishina pdf over 1 - cos(theta), not normalised
+  static double kleinNishina(double energy, double one_minus_cos);
+
+  // Returns std::pair(scattered energy, cos theta) from a uniform random
+  // number
+  std::pair<double, double> sample(double energy, double uniform) const;
+
+  // Scatters the particle in place, returning the energy given to the
+  // electron
+  double scatter(Particle &particle, RandomNumberGenerator &rng) const;
+
+  // Batched variants. Arrays must all have the same size.
+  void sampleBatch(std::span<const double> energies,
+                   std::span<const double> uniforms,
+                   std::span<double> scattered_energies,
+                   std::span<double> cos_thetas) const;
+  void scatterBatch(std::span<Particle> particles, RandomNumberGenerator &rng,
+                    std::span<double> deposited_energies) const;
+};
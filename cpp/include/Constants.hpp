@@ -3,9 +3,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace ParticleConstants
 {
@@ -30,6 +34,21 @@ inline const std::unordered_map<ParticleType, double> ParticleTypeToMass{
     {ParticleType::NEUTRON, 939.56542194},
     {ParticleType::PROTON, 938.27208816}};
 
+// Electron rest mass in MeV
+inline const double ElectronMass{0.51099895};
+
+// Classical electron radius in cm
+inline const double ClassicalElectronRadius{2.8179403262e-13};
+
+// Planck constant times speed of light in MeV Angstrom
+inline const double PlanckTimesC{1.23984198e-2};
+
+// Avogadro constant in 1/mol
+inline const double Avogadro{6.02214076e23};
+
+// Rydberg energy in MeV
+inline const double RydbergEnergy{13.605693122994e-6};
+
 enum class ReactionType
 {
   COHERENT_SCATTERING = 0,
@@ -45,7 +64,9 @@ inline const std::unordered_map<ParticleType, std::unordered_set<ReactionType>>
     AllowedReactions{{ParticleType::GAMMA,
                       {ReactionType::COHERENT_SCATTERING,
                        ReactionType::INCOHERENT_SCATTERING,
-                       ReactionType::PHOTOELECTRIC_ABSORPTION}}};
+                       ReactionType::PHOTOELECTRIC_ABSORPTION,
+                       ReactionType::NUCLEAR_PAIR_PRODUCTION,
+                       ReactionType::ELECTRON_PAIR_PRODUCTION}}};
 
 } // namespace ParticleConstants
 
@@ -83,6 +104,229 @@ inline const std::unordered_map<
           {ParticleConstants::ReactionType::TOTAL_WITHOUT_COHERENT, 7}}}};
 } // namespace FileConstants
 
+namespace GeometryConstants
+{
+// Distance a particle is pushed past a boundary so that it ends up inside the
+// next region (cm)
+inline const double BoundaryPush{1e-9};
+
+// Maximum number of cells in a bounding volume hierarchy leaf
+inline const int BvhLeafSize{4};
+
+// Subtrees with at least this many cells are built on their own thread
+inline const int BvhParallelThreshold{4096};
+} // namespace GeometryConstants
+
+namespace SamplingConstants
+{
+// Energy range (MeV) covered by precomputed sampling tables, matching the
+// photon data files
+inline const double TableMinEnergy{1e-3};
+inline const double TableMaxEnergy{1e5};
+
+// Log spaced energies and equiprobable quantiles per sampling table
+inline const int TableEnergies{161};
+inline const int TableQuantiles{257};
+
+// Points used to integrate each pdf when building its table
+inline const int TableIntegrationPoints{4096};
+
+// Per element coherent scattering tables. The tabulated variable has a smooth
+// distribution so a coarser energy grid than the Compton one suffices, but
+// it changes quickly in the last quantiles, which are refined.
+inline const int CoherentTableEnergies{81};
+inline const int CoherentTableQuantiles{257};
+
+// Largest core over outer shell momentum scale of the coherent form factor
+inline const double CoherentMaxScaleRatio{16.0};
+} // namespace SamplingConstants
+
+namespace SourceConstants
+{
+// Gamma lines (MeV, photons per decay) of common calibration and industrial
+// sources, lines below 1% omitted
+inline const std::unordered_map<std::string,
+                                std::vector<std::pair<double, double>>>
+    NuclideLines{{"Co-60", {{1.173228, 0.9985}, {1.332492, 0.999826}}},
+                 {"Cs-137", {{0.661657, 0.851}}},
+                 {"Eu-152",
+                  {{0.1217817, 0.2853},
+                   {0.2446974, 0.0755},
+                   {0.3442785, 0.2659},
+                   {0.4111165, 0.02237},
+                   {0.4439606, 0.02827},
+                   {0.7789045, 0.1293},
+                   {0.867380, 0.0423},
+                   {0.964057, 0.1451},
+                   {1.085837, 0.1011},
+                   {1.089737, 0.01734},
+                   {1.112076, 0.1367},
+                   {1.212948, 0.01415},
+                   {1.299142, 0.01633},
+                   {1.408013, 0.2087}}}};
+} // namespace SourceConstants
+
+namespace TallyConstants
+{
+// Alignment of per thread tally buffers so that threads never write to the
+// same cache line
+inline const size_t CacheLineSize{64};
+
+// Smallest |cos| used when scoring surface flux, as 1 / |cos| has infinite
+// variance for grazing crossings
+inline const double MinSurfaceCos{1e-2};
+
+// Length in cm of the track scored for a particle leaving the geometry
+inline const double EscapeTrackLength{1e10};
+} // namespace TallyConstants
+
+namespace TransportConstants
+{
+// Photons below the lowest data energy deposit what is left locally, in MeV
+inline const double PhotonEnergyCutoff{1e-3};
+
+// Batches run before convergence targets are checked, as the relative error
+// estimate is unreliable from fewer
+inline const int MinBatches{10};
+
+// Recent (energy, material) attenuation lookups each thread remembers
+inline const size_t CrossSectionCacheSize{4};
+
+// Elements of a mixture whose coefs fit on the stack when one is selected
+// for a collision. Larger mixtures interpolate them a second time instead.
+inline const size_t MaxStackElements{16};
+
+// Directions closer to the z axis than this (sqrt(1 - w^2)) are rotated about
+// z instead, as the general formula divides by it
+inline const double DirectionAxisTolerance{1e-10};
+} // namespace TransportConstants
+
+namespace VarianceReductionConstants
+{
+// Weight window bounds relative to the lower bound. A region of importance I
+// has lower bound 1 / (SurvivalRatio I), so a weight 1 source particle sits
+// at the survival weight of an importance 1 region.
+inline const double WindowUpperRatio{5.0};
+inline const double WindowSurvivalRatio{3.0};
+
+// Most copies a particle is split into at once
+inline const int MaxSplit{16};
+
+// Russian roulette of low weight particles when implicit capture runs
+// without weight windows
+inline const double CutoffWeight{1e-2};
+inline const double CutoffSurvivalWeight{1e-1};
+
+// Particles a thread can hold back for later transport
+inline const size_t ParticleBankCapacity{4096};
+} // namespace VarianceReductionConstants
+
+namespace TrackConstants
+{
+// Records each transport thread can hold before the writer drains them, a
+// power of 2. Records arriving at a full ring are dropped, counted and the
+// count stored at the end of the file.
+inline const size_t RingCapacity{1 << 16};
+
+// Records per chunk of the output file
+inline const size_t ChunkRecords{1 << 16};
+
+// Chunk buffers shared by the writer and encoder threads. The writer keeps
+// draining the rings while the others wait to be compressed.
+inline const size_t ChunkBuffers{4};
+
+// Pause of the writer thread when every ring is empty
+inline const int WriterPollMicroseconds{500};
+
+// File identification, followed by the format version
+inline const std::string FileMagic{"NSETRACK"};
+inline const std::uint32_t FileVersion{2};
+} // namespace TrackConstants
+
+namespace CheckpointConstants
+{
+// File identification, followed by the format version
+inline const std::string FileMagic{"NSECHKPT"};
+inline const std::uint32_t FileVersion{2};
+
+// Default wall time between checkpoints of a run (s)
+inline const double DefaultIntervalSeconds{600.0};
+} // namespace CheckpointConstants
+
+namespace ServiceConstants
+{
+// First word of every request and response of the query service
+inline const std::uint32_t ProtocolMagic{0x5358534eu};
+
+// Limits on a single request, larger ones are refused
+inline const std::uint64_t MaxEnergiesPerRequest{1u << 24};
+inline const std::uint32_t MaxComponentsPerRequest{128};
+
+// Requests read but not yet answered, readers wait when it is reached
+inline const size_t MaxQueuedRequests{1024};
+
+// Requests of one connection read but whose responses are not yet sent. Its
+// reader waits when it is reached, so a peer that stops reading only holds up
+// itself.
+inline const size_t MaxPendingResponses{64};
+} // namespace ServiceConstants
+
+namespace ReloadConstants
+{
+// Default time between checks of the data files for changes (s)
+inline const double DefaultIntervalSeconds{2.0};
+} // namespace ReloadConstants
+
+namespace SegmentConstants
+{
+// Start of a shared cross section segment, followed by the layout version
+inline const std::string SegmentMagic{"NSEXSSEG"};
+inline const std::uint32_t SegmentVersion{1};
+
+// Alignment of every column in the segment (bytes)
+inline const size_t ColumnAlignment{64};
+} // namespace SegmentConstants
+
+namespace NumaConstants
+{
+// Huge page size replicas are aligned to and allocated in (bytes)
+inline const size_t HugePageSize{2 << 20};
+
+// Alignment of every table in a replica (bytes)
+inline const size_t TableAlignment{64};
+
+// Where the kernel publishes the NUMA topology
+inline const std::string NodePath{"/sys/devices/system/node/"};
+} // namespace NumaConstants
+
+namespace AtomicRelaxationConstants
+{
+// Burhop fit of the K shell fluorescence yield w,
+// (w / (1 - w))^(1/4) = A + B Z + C Z^3
+inline const double KYieldA{0.015};
+inline const double KYieldB{0.0327};
+inline const double KYieldC{-0.64e-6};
+
+// Edges below the K edge needed to take the L3 edge from the data for the
+// K alpha energy, Moseley's law is used otherwise
+inline const int LEdgesBelowK{3};
+} // namespace AtomicRelaxationConstants
+
+namespace PointKernelConstants
+{
+// GP buildup ratios K closer than this to 1 use the linear limit of the
+// progression
+inline const double GPUnitRatioTolerance{1e-6};
+} // namespace PointKernelConstants
+
+namespace SweepConstants
+{
+// Configurations a sweep worker claims at a time, results are handed out per
+// chunk
+inline const long long PointKernelChunk{256};
+inline const long long MonteCarloChunk{1};
+} // namespace SweepConstants
+
 namespace ElementConversion
 {
 enum class Element
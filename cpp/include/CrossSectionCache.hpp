@@ -0,0 +1,143 @@
+// Per-thread memo of total attenuation coefs for the last few (energy,
+// material) lookups
+// A photon keeps its energy between collisions, so every boundary crossing
+// and delta tracking trial asks for the same coefs again. Entries remember
+// the interpolated total and the table bin it came from, the bin being reused
+// to skip the search when the same material is asked for at a nearby energy.
+// Changing a particle energy invalidates the coefs but keeps the bins.
+// Materials are told apart by Material::getId, which no other set of tables
+// ever shares, so a material built at the address of a freed one never hits
+// its entries.
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+struct CrossSectionCacheStatistics
+{
+  long long hits;
+  long long misses;
+
+  double getHitRate() const
+  {
+    long long lookups{hits + misses};
+    return (lookups == 0) ? 0.0 : static_cast<double>(hits) / lookups;
+  }
+};
+
+class CrossSectionCache
+{
+public:
+  struct Entry
+  {
+    // NaN never matches, so invalidated entries always miss
+    double energy{std::numeric_limits<double>::quiet_NaN()};
+    std::uint64_t material_id{0}; // Material ids start at 1
+    ParticleConstants::ParticleType particle_type{};
+    std::pair<size_t, size_t> above_below_indices{0, 0};
+    double total{0.0}; // 1/cm
+  };
+
+private:
+  std::array<Entry, TransportConstants::CrossSectionCacheSize> entries;
+  size_t next{0}; // Entry replaced by the next store
+  long long hits{0};
+  long long misses{0};
+
+  // Counts of caches whose threads have finished
+  inline static std::atomic<long long> finished_hits{0};
+  inline static std::atomic<long long> finished_misses{0};
+
+public:
+  CrossSectionCache() = default;
+  CrossSectionCache(const CrossSectionCache &) = delete;
+  CrossSectionCache &operator=(const CrossSectionCache &) = delete;
+  ~CrossSectionCache()
+  {
+    finished_hits += hits;
+    finished_misses += misses;
+  }
+
+  // Cache of the calling thread
+  static CrossSectionCache &getThreadCache()
+  {
+    thread_local CrossSectionCache cache;
+    return cache;
+  }
+
+  // Entry for an exact (energy, material, particle type) match, else nullptr
+  const Entry *find(double energy, std::uint64_t material_id,
+                    ParticleConstants::ParticleType particle_type)
+  {
+    for(const Entry &entry : entries)
+    {
+      if(entry.energy == energy && entry.material_id == material_id &&
+         entry.particle_type == particle_type)
+      {
+        hits++;
+        return &entry;
+      }
+    }
+
+    misses++;
+    return nullptr;
+  }
+
+  // Most recent entry for material whatever its energy, for its bin
+  const Entry *findBin(std::uint64_t material_id,
+                       ParticleConstants::ParticleType particle_type) const
+  {
+    for(size_t i{0}; i < entries.size(); i++)
+    {
+      const Entry &entry{entries[(next + entries.size() - 1 - i) %
+                                 entries.size()]};
+
+      if(entry.material_id == material_id &&
+         entry.particle_type == particle_type)
+      {
+        return &entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  void store(const Entry &entry)
+  {
+    entries[next] = entry;
+    next = (next + 1) % entries.size();
+  }
+
+  // Called when a particle changes energy, coefs go but bins stay
+  void invalidate()
+  {
+    for(Entry &entry : entries)
+    {
+      entry.energy = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+
+  // Hits and misses of finished threads plus the calling thread
+  static CrossSectionCacheStatistics getStatistics()
+  {
+    const CrossSectionCache &cache{getThreadCache()};
+
+    return {finished_hits + cache.hits, finished_misses + cache.misses};
+  }
+
+  static void resetStatistics()
+  {
+    CrossSectionCache &cache{getThreadCache()};
+
+    finished_hits = 0;
+    finished_misses = 0;
+    cache.hits = 0;
+    cache.misses = 0;
+  }
+};
@@ -0,0 +1,93 @@
+// Constructive solid geometry made of cells, each the intersection of surface
+// half-spaces and filled with a material
+// Cell lookup is accelerated with a bounding volume hierarchy over the cell
+// bounding boxes
+
+#pragma once
+
+#include "BoundingBox.hpp"
+#include "Geometry.hpp"
+#include "Surface.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Which half-space of a surface a cell lies in
+enum class Sense
+{
+  INSIDE = 0, // evaluate < 0
+  OUTSIDE = 1 // evaluate >= 0
+};
+
+struct CellSurface
+{
+  int surface; // Index returned by CsgGeometry::addSurface
+  Sense sense;
+};
+
+struct Cell
+{
+  std::vector<CellSurface> surfaces;
+  const Material *material; // nullptr for a void cell
+  BoundingBox bounds;
+};
+
+struct BvhNode
+{
+  BoundingBox bounds;
+  int left;  // Child node indices, -1 for leaves
+  int right;
+  int first; // Leaf range in cell_order
+  int count;
+};
+
+class CsgGeometry : public Geometry
+{
+private:
+  std::vector<std::unique_ptr<Surface>> surfaces;
+  std::vector<Cell> cells;
+  std::vector<BvhNode> nodes;
+  std::vector<int> cell_order;      // Bounded cells grouped by leaf
+  std::vector<int> unbounded_cells; // Checked linearly after the hierarchy
+  bool built;
+
+  // Recursively builds the subtree over cell_order[first, first + count) into
+  // the preallocated node
+  void buildNode(int node, int first, int count, int parallel_depth,
+                 std::atomic<int> &next_node);
+
+public:
+  // Constructor
+  CsgGeometry() : built{false} {}
+
+  // Returns the index used to refer to the surface in cells
+  int addSurface(std::unique_ptr<Surface> surface);
+
+  // Returns the region index of the cell. Cells must not overlap.
+  int addCell(const std::vector<CellSurface> &cell_surfaces,
+              const Material *material);
+
+  // Builds the bounding volume hierarchy, must be called after the last cell
+  // is added and before any queries
+  void build();
+
+  // Getters
+  const std::vector<BvhNode> &getNodes() const { return nodes; }
+  const Cell &getCell(int region) const { return cells.at(region); }
+
+  // Whether position is inside a single cell, without the hierarchy
+  bool cellContains(int region, const Vector3D &position) const;
+
+  int findRegion(const Vector3D &position) const override;
+  double distanceToBoundary(const Vector3D &position, const Vector3D &direction,
+                            int region) const override;
+  const Material *getMaterial(int region) const override
+  {
+    return cells.at(region).material;
+  }
+  int getNumberRegions() const override
+  {
+    return static_cast<int>(cells.size());
+  }
+};
@@ -1,36 +1,118 @@
 // Processes cross section data from the data folder
 // Singleton design pattern
+// The data is held as an immutable XsLibrary version. Loading an element,
+// registering a material or reloading changed files publishes a new version
+// in one step, and lookups read whichever version is current when they start.
+// A replaced version is freed once no query holds it.
+// Files are checked for changes by size and modification time and confirmed
+// by a hash of their contents, so a reload only reparses the elements whose
+// files changed and only rebuilds the registered materials made of them.
 
 #pragma once
 
 #include "Constants.hpp"
+#include "Material.hpp"
+#include "XsLibrary.hpp"
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <string>
+#include <thread>
 #include <vector>
 
-// Cached data stored in a map linking each particle to an element and its cross
-// section data
-using XsData =
-    std::unordered_map<ParticleConstants::ParticleType,
-                       std::unordered_map<ElementConversion::Element,
-                                          std::vector<std::vector<double>>>>;
+// How DataProcessor::reload decides that a file has changed
+enum class ReloadCheck
+{
+  MODIFIED, // Size or modification time differ and so does the hash
+  CONTENTS  // Hash of every file, for file systems with coarse times
+};
+
+// Outcome of DataProcessor::reload
+struct ReloadReport
+{
+  long long version; // Published, or the current one if nothing changed
+  std::vector<
+      std::pair<ParticleConstants::ParticleType, ElementConversion::Element>>
+      reparsed;
+  size_t no_rebuilt_materials;
+  std::vector<std::string> errors; // Files left on their old data
+};
 
 class DataProcessor
 {
 private:
-  XsData data;
-
-  int number_data_elements;
+  // Size, modification time and content hash of a file when it was parsed
+  struct FileStamp
+  {
+    std::uintmax_t size;
+    std::int64_t modified;
+    std::uint64_t hash;
+  };
+
+  // Address of the current version, compared without locking by the lookups
+  // below
+  std::atomic<const XsLibrary *> current;
+
+  // Owns the current version, replaced only under update_mutex
+  std::shared_ptr<const XsLibrary> library;
+  mutable std::mutex library_mutex;
+
+  // Version the lookups of the calling thread read, swapped for the current
+  // one once they see a publish. As it is held, no later version can reuse its
+  // address.
+  static thread_local std::shared_ptr<const XsLibrary> thread_library;
+
+  // Serialises everything that builds a new version
+  std::mutex update_mutex;
+  std::unordered_map<
+      ParticleConstants::ParticleType,
+      std::unordered_map<ElementConversion::Element, FileStamp>>
+      stamps;
+
+  // Background reloading
+  std::thread reloader;
+  std::mutex reloader_mutex;
+  std::condition_variable reloader_wake;
+  bool stop_reloading;
 
   // Empty Constructor
-  DataProcessor() : number_data_elements{0} {}
+  DataProcessor();
+  ~DataProcessor();
+
+  const XsLibrary &getCurrent() const
+  {
+    if(thread_library.get() != current.load(std::memory_order_acquire))
+    {
+      thread_library = getLibrary();
+    }
+
+    return *thread_library;
+  }
 
   void getDataFromFile(
       std::string &filepath, ParticleConstants::ParticleType particle_type,
       ElementConversion::Element element); // Stores filedata in data
 
+  // Reads a whole file, stamping it with its size and modification time from
+  // before the read and the hash of what was read
+  static std::string readFile(const std::string &filepath, FileStamp &stamp);
+
+  static FileStamp statFile(const std::string &filepath);
+
+  // Tables of an element from the contents of its file. Reloads check them,
+  // as a file caught part way through being written must keep its old data.
+  std::shared_ptr<const ElementXs>
+  parseElement(const std::string &contents,
+               ParticleConstants::ParticleType particle_type,
+               ElementConversion::Element element, bool check);
+
   std::vector<std::string> manualSplit(const std::string &string,
                                        char delimiter);
 
@@ -40,22 +122,16 @@ private:
   std::string processFilePath(ParticleConstants::ParticleType particle_type,
                               ElementConversion::Element element);
 
-  bool inDatabase(ParticleConstants::ParticleType particle_type,
-                  ElementConversion::Element element);
-
-  // Log-log interpolatation between b1 and b2 based off how far value is
-  // between a1 and a2
-  double interpolateBetween(double value, double a1, double a2, double b1,
-                            double b2) const;
-
-  void checkReaction(ParticleConstants::ParticleType particle_type,
-                     ParticleConstants::ReactionType reaction);
+  // Majorants over every material of library
+  static void buildMajorants(XsLibrary &library);
 
-  const std::pair<size_t, size_t>
-  getAboveBelowIndices(double value, std::vector<double> values)
-      const; // Returns std::pair(upper_index, lower_index)
+  // Makes next the current version, numbered after the one it replaces
+  void publish(std::shared_ptr<XsLibrary> next);
 
 public:
+  DataProcessor(const DataProcessor &) = delete;
+  DataProcessor &operator=(const DataProcessor &) = delete;
+
   // Singleton access
   static DataProcessor &getInstance();
   static DataProcessor &
@@ -66,19 +142,44 @@ public:
                                           ElementConversion::Element>>
                   &particle_element_pairs);
 
-  // Getters
-  const XsData &getAllData() const { return data; }
-  int get_number_data_elements() const { return number_data_elements; }
-  const std::vector<std::vector<double>> &
-  getData(ParticleConstants::ParticleType particle_type,
-          ElementConversion::Element element)
+  // Current version, which stays valid for as long as it is held. Queries
+  // that must not see a reload part way through hold one for their duration.
+  std::shared_ptr<const XsLibrary> getLibrary() const;
+
+  // Drops the version the lookups of the calling thread hold, so that an idle
+  // thread does not keep a replaced version alive. The next lookup takes the
+  // current one again.
+  static void releaseThread() { thread_library.reset(); }
+
+  // Calls releaseThread when it goes out of scope, at the end of a query or
+  // batch
+  class ThreadRelease
+  {
+  public:
+    ThreadRelease() = default;
+    ThreadRelease(const ThreadRelease &) = delete;
+    ThreadRelease &operator=(const ThreadRelease &) = delete;
+    ~ThreadRelease() { releaseThread(); }
+  };
+
+  // Getters, reading the current version. Tables come with shared ownership
+  // and stay valid for as long as they are held, whatever is published
+  // meanwhile.
+  std::shared_ptr<const XsData> getAllData() const;
+  int get_number_data_elements() const
   {
-    return data.at(particle_type).at(element); // Throws if not found
+    return getCurrent().getNoElements();
   }
-  const double getAttenCoef(double energy,
-                            ParticleConstants::ReactionType reaction,
-                            ParticleConstants::ParticleType particle_type,
-                            ElementConversion::Element element);
+  std::shared_ptr<const std::vector<std::vector<double>>>
+  getData(ParticleConstants::ParticleType particle_type,
+          ElementConversion::Element element); // Throws if not found
+  // From the version the calling thread holds, valid until its next lookup
+  // or releaseThread
+  const CoherentSampler &
+  getCoherentSampler(ElementConversion::Element element) const;
+  double getAttenCoef(double energy, ParticleConstants::ReactionType reaction,
+                      ParticleConstants::ParticleType particle_type,
+                      ElementConversion::Element element);
   const std::vector<double>
   getAllAttenCoefs(double energy, ParticleConstants::ParticleType particle_type,
                    ElementConversion::Element element);
@@ -91,4 +192,21 @@ public:
       const std::vector<std::pair<ParticleConstants::ParticleType,
                                   ElementConversion::Element>>
           &particle_element_pairs);
-};
\ No newline at end of file
+
+  // Registers a material, whose tables and the majorants over all registered
+  // materials then follow reloads. Returns its index in XsLibrary.
+  size_t addMaterial(const Material &material);
+
+  // Reparses the loaded elements whose files changed, rebuilds the materials
+  // made of them and the majorants, and publishes the result. Files that
+  // cannot be read or parsed keep their old data and are reported.
+  ReloadReport reload(ReloadCheck check = ReloadCheck::MODIFIED);
+
+  // Reloads every interval_seconds on a background thread until
+  // stopReloading, passing reports with changes or errors to on_reload,
+  // which must not throw
+  void startReloading(
+      double interval_seconds,
+      std::function<void(const ReloadReport &)> on_reload = {});
+  void stopReloading();
+};
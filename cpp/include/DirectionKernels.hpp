@@ -0,0 +1,168 @@
+// Kernels for changing particle directions at collisions
+// Angles are carried as cosines and sines throughout, so no kernel goes
+// through acos or atan2, and isotropic directions come from a point in the
+// unit disc (Marsaglia) rather than two angles. Rotations keep directions unit
+// length with one Newton step instead of a sqrt, which leaves a unit vector
+// bit for bit unchanged.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "Simd.hpp"
+#include "Vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+namespace DirectionKernels
+{
+
+// Cosine and sine of an azimuthal angle
+struct Azimuth
+{
+  double cos_phi;
+  double sin_phi;
+};
+
+// Isotropic unit vector from a point (x, y) in the unit disc with
+// s = x^2 + y^2 < 1 (Marsaglia 1972)
+inline Vector3D isotropicFromDisc(double x, double y, double s)
+{
+  double scale{2.0 * std::sqrt(1.0 - s)};
+
+  return {scale * x, scale * y, 1.0 - 2.0 * s};
+}
+
+// Rescales a direction whose length has drifted by rounding back to unit
+// length. One Newton step for 1 / |d| is exact to rounding for such drift and
+// rounds to a factor of exactly 1 when there is none.
+inline Vector3D keepUnit(const Vector3D &direction)
+{
+  return direction * (1.5 - 0.5 * direction.squaredMagnitude());
+}
+
+// Rotates a unit direction by polar angle theta (given as cos theta) and
+// azimuthal angle phi (given as cos and sin) about itself. Not rescaled, see
+// keepUnit.
+inline Vector3D rotateDirection(const Vector3D &direction, double cos_theta,
+                                const Azimuth &azimuth)
+{
+  double sin_theta{std::sqrt(std::max(0.0, 1.0 - cos_theta * cos_theta))};
+  double cos_phi{azimuth.cos_phi};
+  double sin_phi{azimuth.sin_phi};
+
+  double u{direction.getX()};
+  double v{direction.getY()};
+  double w{direction.getZ()};
+
+  double perp{std::sqrt(std::max(0.0, 1.0 - w * w))};
+
+  // Close to the z axis the general formula divides by ~0, so rotate about z
+  if(perp < TransportConstants::DirectionAxisTolerance)
+  {
+    return {sin_theta * cos_phi, sin_theta * sin_phi,
+            std::copysign(cos_theta, w)};
+  }
+
+  return {cos_theta * u + sin_theta * (u * w * cos_phi - v * sin_phi) / perp,
+          cos_theta * v + sin_theta * (v * w * cos_phi + u * sin_phi) / perp,
+          cos_theta * w - sin_theta * perp * cos_phi};
+}
+
+// As above with phi itself, for callers that already have the angle
+inline Vector3D rotateDirection(const Vector3D &direction, double cos_theta,
+                                double phi)
+{
+  return rotateDirection(direction, cos_theta, {std::cos(phi), std::sin(phi)});
+}
+
+// Rotates directions held as coordinate arrays in place, SIMD register by
+// register, and keeps them unit length. Lanes close to the z axis are
+// finished in scalar code. Arrays must all have the same size.
+inline void rotateDirections(std::span<double> u, std::span<double> v,
+                             std::span<double> w,
+                             std::span<const double> cos_thetas,
+                             std::span<const double> cos_phis,
+                             std::span<const double> sin_phis)
+{
+  size_t n{u.size()};
+
+  if(v.size() != n || w.size() != n || cos_thetas.size() != n ||
+     cos_phis.size() != n || sin_phis.size() != n)
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  using Simd::Register;
+  constexpr size_t width{Register::width};
+  const double axis_tolerance{TransportConstants::DirectionAxisTolerance};
+  const Register zero{Register::broadcast(0.0)};
+  const Register one{Register::broadcast(1.0)};
+  const Register half{Register::broadcast(0.5)};
+  const Register three_halves{Register::broadcast(1.5)};
+  const Register min_perp2{
+      Register::broadcast(axis_tolerance * axis_tolerance)};
+
+  size_t i{0};
+
+  for(; i + width <= n; i += width)
+  {
+    std::array<double, width> old_w;
+
+    Register x{Register::load(&u[i])};
+    Register y{Register::load(&v[i])};
+    Register z{Register::load(&w[i])};
+    Register cos_theta{Register::load(&cos_thetas[i])};
+    Register cos_phi{Register::load(&cos_phis[i])};
+    Register sin_phi{Register::load(&sin_phis[i])};
+    z.store(old_w.data());
+
+    Register sin_theta{sqrt(max(zero, one - cos_theta * cos_theta))};
+
+    // Clamped so near axis lanes stay finite until they are redone below
+    Register perp{sqrt(max(min_perp2, one - z * z))};
+    Register scale{sin_theta / perp};
+    Register z_cos_phi{z * cos_phi};
+
+    Register new_x{fma(scale, x * z_cos_phi - y * sin_phi, cos_theta * x)};
+    Register new_y{fma(scale, y * z_cos_phi + x * sin_phi, cos_theta * y)};
+    Register new_z{cos_theta * z - sin_theta * perp * cos_phi};
+
+    Register length2{
+        fma(new_x, new_x, fma(new_y, new_y, new_z * new_z))};
+    Register factor{three_halves - half * length2};
+
+    (new_x * factor).store(&u[i]);
+    (new_y * factor).store(&v[i]);
+    (new_z * factor).store(&w[i]);
+
+    for(size_t lane{0}; lane < width; lane++)
+    {
+      if(std::sqrt(std::max(0.0, 1.0 - old_w[lane] * old_w[lane])) <
+         axis_tolerance)
+      {
+        Vector3D rotated{rotateDirection({0.0, 0.0, old_w[lane]},
+                                         cos_thetas[i + lane],
+                                         {cos_phis[i + lane],
+                                          sin_phis[i + lane]})};
+        u[i + lane] = rotated.getX();
+        v[i + lane] = rotated.getY();
+        w[i + lane] = rotated.getZ();
+      }
+    }
+  }
+
+  for(; i < n; i++)
+  {
+    Vector3D rotated{keepUnit(rotateDirection(
+        {u[i], v[i], w[i]}, cos_thetas[i], {cos_phis[i], sin_phis[i]}))};
+    u[i] = rotated.getX();
+    v[i] = rotated.getY();
+    w[i] = rotated.getZ();
+  }
+}
+
+} // namespace DirectionKernels
@@ -0,0 +1,225 @@
+// Fast log2 and exp2 for log-log interpolation of the cross section tables
+// Both reduce their argument with integer operations on the IEEE 754 bit
+// pattern and sum a truncated series, with as many terms as the precision
+// needs:
+//
+//   HIGH  relative error below 1e-12
+//   FAST  relative error below 1e-7
+//
+// log2 takes positive normal numbers and exp2 arguments in [-1022, 1023],
+// neither checks. The functions are templates over double and Simd::Register
+// so that scalar and SIMD kernels share them. Interpolation uses them in
+// place of std::log and std::exp when the precision is not STANDARD, starting
+// from the NSE_LOG_EXP build setting and changeable at run time.
+
+#pragma once
+
+#include "Simd.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace FastMath
+{
+
+enum class Precision
+{
+  STANDARD, // std::log and std::exp
+  HIGH,
+  FAST
+};
+
+#if defined(NSE_LOG_EXP_FAST)
+inline constexpr Precision BuildPrecision{Precision::FAST};
+#elif defined(NSE_LOG_EXP_HIGH)
+inline constexpr Precision BuildPrecision{Precision::HIGH};
+#else
+inline constexpr Precision BuildPrecision{Precision::STANDARD};
+#endif
+
+// Precision used by Interpolation, read on every interpolation
+inline std::atomic<Precision> current_precision{BuildPrecision};
+
+inline Precision getPrecision()
+{
+  return current_precision.load(std::memory_order_relaxed);
+}
+inline void setPrecision(Precision precision_)
+{
+  current_precision.store(precision_, std::memory_order_relaxed);
+}
+
+// Bit pattern constants
+inline constexpr std::int64_t OneBits{0x3ff0000000000000};
+inline constexpr std::int64_t SqrtHalfBits{0x3fe6a09e667f3bcd};
+inline constexpr std::int64_t MantissaMask{0x000fffffffffffff};
+inline constexpr std::int64_t TwoTo52Bits{0x4330000000000000};
+inline constexpr std::int64_t RoundingShiftBits{0x4338000000000000};
+inline constexpr double TwoTo52{0x1p52};
+inline constexpr double RoundingShift{0x1.8p52}; // x + this rounds x
+
+// Series terms, each bound above holding with margin
+template <Precision P>
+inline constexpr size_t LogTerms{P == Precision::HIGH ? 8 : 5};
+template <Precision P>
+inline constexpr size_t ExpTerms{P == Precision::HIGH ? 11 : 8};
+
+// log2 m = t sum_k 2 / (ln 2 (2k + 1)) t^2k with t = (m - 1) / (m + 1)
+template <size_t N> constexpr std::array<double, N> logCoefficients()
+{
+  std::array<double, N> coefficients{};
+
+  for(size_t k{0}; k < N; k++)
+  {
+    coefficients[k] = 2.0 / (std::numbers::ln2 * (2.0 * k + 1.0));
+  }
+
+  return coefficients;
+}
+
+// 2^f = sum_k (f ln 2)^k / k!
+template <size_t N> constexpr std::array<double, N> expCoefficients()
+{
+  std::array<double, N> coefficients{};
+  double term{1.0};
+
+  for(size_t k{0}; k < N; k++)
+  {
+    coefficients[k] = term;
+    term *= std::numbers::ln2 / (k + 1.0);
+  }
+
+  return coefficients;
+}
+
+// Scalar versions of the Simd::Register bit operations
+inline double addBits(double a, std::int64_t bits)
+{
+  return std::bit_cast<double>(std::bit_cast<std::uint64_t>(a) +
+                               static_cast<std::uint64_t>(bits));
+}
+inline double andBits(double a, std::int64_t bits)
+{
+  return std::bit_cast<double>(std::bit_cast<std::uint64_t>(a) &
+                               static_cast<std::uint64_t>(bits));
+}
+inline double orBits(double a, std::int64_t bits)
+{
+  return std::bit_cast<double>(std::bit_cast<std::uint64_t>(a) |
+                               static_cast<std::uint64_t>(bits));
+}
+inline double shiftLeftBits(double a, int count)
+{
+  return std::bit_cast<double>(std::bit_cast<std::uint64_t>(a) << count);
+}
+inline double shiftRightBits(double a, int count)
+{
+  return std::bit_cast<double>(std::bit_cast<std::uint64_t>(a) >> count);
+}
+
+template <typename T> T constant(double value)
+{
+  if constexpr(std::is_same_v<T, double>)
+  {
+    return value;
+  }
+  else
+  {
+    return T::broadcast(value);
+  }
+}
+
+template <typename T, size_t N>
+T horner(T x, const std::array<double, N> &coefficients)
+{
+  T result{constant<T>(coefficients[N - 1])};
+
+  for(size_t k{N - 1}; k-- > 0;)
+  {
+    result = result * x + constant<T>(coefficients[k]);
+  }
+
+  return result;
+}
+
+template <Precision P, typename T> T log2(T x)
+{
+  static_assert(P != Precision::STANDARD, "Use std::log2");
+  constexpr auto coefficients{logCoefficients<LogTerms<P>>()};
+
+  // x = 2^e m with m in [sqrt(1/2), sqrt(2)), by moving the mantissa range
+  // so that the exponent field holds e
+  T bits{addBits(x, OneBits - SqrtHalfBits)};
+  T exponent{orBits(shiftRightBits(bits, 52), TwoTo52Bits) -
+             constant<T>(TwoTo52 + 1023.0)};
+  T mantissa{addBits(andBits(bits, MantissaMask), SqrtHalfBits)};
+
+  T t{(mantissa - constant<T>(1.0)) / (mantissa + constant<T>(1.0))};
+
+  return exponent + t * horner(t * t, coefficients);
+}
+
+template <Precision P, typename T> T exp2(T x)
+{
+  static_assert(P != Precision::STANDARD, "Use std::exp2");
+  constexpr auto coefficients{expCoefficients<ExpTerms<P>>()};
+
+  // x = n + f with n the nearest integer, and 2^n built from the bits of n
+  // left in the mantissa of the shifted sum
+  T shifted{x + constant<T>(RoundingShift)};
+  T n{shifted - constant<T>(RoundingShift)};
+  T scale{shiftLeftBits(addBits(shifted, 1023 - RoundingShiftBits), 52)};
+
+  return scale * horner(x - n, coefficients);
+}
+
+// Array versions, register by register. Arrays must have the same size.
+template <Precision P>
+void log2(std::span<const double> values, std::span<double> results)
+{
+  if(values.size() != results.size())
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  size_t i{0};
+
+  for(; i + Simd::Register::width <= values.size(); i += Simd::Register::width)
+  {
+    log2<P>(Simd::Register::load(&values[i])).store(&results[i]);
+  }
+
+  for(; i < values.size(); i++)
+  {
+    results[i] = log2<P>(values[i]);
+  }
+}
+
+template <Precision P>
+void exp2(std::span<const double> values, std::span<double> results)
+{
+  if(values.size() != results.size())
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  size_t i{0};
+
+  for(; i + Simd::Register::width <= values.size(); i += Simd::Register::width)
+  {
+    exp2<P>(Simd::Register::load(&values[i])).store(&results[i]);
+  }
+
+  for(; i < values.size(); i++)
+  {
+    results[i] = exp2<P>(values[i]);
+  }
+}
+
+} // namespace FastMath
@@ -0,0 +1,48 @@
+// Geometric progression (GP) buildup factor model for point-kernel shielding
+// For a material, the buildup at x mean free paths is
+//   B(x) = 1 + (b - 1) (K^x - 1) / (K - 1), or 1 + (b - 1) x when K = 1,
+//   K(x) = c x^a + d (tanh(x / Xk - 2) - tanh(-2)) / (1 - tanh(-2))
+// with b, c, a, Xk and d fitted per energy (e.g. ANSI/ANS-6.4.3 tables, valid
+// to 40 mean free paths). Coefficients are user supplied and interpolated
+// linearly in log energy between table rows.
+
+#pragma once
+
+#include <vector>
+
+struct GPCoefficients
+{
+  double energy; // MeV
+  double b;
+  double c;
+  double a;
+  double xk;
+  double d;
+};
+
+class GPBuildup
+{
+private:
+  std::vector<GPCoefficients> table; // Strictly increasing energies
+
+  void checkTable() const;
+
+public:
+  // Constructor
+  GPBuildup(const std::vector<GPCoefficients> &table_);
+
+  // Getters
+  const std::vector<GPCoefficients> &getTable() const { return table; }
+
+  // Coefficients at energy, throws outside the table range
+  GPCoefficients getCoefficients(double energy) const;
+
+  double getBuildup(double energy, double mean_free_paths) const
+  {
+    return evaluate(getCoefficients(energy), mean_free_paths);
+  }
+
+  // Buildup at mean_free_paths for a single set of coefficients
+  static double evaluate(const GPCoefficients &coefficients,
+                         double mean_free_paths);
+};
@@ -0,0 +1,30 @@
+// Abstract base geometry class that transport uses polymorphically to locate
+// particles and find distances to region boundaries
+
+#pragma once
+
+#include "Material.hpp"
+#include "Vector.hpp"
+
+class Geometry
+{
+public:
+  virtual ~Geometry() = default;
+
+  // Region index containing position, -1 if outside the geometry
+  virtual int findRegion(const Vector3D &position) const = 0;
+
+  // Distance along direction (unit vector) from position to the boundary of
+  // region. Infinite if the boundary is never reached.
+  virtual double distanceToBoundary(const Vector3D &position,
+                                    const Vector3D &direction,
+                                    int region) const = 0;
+
+  // Material filling a region, nullptr for a void region
+  virtual const Material *getMaterial(int region) const = 0;
+
+  virtual int getNumberRegions() const = 0;
+
+  // All distinct non-void materials used by the geometry
+  std::vector<const Material *> getMaterials() const;
+};
@@ -0,0 +1,148 @@
+// Compile time gated counters and phase timers for the hot paths
+// With NSE_INSTRUMENT defined (cmake -DNSE_INSTRUMENT=ON) the NSE_COUNT,
+// NSE_COUNT_COLLISION and NSE_TIME_SCOPE macros add to counters of the calling
+// thread, which are folded into shared totals when the thread ends. Without it
+// the macros expand to nothing, so normal builds carry no cost at all.
+// Phase timers read the time stamp counter and are inclusive, e.g. lookups
+// made during transport count towards both phases.
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Instrumentation
+{
+
+enum class Counter
+{
+  XS_LOOKUPS = 0,         // DataProcessor attenuation coef lookups
+  MATERIAL_LOOKUPS = 1,   // Material attenuation coef lookups
+  BIN_SEARCHES = 2,       // Energy grid binary searches
+  K_EDGE_HITS = 3,        // Searches landing exactly on a k-edge
+  RNG_DRAWS = 4,          // Uniform random numbers drawn
+  BOUNDARY_CROSSINGS = 5, // Region boundaries crossed by surface tracking
+  XS_CACHE_HITS = 6,      // Material totals found in CrossSectionCache
+  XS_CACHE_MISSES = 7     // Material totals interpolated and cached
+};
+
+enum class Phase
+{
+  LOAD = 0,   // Reading data files
+  LOOKUP = 1, // Attenuation coef lookups
+  TRANSPORT = 2
+};
+
+inline const size_t NoCounters{8};
+inline const size_t NoReactions{7}; // Indexed by ReactionType
+inline const size_t NoPhases{3};
+
+struct Totals
+{
+  std::array<long long, NoCounters> counters{};
+  std::array<long long, NoReactions> collisions{};
+  std::array<long long, NoPhases> phase_calls{};
+  std::array<std::uint64_t, NoPhases> phase_ticks{};
+
+  Totals &operator+=(const Totals &other);
+};
+
+// Time stamp counter where there is one, else steady clock nanoseconds
+inline std::uint64_t readTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Totals of the calling thread, folded into the finished totals on exit
+class ThreadTotals
+{
+private:
+  Totals totals;
+
+public:
+  ThreadTotals() = default;
+  ThreadTotals(const ThreadTotals &) = delete;
+  ThreadTotals &operator=(const ThreadTotals &) = delete;
+  ~ThreadTotals();
+
+  static ThreadTotals &get()
+  {
+    thread_local ThreadTotals thread_totals;
+    return thread_totals;
+  }
+
+  Totals &getTotals() { return totals; }
+};
+
+inline void count(Counter counter)
+{
+  ThreadTotals::get().getTotals().counters[static_cast<size_t>(counter)] += 1;
+}
+
+inline void countCollision(ParticleConstants::ReactionType reaction)
+{
+  ThreadTotals::get().getTotals().collisions[static_cast<size_t>(reaction)] +=
+      1;
+}
+
+// Adds the ticks between construction and destruction to a phase
+class ScopedTimer
+{
+private:
+  Phase phase;
+  std::uint64_t start;
+
+public:
+  explicit ScopedTimer(Phase phase_) : phase{phase_}, start{readTicks()} {}
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ~ScopedTimer()
+  {
+    Totals &totals{ThreadTotals::get().getTotals()};
+    totals.phase_calls[static_cast<size_t>(phase)] += 1;
+    totals.phase_ticks[static_cast<size_t>(phase)] += readTicks() - start;
+  }
+};
+
+// Totals of finished threads plus the calling thread. Call once the run has
+// finished, as running threads are not included.
+Totals getTotals();
+
+void reset();
+
+// Ticks per second of readTicks, measured on first use
+double getTicksPerSecond();
+
+// Dumps totals, phase times given in ticks and seconds
+void writeJson(std::ostream &os, const Totals &totals);
+void writeCsv(std::ostream &os, const Totals &totals);
+
+} // namespace Instrumentation
+
+#if defined(NSE_INSTRUMENT)
+#define NSE_COUNT(counter)                                                     \
+  Instrumentation::count(Instrumentation::Counter::counter)
+#define NSE_COUNT_COLLISION(reaction) Instrumentation::countCollision(reaction)
+#define NSE_TIME_SCOPE(phase)                                                  \
+  Instrumentation::ScopedTimer nse_scoped_timer                                \
+  {                                                                            \
+    Instrumentation::Phase::phase                                              \
+  }
+#else
+#define NSE_COUNT(counter) ((void)0)
+#define NSE_COUNT_COLLISION(reaction) ((void)0)
+#define NSE_TIME_SCOPE(phase) ((void)0)
+#endif
@@ -0,0 +1,189 @@
+// Shared interpolation helpers for tabulated cross section data
+// Tables are stored as rows of {energy, coef1, coef2, ...} with energies going
+// low to high and k-edges represented by duplicated energies. Tables can be
+// any type with size() and rows[row][column], e.g. nested vectors or the flat
+// replicas of NumaReplicas. Log-log interpolation goes through FastMath when
+// its precision is not STANDARD.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "FastMath.hpp"
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Interpolation
+{
+
+// Which side of a discontinuity (k-edge) to evaluate at
+enum class Side
+{
+  BELOW = 0,
+  ABOVE = 1
+};
+
+// interpolateBetween with FastMath. Logs are taken of ratios, which are close
+// to 1 between neighbouring grid points, so that their relative error carries
+// over to the proportion instead of being amplified by cancellation.
+template <FastMath::Precision P>
+double interpolateBetweenFast(double value, double a1, double a2, double b1,
+                              double b2)
+{
+  double proportion{FastMath::log2<P>(value / a1) /
+                    FastMath::log2<P>(a2 / a1)};
+
+  if(b1 <= 0.0 || b2 <= 0.0)
+  {
+    return b1 + (b2 - b1) * proportion;
+  }
+
+  return b1 * FastMath::exp2<P>(proportion * FastMath::log2<P>(b2 / b1));
+}
+
+// Log-log interpolatation between b1 and b2 based off how far value is
+// between a1 and a2
+inline double interpolateBetween(double value, double a1, double a2, double b1,
+                                 double b2)
+{
+  if(!(value > a1 && value < a2))
+  {
+    throw std::runtime_error("value must be between a1 and a2 (exclusively)");
+  }
+
+  switch(FastMath::getPrecision())
+  {
+  case FastMath::Precision::HIGH:
+    return interpolateBetweenFast<FastMath::Precision::HIGH>(value, a1, a2, b1,
+                                                             b2);
+  case FastMath::Precision::FAST:
+    return interpolateBetweenFast<FastMath::Precision::FAST>(value, a1, a2, b1,
+                                                             b2);
+  default:
+    break;
+  }
+
+  // Transform to log space
+  double log_value{std::log(value)};
+  double log_a1{std::log(a1)};
+  double log_a2{std::log(a2)};
+  double proportion{(log_value - log_a1) / (log_a2 - log_a1)};
+
+  // Zero coefs (e.g. below a threshold) have no logarithm so fall back to
+  // lin-log interpolation
+  if(b1 <= 0.0 || b2 <= 0.0)
+  {
+    return b1 + (b2 - b1) * proportion;
+  }
+
+  double log_b1{std::log(b1)};
+  double log_b2{std::log(b2)};
+  double log_result{log_b1 + (log_b2 - log_b1) * proportion};
+
+  // Transform back
+  return std::exp(log_result);
+}
+
+// Returns std::pair(upper_index, lower_index) of the rows bracketing value.
+// Indices are equal when value sits exactly on a grid point, in which case the
+// row above any k-edge is returned.
+template <typename Rows>
+std::pair<size_t, size_t> getAboveBelowIndices(double value, const Rows &rows)
+{
+  const size_t energy_column{FileConstants::EnergyColumn};
+
+  NSE_COUNT(BIN_SEARCHES);
+
+  // lower_bound gives first row with energy >= target
+  size_t upper_index{*std::ranges::lower_bound(
+      std::views::iota(size_t{0}, rows.size()), value, {},
+      [&rows, energy_column](size_t row) { return rows[row][energy_column]; })};
+
+  // If energy is too low
+  if(upper_index == 0)
+  {
+    // Check for lower bound
+    if(value == rows[0][energy_column])
+    {
+      return std::make_pair(0, 0);
+    }
+    throw std::runtime_error("Value below range");
+  }
+  if(upper_index == rows.size())
+  {
+    throw std::runtime_error("Value above range");
+  }
+
+  size_t max_index{rows.size() - 1};
+
+  // Edge case: if at a k-edge then value == values[upper_index] ==
+  // values[upper_index + 1]
+  // First check that we're not at the end
+  if(upper_index < max_index)
+  {
+    // Check for k-edge
+    if(value == rows[upper_index + 1][energy_column])
+    {
+      // At k-edge so return both of the larger indices
+      upper_index += 1;
+      NSE_COUNT(K_EDGE_HITS);
+
+      return std::make_pair(upper_index, upper_index);
+    }
+  }
+
+  // Also check if value exactly matches
+  if(value == rows[upper_index][energy_column])
+  {
+    return std::make_pair(upper_index, upper_index);
+  }
+
+  size_t lower_index{upper_index - 1};
+
+  return std::make_pair(upper_index, lower_index);
+}
+
+// Interpolated value of a column at energy between the rows given by
+// getAboveBelowIndices. At a k-edge side selects whether the value just below
+// or just above the edge is returned.
+template <typename Rows>
+double interpolateBetweenRows(double energy, const Rows &rows, size_t column,
+                              std::pair<size_t, size_t> above_below_indices,
+                              Side side = Side::ABOVE)
+{
+  size_t index1{above_below_indices.second};
+  size_t index2{above_below_indices.first};
+
+  // On a grid point
+  if(index1 == index2)
+  {
+    // Step back over the duplicated k-edge energy if the lower side is wanted
+    if(side == Side::BELOW && index1 > 0 &&
+       rows[index1 - 1][FileConstants::EnergyColumn] == energy)
+    {
+      index1 -= 1;
+    }
+    return rows[index1][column];
+  }
+
+  return interpolateBetween(energy, rows[index1][FileConstants::EnergyColumn],
+                            rows[index2][FileConstants::EnergyColumn],
+                            rows[index1][column], rows[index2][column]);
+}
+
+// Interpolated value of a column at energy. At a k-edge side selects whether
+// the value just below or just above the edge is returned.
+template <typename Rows>
+double interpolateColumn(double energy, const Rows &rows, size_t column,
+                         Side side = Side::ABOVE)
+{
+  return interpolateBetweenRows(energy, rows, column,
+                                getAboveBelowIndices(energy, rows), side);
+}
+
+} // namespace Interpolation
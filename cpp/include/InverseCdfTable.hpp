@@ -0,0 +1,62 @@
+// Precomputed inverse cumulative distribution tables for sampling a variable
+// whose distribution depends on energy
+// Rows are on a log spaced energy grid and hold equiprobable quantiles of the
+// variable, so sampling is an index calculation plus bilinear interpolation
+// with no rejection loop
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Cumulative probabilities of the quantiles of a row
+enum class QuantileSpacing
+{
+  UNIFORM,     // Equiprobable
+  REFINED_HIGH // At 1 - (1 - j / (n - 1))^2, finer towards the high end
+};
+
+class InverseCdfTable
+{
+private:
+  double log_min_energy;
+  double inverse_log_step; // 1 / spacing of the log energy grid
+  int no_energies;
+  int no_quantiles;
+  QuantileSpacing spacing;
+  std::vector<float> quantiles; // Row major, no_energies x no_quantiles
+
+  // Quantiles of pdf over [low, high] at one energy
+  void buildRow(int row, double energy,
+                const std::function<double(double, double)> &pdf, double low,
+                double high);
+
+public:
+  // Empty table, must be assigned before sampling
+  InverseCdfTable()
+      : log_min_energy{0}, inverse_log_step{0}, no_energies{0},
+        no_quantiles{0}, spacing{QuantileSpacing::UNIFORM}
+  {}
+
+  // Builds the table from pdf(energy, x) (need not be normalised) supported
+  // on support(energy) = {low, high}. The integration grid is refined
+  // geometrically towards both ends, where peaks and edges are expected.
+  // REFINED_HIGH spacing suits variables whose density changes quickly
+  // within the last few equiprobable quantiles.
+  InverseCdfTable(
+      double min_energy, double max_energy, int no_energies_,
+      int no_quantiles_, const std::function<double(double, double)> &pdf,
+      const std::function<std::pair<double, double>(double)> &support,
+      QuantileSpacing spacing_ = QuantileSpacing::UNIFORM);
+
+  // Getters
+  int getNoEnergies() const { return no_energies; }
+  int getNoQuantiles() const { return no_quantiles; }
+  size_t getMemoryBytes() const { return quantiles.size() * sizeof(float); }
+
+  // Samples x at energy from a uniform random number in [0, 1]. Energies
+  // outside the table are clamped to its ends.
+  double sample(double energy, double uniform) const;
+};
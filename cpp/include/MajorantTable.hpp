@@ -0,0 +1,35 @@
+// Majorant cross section table used for Woodcock delta tracking
+// Stores, for each interval of the union energy grid of a set of materials, an
+// upper bound on the total linear attenuation coef of every material
+
+#pragma once
+
+#include "Constants.hpp"
+#include "Material.hpp"
+#include "NumaReplicas.hpp"
+
+#include <memory>
+#include <vector>
+
+class MajorantTable
+{
+private:
+  std::vector<double> energies;  // Union energy grid, strictly increasing
+  std::vector<double> majorants; // 1/cm, one per interval of energies
+
+  // Per NUMA node copies if NumaReplicas was enabled when the table was built
+  std::vector<std::shared_ptr<const double>> replica_energies;
+  std::vector<std::shared_ptr<const double>> replica_majorants;
+
+public:
+  // Constructor building the max-over-materials table
+  MajorantTable(const std::vector<const Material *> &materials,
+                ParticleConstants::ParticleType particle_type);
+
+  // Getters
+  const std::vector<double> &getEnergies() const { return energies; }
+  const std::vector<double> &getMajorants() const { return majorants; }
+
+  // Majorant (1/cm) valid everywhere in the interval containing energy
+  double getMajorant(double energy) const;
+};
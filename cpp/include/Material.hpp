@@ -2,5 +2,87 @@
 
 #pragma once
 
+#include "Constants.hpp"
+#include "NumaReplicas.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Macroscopic cross section table for a single particle type. Rows have the
+// same layout as DataProcessor element data but hold linear attenuation coefs
+// (1/cm) on the union of the constituent element energy grids.
+using MaterialXsTable = std::vector<std::vector<double>>;
+
+class XsLibrary;
+
 class Material
-{}
\ No newline at end of file
+{
+private:
+  std::string name;
+  std::uint64_t id; // Unique to these tables, copies of them share it
+  double density;   // g/cm^3
+  std::vector<std::pair<ElementConversion::Element, double>>
+      composition; // Element and mass fraction, fractions sum to 1
+  std::unordered_map<ParticleConstants::ParticleType, MaterialXsTable> tables;
+
+  // Per NUMA node copies of the tables if NumaReplicas was enabled when they
+  // were built
+  std::unordered_map<ParticleConstants::ParticleType, std::vector<FlatTable>>
+      replica_tables;
+
+  void checkComposition() const;
+
+  // Replica local to the calling thread, nullptr if there are none
+  const FlatTable *
+  getLocalReplica(ParticleConstants::ParticleType particle_type) const;
+
+  // Builds the macroscopic table for a particle type from element data in
+  // library
+  void buildTable(ParticleConstants::ParticleType particle_type,
+                  const XsLibrary &library);
+
+public:
+  // Constructor taking mass fractions, which are normalised to sum to 1
+  Material(const std::string &name_, double density_,
+           const std::vector<std::pair<ElementConversion::Element, double>>
+               &composition_);
+
+  // Constructor from a chemical formula given as number of atoms per element
+  static Material
+  fromFormula(const std::string &name_, double density_,
+              const std::vector<std::pair<ElementConversion::Element, double>>
+                  &atoms_per_molecule);
+
+  // Same material with its tables built from library, which must hold the
+  // data of every element in it
+  Material rebuiltFrom(const XsLibrary &library) const;
+
+  // Getters
+  const std::string &getName() const { return name; }
+  std::uint64_t getId() const { return id; }
+  double getDensity() const { return density; }
+  const std::vector<std::pair<ElementConversion::Element, double>> &
+  getComposition() const
+  {
+    return composition;
+  }
+  const MaterialXsTable &
+  getTable(ParticleConstants::ParticleType particle_type) const
+  {
+    return tables.at(particle_type); // Throws if not found
+  }
+
+  // Linear attenuation coefs in 1/cm
+  double
+  getLinearAttenCoef(double energy, ParticleConstants::ReactionType reaction,
+                     ParticleConstants::ParticleType particle_type) const;
+
+  // Sum of the linear attenuation coefs of all allowed reactions, i.e. the
+  // total used for transport
+  double
+  getTotalLinearAttenCoef(double energy,
+                          ParticleConstants::ParticleType particle_type) const;
+};
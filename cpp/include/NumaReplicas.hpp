@@ -0,0 +1,129 @@
+// Per NUMA node copies of the read-only lookup tables
+// Opt-in: once enable() has been called, element data loaded by DataProcessor
+// and tables built by Material and MajorantTable afterwards are also copied
+// once per node into memory first touched by a thread running on that node,
+// backed by huge pages where the system allows. Lookups then read the replica
+// of the node the calling thread runs on, which RunDriver workers pin
+// themselves to. On a single node machine there is one replica, so only the
+// huge pages remain, and where neither is available the copies behave like
+// the original tables.
+// Copies are carved from huge page sized chunks and hold a reference to their
+// chunk, which is unmapped once every table copied into it has been
+// destroyed, so tables replaced by a reload or built for a temporary material
+// give their memory back.
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Row major table in replica memory, indexed like the nested vector tables
+struct FlatTable
+{
+  std::shared_ptr<const double> values; // Keeps its chunk mapped
+  size_t no_rows{0};
+  size_t no_columns{0};
+
+  size_t size() const { return no_rows; }
+  bool empty() const { return no_rows == 0; }
+  const double *operator[](size_t row) const
+  {
+    return values.get() + row * no_columns;
+  }
+};
+
+class NumaReplicas
+{
+private:
+  // Unmapped when the last table in it goes
+  struct Chunk
+  {
+    std::byte *base;
+    size_t size;
+    size_t used;
+
+    Chunk(std::byte *base_, size_t size_);
+    Chunk(const Chunk &) = delete;
+    Chunk &operator=(const Chunk &) = delete;
+    ~Chunk();
+  };
+
+  struct Node
+  {
+    int id;                       // Kernel node number
+    std::vector<int> cpus;        // Empty when unknown
+    std::shared_ptr<Chunk> chunk; // Being filled
+  };
+
+  bool enabled;
+  bool huge_pages;
+  std::vector<Node> nodes;
+  std::vector<int> cpu_nodes; // Replica index of each CPU
+  size_t replicated_bytes; // Every copy made, including freed ones
+  size_t huge_page_bytes;
+  std::mutex mutex; // Replication happens during setup, possibly in parallel
+
+  // Replica index of the calling thread, -1 until known
+  static thread_local int thread_node;
+
+  // Constructor reading the topology
+  NumaReplicas();
+
+  // Uninitialised replica memory of bytes on every node, in node order, each
+  // holding a reference to its chunk
+  std::vector<std::shared_ptr<std::byte>> allocate(size_t bytes);
+  std::byte *mapChunk(size_t size);
+
+  // Runs fill(node) for every node on a thread pinned to the node so that
+  // the pages it touches first are placed there
+  template <typename Fill> void fillOnNodes(Fill fill);
+
+  int findThreadNode() const;
+
+public:
+  NumaReplicas(const NumaReplicas &) = delete;
+  NumaReplicas &operator=(const NumaReplicas &) = delete;
+
+  // Singleton access
+  static NumaReplicas &getInstance();
+
+  // Turns the mode on, tables built earlier stay unreplicated
+  void enable(bool huge_pages_ = true);
+
+  // Getters
+  bool isEnabled() const { return enabled; }
+  int getNoNodes() const { return static_cast<int>(nodes.size()); }
+  size_t getReplicatedBytes() const { return replicated_bytes; }
+  size_t getHugePageBytes() const { return huge_page_bytes; }
+
+  // Replica memory mapped now, which falls as tables are destroyed
+  static size_t getMappedBytes();
+
+  // Copies of a table or array, one per node in node order, mapped for as
+  // long as they are held
+  std::vector<FlatTable>
+  replicate(const std::vector<std::vector<double>> &rows);
+  std::vector<std::shared_ptr<const double>>
+  replicate(const std::vector<double> &values);
+
+  // Pins the calling thread to the CPUs of node thread % nodes, no-op with a
+  // single node
+  void bindThread(int thread);
+
+  // Replica index of the calling thread, from the CPU it first ran on unless
+  // bound
+  int getThreadNode() const
+  {
+    if(thread_node < 0)
+    {
+      thread_node = findThreadNode();
+    }
+
+    return thread_node;
+  }
+};
@@ -6,31 +6,35 @@
 #include "Constants.hpp"
 #include "Vector.hpp"
 
+#include <cstdint>
 #include <string>
-#include <vector>
 
 class Particle
 {
 private:
-  double mass;         // MeV
-  double energy;       // MeV
-  double birth_energy; // Energy when first created
-  int id;              // Unique particle identifier
+  double mass;                  // MeV
+  double energy;                // MeV
+  double birth_energy;          // Energy when first created
+  double weight;                // Statistical weight, 1 for analog transport
+  std::uint64_t id;             // Set by the source or derived from the parent
+  std::uint64_t parent_id;      // Equal to id for source particles
+  std::uint32_t no_secondaries; // Secondaries created so far
   Vector3D position;
   Vector3D direction;
   ParticleConstants::ParticleType type;
-  std::vector<Vector3D> interaction_points;
 
 public:
   // Constructor
   Particle(ParticleConstants::ParticleType type_, double energy_,
-           Vector3D &position_, Vector3D &direction_);
+           const Vector3D &position_, const Vector3D &direction_);
 
   // Getters
   double getMass() const { return mass; }
   double getEnergy() const { return energy; }
   double getBirthEnergy() const { return birth_energy; }
-  int getID() const { return id; }
+  double getWeight() const { return weight; }
+  std::uint64_t getID() const { return id; }
+  std::uint64_t getParentID() const { return parent_id; }
   Vector3D getPosition() const { return position; }
   Vector3D getDirection() const { return direction; }
   ParticleConstants::ParticleType getType() const { return type; }
@@ -42,10 +46,27 @@ public:
 
   // Setters
   void setEnergy(double energy_);
-  void setPosition(Vector3D &position_);
-  void setDirection(Vector3D &direction_);
+  void setPosition(const Vector3D &position_);
+  void setDirection(const Vector3D &direction_);
+  // Unchecked, for unit vectors from DirectionKernels
+  void setUnitDirection(const Vector3D &direction_) { direction = direction_; }
+  void setWeight(double weight_);
+
+  // Makes this a source particle with id
+  void setID(std::uint64_t id_);
+
+  // Secondary emitted by this particle with its weight. The id depends only
+  // on this id and how many secondaries came before, so it is reproducible
+  // whatever the thread or processing order.
+  Particle createSecondary(ParticleConstants::ParticleType type_,
+                           double energy_, const Vector3D &direction_);
+
+  // Copy of this particle for splitting, with its own id drawn like that of
+  // a secondary and this particle as its parent
+  Particle split();
 
   // Validation
   void checkEnergy(double energy_) const;
-  void checkDirection(Vector3D &direction_) const;
+  void checkDirection(const Vector3D &direction_) const;
+  void checkWeight(double weight_) const;
 };
\ No newline at end of file
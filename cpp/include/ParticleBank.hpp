@@ -0,0 +1,56 @@
+// Fixed capacity stack of particles waiting to be transported, such as split
+// copies. Storage is reserved once so pushing and popping never allocate.
+
+#pragma once
+
+#include "Particle.hpp"
+
+#include <vector>
+
+class ParticleBank
+{
+private:
+  std::vector<Particle> particles;
+  size_t capacity;
+
+public:
+  // Constructor
+  ParticleBank(size_t capacity_) : capacity{capacity_}
+  {
+    particles.reserve(capacity);
+  }
+
+  // Copying a vector does not copy its reserved storage, so banks are only
+  // moved
+  ParticleBank(const ParticleBank &) = delete;
+  ParticleBank &operator=(const ParticleBank &) = delete;
+  ParticleBank(ParticleBank &&) = default;
+  ParticleBank &operator=(ParticleBank &&) = default;
+
+  // Getters
+  size_t getSize() const { return particles.size(); }
+  size_t getCapacity() const { return capacity; }
+  size_t getReserved() const { return particles.capacity(); }
+  size_t getFreeSpace() const { return capacity - particles.size(); }
+  bool isEmpty() const { return particles.empty(); }
+
+  // Returns false without adding the particle if the bank is full
+  bool push(const Particle &particle)
+  {
+    if(particles.size() == capacity)
+    {
+      return false;
+    }
+
+    particles.push_back(particle);
+
+    return true;
+  }
+
+  // Removes the most recently pushed particle into particle
+  void pop(Particle &particle)
+  {
+    particle = particles.back();
+    particles.pop_back();
+  }
+};
@@ -0,0 +1,136 @@
+// Source of particles with sampled energy, position and direction
+// Energies come from a spectrum of discrete lines and histogram bins merged
+// into one Walker alias table, so one component is picked with a single
+// compare whatever the number of lines. Positions are a point, a disc surface
+// or a box volume and directions isotropic or beamed into a cone. Every draw
+// takes a bounded expected number of random numbers, so sampling is O(1) per
+// particle.
+
+#pragma once
+
+#include "AliasTable.hpp"
+#include "BoundingBox.hpp"
+#include "Constants.hpp"
+#include "Particle.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "Vector.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Energy distribution of source particles, lines and bins in any proportion
+class SourceSpectrum
+{
+private:
+  AliasTable table;          // Over lines then bins, by intensity
+  std::vector<double> low;   // Energy of each line or lower edge of each bin
+  std::vector<double> width; // Zero for lines
+  double total_intensity;
+  double mean_energy;
+
+public:
+  // Constructor from lines (MeV, intensity) and a histogram of
+  // no_bins + 1 edges (MeV) and no_bins intensities, either of which may be
+  // empty. Intensities are relative, e.g. per decay.
+  SourceSpectrum(const std::vector<double> &line_energies,
+                 const std::vector<double> &line_intensities,
+                 const std::vector<double> &bin_edges = {},
+                 const std::vector<double> &bin_intensities = {});
+
+  // Lines only, a histogram only or the lines of a nuclide in
+  // SourceConstants::NuclideLines
+  static SourceSpectrum fromLines(const std::vector<double> &energies,
+                                  const std::vector<double> &intensities);
+  static SourceSpectrum fromHistogram(const std::vector<double> &edges,
+                                      const std::vector<double> &intensities);
+  static SourceSpectrum fromNuclide(const std::string &nuclide);
+
+  // Getters
+  size_t getNoComponents() const { return low.size(); }
+  double getTotalIntensity() const { return total_intensity; }
+  double getMeanEnergy() const { return mean_energy; }
+
+  // Probability of drawing line or bin component, in constructor order
+  double getProbability(size_t component) const
+  {
+    return table.getProbability(component);
+  }
+
+  // Samples an energy in MeV
+  double sample(RandomNumberGenerator &rng) const
+  {
+    size_t component{table.sample(rng.getUniform())};
+
+    return width[component] == 0.0
+               ? low[component]
+               : low[component] + width[component] * rng.getUniform();
+  }
+};
+
+enum class SourceShape
+{
+  POINT,
+  DISC, // Uniform over the area of a disc
+  BOX   // Uniform over the volume of a box
+};
+
+enum class SourceDirection
+{
+  ISOTROPIC,
+  BEAM // Uniform over a cone about the axis, a pencil beam for angle 0
+};
+
+class ParticleSource
+{
+private:
+  ParticleConstants::ParticleType particle_type;
+  SourceSpectrum spectrum;
+
+  SourceShape shape;
+  Vector3D centre;   // Point, disc centre or box minimum
+  Vector3D extent_u; // Disc radius along its first in-plane axis, or box size
+  Vector3D extent_v; // Disc radius along its second in-plane axis
+
+  SourceDirection direction_mode;
+  Vector3D axis;
+  double cos_half_angle;
+
+  Vector3D samplePosition(RandomNumberGenerator &rng) const;
+  Vector3D sampleDirection(RandomNumberGenerator &rng) const;
+
+public:
+  // Constructor, an isotropic point source at the origin
+  ParticleSource(ParticleConstants::ParticleType particle_type_,
+                 const SourceSpectrum &spectrum_);
+
+  // Getters
+  ParticleConstants::ParticleType getParticleType() const
+  {
+    return particle_type;
+  }
+  const SourceSpectrum &getSpectrum() const { return spectrum; }
+  SourceShape getShape() const { return shape; }
+  SourceDirection getDirectionMode() const { return direction_mode; }
+
+  // Position setters
+  void setPoint(const Vector3D &position_);
+  void setDisc(const Vector3D &centre_, const Vector3D &normal_,
+               double radius_);
+  void setBox(const BoundingBox &bounds_);
+
+  // Direction setters, half_angle_ in radians
+  void setIsotropic();
+  void setBeam(const Vector3D &axis_, double half_angle_ = 0.0);
+
+  // Samples one particle
+  Particle sample(RandomNumberGenerator &rng) const;
+
+  // Appends no_particles sampled particles, reserving once. Same particles
+  // as no_particles calls of sample with rng.
+  void sample(RandomNumberGenerator &rng, size_t no_particles,
+              std::vector<Particle> &particles) const;
+
+  // Source for RunDriver sampling from this object, which must outlive it
+  std::function<Particle(RandomNumberGenerator &)> getSource() const;
+};
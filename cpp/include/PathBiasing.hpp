@@ -0,0 +1,57 @@
+// Per region path length biasing for deep penetration problems
+// The exponential transform samples flight distances with the stretched
+// attenuation coef mu (1 - p cos), cos being taken between the flight
+// direction and a preferred direction, and corrects the particle weight by
+// the ratio of true to biased distance pdfs. Forced collisions split a
+// particle entering a region into an uncollided part that crosses it and a
+// collided part that is made to collide inside it.
+
+#pragma once
+
+#include "Vector.hpp"
+
+#include <vector>
+
+struct RegionBiasing
+{
+  double stretch{0.0}; // Exponential transform parameter p, 0 <= p < 1
+  Vector3D preferred_direction{Vector3D::UNITZ};
+  bool forced_collision{false};
+};
+
+class PathBiasing
+{
+private:
+  std::vector<RegionBiasing> regions;
+
+  void checkRegions() const;
+
+public:
+  // Constructor with the biasing of every geometry region, preferred
+  // directions are normalised
+  PathBiasing(const std::vector<RegionBiasing> &regions_);
+
+  // Getters
+  const RegionBiasing &getRegion(int region) const
+  {
+    return regions.at(region);
+  }
+  int getNumberRegions() const { return static_cast<int>(regions.size()); }
+  bool isStretched(int region) const
+  {
+    return regions.at(region).stretch > 0.0;
+  }
+  bool isForced(int region) const
+  {
+    return regions.at(region).forced_collision;
+  }
+
+  // Attenuation coef flights along direction are sampled with in region
+  double getStretchedCoef(double atten_coef, const Vector3D &direction,
+                          int region) const;
+
+  // Weight factor for a biased flight of distance through a region, ending in
+  // a collision or not
+  static double getWeightFactor(double atten_coef, double stretched_coef,
+                                double distance, bool collided);
+};
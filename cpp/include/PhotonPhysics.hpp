@@ -0,0 +1,100 @@
+// Photon collision physics
+// Selects the reaction at a collision from the alias tables of the material
+// and applies it to the particle with the tabulated angular samplers.
+// Absorptions emit secondary photons into a bank: K fluorescence after
+// photoelectric absorption and a back to back annihilation pair after pair
+// production, whose electron and positron deposit their kinetic energy
+// locally. Other atomic relaxation (L lines, Auger electrons) is local.
+
+#pragma once
+
+#include "ComptonSampler.hpp"
+#include "Material.hpp"
+#include "Particle.hpp"
+#include "ParticleBank.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "ReactionSampler.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+struct CollisionResult
+{
+  ParticleConstants::ReactionType reaction;
+  double deposited_energy; // MeV given to the medium locally, times weight
+  bool absorbed;           // Particle history ends
+};
+
+// K shell fluorescence of an element, derived from its data file
+struct KShell
+{
+  double edge;                 // MeV, 0 if below the data range
+  double line_energy;          // K alpha, MeV
+  double emission_probability; // Per photoelectric absorption above the edge
+};
+
+class PhotonPhysics
+{
+private:
+  ComptonSampler compton_sampler;
+  std::unordered_map<const Material *, ReactionSampler> reaction_samplers;
+  std::unordered_map<ElementConversion::Element, KShell> k_shells;
+  std::unordered_map<const Material *, double>
+      max_emission_probabilities; // Over the elements of each material
+
+  // Edge from the highest duplicated energy, the share of absorptions in the
+  // K shell from the jump ratio there, and the yield from the Burhop fit
+  static KShell buildKShell(ElementConversion::Element element);
+
+  // Element of a mixture that undergoes reaction, chosen with probability
+  // proportional to its share of the attenuation coef
+  ElementConversion::Element
+  selectElement(const Material &material, double energy,
+                ParticleConstants::ReactionType reaction,
+                double uniform) const;
+
+  // Applies a scattering reaction, returning the energy given to the medium
+  // per unit weight
+  double scatter(Particle &particle, const Material &material,
+                 ParticleConstants::ReactionType reaction,
+                 RandomNumberGenerator &rng) const;
+
+  // Applies an absorption reaction, banking secondaries of the given weight
+  // into secondaries (if any) and returning the energy given to the medium
+  // per unit weight. Secondaries that do not fit are deposited too.
+  double absorb(Particle &particle, double weight, const Material &material,
+                ParticleConstants::ReactionType reaction,
+                RandomNumberGenerator &rng, ParticleBank *secondaries) const;
+
+  // Banks a photon emitted at the particle position, false if there is no
+  // room
+  static bool emit(Particle &particle, double weight, double energy,
+                   const Vector3D &direction, ParticleBank *secondaries);
+
+public:
+  // Constructor, builds reaction tables for every material that can be
+  // collided with
+  PhotonPhysics(const std::vector<const Material *> &materials);
+
+  // Getters
+  const ComptonSampler &getComptonSampler() const { return compton_sampler; }
+  const ReactionSampler &getReactionSampler(const Material &material) const
+  {
+    return reaction_samplers.at(&material); // Throws if not found
+  }
+
+  const KShell &getKShell(ElementConversion::Element element) const
+  {
+    return k_shells.at(element); // Throws if not found
+  }
+
+  // Samples and applies a collision in material, updating the energy and
+  // direction of the particle. With implicit capture the particle always
+  // scatters and its weight is reduced by the absorption probability
+  // instead, the absorbed share of the weight depositing its energy and
+  // carrying the secondaries. Without a bank secondaries are deposited.
+  CollisionResult collide(Particle &particle, const Material &material,
+                          RandomNumberGenerator &rng,
+                          bool implicit_capture = false,
+                          ParticleBank *secondaries = nullptr) const;
+};
@@ -0,0 +1,74 @@
+// Deterministic point-kernel shielding engine
+// Computes the flux at detector points from an isotropic point source behind a
+// layered slab shield as exp(-mfp) B / (4 pi r^2), where mfp is the number of
+// mean free paths along the straight source to detector ray, using the total
+// attenuation including coherent scattering, and B is the GP buildup factor.
+// Multilayer shields use the buildup of the last non-void layer the ray
+// crosses with the total mean free paths. Layers whose material has no GP
+// data give the uncollided flux only (B = 1).
+
+#pragma once
+
+#include "GPBuildup.hpp"
+#include "Material.hpp"
+#include "SlabGeometry.hpp"
+#include "Vector.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+// Detector positions in structure of arrays layout
+struct DetectorPoints
+{
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+
+  void add(const Vector3D &position)
+  {
+    x.push_back(position.getX());
+    y.push_back(position.getY());
+    z.push_back(position.getZ());
+  }
+  size_t size() const { return x.size(); }
+};
+
+class PointKernel
+{
+private:
+  const SlabGeometry &shield;
+  std::unordered_map<const Material *, GPBuildup> buildups;
+
+  // Mean free paths from source to detector for per layer coefs
+  double getMeanFreePaths(const Vector3D &source, const Vector3D &detector,
+                          const std::vector<double> &coefs) const;
+
+  // Last non-void layer crossed going from source_z to detector_z, -1 if none
+  int getLastLayer(double source_z, double detector_z) const;
+
+public:
+  // Constructor, shield must outlive the engine
+  PointKernel(const SlabGeometry &shield_);
+
+  // Sets the GP buildup used behind layers of material
+  void setBuildup(const Material &material, const GPBuildup &buildup);
+
+  // Total attenuation coef (1/cm) of every layer at energy, 0 for voids
+  std::vector<double> getLayerCoefs(double energy) const;
+
+  double getMeanFreePaths(const Vector3D &source, const Vector3D &detector,
+                          double energy) const
+  {
+    return getMeanFreePaths(source, detector, getLayerCoefs(energy));
+  }
+
+  // Flux per source photon (1/cm^2) at a single detector
+  double getFlux(const Vector3D &source, const Vector3D &detector,
+                 double energy, bool with_buildup = true) const;
+
+  // Flux per source photon at every detector. Ray mean free paths are
+  // computed several detectors at a time in SIMD registers.
+  void evaluate(const Vector3D &source, double energy,
+                const DetectorPoints &detectors, std::vector<double> &fluxes,
+                bool with_buildup = true) const;
+};
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "DirectionKernels.hpp"
+#include "Instrumentation.hpp"
 #include "Material.hpp"
 #include "Particle.hpp"
 
@@ -17,7 +19,7 @@ private:
 
 public:
   // Constructor with explicit seed
-  RandomNumberGenerator(std::uint64_t seed_) : seed{seed_}, rng(seed_) {}
+  RandomNumberGenerator(std::uint64_t seed_) : rng(seed_), seed{seed_} {}
   // Default constructor with random seed - uses explicit seed constructor with
   // random seed
   RandomNumberGenerator() : RandomNumberGenerator(std::random_device{}()) {}
@@ -26,6 +28,36 @@ public:
   std::uint64_t getSeed() const { return seed; }
   std::mt19937_64 getRNG() const { return rng; }
 
+  // Uniform random number in (0, 1]
+  double getUniform()
+  {
+    NSE_COUNT(RNG_DRAWS);
+
+    // Top 53 bits of one draw in [0, 1), flipped to avoid log(0) in sampling.
+    // generate_canonical gives the same distribution but takes long double
+    // logarithms on every call to work out how many draws it needs, which
+    // was half the cost of a draw.
+    return 1.0 - static_cast<double>(rng() >> 11) * 0x1.0p-53;
+  }
+
+  // Unit vector uniformly distributed over the sphere
+  Vector3D getIsotropicDirection();
+
+  // Uniform azimuthal angle as its cosine and sine
+  DirectionKernels::Azimuth getAzimuth();
+
+  // SplitMix64 finaliser, spreads nearby seeds or ids over the whole state
+  // space
+  static std::uint64_t mixSeed(std::uint64_t value)
+  {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+
+    return value ^ (value >> 31);
+  }
+
   // Montecarlo application
-  double getRandomStep(const Particle &particle, Material material);
+  double getRandomStep(const Particle &particle, const Material &material);
+  double getRandomStep(double atten_coef); // Atten coef in 1/cm
 };
\ No newline at end of file
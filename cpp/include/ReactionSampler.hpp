@@ -0,0 +1,98 @@
+// Reaction channel selection at collisions using per energy interval alias
+// tables
+// Companion to the cross section tables of DataProcessor and Material. Every
+// interval of a table's energy grid stores the branching ratios of the allowed
+// reactions at both of its ends as alias tables. A sample picks one end with
+// probability given by the log energy position in the interval, then a
+// channel from that end's table, all from a single uniform random number. The
+// result follows branching ratios interpolated linearly in log energy at O(1)
+// cost, without evaluating the partials.
+
+#pragma once
+
+#include "AliasTable.hpp"
+#include "Constants.hpp"
+
+#include <span>
+#include <vector>
+
+// Deviation of the sampled branching ratios from the exactly interpolated
+// ones, checked at interior points of every interval
+struct ReactionSamplerAccuracy
+{
+  std::vector<ParticleConstants::ReactionType> channels;
+  std::vector<double> max_abs_error;    // Per channel
+  std::vector<double> max_error_energy; // MeV, where max_abs_error occurs
+  double mean_abs_error;                // Over all channels and points
+  int no_points;
+};
+
+class ReactionSampler
+{
+private:
+  std::vector<std::vector<double>> rows; // Copy of the cross section table
+  std::vector<double> log_energies;
+  std::vector<ParticleConstants::ReactionType> channels; // In enum order
+  std::vector<size_t> channel_columns;
+  std::vector<AliasEntry> entries; // 2 * channels.size() per interval
+
+  std::span<const AliasEntry> getEntries(size_t interval, int end) const
+  {
+    size_t no_channels{channels.size()};
+
+    return {entries.data() + (2 * interval + end) * no_channels, no_channels};
+  }
+
+  // Exact interpolated branching ratios at energy
+  std::vector<double> branchingRatios(double energy) const;
+
+public:
+  // Constructor from element data (mass atten coefs) or a MaterialXsTable
+  // (linear atten coefs), both have the data file row layout
+  ReactionSampler(const std::vector<std::vector<double>> &rows_,
+                  ParticleConstants::ParticleType particle_type);
+
+  // Getters
+  const std::vector<ParticleConstants::ReactionType> &getChannels() const
+  {
+    return channels;
+  }
+  size_t getNoIntervals() const { return rows.size() - 1; }
+
+  // Index of the grid interval containing energy, as used by sample
+  size_t getInterval(double energy) const;
+
+  // Log energy position of energy within an interval, in [0, 1]
+  double getFraction(size_t interval, double energy) const;
+
+  // Selects a reaction from a uniform random number in (0, 1]
+  ParticleConstants::ReactionType sample(double energy, double uniform) const
+  {
+    size_t interval{getInterval(energy)};
+
+    return sampleInterval(interval, getFraction(interval, energy), uniform);
+  }
+
+  // For callers that already know the interval and fraction, e.g. from an
+  // attenuation coef lookup
+  ParticleConstants::ReactionType
+  sampleInterval(size_t interval, double fraction, double uniform) const
+  {
+    // Upper end with probability fraction, the uniform is rescaled for reuse
+    if(uniform <= 1.0 - fraction)
+    {
+      return channels[AliasTable::sample(getEntries(interval, 0),
+                                         uniform / (1.0 - fraction))];
+    }
+
+    return channels[AliasTable::sample(getEntries(interval, 1),
+                                       (uniform - (1.0 - fraction)) /
+                                           fraction)];
+  }
+
+  // Probability of a channel at a log energy fraction through an interval
+  double getProbability(size_t interval, double fraction,
+                        size_t channel) const;
+
+  ReactionSamplerAccuracy getAccuracy() const;
+};
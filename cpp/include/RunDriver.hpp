@@ -0,0 +1,125 @@
+// Run driver processing source histories in batches across threads
+// Each thread transports a fixed share of every batch and scores into its own
+// tally buffers, so threads only synchronise when a batch ends. The buffers
+// are then reduced and folded into per tally statistics, and the run stops as
+// soon as every convergence target is met or the history limit is reached.
+// Runs can checkpoint between batches and be restarted from a checkpoint, see
+// Checkpoint.hpp.
+
+#pragma once
+
+#include "Checkpoint.hpp"
+#include "Particle.hpp"
+#include "ParticleBank.hpp"
+#include "PathBiasing.hpp"
+#include "PhotonPhysics.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "TallySet.hpp"
+#include "TallyStatistics.hpp"
+#include "TrackRecorder.hpp"
+#include "Transport.hpp"
+#include "WeightWindows.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Creates a source particle. Called concurrently from all threads, each with
+// its own generator.
+using Source = std::function<Particle(RandomNumberGenerator &)>;
+
+struct RunSettings
+{
+  int no_threads{1};
+  long long histories_per_batch{10000};
+  long long max_histories{10000000};
+  std::uint64_t seed{12345};
+
+  // Variance reduction, analog transport by default
+  bool implicit_capture{false};
+  const WeightWindows *weight_windows{nullptr}; // Not owned
+  const PathBiasing *path_biasing{nullptr};     // Not owned, surface tracking
+
+  // Interaction point output, none by default
+  TrackRecorder *track_recorder{nullptr}; // Not owned, one ring per thread
+
+  // Checkpoints, none by default. Written in the background every
+  // checkpoint_interval seconds of run time and once more when run returns.
+  std::string checkpoint_path;
+  double checkpoint_interval{CheckpointConstants::DefaultIntervalSeconds};
+};
+
+// Stop condition on the relative error of a tally bin, where bin
+// TallyStatistics::TotalBin is the sum over all bins
+struct ConvergenceTarget
+{
+  int tally;
+  long long bin;
+  double relative_error;
+};
+
+class RunDriver
+{
+private:
+  const Transport &transport;
+  const PhotonPhysics &physics;
+  TallySet &tally_set;
+  Source source;
+  RunSettings settings;
+  std::vector<ConvergenceTarget> targets;
+  std::vector<TallyStatistics> statistics; // Per tally
+  std::vector<ParticleBank> banks;         // Per thread
+  long long histories_run;
+  int batches_run;
+  double elapsed_seconds;
+  std::unique_ptr<CheckpointWriter> checkpoint_writer; // Null without a path
+  double last_checkpoint_seconds;
+
+  // Runs one batch, with thread t taking the t-th share of the histories
+  void runBatch(long long histories);
+
+  // Transports a source particle and everything it banks, depth first as the
+  // bank is last in first out
+  void runHistory(int thread, Particle &particle, RandomNumberGenerator &rng);
+
+  // Transports one particle until it is absorbed, killed or escapes
+  void transportParticle(int thread, Particle &particle,
+                         RandomNumberGenerator &rng, ParticleBank &bank);
+
+  // Scores the track of a particle that left the geometry from start
+  void scoreEscape(int thread, const Vector3D &start, const Particle &particle);
+
+public:
+  // Constructor, allocates the tally buffers for the threads
+  RunDriver(const Transport &transport_, const PhotonPhysics &physics_,
+            TallySet &tally_set_, const Source &source_,
+            const RunSettings &settings_);
+
+  void addTarget(const ConvergenceTarget &target);
+
+  // Getters
+  const TallyStatistics &getStatistics(int tally) const
+  {
+    return statistics.at(tally);
+  }
+  const ParticleBank &getBank(int thread) const { return banks.at(thread); }
+  long long getHistoriesRun() const { return histories_run; }
+  int getBatchesRun() const { return batches_run; }
+  double getElapsedSeconds() const { return elapsed_seconds; }
+
+  // Whether every target is met
+  bool isConverged() const;
+
+  // State at the end of the last batch
+  Checkpoint getCheckpoint() const;
+
+  // Continues from a checkpoint of a run with the same seed, threads, batch
+  // size and tallies, throws otherwise. Call before run.
+  void restart(const Checkpoint &checkpoint);
+
+  // Runs batches until converged or settings.max_histories have run.
+  // Returns isConverged().
+  bool run();
+};
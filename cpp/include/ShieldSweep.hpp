@@ -0,0 +1,106 @@
+// Parallel evaluator of shield transmission over a grid of designs
+// The parameter space is the product of candidate materials and thicknesses
+// for every layer and of source energies. Each configuration is a slab stack
+// hit by a normally incident beam and its transmission is either the
+// point-kernel value exp(-mfp) B or the current behind the stack from a short
+// Monte Carlo run. Attenuation coefs and GP coefficients are computed once
+// per (material, energy) and shared by every configuration.
+
+#pragma once
+
+#include "GPBuildup.hpp"
+#include "Material.hpp"
+#include "PhotonPhysics.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class SweepMethod
+{
+  POINT_KERNEL = 0,
+  MONTE_CARLO = 1
+};
+
+struct SweepSpace
+{
+  // Candidates for each layer, ordered along +z. A nullptr material is a void
+  // layer.
+  std::vector<std::vector<const Material *>> materials;
+  std::vector<std::vector<double>> thicknesses; // cm
+  std::vector<double> energies;                 // MeV
+};
+
+struct SweepSettings
+{
+  SweepMethod method{SweepMethod::POINT_KERNEL};
+  int no_threads{1};
+  long long histories{10000}; // Per configuration for Monte Carlo
+  std::uint64_t seed{12345};
+};
+
+struct SweepConfiguration
+{
+  std::vector<std::pair<const Material *, double>> layers;
+  double energy;
+};
+
+struct SweepResult
+{
+  long long index;
+  SweepConfiguration configuration;
+  double transmission;   // Per source photon
+  double relative_error; // 0 for point-kernel results
+};
+
+class ShieldSweep
+{
+private:
+  SweepSpace space;
+  SweepSettings settings;
+  std::unordered_map<const Material *, GPBuildup> buildups;
+
+  std::vector<const Material *> materials; // Distinct non-void candidates
+  std::vector<std::vector<int>> layer_materials; // Index into materials, -1
+                                                 // for voids
+
+  // Shared lookups, filled by run
+  std::vector<std::vector<double>> coefs; // [energy][material], 1/cm
+  std::vector<std::vector<std::optional<GPCoefficients>>>
+      gp_coefficients;                     // [energy][material]
+  std::unique_ptr<PhotonPhysics> physics; // Monte Carlo only
+
+  void checkSpace() const;
+  void buildLookups();
+
+  // Candidate material and thickness of every layer and energy index of a
+  // configuration, the energy varying fastest
+  void decode(long long index, std::vector<int> &material_choices,
+              std::vector<int> &thickness_choices, int &energy_index) const;
+
+  double evaluatePointKernel(const std::vector<int> &material_choices,
+                             const std::vector<int> &thickness_choices,
+                             int energy_index) const;
+  std::pair<double, double>
+  evaluateMonteCarlo(long long index,
+                     const SweepConfiguration &configuration) const;
+
+public:
+  // Constructor
+  ShieldSweep(const SweepSpace &space_, const SweepSettings &settings_);
+
+  // Sets the GP buildup used for point-kernel configurations whose last
+  // non-void layer is material
+  void setBuildup(const Material &material, const GPBuildup &buildup);
+
+  long long getNoConfigurations() const;
+  SweepConfiguration getConfiguration(long long index) const;
+
+  // Evaluates every configuration on no_threads threads. on_result is called
+  // as results finish, in no particular order, one call at a time.
+  void run(const std::function<void(const SweepResult &)> &on_result);
+};
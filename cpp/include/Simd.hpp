@@ -0,0 +1,257 @@
+// Thin wrapper over the widest double precision SIMD register the compiler
+// targets: AVX/AVX2 (4 lanes), SSE2 (2 lanes), otherwise scalar (1 lane) where
+// plain loops are left to the auto-vectoriser (e.g. NEON)
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Simd
+{
+
+#if defined(__AVX__)
+
+inline constexpr const char *InstructionSet{"avx"};
+
+struct Register
+{
+  static constexpr size_t width{4};
+  __m256d value;
+
+  static Register load(const double *values)
+  {
+    return {_mm256_loadu_pd(values)};
+  }
+  static Register broadcast(double value) { return {_mm256_set1_pd(value)}; }
+  void store(double *values) const { _mm256_storeu_pd(values, value); }
+
+  friend Register operator+(Register a, Register b)
+  {
+    return {_mm256_add_pd(a.value, b.value)};
+  }
+  friend Register operator-(Register a, Register b)
+  {
+    return {_mm256_sub_pd(a.value, b.value)};
+  }
+  friend Register operator*(Register a, Register b)
+  {
+    return {_mm256_mul_pd(a.value, b.value)};
+  }
+  friend Register operator/(Register a, Register b)
+  {
+    return {_mm256_div_pd(a.value, b.value)};
+  }
+  friend Register sqrt(Register a) { return {_mm256_sqrt_pd(a.value)}; }
+  friend Register min(Register a, Register b)
+  {
+    return {_mm256_min_pd(a.value, b.value)};
+  }
+  friend Register max(Register a, Register b)
+  {
+    return {_mm256_max_pd(a.value, b.value)};
+  }
+  // a * b + c
+  friend Register fma(Register a, Register b, Register c)
+  {
+#if defined(__FMA__)
+    return {_mm256_fmadd_pd(a.value, b.value, c.value)};
+#else
+    return {_mm256_add_pd(_mm256_mul_pd(a.value, b.value), c.value)};
+#endif
+  }
+
+  // Integer operations on the 64 bit patterns of the lanes, done on SSE2
+  // halves as AVX without AVX2 has no 256 bit integer instructions
+  template <typename Op> static Register onHalves(Register a, Op op)
+  {
+    __m128i low{_mm_castpd_si128(_mm256_castpd256_pd128(a.value))};
+    __m128i high{_mm_castpd_si128(_mm256_extractf128_pd(a.value, 1))};
+
+    return {_mm256_insertf128_pd(
+        _mm256_castpd128_pd256(_mm_castsi128_pd(op(low))),
+        _mm_castsi128_pd(op(high)), 1)};
+  }
+  friend Register addBits(Register a, std::int64_t bits)
+  {
+    __m128i addend{_mm_set1_epi64x(bits)};
+    return onHalves(a,
+                    [addend](__m128i h) { return _mm_add_epi64(h, addend); });
+  }
+  friend Register andBits(Register a, std::int64_t bits)
+  {
+    __m128i mask{_mm_set1_epi64x(bits)};
+    return onHalves(a, [mask](__m128i h) { return _mm_and_si128(h, mask); });
+  }
+  friend Register orBits(Register a, std::int64_t bits)
+  {
+    __m128i mask{_mm_set1_epi64x(bits)};
+    return onHalves(a, [mask](__m128i h) { return _mm_or_si128(h, mask); });
+  }
+  friend Register shiftLeftBits(Register a, int count)
+  {
+    __m128i shift{_mm_cvtsi32_si128(count)};
+    return onHalves(a, [shift](__m128i h) { return _mm_sll_epi64(h, shift); });
+  }
+  friend Register shiftRightBits(Register a, int count)
+  {
+    __m128i shift{_mm_cvtsi32_si128(count)};
+    return onHalves(a, [shift](__m128i h) { return _mm_srl_epi64(h, shift); });
+  }
+};
+
+#elif defined(__SSE2__)
+
+inline constexpr const char *InstructionSet{"sse2"};
+
+struct Register
+{
+  static constexpr size_t width{2};
+  __m128d value;
+
+  static Register load(const double *values) { return {_mm_loadu_pd(values)}; }
+  static Register broadcast(double value) { return {_mm_set1_pd(value)}; }
+  void store(double *values) const { _mm_storeu_pd(values, value); }
+
+  friend Register operator+(Register a, Register b)
+  {
+    return {_mm_add_pd(a.value, b.value)};
+  }
+  friend Register operator-(Register a, Register b)
+  {
+    return {_mm_sub_pd(a.value, b.value)};
+  }
+  friend Register operator*(Register a, Register b)
+  {
+    return {_mm_mul_pd(a.value, b.value)};
+  }
+  friend Register operator/(Register a, Register b)
+  {
+    return {_mm_div_pd(a.value, b.value)};
+  }
+  friend Register sqrt(Register a) { return {_mm_sqrt_pd(a.value)}; }
+  friend Register min(Register a, Register b)
+  {
+    return {_mm_min_pd(a.value, b.value)};
+  }
+  friend Register max(Register a, Register b)
+  {
+    return {_mm_max_pd(a.value, b.value)};
+  }
+  // a * b + c
+  friend Register fma(Register a, Register b, Register c)
+  {
+    return {_mm_add_pd(_mm_mul_pd(a.value, b.value), c.value)};
+  }
+
+  // Integer operations on the 64 bit patterns of the lanes
+  friend Register addBits(Register a, std::int64_t bits)
+  {
+    return {_mm_castsi128_pd(
+        _mm_add_epi64(_mm_castpd_si128(a.value), _mm_set1_epi64x(bits)))};
+  }
+  friend Register andBits(Register a, std::int64_t bits)
+  {
+    return {_mm_castsi128_pd(
+        _mm_and_si128(_mm_castpd_si128(a.value), _mm_set1_epi64x(bits)))};
+  }
+  friend Register orBits(Register a, std::int64_t bits)
+  {
+    return {_mm_castsi128_pd(
+        _mm_or_si128(_mm_castpd_si128(a.value), _mm_set1_epi64x(bits)))};
+  }
+  friend Register shiftLeftBits(Register a, int count)
+  {
+    return {_mm_castsi128_pd(
+        _mm_sll_epi64(_mm_castpd_si128(a.value), _mm_cvtsi32_si128(count)))};
+  }
+  friend Register shiftRightBits(Register a, int count)
+  {
+    return {_mm_castsi128_pd(
+        _mm_srl_epi64(_mm_castpd_si128(a.value), _mm_cvtsi32_si128(count)))};
+  }
+};
+
+#else
+
+inline constexpr const char *InstructionSet{"scalar"};
+
+struct Register
+{
+  static constexpr size_t width{1};
+  double value;
+
+  static Register load(const double *values) { return {*values}; }
+  static Register broadcast(double value) { return {value}; }
+  void store(double *values) const { *values = value; }
+
+  friend Register operator+(Register a, Register b)
+  {
+    return {a.value + b.value};
+  }
+  friend Register operator-(Register a, Register b)
+  {
+    return {a.value - b.value};
+  }
+  friend Register operator*(Register a, Register b)
+  {
+    return {a.value * b.value};
+  }
+  friend Register operator/(Register a, Register b)
+  {
+    return {a.value / b.value};
+  }
+  friend Register sqrt(Register a) { return {std::sqrt(a.value)}; }
+  friend Register min(Register a, Register b)
+  {
+    return {(b.value < a.value) ? b.value : a.value};
+  }
+  friend Register max(Register a, Register b)
+  {
+    return {(a.value < b.value) ? b.value : a.value};
+  }
+  // a * b + c
+  friend Register fma(Register a, Register b, Register c)
+  {
+    return {a.value * b.value + c.value};
+  }
+
+  // Integer operations on the 64 bit pattern
+  friend Register addBits(Register a, std::int64_t bits)
+  {
+    return {std::bit_cast<double>(std::bit_cast<std::uint64_t>(a.value) +
+                                  static_cast<std::uint64_t>(bits))};
+  }
+  friend Register andBits(Register a, std::int64_t bits)
+  {
+    return {std::bit_cast<double>(std::bit_cast<std::uint64_t>(a.value) &
+                                  static_cast<std::uint64_t>(bits))};
+  }
+  friend Register orBits(Register a, std::int64_t bits)
+  {
+    return {std::bit_cast<double>(std::bit_cast<std::uint64_t>(a.value) |
+                                  static_cast<std::uint64_t>(bits))};
+  }
+  friend Register shiftLeftBits(Register a, int count)
+  {
+    return {std::bit_cast<double>(std::bit_cast<std::uint64_t>(a.value)
+                                  << count)};
+  }
+  friend Register shiftRightBits(Register a, int count)
+  {
+    return {std::bit_cast<double>(std::bit_cast<std::uint64_t>(a.value) >>
+                                  count)};
+  }
+};
+
+#endif
+
+} // namespace Simd
@@ -0,0 +1,39 @@
+// Slab geometry made of a stack of infinite layers perpendicular to the z axis
+// Layer i occupies boundaries[i] <= z < boundaries[i + 1], the first layer
+// starting at z = 0
+
+#pragma once
+
+#include "Geometry.hpp"
+
+#include <utility>
+#include <vector>
+
+class SlabGeometry : public Geometry
+{
+private:
+  std::vector<const Material *> materials;
+  std::vector<double> boundaries; // cm, size is number of layers + 1
+
+public:
+  // Constructor taking (material, thickness in cm) pairs ordered along +z. A
+  // nullptr material makes a void layer.
+  SlabGeometry(
+      const std::vector<std::pair<const Material *, double>> &layers);
+
+  // Getters
+  const std::vector<double> &getBoundaries() const { return boundaries; }
+  double getTotalThickness() const { return boundaries.back(); }
+
+  int findRegion(const Vector3D &position) const override;
+  double distanceToBoundary(const Vector3D &position, const Vector3D &direction,
+                            int region) const override;
+  const Material *getMaterial(int region) const override
+  {
+    return materials.at(region);
+  }
+  int getNumberRegions() const override
+  {
+    return static_cast<int>(materials.size());
+  }
+};
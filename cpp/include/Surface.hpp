@@ -0,0 +1,99 @@
+// Abstract base surface class and the quadric surfaces used to build
+// constructive solid geometry cells
+// Each surface splits space into an inside (evaluate < 0) and an outside
+// (evaluate >= 0) half-space
+
+#pragma once
+
+#include "BoundingBox.hpp"
+#include "Vector.hpp"
+
+class Surface
+{
+public:
+  virtual ~Surface() = default;
+
+  // Negative inside the surface, zero or positive outside
+  virtual double evaluate(const Vector3D &position) const = 0;
+
+  // Distance along direction (unit vector) to the nearest crossing in front of
+  // position, infinite if the surface is never crossed
+  virtual double distance(const Vector3D &position,
+                          const Vector3D &direction) const = 0;
+
+  // Bounds of each half-space, infinite where unbounded
+  virtual BoundingBox getInsideBounds() const { return BoundingBox(); }
+  virtual BoundingBox getOutsideBounds() const { return BoundingBox(); }
+};
+
+// Plane n.x = d, inside is the side the normal points away from
+class Plane : public Surface
+{
+private:
+  Vector3D normal; // Unit vector
+  double offset;
+
+  // Half-space bounds, only finite on one side for axis aligned planes
+  BoundingBox halfSpaceBounds(const Vector3D &half_space_normal,
+                              double half_space_offset) const;
+
+public:
+  // Constructor, normal does not need to be normalised
+  Plane(const Vector3D &normal_, double offset_);
+
+  double evaluate(const Vector3D &position) const override;
+  double distance(const Vector3D &position,
+                  const Vector3D &direction) const override;
+  BoundingBox getInsideBounds() const override;
+  BoundingBox getOutsideBounds() const override;
+};
+
+class Sphere : public Surface
+{
+private:
+  Vector3D centre;
+  double radius;
+
+public:
+  // Constructor
+  Sphere(const Vector3D &centre_, double radius_);
+
+  double evaluate(const Vector3D &position) const override;
+  double distance(const Vector3D &position,
+                  const Vector3D &direction) const override;
+  BoundingBox getInsideBounds() const override;
+};
+
+// Infinite cylinder about an arbitrary axis through a point
+class Cylinder : public Surface
+{
+private:
+  Vector3D point;
+  Vector3D axis; // Unit vector
+  double radius;
+
+public:
+  // Constructor, axis does not need to be normalised
+  Cylinder(const Vector3D &point_, const Vector3D &axis_, double radius_);
+
+  double evaluate(const Vector3D &position) const override;
+  double distance(const Vector3D &position,
+                  const Vector3D &direction) const override;
+  BoundingBox getInsideBounds() const override;
+};
+
+// Axis aligned box macrobody
+class Box : public Surface
+{
+private:
+  BoundingBox bounds;
+
+public:
+  // Constructor
+  Box(const Vector3D &min_, const Vector3D &max_);
+
+  double evaluate(const Vector3D &position) const override;
+  double distance(const Vector3D &position,
+                  const Vector3D &direction) const override;
+  BoundingBox getInsideBounds() const override { return bounds; }
+};
@@ -0,0 +1,197 @@
+// Tallies scored by transport threads
+// A tally only describes how events map to bins. Scores go into a TallyBuffer
+// owned by the scoring thread, so the transport loop needs no atomics or
+// locks, and the buffers of all threads are merged at batch boundaries by
+// TallySet.
+
+#pragma once
+
+#include "AlignedAllocator.hpp"
+#include "CartesianMesh.hpp"
+#include "Constants.hpp"
+#include "Vector.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dense buffers hold every bin. Sparse buffers only hold bins that were
+// scored, for large meshes where each thread touches few voxels per batch.
+enum class TallyStorage
+{
+  DENSE = 0,
+  SPARSE = 1
+};
+
+// Scores of one thread for one tally, aligned so that no two threads share a
+// cache line
+class alignas(TallyConstants::CacheLineSize) TallyBuffer
+{
+private:
+  TallyStorage storage;
+  size_t no_bins;
+  std::vector<double, AlignedAllocator<double, TallyConstants::CacheLineSize>>
+      dense_scores;
+  std::unordered_map<size_t, double> sparse_scores;
+  double history_score; // Scored during a history and binned at its end
+
+public:
+  // Constructor
+  TallyBuffer(size_t no_bins_, TallyStorage storage_);
+
+  // Getters
+  TallyStorage getStorage() const { return storage; }
+  size_t getNoBins() const { return no_bins; }
+  double get(size_t bin) const;
+  size_t getMemoryBytes() const;
+
+  void add(size_t bin, double score)
+  {
+    if(storage == TallyStorage::DENSE)
+    {
+      dense_scores[bin] += score;
+    }
+    else
+    {
+      sparse_scores[bin] += score;
+    }
+  }
+
+  void addHistoryScore(double score) { history_score += score; }
+
+  // Returns the history score and resets it
+  double takeHistoryScore()
+  {
+    double score{history_score};
+    history_score = 0.0;
+
+    return score;
+  }
+
+  // Calls function(bin, score) for every bin that may be non-zero
+  template <typename Function> void forEachScore(Function function) const
+  {
+    if(storage == TallyStorage::DENSE)
+    {
+      for(size_t bin{0}; bin < no_bins; bin++)
+      {
+        function(bin, dense_scores[bin]);
+      }
+    }
+    else
+    {
+      for(const auto &bin_score : sparse_scores)
+      {
+        function(bin_score.first, bin_score.second);
+      }
+    }
+  }
+
+  // Adds the scores of other, which must have the same layout
+  void merge(const TallyBuffer &other);
+
+  // Zeroes all scores, keeping the allocated storage
+  void clear();
+};
+
+class Tally
+{
+protected:
+  std::string name;
+  TallyStorage storage;
+
+  // Index of the bin of energy in edges (low to high), -1 if outside
+  static int findEnergyBin(const std::vector<double> &edges, double energy);
+
+  static void checkEnergyEdges(const std::vector<double> &edges);
+
+public:
+  // Constructor
+  Tally(const std::string &name_, TallyStorage storage_)
+      : name{name_}, storage{storage_}
+  {}
+  virtual ~Tally() = default;
+
+  // Getters
+  const std::string &getName() const { return name; }
+  TallyStorage getStorage() const { return storage; }
+  virtual size_t getNoBins() const = 0;
+
+  // Events. Scores must already include the particle weight.
+  // Energy deposited (MeV) at position in region
+  virtual void scoreDeposit(TallyBuffer &, const Vector3D &, int, double) const
+  {}
+  // Straight flight from start to end at energy
+  virtual void scoreTrack(TallyBuffer &, const Vector3D &, const Vector3D &,
+                          double, double) const
+  {}
+  // End of a source history including all of its secondaries
+  virtual void endHistory(TallyBuffer &) const {}
+};
+
+// Energy deposition on a regular Cartesian mesh, one bin per voxel
+class MeshTally : public Tally
+{
+private:
+  CartesianMesh mesh;
+
+public:
+  // Constructor
+  MeshTally(const std::string &name_, const CartesianMesh &mesh_,
+            TallyStorage storage_ = TallyStorage::DENSE)
+      : Tally{name_, storage_}, mesh{mesh_}
+  {}
+
+  // Getters
+  const CartesianMesh &getMesh() const { return mesh; }
+  size_t getNoBins() const override { return mesh.getSize(); }
+
+  void scoreDeposit(TallyBuffer &buffer, const Vector3D &position, int region,
+                    double deposit) const override;
+};
+
+// Current and flux through the plane n.x = d, binned in energy
+// Energy bin e has the net current (crossings along n positive) in bin 2e and
+// the surface flux (weight / |cos|) in bin 2e + 1
+class SurfaceTally : public Tally
+{
+private:
+  Vector3D normal; // Unit vector
+  double offset;
+  std::vector<double> energy_edges;
+
+public:
+  // Constructor, normal does not need to be normalised
+  SurfaceTally(const std::string &name_, const Vector3D &normal_,
+               double offset_, const std::vector<double> &energy_edges_);
+
+  // Getters
+  const std::vector<double> &getEnergyEdges() const { return energy_edges; }
+  size_t getNoBins() const override { return 2 * (energy_edges.size() - 1); }
+
+  void scoreTrack(TallyBuffer &buffer, const Vector3D &start,
+                  const Vector3D &end, double energy,
+                  double weight) const override;
+};
+
+// Spectrum of the total energy deposited per history in a set of detector
+// regions. Histories depositing nothing are not counted.
+class PulseHeightTally : public Tally
+{
+private:
+  std::vector<int> regions;
+  std::vector<double> energy_edges;
+
+public:
+  // Constructor
+  PulseHeightTally(const std::string &name_, const std::vector<int> &regions_,
+                   const std::vector<double> &energy_edges_);
+
+  // Getters
+  const std::vector<double> &getEnergyEdges() const { return energy_edges; }
+  size_t getNoBins() const override { return energy_edges.size() - 1; }
+
+  void scoreDeposit(TallyBuffer &buffer, const Vector3D &position, int region,
+                    double deposit) const override;
+  void endHistory(TallyBuffer &buffer) const override;
+};
@@ -0,0 +1,71 @@
+// Tallies of a run together with one set of buffers per transport thread
+// Threads score only into their own buffers. At a batch boundary reduce()
+// merges the buffers pairwise in a parallel tree, taking log2(threads)
+// rounds, and hands back the batch totals.
+
+#pragma once
+
+#include "Tally.hpp"
+
+#include <memory>
+#include <vector>
+
+class TallySet
+{
+private:
+  std::vector<std::unique_ptr<Tally>> tallies;
+  std::vector<std::vector<TallyBuffer>> thread_buffers; // [thread][tally]
+  std::vector<TallyBuffer> batch_totals;                // [tally]
+
+public:
+  // Adds a tally, returning its index. Must be called before allocate.
+  int addTally(std::unique_ptr<Tally> tally);
+
+  // Creates zeroed buffers for no_threads threads
+  void allocate(int no_threads);
+
+  // Getters
+  int getNoTallies() const { return static_cast<int>(tallies.size()); }
+  int getNoThreads() const { return static_cast<int>(thread_buffers.size()); }
+  const Tally &getTally(int tally) const { return *tallies.at(tally); }
+  std::vector<TallyBuffer> &getThreadBuffers(int thread)
+  {
+    return thread_buffers[thread];
+  }
+  size_t getMemoryBytes() const;
+
+  // Events scored into the buffers of thread, see Tally
+  void scoreDeposit(int thread, const Vector3D &position, int region,
+                    double deposit)
+  {
+    std::vector<TallyBuffer> &buffers{thread_buffers[thread]};
+
+    for(size_t i{0}; i < tallies.size(); i++)
+    {
+      tallies[i]->scoreDeposit(buffers[i], position, region, deposit);
+    }
+  }
+  void scoreTrack(int thread, const Vector3D &start, const Vector3D &end,
+                  double energy, double weight)
+  {
+    std::vector<TallyBuffer> &buffers{thread_buffers[thread]};
+
+    for(size_t i{0}; i < tallies.size(); i++)
+    {
+      tallies[i]->scoreTrack(buffers[i], start, end, energy, weight);
+    }
+  }
+  void endHistory(int thread)
+  {
+    std::vector<TallyBuffer> &buffers{thread_buffers[thread]};
+
+    for(size_t i{0}; i < tallies.size(); i++)
+    {
+      tallies[i]->endHistory(buffers[i]);
+    }
+  }
+
+  // Merges and clears all thread buffers, returning the scores of each tally
+  // since the last reduction. Must not overlap with scoring.
+  const std::vector<TallyBuffer> &reduce();
+};
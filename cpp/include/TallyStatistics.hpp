@@ -0,0 +1,65 @@
+// Running statistics of one tally over batches
+// The batch result of every bin, normalised per history, is folded into a
+// running mean and sum of squared deviations with Welford's one pass update,
+// weighted by the histories of the batch so that a short last batch counts
+// for only the histories it ran. The sum over all bins is tracked the same
+// way as the tally total.
+
+#pragma once
+
+#include "Tally.hpp"
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+class TallyStatistics
+{
+private:
+  long long no_batches;
+  long long no_histories;
+  std::vector<double> means;              // Per history, per bin
+  std::vector<double> squared_deviations; // Welford M2, per bin
+  double total_mean;
+  double total_squared_deviation;
+  std::vector<double> batch_scores; // Scratch for expanding sparse batches
+
+  // Folds in value from a batch of histories, once they are counted
+  void update(double &mean, double &squared_deviation, double value,
+              long long histories) const
+  {
+    double deviation{value - mean};
+    mean += deviation * histories / no_histories;
+    squared_deviation += histories * deviation * (value - mean);
+  }
+
+public:
+  // Bin index of the sum over all bins
+  static constexpr long long TotalBin{-1};
+
+  // Constructor
+  TallyStatistics(size_t no_bins);
+
+  // Getters
+  long long getNoBatches() const { return no_batches; }
+  long long getNoHistories() const { return no_histories; }
+  size_t getNoBins() const { return means.size(); }
+
+  // Mean score per history
+  double getMean(long long bin) const;
+
+  // Relative standard error of the mean, infinite before two batches or for
+  // a zero mean
+  double getRelativeError(long long bin) const;
+
+  // 1 / (R^2 T) for a run time T in seconds
+  double getFigureOfMerit(long long bin, double seconds) const;
+
+  // Adds the reduced scores of a batch of histories
+  void addBatch(const TallyBuffer &batch, long long histories);
+
+  // Binary state for checkpoints, read back into statistics with the same
+  // number of bins. Restored statistics continue bit for bit.
+  void writeState(std::ostream &os) const;
+  void readState(std::istream &is);
+};
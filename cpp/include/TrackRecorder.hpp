@@ -0,0 +1,198 @@
+// Streaming binary output of particle interaction points
+// Transport threads append fixed size records to their own ring buffers and a
+// background writer thread drains the rings into chunks, which an encoder
+// thread compresses and writes to a chunked columnar file. Recording never
+// waits on the disk and draining never waits on compression while a free
+// chunk buffer is left. A record arriving at a full ring is dropped and
+// counted rather than blocking the transport loop, and the count is stored in
+// the file so that readers know it is incomplete.
+//
+// File layout, in native byte order: FileMagic, uint32 version, then chunks of
+// uint32 record count followed by every column in TrackColumn order as a uint8
+// codec, uint64 encoded size and the encoded bytes. A record count of 0 ends
+// the file and is followed by uint64 records written and uint64 records
+// dropped. Records of different threads interleave, the particle ids tell
+// histories apart.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "Particle.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class TrackEvent : std::uint8_t
+{
+  START = 0,     // Source particle or particle taken from the bank
+  COLLISION = 1, // After the collision, reaction gives what happened
+  CROSSING = 2,  // Entry into a region when transport stops at boundaries
+  ESCAPE = 3,    // Last position inside the geometry
+  END = 4        // Absorbed, below the energy cutoff or killed by roulette
+};
+
+enum class TrackCompression : std::uint8_t
+{
+  NONE = 0,
+  SHUFFLE_RLE = 1 // Bytes grouped by significance, then run length encoded
+};
+
+struct TrackRecord
+{
+  std::uint64_t id;
+  std::uint64_t parent_id;
+  Vector3D position;
+  double energy; // MeV
+  double weight;
+  std::int32_t region;
+  TrackEvent event;
+  std::uint8_t reaction; // ReactionType of collisions, 0 otherwise
+};
+
+// Columns of the file in the order they are written
+enum class TrackColumn
+{
+  ID = 0,
+  PARENT_ID = 1,
+  X = 2,
+  Y = 3,
+  Z = 4,
+  ENERGY = 5,
+  WEIGHT = 6,
+  REGION = 7,
+  EVENT = 8,
+  REACTION = 9
+};
+
+class TrackRecorder
+{
+private:
+  // Single producer single consumer ring, the producer being one transport
+  // thread and the consumer the writer
+  struct Ring
+  {
+    std::vector<TrackRecord> records;
+    alignas(64) std::atomic<size_t> head{0}; // Next slot written
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot read
+    std::atomic<long long> dropped{0};
+  };
+
+  std::vector<std::unique_ptr<Ring>> rings; // Per thread
+  size_t mask;                              // Ring capacity - 1
+  TrackCompression compression;
+
+  std::ofstream file;
+  std::thread writer;
+  std::thread encoder;
+  std::atomic<bool> stopping{false};
+  std::exception_ptr writer_error; // Set by the encoder
+  bool closed{false};
+
+  // Chunk buffers passed between the writer and the encoder, guarded by
+  // chunk_mutex
+  std::mutex chunk_mutex;
+  std::condition_variable chunk_ready; // A full chunk or the end is queued
+  std::condition_variable chunk_free;  // A buffer is free or the encoder failed
+  std::vector<std::vector<TrackRecord>> free_chunks;
+  std::deque<std::vector<TrackRecord>> full_chunks;
+  bool drained{false};        // The writer has queued its last chunk
+  bool encoder_failed{false}; // No more chunks are taken
+
+  // Writer thread state
+  std::vector<TrackRecord> chunk;
+  long long records_drained{0};
+
+  // Encoder thread state
+  std::vector<std::uint8_t> column;
+  std::vector<std::uint8_t> encoded;
+  long long records_written{0};
+
+  void runWriter();
+  void runEncoder();
+
+  // Moves everything in ring to the chunk, queueing full chunks. Returns false
+  // once the encoder has failed.
+  bool drain(Ring &ring);
+
+  // Queues the chunk for the encoder and takes a free buffer in its place.
+  // Waits only if every buffer is queued. Returns false if the encoder failed.
+  bool queueChunk();
+
+  void writeChunk(const std::vector<TrackRecord> &records);
+  void writeColumn(const std::vector<TrackRecord> &records,
+                   TrackColumn track_column);
+
+public:
+  // Constructor, opens path and starts the writer. Throws if the file cannot
+  // be opened or ring_capacity is not a power of 2.
+  TrackRecorder(const std::string &path, int no_threads,
+                TrackCompression compression_ = TrackCompression::NONE,
+                size_t ring_capacity = TrackConstants::RingCapacity);
+  TrackRecorder(const TrackRecorder &) = delete;
+  TrackRecorder &operator=(const TrackRecorder &) = delete;
+  ~TrackRecorder();
+
+  // Getters
+  int getNoThreads() const { return static_cast<int>(rings.size()); }
+  long long getDropped() const;
+
+  // Records in the file, valid once closed
+  long long getRecordsWritten() const { return records_written; }
+
+  // Appends a record from a transport thread, never blocking
+  void record(int thread, const TrackRecord &track_record)
+  {
+    Ring &ring{*rings[thread]};
+    size_t head{ring.head.load(std::memory_order_relaxed)};
+
+    if(head - ring.tail.load(std::memory_order_acquire) > mask)
+    {
+      ring.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    ring.records[head & mask] = track_record;
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+  // Record of particle at its current position
+  void record(int thread, const Particle &particle, int region,
+              TrackEvent event, std::uint8_t reaction = 0)
+  {
+    record(thread, {particle.getID(), particle.getParentID(),
+                    particle.getPosition(), particle.getEnergy(),
+                    particle.getWeight(), region, event, reaction});
+  }
+
+  // Stops the writer once every ring is drained, ends and closes the file.
+  // Throws if the writer failed. Recording must have finished.
+  void close();
+
+  // Reads back a whole file, mainly for checks and post-processing, with the
+  // number of records dropped while recording it. Throws if the file was not
+  // ended by close.
+  static std::vector<TrackRecord> readFile(const std::string &path,
+                                           long long &dropped);
+  static std::vector<TrackRecord> readFile(const std::string &path)
+  {
+    long long dropped;
+    return readFile(path, dropped);
+  }
+
+  // Column codec, exposed for the reader
+  static void encodeShuffleRle(const std::vector<std::uint8_t> &bytes,
+                               size_t element_size,
+                               std::vector<std::uint8_t> &output);
+  static void decodeShuffleRle(const std::vector<std::uint8_t> &input,
+                               size_t element_size,
+                               std::vector<std::uint8_t> &bytes);
+};
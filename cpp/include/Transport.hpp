@@ -0,0 +1,75 @@
+// Transport class responsible for moving particles through a geometry between
+// collisions
+
+#pragma once
+
+#include "Geometry.hpp"
+#include "MajorantTable.hpp"
+#include "Particle.hpp"
+#include "PathBiasing.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <optional>
+
+// Surface tracking stops at every region boundary and resamples the step with
+// the local attenuation coef. Delta (Woodcock) tracking flies with a majorant
+// across boundaries and accepts real collisions with probability mu / mu_max.
+enum class TrackingMode
+{
+  SURFACE = 0,
+  DELTA = 1
+};
+
+// Where a call to Transport::moveToEvent stopped the particle
+struct TransportEvent
+{
+  int region;    // Region the particle is now in, -1 if it left the geometry
+  bool collided; // False if it stopped on entering region
+};
+
+class Transport
+{
+private:
+  const Geometry &geometry;
+  ParticleConstants::ParticleType particle_type;
+  TrackingMode tracking_mode;
+  std::optional<MajorantTable> majorant_table; // Only built for delta tracking
+
+  int surfaceTrack(Particle &particle, RandomNumberGenerator &rng) const;
+  TransportEvent surfaceStep(Particle &particle, int region,
+                             RandomNumberGenerator &rng,
+                             const PathBiasing *biasing = nullptr) const;
+  int deltaTrack(Particle &particle, RandomNumberGenerator &rng) const;
+
+public:
+  // Constructor
+  Transport(const Geometry &geometry_,
+            ParticleConstants::ParticleType particle_type_,
+            TrackingMode tracking_mode_);
+
+  // Getters
+  const Geometry &getGeometry() const { return geometry; }
+  TrackingMode getTrackingMode() const { return tracking_mode; }
+
+  // Moves the particle to its next real collision. Returns the region the
+  // collision happens in, or -1 if the particle leaves the geometry.
+  int moveToCollision(Particle &particle, RandomNumberGenerator &rng) const;
+
+  // Moves the particle to its next real collision or, with surface tracking,
+  // into the next region if a boundary comes first. Lets callers act on
+  // region crossings, e.g. for weight windows. Flights in stretched regions
+  // of biasing use the exponential transform, which needs surface tracking.
+  TransportEvent moveToEvent(Particle &particle, RandomNumberGenerator &rng,
+                             const PathBiasing *biasing = nullptr) const;
+
+  // Forces the particle to collide before it leaves region. Its uncollided
+  // part is split off into uncollided with its own id, moved into the next
+  // region with the weight times the probability of crossing region, and the
+  // particle keeps the weight times the probability of colliding. Uncollided
+  // parts below the cutoff weight play Russian roulette. Returns the event for
+  // the uncollided part, or nothing if there is none and uncollided is
+  // unchanged.
+  std::optional<TransportEvent>
+  forceCollision(Particle &particle, Particle &uncollided, int region,
+                 RandomNumberGenerator &rng) const;
+};
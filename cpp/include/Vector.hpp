@@ -1,4 +1,6 @@
 // Vector3D class resembling a spatial 3-dimensional vector
+// Everything is defined inline (and constexpr where the maths allows) so hot
+// operations compile down to straight-line code at the call site
 
 #pragma once
 
@@ -15,9 +17,9 @@ private:
 
 public:
   // Constructors
-  Vector3D() : x{0}, y{0}, z{0} {}
-  Vector3D(double x_, double y_, double z_) : x{x_}, y{y_}, z{z_} {}
-  Vector3D(double value) : x{value}, y{value}, z{value} {}
+  constexpr Vector3D() : x{0}, y{0}, z{0} {}
+  constexpr Vector3D(double x_, double y_, double z_) : x{x_}, y{y_}, z{z_} {}
+  constexpr Vector3D(double value) : x{value}, y{value}, z{value} {}
 
   // Constant vectors
   static const Vector3D ZERO;
@@ -26,45 +28,123 @@ public:
   static const Vector3D UNITZ;
 
   // Getters
-  double getX() const { return x; }
-  double getY() const { return y; }
-  double getZ() const { return z; }
+  constexpr double getX() const { return x; }
+  constexpr double getY() const { return y; }
+  constexpr double getZ() const { return z; }
 
   // Setters
-  void setX(double x_) { x = x_; }
-  void setY(double y_) { y = y_; }
-  void setZ(double z_) { z = z_; }
+  constexpr void setX(double x_) { x = x_; }
+  constexpr void setY(double y_) { y = y_; }
+  constexpr void setZ(double z_) { z = z_; }
 
   // Operators
-  Vector3D operator+(const Vector3D &other) const;
-  Vector3D operator-(const Vector3D &other) const;
-  Vector3D &operator+=(const Vector3D &other);
-  Vector3D &operator-=(const Vector3D &other);
-  Vector3D operator*(double scalar) const;
-  Vector3D operator/(double scalar) const;
-  Vector3D &operator*=(double scalar);
-  Vector3D &operator/=(double scalar);
+  constexpr Vector3D operator+(const Vector3D &other) const
+  {
+    return {x + other.x, y + other.y, z + other.z};
+  }
+  constexpr Vector3D operator-(const Vector3D &other) const
+  {
+    return {x - other.x, y - other.y, z - other.z};
+  }
+  constexpr Vector3D &operator+=(const Vector3D &other)
+  {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    return *this;
+  }
+  constexpr Vector3D &operator-=(const Vector3D &other)
+  {
+    x -= other.x;
+    y -= other.y;
+    z -= other.z;
+    return *this;
+  }
+  constexpr Vector3D operator*(double scalar) const
+  {
+    return {x * scalar, y * scalar, z * scalar};
+  }
+  constexpr Vector3D operator/(double scalar) const
+  {
+    return {x / scalar, y / scalar, z / scalar};
+  }
+  constexpr Vector3D &operator*=(double scalar)
+  {
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+    return *this;
+  }
+  constexpr Vector3D &operator/=(double scalar)
+  {
+    x /= scalar;
+    y /= scalar;
+    z /= scalar;
+    return *this;
+  }
 
   // LHS scalar
-  friend Vector3D operator*(double scalar, const Vector3D &v);
+  friend constexpr Vector3D operator*(double scalar, const Vector3D &v)
+  {
+    return {v.x * scalar, v.y * scalar, v.z * scalar};
+  }
 
   // Comparison
-  bool operator==(const Vector3D &other) const;
-  bool operator!=(const Vector3D &other) const;
+  constexpr bool operator==(const Vector3D &other) const
+  {
+    return x == other.x && y == other.y && z == other.z;
+  }
+  constexpr bool operator!=(const Vector3D &other) const
+  {
+    return !(*this == other); // Uses operator ==
+  }
 
   // Maths
-  double dot(const Vector3D &other) const;
-  Vector3D cross(const Vector3D &other) const;
-  double magnitude() const;
-  double squaredMagnitude() const;
-  Vector3D normalise() const;
-  double distance(const Vector3D &other) const;
-  double angle(const Vector3D &other) const;
-  Vector3D projectOnto(const Vector3D &other) const;
+  constexpr double dot(const Vector3D &other) const
+  {
+    return x * other.x + y * other.y + z * other.z;
+  }
+  constexpr Vector3D cross(const Vector3D &other) const
+  {
+    return {y * other.z - z * other.y, z * other.x - x * other.z,
+            x * other.y - y * other.x};
+  }
+  double magnitude() const { return std::sqrt(x * x + y * y + z * z); }
+  constexpr double squaredMagnitude() const { return x * x + y * y + z * z; }
+  Vector3D normalise() const
+  {
+    double mag = magnitude();
+    return (mag == 0.0) ? Vector3D::ZERO : (*this / mag);
+  }
+  double distance(const Vector3D &other) const
+  {
+    return (*this - other).magnitude();
+  }
+  double angle(const Vector3D &other) const
+  {
+    // cos(theta) = dot_product / (mag1 * mag2)
+    double magProduct = magnitude() * other.magnitude();
+    return (magProduct == 0.0) ? 0.0 : std::acos(dot(other) / magProduct);
+  }
+  constexpr Vector3D projectOnto(const Vector3D &other) const
+  {
+    // projection = vec1 * (dot_product / (mag1 * mag2))
+    double denom = other.squaredMagnitude();
+    return (denom == 0.0) ? Vector3D::ZERO : other * (dot(other) / denom);
+  }
 
-  // Validation
-  bool isZero() const;
+  // Validation, compares components directly rather than taking a sqrt
+  constexpr bool isZero() const { return x == 0 && y == 0 && z == 0; }
 
   // ostream
-  friend std::ostream &operator<<(std::ostream &os, const Vector3D &v);
-};
\ No newline at end of file
+  friend std::ostream &operator<<(std::ostream &os, const Vector3D &v)
+  {
+    return os << '(' << v.x << ", " << v.y << ", " << v.z << ')';
+  }
+};
+
+// Constant vectors
+inline constexpr Vector3D Vector3D::ZERO{0, 0, 0};
+inline constexpr Vector3D Vector3D::UNITX{1, 0, 0};
+inline constexpr Vector3D Vector3D::UNITY{0, 1, 0};
+inline constexpr Vector3D Vector3D::UNITZ{0, 0, 1};
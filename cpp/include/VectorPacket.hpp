@@ -0,0 +1,278 @@
+// Vector3DPacket class holding N Vector3Ds in structure of arrays layout for
+// batched geometry and collision kernels
+// Mirrors the Vector3D operation set lane by lane, with per-lane scalars
+// (e.g. distances along rays) passed as Lanes. Arithmetic goes through
+// Simd::Register so it uses SSE2/AVX where the compiler targets them.
+
+#pragma once
+
+#include "Simd.hpp"
+#include "Vector.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+template <size_t N> class Vector3DPacket
+{
+  static_assert(N == 4 || N == 8, "Vector3DPacket width must be 4 or 8");
+  static_assert(N % Simd::Register::width == 0,
+                "Vector3DPacket width must be a multiple of the SIMD width");
+
+public:
+  using Lanes = std::array<double, N>;
+
+private:
+  alignas(64) Lanes x;
+  alignas(64) Lanes y;
+  alignas(64) Lanes z;
+
+  static constexpr size_t width{Simd::Register::width};
+
+  // Lane-wise a op b, register by register
+  template <typename Op>
+  static Lanes apply(const Lanes &a, const Lanes &b, Op op)
+  {
+    Lanes result;
+
+    for(size_t i{0}; i < N; i += width)
+    {
+      op(Simd::Register::load(&a[i]), Simd::Register::load(&b[i]))
+          .store(&result[i]);
+    }
+
+    return result;
+  }
+
+  static Lanes broadcast(double value)
+  {
+    Lanes lanes;
+    lanes.fill(value);
+    return lanes;
+  }
+
+public:
+  // Constructors
+  Vector3DPacket() : Vector3DPacket(Vector3D::ZERO) {}
+  Vector3DPacket(const Lanes &x_, const Lanes &y_, const Lanes &z_)
+      : x{x_}, y{y_}, z{z_}
+  {}
+  // Every lane set to the same vector
+  Vector3DPacket(const Vector3D &vector)
+      : x{broadcast(vector.getX())}, y{broadcast(vector.getY())},
+        z{broadcast(vector.getZ())}
+  {}
+
+  // Gather from / scatter to N consecutive Vector3Ds
+  static Vector3DPacket load(const Vector3D *vectors)
+  {
+    Vector3DPacket packet;
+
+    for(size_t i{0}; i < N; i++)
+    {
+      packet.set(i, vectors[i]);
+    }
+
+    return packet;
+  }
+  void store(Vector3D *vectors) const
+  {
+    for(size_t i{0}; i < N; i++)
+    {
+      vectors[i] = get(i);
+    }
+  }
+
+  // Getters
+  static constexpr size_t size() { return N; }
+  const Lanes &getX() const { return x; }
+  const Lanes &getY() const { return y; }
+  const Lanes &getZ() const { return z; }
+  Vector3D get(size_t lane) const { return {x[lane], y[lane], z[lane]}; }
+
+  // Setters
+  void set(size_t lane, const Vector3D &vector)
+  {
+    x[lane] = vector.getX();
+    y[lane] = vector.getY();
+    z[lane] = vector.getZ();
+  }
+
+  // Operators
+  Vector3DPacket operator+(const Vector3DPacket &other) const
+  {
+    auto add{[](Simd::Register a, Simd::Register b) { return a + b; }};
+    return {apply(x, other.x, add), apply(y, other.y, add),
+            apply(z, other.z, add)};
+  }
+  Vector3DPacket operator-(const Vector3DPacket &other) const
+  {
+    auto sub{[](Simd::Register a, Simd::Register b) { return a - b; }};
+    return {apply(x, other.x, sub), apply(y, other.y, sub),
+            apply(z, other.z, sub)};
+  }
+  Vector3DPacket &operator+=(const Vector3DPacket &other)
+  {
+    return *this = *this + other;
+  }
+  Vector3DPacket &operator-=(const Vector3DPacket &other)
+  {
+    return *this = *this - other;
+  }
+  Vector3DPacket operator*(const Lanes &scalars) const
+  {
+    auto mul{[](Simd::Register a, Simd::Register b) { return a * b; }};
+    return {apply(x, scalars, mul), apply(y, scalars, mul),
+            apply(z, scalars, mul)};
+  }
+  Vector3DPacket operator/(const Lanes &scalars) const
+  {
+    auto div{[](Simd::Register a, Simd::Register b) { return a / b; }};
+    return {apply(x, scalars, div), apply(y, scalars, div),
+            apply(z, scalars, div)};
+  }
+  Vector3DPacket operator*(double scalar) const
+  {
+    return *this * broadcast(scalar);
+  }
+  Vector3DPacket operator/(double scalar) const
+  {
+    return *this / broadcast(scalar);
+  }
+  Vector3DPacket &operator*=(double scalar) { return *this = *this * scalar; }
+  Vector3DPacket &operator/=(double scalar) { return *this = *this / scalar; }
+
+  // LHS scalar
+  friend Vector3DPacket operator*(double scalar, const Vector3DPacket &v)
+  {
+    return v * scalar;
+  }
+
+  // this + direction * distances in one fused pass, e.g. advancing rays
+  Vector3DPacket advance(const Vector3DPacket &direction,
+                         const Lanes &distances) const
+  {
+    Vector3DPacket result;
+
+    for(size_t i{0}; i < N; i += width)
+    {
+      Simd::Register distance{Simd::Register::load(&distances[i])};
+
+      fma(Simd::Register::load(&direction.x[i]), distance,
+          Simd::Register::load(&x[i]))
+          .store(&result.x[i]);
+      fma(Simd::Register::load(&direction.y[i]), distance,
+          Simd::Register::load(&y[i]))
+          .store(&result.y[i]);
+      fma(Simd::Register::load(&direction.z[i]), distance,
+          Simd::Register::load(&z[i]))
+          .store(&result.z[i]);
+    }
+
+    return result;
+  }
+
+  // Maths
+  Lanes dot(const Vector3DPacket &other) const
+  {
+    Lanes result;
+
+    for(size_t i{0}; i < N; i += width)
+    {
+      Simd::Register sum{Simd::Register::load(&x[i]) *
+                         Simd::Register::load(&other.x[i])};
+      sum = fma(Simd::Register::load(&y[i]), Simd::Register::load(&other.y[i]),
+                sum);
+      sum = fma(Simd::Register::load(&z[i]), Simd::Register::load(&other.z[i]),
+                sum);
+      sum.store(&result[i]);
+    }
+
+    return result;
+  }
+  Vector3DPacket cross(const Vector3DPacket &other) const
+  {
+    auto mul{[](Simd::Register a, Simd::Register b) { return a * b; }};
+    auto sub{[](Simd::Register a, Simd::Register b) { return a - b; }};
+
+    return {apply(apply(y, other.z, mul), apply(z, other.y, mul), sub),
+            apply(apply(z, other.x, mul), apply(x, other.z, mul), sub),
+            apply(apply(x, other.y, mul), apply(y, other.x, mul), sub)};
+  }
+  Lanes squaredMagnitude() const { return dot(*this); }
+  Lanes magnitude() const
+  {
+    Lanes result{squaredMagnitude()};
+
+    for(size_t i{0}; i < N; i += width)
+    {
+      sqrt(Simd::Register::load(&result[i])).store(&result[i]);
+    }
+
+    return result;
+  }
+  // Zero lanes stay zero, as with Vector3D::normalise
+  Vector3DPacket normalise() const
+  {
+    Lanes inverse{magnitude()};
+
+    for(size_t i{0}; i < N; i++)
+    {
+      inverse[i] = (inverse[i] == 0.0) ? 0.0 : 1.0 / inverse[i];
+    }
+
+    return *this * inverse;
+  }
+  Lanes distance(const Vector3DPacket &other) const
+  {
+    return (*this - other).magnitude();
+  }
+  Lanes angle(const Vector3DPacket &other) const
+  {
+    Lanes dots{dot(other)};
+    Lanes magnitudes{magnitude()};
+    Lanes other_magnitudes{other.magnitude()};
+    Lanes result;
+
+    for(size_t i{0}; i < N; i++)
+    {
+      double mag_product{magnitudes[i] * other_magnitudes[i]};
+      result[i] =
+          (mag_product == 0.0) ? 0.0 : std::acos(dots[i] / mag_product);
+    }
+
+    return result;
+  }
+  Vector3DPacket projectOnto(const Vector3DPacket &other) const
+  {
+    Lanes dots{dot(other)};
+    Lanes denoms{other.squaredMagnitude()};
+
+    for(size_t i{0}; i < N; i++)
+    {
+      dots[i] = (denoms[i] == 0.0) ? 0.0 : dots[i] / denoms[i];
+    }
+
+    return other * dots;
+  }
+
+  // Validation, bit i is set if lane i is the zero vector
+  std::uint32_t isZero() const
+  {
+    std::uint32_t mask{0};
+
+    for(size_t i{0}; i < N; i++)
+    {
+      if(x[i] == 0 && y[i] == 0 && z[i] == 0)
+      {
+        mask |= (1u << i);
+      }
+    }
+
+    return mask;
+  }
+};
+
+using Vector3DPacket4 = Vector3DPacket<4>;
+using Vector3DPacket8 = Vector3DPacket<8>;
@@ -0,0 +1,45 @@
+// Weight windows derived from an importance map over geometry regions or a
+// Cartesian mesh
+// In a region of importance I the survival weight is 1 / I and the window
+// spans 1 / WindowSurvivalRatio to WindowUpperRatio / WindowSurvivalRatio
+// times it. Particles above the window are split into copies of at most the
+// survival weight, particles below it play Russian roulette for the survival
+// weight. Both games keep the expected weight unchanged.
+
+#pragma once
+
+#include "CartesianMesh.hpp"
+#include "Particle.hpp"
+#include "ParticleBank.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <optional>
+#include <vector>
+
+class WeightWindows
+{
+private:
+  std::vector<double> importances;   // Per region or voxel
+  std::optional<CartesianMesh> mesh; // Importances are per region if empty
+
+  void checkImportances() const;
+
+public:
+  // Constructor with an importance per region
+  WeightWindows(const std::vector<double> &region_importances);
+
+  // Constructor with an importance per voxel of mesh
+  WeightWindows(const CartesianMesh &mesh_,
+                const std::vector<double> &voxel_importances);
+
+  // Importance at position in region, -1 outside the mesh where the windows
+  // do not apply
+  double getImportance(const Vector3D &position, int region) const;
+
+  // Plays the window game at the particle position in region. Split copies,
+  // each with its own id, are pushed to bank, as many as it has room for, and
+  // the particle keeps the remaining weight. Returns false if the particle is
+  // killed.
+  bool apply(Particle &particle, int region, RandomNumberGenerator &rng,
+             ParticleBank &bank) const;
+};
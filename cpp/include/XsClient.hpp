@@ -0,0 +1,57 @@
+// Client of the cross section query service
+// Requests can be pipelined: send any number of queries before receiving
+// their responses, which come back in completion order and are matched to
+// their query by id.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "XsProtocol.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct XsQuery
+{
+  // Mass fractions of the elements, need not be normalised
+  std::vector<std::pair<ElementConversion::Element, double>> composition;
+  double density{1.0}; // g/cm^3, 1 gives mass attenuation coefs in cm^2/g
+  ParticleConstants::ReactionType reaction{
+      ParticleConstants::ReactionType::TOTAL_WITH_COHERENT};
+  std::span<const double> energies;
+};
+
+struct XsResponse
+{
+  std::uint32_t id;
+  bool ok;
+  std::vector<double> values; // Coefs at each energy when ok
+  std::string error;          // Reason otherwise
+};
+
+class XsClient
+{
+private:
+  int fd;
+  std::uint32_t next_id{0};
+
+public:
+  // Constructor, connects to the server listening on socket_path
+  explicit XsClient(const std::string &socket_path);
+  XsClient(const XsClient &) = delete;
+  XsClient &operator=(const XsClient &) = delete;
+  ~XsClient();
+
+  // Sends a query without waiting, returns its id
+  std::uint32_t send(const XsQuery &query);
+
+  // Blocks for the next response, throws if the connection is lost
+  XsResponse receive();
+
+  // Sends a query and waits for its answer, throws on error responses. Only
+  // for use with no other queries in flight.
+  std::vector<double> query(const XsQuery &query);
+};
@@ -0,0 +1,102 @@
+// One version of the cross section library held by DataProcessor
+// A version never changes once published. Loading an element or reloading
+// changed files builds a new version that shares every table it did not touch
+// with the old one, and DataProcessor publishes it in a single step, so a
+// query that pinned a version with DataProcessor::getLibrary finishes on it
+// while later queries see the new one. Materials registered with
+// DataProcessor belong to the version too, along with the majorant over them.
+
+#pragma once
+
+#include "CoherentSampler.hpp"
+#include "Constants.hpp"
+#include "MajorantTable.hpp"
+#include "Material.hpp"
+#include "NumaReplicas.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Tables parsed from the data file of one particle type and element
+struct ElementXs
+{
+  ParticleConstants::ParticleType particle_type;
+  ElementConversion::Element element;
+  std::vector<std::vector<double>> rows;
+  std::vector<FlatTable> replicas; // Per NUMA node if enabled when parsed
+
+  // Photons only. Fitting the form factor takes tens of ms, so it waits for
+  // the first coherent scatter off the element rather than slowing every
+  // load and reload.
+  mutable std::once_flag coherent_once;
+  mutable std::unique_ptr<const CoherentSampler> coherent_sampler;
+
+  // Sampler of the element, built on the first call. Throws for particles
+  // other than photons.
+  const CoherentSampler &getCoherentSampler() const;
+};
+
+// Cached data stored in a map linking each particle to an element and its cross
+// section data
+using XsData = std::unordered_map<
+    ParticleConstants::ParticleType,
+    std::unordered_map<ElementConversion::Element,
+                       std::shared_ptr<const ElementXs>>>;
+
+class XsLibrary
+{
+private:
+  friend class DataProcessor;
+
+  long long version;
+  XsData data;
+  std::vector<std::shared_ptr<const Material>> materials;
+  std::unordered_map<ParticleConstants::ParticleType,
+                     std::shared_ptr<const MajorantTable>>
+      majorants; // Over every registered material
+
+  static void checkReaction(ParticleConstants::ParticleType particle_type,
+                            ParticleConstants::ReactionType reaction);
+
+public:
+  // Constructor for the empty library DataProcessor starts from
+  XsLibrary() : version{0} {}
+
+  // Getters
+  long long getVersion() const { return version; }
+  const XsData &getAllData() const { return data; }
+  int getNoElements() const;
+  bool contains(ParticleConstants::ParticleType particle_type,
+                ElementConversion::Element element) const;
+  const ElementXs &getElement(ParticleConstants::ParticleType particle_type,
+                              ElementConversion::Element element) const
+  {
+    return *data.at(particle_type).at(element); // Throws if not found
+  }
+  const std::vector<std::vector<double>> &
+  getData(ParticleConstants::ParticleType particle_type,
+          ElementConversion::Element element) const
+  {
+    return getElement(particle_type, element).rows;
+  }
+  const CoherentSampler &
+  getCoherentSampler(ElementConversion::Element element) const;
+
+  // Registered materials, in the order DataProcessor::addMaterial was called
+  size_t getNoMaterials() const { return materials.size(); }
+  const Material &getMaterial(size_t index) const
+  {
+    return *materials.at(index); // Throws if not found
+  }
+  const MajorantTable &
+  getMajorant(ParticleConstants::ParticleType particle_type) const
+  {
+    return *majorants.at(particle_type); // Throws without materials
+  }
+
+  double getAttenCoef(double energy, ParticleConstants::ReactionType reaction,
+                      ParticleConstants::ParticleType particle_type,
+                      ElementConversion::Element element) const;
+};
@@ -0,0 +1,68 @@
+// Binary protocol of the cross section query service
+// A connection carries a stream of requests, each answered by one response
+// with the same id. Responses may come back in any order, so clients can
+// pipeline many requests. Everything is in native byte order as the service
+// is local only.
+//
+// Request: XsRequestHeader, no_components XsComponent, no_energies doubles
+// Response: XsResponseHeader, then no_values doubles when the status is OK or
+// an error message of no_values bytes otherwise
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include <sys/un.h>
+
+enum class XsStatus : std::uint32_t
+{
+  OK = 0,
+  ERROR = 1
+};
+
+struct XsRequestHeader
+{
+  std::uint32_t magic;
+  std::uint32_t id;
+  std::uint32_t reaction;      // ParticleConstants::ReactionType
+  std::uint32_t no_components; // 1 for a single element
+  std::uint64_t no_energies;
+  double density; // g/cm^3, 1 gives mass attenuation coefs in cm^2/g
+};
+
+// Element of a mixture, mass fractions are normalised by the server
+struct XsComponent
+{
+  std::uint32_t atomic_number;
+  std::uint32_t padding;
+  double mass_fraction;
+};
+
+struct XsResponseHeader
+{
+  std::uint32_t magic;
+  std::uint32_t id;
+  XsStatus status;
+  std::uint32_t padding;
+  std::uint64_t no_values;
+};
+
+static_assert(std::is_trivially_copyable_v<XsRequestHeader> &&
+              std::is_trivially_copyable_v<XsComponent> &&
+              std::is_trivially_copyable_v<XsResponseHeader>);
+
+namespace XsSocket
+{
+
+// Blocking transfers of exactly size bytes, retrying partial transfers and
+// interrupts. False once the peer has gone or on error.
+bool readAll(int fd, void *buffer, size_t size);
+bool writeAll(int fd, const void *buffer, size_t size);
+
+// Socket address for path, throws if the path is too long
+struct sockaddr_un makeAddress(const std::string &path);
+
+} // namespace XsSocket
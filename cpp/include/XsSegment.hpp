@@ -0,0 +1,98 @@
+// Parsed cross section data in a named POSIX shared memory segment
+// One process publishes the tables it has loaded, after which any number of
+// processes on the node attach to them read-only, sharing the same physical
+// pages and skipping the parse. The segment is position independent:
+//
+//   Header, Table entries sorted by (particle type, element), then the columns
+//   of every table as contiguous doubles, each aligned to a cache line
+//
+// with every table referring to its columns by byte offset from the start of
+// the segment. A segment outlives its publisher until it is removed.
+// Transport reads its tables through DataProcessor, which loads from the data
+// files only, so a segment serves processes that look cross sections up
+// directly with getColumn and getAttenCoef.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "DataProcessor.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+class XsSegment
+{
+public:
+  struct Header
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t ready; // Set last by the publisher
+    std::uint64_t size;  // Bytes of the whole segment
+    std::uint64_t no_tables;
+    std::uint64_t tables_offset;
+  };
+
+  struct Table
+  {
+    std::uint32_t particle_type;
+    std::uint32_t element;
+    std::uint64_t no_rows;
+    std::uint64_t no_columns;
+    std::uint64_t columns_offset; // Column c starts at + c * column_stride
+    std::uint64_t column_stride;  // Bytes
+  };
+
+private:
+  std::string name;
+  const std::byte *base;
+  size_t size;
+
+  // Constructor over a mapping, see publish and attach
+  XsSegment(const std::string &name_, const std::byte *base_, size_t size_)
+      : name{name_}, base{base_}, size{size_}
+  {}
+
+  const Header &getHeader() const
+  {
+    return *reinterpret_cast<const Header *>(base);
+  }
+
+  // Throws if not found
+  const Table &getTable(ParticleConstants::ParticleType particle_type,
+                        ElementConversion::Element element) const;
+
+public:
+  XsSegment(const XsSegment &) = delete;
+  XsSegment &operator=(const XsSegment &) = delete;
+  XsSegment(XsSegment &&other) noexcept;
+  XsSegment &operator=(XsSegment &&other) noexcept;
+  ~XsSegment(); // Unmaps, the segment itself stays until removed
+
+  // Copies data into a new segment, throws if one already has the name.
+  // Names are POSIX shared memory names, a leading / is added if missing.
+  static XsSegment publish(const std::string &name_, const XsData &data);
+
+  // Maps an existing segment read-only, throws if it is missing, not yet
+  // complete or of another layout version
+  static XsSegment attach(const std::string &name_);
+
+  // Removes the name, mappings already made stay valid. False if missing.
+  static bool remove(const std::string &name_);
+
+  // Getters
+  const std::string &getName() const { return name; }
+  size_t getSize() const { return size; }
+  size_t getNoTables() const { return getHeader().no_tables; }
+  bool contains(ParticleConstants::ParticleType particle_type,
+                ElementConversion::Element element) const;
+  std::span<const double>
+  getColumn(ParticleConstants::ParticleType particle_type,
+            ElementConversion::Element element, size_t column) const;
+
+  // Same value as DataProcessor::getAttenCoef for the published data
+  double getAttenCoef(double energy, ParticleConstants::ReactionType reaction,
+                      ParticleConstants::ParticleType particle_type,
+                      ElementConversion::Element element) const;
+};
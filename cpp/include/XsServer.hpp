@@ -0,0 +1,113 @@
+// Long lived cross section query service over a Unix domain socket
+// Photon data of every element is loaded once when the server starts and
+// stays in memory. A reader thread per connection decodes requests into a
+// shared queue served by a pool of worker threads. Workers hand responses to
+// a writer thread of the connection, so they never wait on a slow peer.
+// Connections can pipeline requests, the response ids telling them apart. See
+// XsProtocol.hpp for the wire format.
+
+#pragma once
+
+#include "Constants.hpp"
+#include "XsProtocol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class XsServer
+{
+private:
+  struct Connection
+  {
+    int fd;
+    std::thread writer;
+    std::atomic<bool> finished{false};
+
+    // Responses waiting for the writer, encoded
+    std::mutex mutex;
+    std::condition_variable wake; // Writer and a reader waiting for room
+    std::deque<std::vector<char>> responses;
+    size_t pending{0}; // Requests read whose responses are not yet sent
+    bool closing{false};
+    bool broken{false}; // A write failed, responses are discarded
+
+    explicit Connection(int fd_) : fd{fd_} {}
+    ~Connection();
+  };
+
+  struct Request
+  {
+    std::shared_ptr<Connection> connection;
+    XsRequestHeader header;
+    std::vector<XsComponent> components;
+    std::vector<double> energies;
+  };
+
+  struct Reader
+  {
+    std::shared_ptr<Connection> connection;
+    std::thread thread;
+  };
+
+  std::string socket_path;
+  int listen_fd;
+  std::thread acceptor;
+  std::vector<std::thread> workers;
+
+  std::mutex readers_mutex;
+  std::list<Reader> readers;
+
+  std::mutex queue_mutex;
+  std::condition_variable queue_not_empty;
+  std::condition_variable queue_not_full;
+  std::deque<Request> queue;
+  bool stopping{false};
+
+  std::atomic<long long> requests_served{0};
+  std::atomic<long long> values_served{0};
+
+  void runAcceptor();
+  void runReader(std::shared_ptr<Connection> connection);
+  void runWorker();
+  static void runWriter(Connection &connection);
+
+  // Joins readers whose connection has closed
+  void reapReaders();
+
+  // Coefs of a request in 1/cm (or cm^2/g for unit density), throws on
+  // invalid requests
+  static void evaluate(const Request &request, std::vector<double> &values);
+
+  // Queues a response for the writer of connection, never blocking on the
+  // peer
+  static void respond(Connection &connection, std::uint32_t id,
+                      XsStatus status, const void *payload,
+                      std::uint64_t no_values, size_t value_size);
+
+  // Gives back the place of a response that will never be sent
+  static void releasePending(Connection &connection);
+
+public:
+  // Constructor, loads the photon data of every element, listens on
+  // socket_path (replacing a stale socket file) and starts no_workers workers
+  XsServer(const std::string &socket_path_, int no_workers);
+  XsServer(const XsServer &) = delete;
+  XsServer &operator=(const XsServer &) = delete;
+  ~XsServer();
+
+  // Getters
+  const std::string &getSocketPath() const { return socket_path; }
+  long long getRequestsServed() const { return requests_served; }
+  long long getValuesServed() const { return values_served; }
+
+  // Closes every connection, answers the requests already queued and joins
+  // all threads
+  void stop();
+};
@@ -0,0 +1,108 @@
+// Implementation of the AliasTable class
+
+#include "AliasTable.hpp"
+
+#include <stdexcept>
+
+// Constructor
+AliasTable::AliasTable(const std::vector<double> &weights)
+    : entries(weights.size())
+{
+  build(weights, entries);
+}
+
+void AliasTable::build(std::span<const double> weights,
+                       std::span<AliasEntry> entries)
+{
+  if(weights.empty() || weights.size() != entries.size())
+  {
+    throw std::invalid_argument(
+        "Alias table weights and entries must be the same non-zero size");
+  }
+
+  double total{0.0};
+
+  for(double weight : weights)
+  {
+    if(weight < 0.0)
+    {
+      throw std::invalid_argument("Alias table weights cannot be negative");
+    }
+    total += weight;
+  }
+
+  if(!(total > 0.0))
+  {
+    throw std::invalid_argument("Alias table weights cannot all be zero");
+  }
+
+  size_t n{weights.size()};
+
+  // Scale so the average column holds exactly 1
+  std::vector<double> scaled(n);
+  std::vector<size_t> small;
+  std::vector<size_t> large;
+
+  for(size_t i{0}; i < n; i++)
+  {
+    scaled[i] = weights[i] * n / total;
+
+    if(scaled[i] < 1.0)
+    {
+      small.push_back(i);
+    }
+    else
+    {
+      large.push_back(i);
+    }
+  }
+
+  // Fill each under-full column from an over-full one
+  while(!small.empty() && !large.empty())
+  {
+    size_t less{small.back()};
+    size_t more{large.back()};
+    small.pop_back();
+
+    entries[less] = {static_cast<float>(scaled[less]),
+                     static_cast<std::uint32_t>(more)};
+
+    scaled[more] -= 1.0 - scaled[less];
+
+    if(scaled[more] < 1.0)
+    {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+
+  // Whatever is left is full up to rounding
+  for(size_t i : large)
+  {
+    entries[i] = {1.0f, static_cast<std::uint32_t>(i)};
+  }
+  for(size_t i : small)
+  {
+    entries[i] = {1.0f, static_cast<std::uint32_t>(i)};
+  }
+}
+
+double AliasTable::getProbability(std::span<const AliasEntry> entries,
+                                  size_t index)
+{
+  double probability{0.0};
+
+  for(size_t column{0}; column < entries.size(); column++)
+  {
+    if(column == index)
+    {
+      probability += entries[column].probability;
+    }
+    if(entries[column].alias == index)
+    {
+      probability += 1.0 - entries[column].probability;
+    }
+  }
+
+  return probability / entries.size();
+}
@@ -0,0 +1,54 @@
+// Implementation of the CartesianMesh class
+
+#include "CartesianMesh.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Constructor
+CartesianMesh::CartesianMesh(const BoundingBox &bounds_,
+                             const std::array<int, 3> &no_voxels_)
+    : bounds{bounds_}, no_voxels{no_voxels_}
+{
+  Vector3D size{bounds.max - bounds.min};
+
+  if(!bounds.isBounded() || !(size.getX() > 0.0) || !(size.getY() > 0.0) ||
+     !(size.getZ() > 0.0))
+  {
+    throw std::invalid_argument("Invalid mesh bounds: mesh must be finite with "
+                                "a positive size along every axis");
+  }
+
+  if(no_voxels[0] < 1 || no_voxels[1] < 1 || no_voxels[2] < 1)
+  {
+    throw std::invalid_argument("Invalid mesh: need at least one voxel along "
+                                "every axis");
+  }
+
+  inverse_voxel_size = Vector3D(no_voxels[0] / size.getX(),
+                                no_voxels[1] / size.getY(),
+                                no_voxels[2] / size.getZ());
+}
+
+long long CartesianMesh::getVoxel(const Vector3D &position) const
+{
+  if(!bounds.contains(position))
+  {
+    return -1;
+  }
+
+  Vector3D scaled{position - bounds.min};
+
+  // Points on the upper faces belong to the last voxel
+  long long i{std::min(
+      static_cast<int>(scaled.getX() * inverse_voxel_size.getX()),
+      no_voxels[0] - 1)};
+  long long j{std::min(
+      static_cast<int>(scaled.getY() * inverse_voxel_size.getY()),
+      no_voxels[1] - 1)};
+  long long k{std::min(
+      static_cast<int>(scaled.getZ() * inverse_voxel_size.getZ()),
+      no_voxels[2] - 1)};
+
+  return (k * no_voxels[1] + j) * no_voxels[0] + i;
+}
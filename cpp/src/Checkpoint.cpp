@@ -0,0 +1,256 @@
+// Implementation of the Checkpoint and CheckpointWriter classes
+
+#include "Checkpoint.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+template <typename T> void writeValue(std::ofstream &file, T value)
+{
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Throws if the file ends first
+template <typename T> T readValue(std::ifstream &file, const std::string &path)
+{
+  T value{};
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+
+  if(!file.good())
+  {
+    throw std::runtime_error("Truncated checkpoint file " + path);
+  }
+
+  return value;
+}
+
+// Flushes a file or directory to disk
+void syncPath(const std::string &path, int flags)
+{
+  int fd{::open(path.c_str(), flags)};
+
+  if(fd < 0)
+  {
+    throw std::runtime_error("Cannot open for sync " + path);
+  }
+
+  int result{::fsync(fd)};
+  ::close(fd);
+
+  if(result != 0)
+  {
+    throw std::runtime_error("Cannot sync checkpoint to disk: " + path);
+  }
+}
+
+} // namespace
+
+void Checkpoint::write(const std::string &path) const
+{
+  std::string temporary_path{path + ".tmp"};
+
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+
+    if(!file)
+    {
+      throw std::runtime_error("Cannot open checkpoint file " +
+                               temporary_path);
+    }
+
+    file.write(CheckpointConstants::FileMagic.data(),
+               static_cast<std::streamsize>(
+                   CheckpointConstants::FileMagic.size()));
+    writeValue(file, CheckpointConstants::FileVersion);
+    writeValue(file, seed);
+    writeValue(file, no_threads);
+    writeValue(file, histories_per_batch);
+    writeValue(file, histories_run);
+    writeValue(file, batches_run);
+    writeValue(file, elapsed_seconds);
+    writeValue(file, static_cast<std::uint32_t>(statistics.size()));
+
+    for(const TallyStatistics &tally_statistics : statistics)
+    {
+      writeValue(file,
+                 static_cast<std::uint64_t>(tally_statistics.getNoBins()));
+      tally_statistics.writeState(file);
+    }
+
+    file.close();
+
+    if(!file)
+    {
+      throw std::runtime_error("Checkpoint write failed: " + temporary_path);
+    }
+  }
+
+  // The contents must be on disk before the rename can be
+  syncPath(temporary_path, O_RDONLY);
+
+  if(std::rename(temporary_path.c_str(), path.c_str()) != 0)
+  {
+    throw std::runtime_error("Cannot replace checkpoint file " + path);
+  }
+
+  std::filesystem::path directory{std::filesystem::path(path).parent_path()};
+  syncPath(directory.empty() ? "." : directory.string(),
+           O_RDONLY | O_DIRECTORY);
+}
+
+Checkpoint Checkpoint::read(const std::string &path,
+                            const TallySet &tally_set)
+{
+  std::ifstream file(path, std::ios::binary);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot open checkpoint file " + path);
+  }
+
+  std::string magic(CheckpointConstants::FileMagic.size(), '\0');
+  file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+
+  if(!file.good() || magic != CheckpointConstants::FileMagic ||
+     readValue<std::uint32_t>(file, path) != CheckpointConstants::FileVersion)
+  {
+    throw std::runtime_error("Not a checkpoint file of this version: " + path);
+  }
+
+  Checkpoint checkpoint{};
+  checkpoint.seed = readValue<std::uint64_t>(file, path);
+  checkpoint.no_threads = readValue<std::int32_t>(file, path);
+  checkpoint.histories_per_batch = readValue<std::int64_t>(file, path);
+  checkpoint.histories_run = readValue<std::int64_t>(file, path);
+  checkpoint.batches_run = readValue<std::int32_t>(file, path);
+  checkpoint.elapsed_seconds = readValue<double>(file, path);
+
+  std::uint32_t no_tallies{readValue<std::uint32_t>(file, path)};
+
+  if(no_tallies != static_cast<std::uint32_t>(tally_set.getNoTallies()))
+  {
+    throw std::runtime_error("Invalid checkpoint file: tallies differ " +
+                             path);
+  }
+
+  for(std::uint32_t tally{0}; tally < no_tallies; tally++)
+  {
+    std::uint64_t no_bins{readValue<std::uint64_t>(file, path)};
+
+    if(no_bins != tally_set.getTally(static_cast<int>(tally)).getNoBins())
+    {
+      throw std::runtime_error("Invalid checkpoint file: tally bins differ " +
+                               path);
+    }
+
+    checkpoint.statistics.emplace_back(no_bins);
+    checkpoint.statistics.back().readState(file);
+  }
+
+  return checkpoint;
+}
+
+// Constructor
+CheckpointWriter::CheckpointWriter(const std::string &path_) : path{path_}
+{
+  if(path.empty())
+  {
+    throw std::invalid_argument("Invalid checkpoint writer: empty path");
+  }
+
+  writer = std::thread(&CheckpointWriter::runWriter, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  changed.notify_all();
+  writer.join();
+}
+
+long long CheckpointWriter::getNoWritten()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return no_written;
+}
+
+void CheckpointWriter::submit(Checkpoint checkpoint)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = std::move(checkpoint);
+  }
+
+  changed.notify_all();
+}
+
+void CheckpointWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this] { return !pending && !writing; });
+
+  if(writer_error)
+  {
+    std::rethrow_exception(std::exchange(writer_error, nullptr));
+  }
+}
+
+void CheckpointWriter::runWriter()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while(true)
+  {
+    changed.wait(lock, [this] { return stopping || pending; });
+
+    if(!pending)
+    {
+      return; // Stopping with nothing left to write
+    }
+
+    Checkpoint checkpoint{std::move(*pending)};
+    pending.reset();
+    writing = true;
+    lock.unlock();
+
+    // Failures are kept for flush, later checkpoints may still succeed
+    std::exception_ptr error;
+
+    try
+    {
+      checkpoint.write(path);
+    }
+    catch(...)
+    {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    writing = false;
+
+    if(error)
+    {
+      writer_error = error;
+    }
+    else
+    {
+      no_written += 1;
+    }
+
+    changed.notify_all();
+  }
+}
@@ -0,0 +1,468 @@
+// Implementation of the CoherentSampler class
+
+#include "CoherentSampler.hpp"
+#include "DirectionKernels.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <numbers>
+#include <stdexcept>
+
+namespace
+{
+
+// Minimises function with the Nelder-Mead simplex method from start, with
+// the initial simplex extending step along each axis
+std::array<double, 3>
+minimiseNelderMead(const std::function<double(const std::array<double, 3> &)>
+                       &function,
+                   const std::array<double, 3> &start, double step,
+                   double tolerance, int max_iterations)
+{
+  std::array<std::array<double, 3>, 4> points;
+  std::array<double, 4> values;
+
+  for(int i{0}; i < 4; i++)
+  {
+    points[i] = start;
+
+    if(i > 0)
+    {
+      points[i][i - 1] += step;
+    }
+
+    values[i] = function(points[i]);
+  }
+
+  for(int iteration{0}; iteration < max_iterations; iteration++)
+  {
+    // Order best to worst
+    std::array<int, 4> order{0, 1, 2, 3};
+    std::sort(order.begin(), order.end(),
+              [&values](int a, int b) { return values[a] < values[b]; });
+
+    std::array<std::array<double, 3>, 4> sorted_points;
+    std::array<double, 4> sorted_values;
+
+    for(int i{0}; i < 4; i++)
+    {
+      sorted_points[i] = points[order[i]];
+      sorted_values[i] = values[order[i]];
+    }
+
+    points = sorted_points;
+    values = sorted_values;
+
+    if(values[3] - values[0] < tolerance)
+    {
+      break;
+    }
+
+    // Moves the worst point through the centroid of the others by factor
+    std::array<double, 3> centroid{0.0, 0.0, 0.0};
+
+    for(int i{0}; i < 3; i++)
+    {
+      for(int axis{0}; axis < 3; axis++)
+      {
+        centroid[axis] += points[i][axis] / 3.0;
+      }
+    }
+
+    auto along{[&](double factor)
+               {
+                 std::array<double, 3> point;
+
+                 for(int axis{0}; axis < 3; axis++)
+                 {
+                   point[axis] = centroid[axis] +
+                                 factor * (points[3][axis] - centroid[axis]);
+                 }
+
+                 return point;
+               }};
+
+    std::array<double, 3> reflected{along(-1.0)};
+    double reflected_value{function(reflected)};
+
+    if(reflected_value < values[0])
+    {
+      std::array<double, 3> expanded{along(-2.0)};
+      double expanded_value{function(expanded)};
+
+      if(expanded_value < reflected_value)
+      {
+        points[3] = expanded;
+        values[3] = expanded_value;
+      }
+      else
+      {
+        points[3] = reflected;
+        values[3] = reflected_value;
+      }
+    }
+    else if(reflected_value < values[2])
+    {
+      points[3] = reflected;
+      values[3] = reflected_value;
+    }
+    else
+    {
+      std::array<double, 3> contracted{along(0.5)};
+      double contracted_value{function(contracted)};
+
+      if(contracted_value < values[3])
+      {
+        points[3] = contracted;
+        values[3] = contracted_value;
+      }
+      else
+      {
+        // Shrink towards the best point
+        for(int i{1}; i < 4; i++)
+        {
+          for(int axis{0}; axis < 3; axis++)
+          {
+            points[i][axis] =
+                points[0][axis] + 0.5 * (points[i][axis] - points[0][axis]);
+          }
+
+          values[i] = function(points[i]);
+        }
+      }
+    }
+  }
+
+  return points[std::distance(
+      values.begin(), std::min_element(values.begin(), values.end()))];
+}
+
+// Gauss-Legendre nodes and weights on [0, 1], returned as
+// std::pair(nodes, weights)
+std::pair<std::vector<double>, std::vector<double>>
+gaussLegendre(int no_points)
+{
+  std::vector<double> nodes(no_points);
+  std::vector<double> weights(no_points);
+
+  for(int i{0}; i < no_points; i++)
+  {
+    // Newton iteration on the Legendre polynomial from the Chebyshev guess
+    double x{std::cos(std::numbers::pi * (i + 0.75) / (no_points + 0.5))};
+    double derivative{1.0};
+
+    for(int iteration{0}; iteration < 100; iteration++)
+    {
+      double current{1.0};
+      double previous{0.0};
+
+      for(int order{1}; order <= no_points; order++)
+      {
+        double next{((2.0 * order - 1.0) * x * current -
+                     (order - 1.0) * previous) /
+                    order};
+        previous = current;
+        current = next;
+      }
+
+      derivative = no_points * (x * current - previous) / (x * x - 1.0);
+
+      double change{current / derivative};
+      x -= change;
+
+      if(std::abs(change) < 1e-15)
+      {
+        break;
+      }
+    }
+
+    nodes[i] = 0.5 * (1.0 - x);
+    weights[i] = 1.0 / ((1.0 - x * x) * derivative * derivative);
+  }
+
+  return std::make_pair(nodes, weights);
+}
+
+// Rows of {energy, coherent cross section in cm^2 per atom} from an
+// element's photon data
+std::vector<std::vector<double>>
+tabulatedCrossSections(const std::vector<std::vector<double>> &rows,
+                       ElementConversion::Element element)
+{
+  size_t coherent_column{
+      FileConstants::ReactionToColumn.at(ParticleConstants::ParticleType::GAMMA)
+          .at(ParticleConstants::ReactionType::COHERENT_SCATTERING)};
+  double atomic_mass{ElementConversion::ElementalMasses.at(element)};
+
+  std::vector<std::vector<double>> cross_sections;
+
+  for(const std::vector<double> &row : rows)
+  {
+    cross_sections.push_back(
+        {row[FileConstants::EnergyColumn],
+         row[coherent_column] * atomic_mass / ParticleConstants::Avogadro});
+  }
+
+  return cross_sections;
+}
+
+} // namespace
+
+// Constructor
+CoherentSampler::CoherentSampler(const std::vector<std::vector<double>> &rows,
+                                 ElementConversion::Element element)
+    : atomic_number{static_cast<double>(element)},
+      form_factor{fitFormFactor(rows, element)},
+      cross_sections{tabulatedCrossSections(rows, element)}
+{
+  FormFactor fitted{form_factor};
+
+  table = InverseCdfTable(
+      SamplingConstants::TableMinEnergy, SamplingConstants::TableMaxEnergy,
+      SamplingConstants::CoherentTableEnergies,
+      SamplingConstants::CoherentTableQuantiles,
+      [fitted, row_energy = 0.0,
+       screening = std::make_pair(0.0, 0.0)](double energy, double w) mutable
+      {
+        // Rows are built one energy at a time
+        if(energy != row_energy)
+        {
+          row_energy = energy;
+          screening = coreScreening(fitted, energy);
+        }
+
+        return density(fitted, screening.first, screening.second, w);
+      },
+      [](double) { return std::make_pair(0.0, 1.0); },
+      QuantileSpacing::REFINED_HIGH);
+}
+
+std::pair<double, double>
+CoherentSampler::coreScreening(const FormFactor &form_factor, double energy)
+{
+  double scaled_energy{energy / (ParticleConstants::PlanckTimesC *
+                                 form_factor.core_scale)};
+  double scaled_squared{scaled_energy * scaled_energy};
+
+  return std::make_pair(scaled_squared,
+                        -std::expm1(-3.0 * std::log1p(scaled_squared)));
+}
+
+double CoherentSampler::oneMinusCos(double scaled_squared, double range,
+                                    double w)
+{
+  // log of (1 + k^2 t / 2)^-1
+  double log_core{std::log1p(-w * range) / 3.0};
+
+  return std::min(-2.0 * std::expm1(log_core) /
+                      (std::exp(log_core) * scaled_squared),
+                  2.0);
+}
+
+double CoherentSampler::density(const FormFactor &form_factor,
+                                double scaled_squared, double range, double w)
+{
+  double log_core{std::log1p(-w * range) / 3.0};
+  double core{std::exp(log_core)};
+  double core_complement{-std::expm1(log_core)};
+
+  // Outer over core shell factor
+  double scale_ratio{form_factor.core_scale / form_factor.outer_scale};
+  double shell_ratio{
+      1.0 / (core + scale_ratio * scale_ratio * core_complement)};
+  double shells{form_factor.core_fraction +
+                (1.0 - form_factor.core_fraction) * shell_ratio * shell_ratio};
+
+  double one_minus_cos{
+      std::min(2.0 * core_complement / (core * scaled_squared), 2.0)};
+  double cos_theta{1.0 - one_minus_cos};
+
+  return (1.0 + cos_theta * cos_theta) * shells * shells;
+}
+
+double CoherentSampler::angularIntegral(const FormFactor &form_factor,
+                                        double energy)
+{
+  // Gauss-Legendre in w, where the integrand is bounded. The outer shell
+  // falls off from w at x = x_o over a geometric range of w, so the
+  // integral is split there into intervals that each see a smooth integrand.
+  static const std::pair<std::vector<double>, std::vector<double>>
+      nodes_weights{gaussLegendre(16)};
+
+  std::pair<double, double> screening{coreScreening(form_factor, energy)};
+
+  double scale_ratio{form_factor.core_scale / form_factor.outer_scale};
+  double outer_w{-std::expm1(-3.0 * std::log1p(1.0 / (scale_ratio *
+                                                      scale_ratio))) /
+                 screening.second};
+
+  double integral{0.0};
+  double low{0.0};
+  double high{std::min(outer_w, 1.0)};
+
+  while(low < 1.0)
+  {
+    for(size_t i{0}; i < nodes_weights.first.size(); i++)
+    {
+      double w{low + (high - low) * nodes_weights.first[i]};
+      integral += (high - low) * nodes_weights.second[i] *
+                  density(form_factor, screening.first, screening.second, w);
+    }
+
+    low = high;
+    high = std::min(8.0 * high, 1.0);
+  }
+
+  // Jacobian of w, constant by construction
+  return 2.0 * screening.second / (3.0 * screening.first) * integral;
+}
+
+FormFactor
+CoherentSampler::fitFormFactor(const std::vector<std::vector<double>> &rows,
+                               ElementConversion::Element element)
+{
+  double atomic_number{static_cast<double>(element)};
+
+  // Tabulated sigma / (pi r_e^2 Z^2), skipping energies where screening is
+  // negligible as they do not constrain the form factor
+  std::vector<std::vector<double>> cross_sections{
+      tabulatedCrossSections(rows, element)};
+  const double thomson{8.0 / 3.0};
+  double sigma_scale{std::numbers::pi *
+                     ParticleConstants::ClassicalElectronRadius *
+                     ParticleConstants::ClassicalElectronRadius *
+                     atomic_number * atomic_number};
+
+  std::vector<double> energies;
+  std::vector<double> log_targets;
+
+  for(const std::vector<double> &row : cross_sections)
+  {
+    double target{row[1] / sigma_scale};
+
+    if(target > 0.0 && target < 0.98 * thomson)
+    {
+      energies.push_back(row[0]);
+      log_targets.push_back(std::log(target));
+    }
+  }
+
+  if(energies.empty())
+  {
+    throw std::runtime_error("No coherent data to fit the form factor to");
+  }
+
+  // Every stride-th energy keeps the fit cheap at load
+  const size_t max_fit_points{24};
+  size_t stride{(energies.size() + max_fit_points - 1) / max_fit_points};
+
+  // Parameters are log outer scale, logit of the log scale ratio over its
+  // maximum and logit core fraction
+  const double log_max_scale_ratio{
+      std::log(SamplingConstants::CoherentMaxScaleRatio)};
+
+  auto toFormFactor{
+      [log_max_scale_ratio](const std::array<double, 3> &parameters)
+      {
+        double outer_scale{std::exp(parameters[0])};
+        double log_scale_ratio{log_max_scale_ratio /
+                               (1.0 + std::exp(-parameters[1]))};
+
+        return FormFactor{outer_scale,
+                          outer_scale * std::exp(log_scale_ratio),
+                          1.0 / (1.0 + std::exp(-parameters[2]))};
+      }};
+
+  // Sum of squared log residuals
+  auto residual{
+      [&](const std::array<double, 3> &parameters)
+      {
+        // Outer scale limited to 0.01 to 1000 1/Angstrom
+        const double log_min_scale{std::log(1e-2)};
+        const double log_max_scale{std::log(1e3)};
+
+        if(!(parameters[0] > log_min_scale && parameters[0] < log_max_scale))
+        {
+          return HUGE_VAL;
+        }
+
+        FormFactor trial{toFormFactor(parameters)};
+        double sum{0.0};
+
+        for(size_t i{0}; i < energies.size(); i += stride)
+        {
+          double difference{std::log(angularIntegral(trial, energies[i])) -
+                            log_targets[i]};
+          sum += difference * difference;
+        }
+
+        return std::isnan(sum) ? HUGE_VAL : sum;
+      }};
+
+  // Coarse grid for the starting point, as the residual has local minima
+  std::array<double, 3> start{0.0, 0.0, -1.0};
+  double start_residual{HUGE_VAL};
+
+  for(double log_outer_scale{std::log(0.05)}; log_outer_scale < std::log(5.0);
+      log_outer_scale += 0.5)
+  {
+    for(double ratio_parameter{-2.0}; ratio_parameter <= 2.0;
+        ratio_parameter += 1.0)
+    {
+      std::array<double, 3> point{log_outer_scale, ratio_parameter, -1.0};
+      double point_residual{residual(point)};
+
+      if(point_residual < start_residual)
+      {
+        start = point;
+        start_residual = point_residual;
+      }
+    }
+  }
+
+  return toFormFactor(minimiseNelderMead(residual, start, 0.5, 1e-8, 300));
+}
+
+double CoherentSampler::getModelCrossSection(double energy) const
+{
+  return std::numbers::pi * ParticleConstants::ClassicalElectronRadius *
+         ParticleConstants::ClassicalElectronRadius * atomic_number *
+         atomic_number * angularIntegral(form_factor, energy);
+}
+
+double CoherentSampler::getCrossSection(double energy) const
+{
+  // The model scaled at energy by tabulated over model sigma, which leaves
+  // the tabulated sigma
+  return Interpolation::interpolateColumn(energy, cross_sections, 1);
+}
+
+void CoherentSampler::scatter(Particle &particle,
+                              RandomNumberGenerator &rng) const
+{
+  double cos_theta{sample(particle.getEnergy(), rng.getUniform())};
+  DirectionKernels::Azimuth azimuth{rng.getAzimuth()};
+
+  particle.setUnitDirection(DirectionKernels::keepUnit(
+      DirectionKernels::rotateDirection(particle.getDirection(), cos_theta,
+                                        azimuth)));
+}
+
+void CoherentSampler::sampleBatch(std::span<const double> energies,
+                                  std::span<const double> uniforms,
+                                  std::span<double> cos_thetas) const
+{
+  if(uniforms.size() != energies.size() ||
+     cos_thetas.size() != energies.size())
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  for(size_t i{0}; i < energies.size(); i++)
+  {
+    cos_thetas[i] = sample(energies[i], uniforms[i]);
+  }
+}
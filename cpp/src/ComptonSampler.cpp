@@ -0,0 +1,138 @@
+// Implementation of the ComptonSampler class
+
+#include "ComptonSampler.hpp"
+#include "Constants.hpp"
+#include "DirectionKernels.hpp"
+
+#include <array>
+#include <stdexcept>
+
+// Constructor
+ComptonSampler::ComptonSampler()
+    : table{SamplingConstants::TableMinEnergy,
+            SamplingConstants::TableMaxEnergy,
+            SamplingConstants::TableEnergies,
+            SamplingConstants::TableQuantiles,
+            kleinNishina,
+            [](double) { return std::make_pair(0.0, 2.0); }}
+{}
+
+double ComptonSampler::kleinNishina(double energy, double one_minus_cos)
+{
+  // dsigma/dOmega ~ P^2 (P + 1/P - sin^2 theta) where P = E' / E
+  double k{energy / ParticleConstants::ElectronMass};
+  double energy_ratio{1.0 / (1.0 + k * one_minus_cos)};
+  double sin_squared{one_minus_cos * (2.0 - one_minus_cos)};
+
+  return energy_ratio * energy_ratio *
+         (energy_ratio + 1.0 / energy_ratio - sin_squared);
+}
+
+std::pair<double, double> ComptonSampler::sample(double energy,
+                                                 double uniform) const
+{
+  double one_minus_cos{table.sample(energy, uniform)};
+  double k{energy / ParticleConstants::ElectronMass};
+
+  return std::make_pair(energy / (1.0 + k * one_minus_cos),
+                        1.0 - one_minus_cos);
+}
+
+double ComptonSampler::scatter(Particle &particle,
+                               RandomNumberGenerator &rng) const
+{
+  double energy{particle.getEnergy()};
+  std::pair<double, double> energy_cos{sample(energy, rng.getUniform())};
+  DirectionKernels::Azimuth azimuth{rng.getAzimuth()};
+
+  particle.setEnergy(energy_cos.first);
+  particle.setUnitDirection(DirectionKernels::keepUnit(
+      DirectionKernels::rotateDirection(particle.getDirection(),
+                                        energy_cos.second, azimuth)));
+
+  return energy - energy_cos.first;
+}
+
+void ComptonSampler::sampleBatch(std::span<const double> energies,
+                                 std::span<const double> uniforms,
+                                 std::span<double> scattered_energies,
+                                 std::span<double> cos_thetas) const
+{
+  if(uniforms.size() != energies.size() ||
+     scattered_energies.size() != energies.size() ||
+     cos_thetas.size() != energies.size())
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  for(size_t i{0}; i < energies.size(); i++)
+  {
+    double one_minus_cos{table.sample(energies[i], uniforms[i])};
+    double k{energies[i] / ParticleConstants::ElectronMass};
+
+    scattered_energies[i] = energies[i] / (1.0 + k * one_minus_cos);
+    cos_thetas[i] = 1.0 - one_minus_cos;
+  }
+}
+
+void ComptonSampler::scatterBatch(std::span<Particle> particles,
+                                  RandomNumberGenerator &rng,
+                                  std::span<double> deposited_energies) const
+{
+  if(deposited_energies.size() != particles.size())
+  {
+    throw std::invalid_argument("Batch arrays must all have the same size");
+  }
+
+  // Work through fixed size chunks on the stack so nothing is allocated
+  const size_t chunk_size{64};
+  std::array<double, chunk_size> energies;
+  std::array<double, chunk_size> uniforms;
+  std::array<double, chunk_size> cos_phis;
+  std::array<double, chunk_size> sin_phis;
+  std::array<double, chunk_size> scattered_energies;
+  std::array<double, chunk_size> cos_thetas;
+  std::array<double, chunk_size> u;
+  std::array<double, chunk_size> v;
+  std::array<double, chunk_size> w;
+
+  for(size_t start{0}; start < particles.size(); start += chunk_size)
+  {
+    size_t count{std::min(chunk_size, particles.size() - start)};
+
+    for(size_t i{0}; i < count; i++)
+    {
+      const Particle &particle{particles[start + i]};
+
+      energies[i] = particle.getEnergy();
+      uniforms[i] = rng.getUniform();
+
+      DirectionKernels::Azimuth azimuth{rng.getAzimuth()};
+      cos_phis[i] = azimuth.cos_phi;
+      sin_phis[i] = azimuth.sin_phi;
+      u[i] = particle.getDirection().getX();
+      v[i] = particle.getDirection().getY();
+      w[i] = particle.getDirection().getZ();
+    }
+
+    sampleBatch(std::span<const double>(energies.data(), count),
+                std::span<const double>(uniforms.data(), count),
+                std::span<double>(scattered_energies.data(), count),
+                std::span<double>(cos_thetas.data(), count));
+    DirectionKernels::rotateDirections(
+        std::span<double>(u.data(), count), std::span<double>(v.data(), count),
+        std::span<double>(w.data(), count),
+        std::span<const double>(cos_thetas.data(), count),
+        std::span<const double>(cos_phis.data(), count),
+        std::span<const double>(sin_phis.data(), count));
+
+    for(size_t i{0}; i < count; i++)
+    {
+      Particle &particle{particles[start + i]};
+
+      particle.setEnergy(scattered_energies[i]);
+      particle.setUnitDirection({u[i], v[i], w[i]});
+      deposited_energies[start + i] = energies[i] - scattered_energies[i];
+    }
+  }
+}
@@ -0,0 +1,262 @@
+// Implementation of the CsgGeometry class
+
+#include "CsgGeometry.hpp"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+int CsgGeometry::addSurface(std::unique_ptr<Surface> surface)
+{
+  if(surface == nullptr)
+  {
+    throw std::invalid_argument("Invalid surface: surface cannot be null");
+  }
+
+  surfaces.push_back(std::move(surface));
+
+  return static_cast<int>(surfaces.size()) - 1;
+}
+
+int CsgGeometry::addCell(const std::vector<CellSurface> &cell_surfaces,
+                         const Material *material)
+{
+  if(cell_surfaces.empty())
+  {
+    throw std::invalid_argument(
+        "Invalid cell: must be bounded by at least one surface");
+  }
+
+  Cell cell{cell_surfaces, material, BoundingBox()};
+
+  // Cell bounds are the overlap of its half-space bounds
+  for(const CellSurface &cell_surface : cell_surfaces)
+  {
+    const Surface &surface{*surfaces.at(cell_surface.surface)};
+
+    cell.bounds = cell.bounds.intersect((cell_surface.sense == Sense::INSIDE)
+                                            ? surface.getInsideBounds()
+                                            : surface.getOutsideBounds());
+  }
+
+  cells.push_back(cell);
+  built = false;
+
+  return static_cast<int>(cells.size()) - 1;
+}
+
+void CsgGeometry::build()
+{
+  nodes.clear();
+  cell_order.clear();
+  unbounded_cells.clear();
+
+  for(int i{0}; i < static_cast<int>(cells.size()); i++)
+  {
+    if(cells[i].bounds.isBounded())
+    {
+      cell_order.push_back(i);
+    }
+    else
+    {
+      unbounded_cells.push_back(i);
+    }
+  }
+
+  if(!cell_order.empty())
+  {
+    // Median splits give at most one leaf per cell, so 2n - 1 nodes at most
+    nodes.resize(2 * cell_order.size() - 1);
+
+    // Spawn threads until there are about as many subtrees as cores
+    int parallel_depth{0};
+    unsigned int cores{std::max(1u, std::thread::hardware_concurrency())};
+
+    while((1u << parallel_depth) < cores)
+    {
+      parallel_depth += 1;
+    }
+
+    std::atomic<int> next_node{1};
+
+    buildNode(0, 0, static_cast<int>(cell_order.size()), parallel_depth,
+              next_node);
+
+    nodes.resize(next_node.load());
+  }
+
+  built = true;
+}
+
+void CsgGeometry::buildNode(int node, int first, int count, int parallel_depth,
+                            std::atomic<int> &next_node)
+{
+  BoundingBox bounds{BoundingBox::empty()};
+  BoundingBox centroid_bounds{BoundingBox::empty()};
+
+  for(int i{first}; i < first + count; i++)
+  {
+    const BoundingBox &cell_bounds{cells[cell_order[i]].bounds};
+
+    bounds = bounds.merge(cell_bounds);
+    centroid_bounds = centroid_bounds.merge(cell_bounds.centroid());
+  }
+
+  nodes[node].bounds = bounds;
+
+  if(count <= GeometryConstants::BvhLeafSize)
+  {
+    nodes[node].left = -1;
+    nodes[node].right = -1;
+    nodes[node].first = first;
+    nodes[node].count = count;
+    return;
+  }
+
+  // Median split along the longest axis of the cell centroids
+  Vector3D extent{centroid_bounds.max - centroid_bounds.min};
+  int axis{0};
+
+  if(extent.getY() > extent.getX() && extent.getY() >= extent.getZ())
+  {
+    axis = 1;
+  }
+  else if(extent.getZ() > extent.getX() && extent.getZ() > extent.getY())
+  {
+    axis = 2;
+  }
+
+  auto centroid_coord{[this, axis](int cell)
+                      {
+                        Vector3D centroid{cells[cell].bounds.centroid()};
+                        return (axis == 0)   ? centroid.getX()
+                               : (axis == 1) ? centroid.getY()
+                                             : centroid.getZ();
+                      }};
+
+  int half{count / 2};
+
+  std::nth_element(cell_order.begin() + first,
+                   cell_order.begin() + first + half,
+                   cell_order.begin() + first + count,
+                   [&centroid_coord](int a, int b)
+                   { return centroid_coord(a) < centroid_coord(b); });
+
+  int left{next_node.fetch_add(2)};
+  int right{left + 1};
+
+  nodes[node].left = left;
+  nodes[node].right = right;
+  nodes[node].first = first;
+  nodes[node].count = 0;
+
+  // Subtrees cover disjoint node and cell ranges so they can be built
+  // concurrently
+  if(parallel_depth > 0 && count >= GeometryConstants::BvhParallelThreshold)
+  {
+    auto left_build{std::async(std::launch::async,
+                               [this, left, first, half, parallel_depth,
+                                &next_node]()
+                               {
+                                 buildNode(left, first, half,
+                                           parallel_depth - 1, next_node);
+                               })};
+
+    buildNode(right, first + half, count - half, parallel_depth - 1,
+              next_node);
+    left_build.get();
+  }
+  else
+  {
+    buildNode(left, first, half, 0, next_node);
+    buildNode(right, first + half, count - half, 0, next_node);
+  }
+}
+
+bool CsgGeometry::cellContains(int region, const Vector3D &position) const
+{
+  for(const CellSurface &cell_surface : cells[region].surfaces)
+  {
+    bool inside{surfaces[cell_surface.surface]->evaluate(position) < 0.0};
+
+    if(inside != (cell_surface.sense == Sense::INSIDE))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int CsgGeometry::findRegion(const Vector3D &position) const
+{
+  if(!built)
+  {
+    throw std::runtime_error("CsgGeometry must be built before it is queried");
+  }
+
+  if(!nodes.empty())
+  {
+    // Depth first traversal of every node whose box contains the position.
+    // Median splits keep the depth at log2(cells) so the stack cannot
+    // overflow.
+    int stack[64];
+    int stack_size{0};
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0)
+    {
+      const BvhNode &node{nodes[stack[--stack_size]]};
+
+      if(!node.bounds.contains(position))
+      {
+        continue;
+      }
+
+      if(node.left == -1)
+      {
+        for(int i{node.first}; i < node.first + node.count; i++)
+        {
+          if(cellContains(cell_order[i], position))
+          {
+            return cell_order[i];
+          }
+        }
+      }
+      else
+      {
+        stack[stack_size++] = node.right;
+        stack[stack_size++] = node.left;
+      }
+    }
+  }
+
+  for(int cell : unbounded_cells)
+  {
+    if(cellContains(cell, position))
+    {
+      return cell;
+    }
+  }
+
+  return -1;
+}
+
+double CsgGeometry::distanceToBoundary(const Vector3D &position,
+                                       const Vector3D &direction,
+                                       int region) const
+{
+  // The cell is left through whichever of its surfaces is crossed first
+  double distance{std::numeric_limits<double>::infinity()};
+
+  for(const CellSurface &cell_surface : cells.at(region).surfaces)
+  {
+    distance = std::min(
+        distance,
+        surfaces[cell_surface.surface]->distance(position, direction));
+  }
+
+  return distance;
+}
@@ -1,17 +1,43 @@
 // Implementation of the DataProcessor class
 
 #include "DataProcessor.hpp"
-#include "constants.hpp"
+#include "Constants.hpp"
+#include "Instrumentation.hpp"
+#include "Interpolation.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
+namespace
+{
+
+// 64 bit FNV-1a hash of file contents
+const std::uint64_t FnvOffsetBasis{0xcbf29ce484222325u};
+const std::uint64_t FnvPrime{0x100000001b3u};
+
+} // namespace
+
+thread_local std::shared_ptr<const XsLibrary> DataProcessor::thread_library;
+
+// Constructor
+DataProcessor::DataProcessor()
+    : current{nullptr}, library{std::make_shared<const XsLibrary>()},
+      stop_reloading{false}
+{
+  current.store(library.get(), std::memory_order_release);
+}
+
+DataProcessor::~DataProcessor() { stopReloading(); }
+
 DataProcessor &DataProcessor::getInstance()
 {
   static DataProcessor instance;
@@ -44,12 +70,76 @@ void DataProcessor::getDataFromFile(
     std::string &filepath, ParticleConstants::ParticleType particle_type,
     ElementConversion::Element element)
 {
+  std::lock_guard<std::mutex> lock(update_mutex);
+
   // Cancel if particle and element pair is already in the database
-  if(inDatabase(particle_type, element))
+  if(library->contains(particle_type, element))
   {
     return;
   }
 
+  NSE_TIME_SCOPE(LOAD);
+
+  FileStamp stamp;
+  std::string contents{readFile(filepath, stamp)};
+
+  // Every other table is shared with the current version
+  auto next{std::make_shared<XsLibrary>(*library)};
+  next->data[particle_type][element] =
+      parseElement(contents, particle_type, element, false);
+
+  stamps[particle_type][element] = stamp;
+  publish(std::move(next));
+}
+
+std::string DataProcessor::readFile(const std::string &filepath,
+                                    FileStamp &stamp)
+{
+  stamp = statFile(filepath);
+
+  std::ifstream file(filepath, std::ios::binary);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot read " + filepath);
+  }
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+
+  // FNV-1a
+  std::string contents_str{contents.str()};
+  stamp.hash = FnvOffsetBasis;
+
+  for(char byte : contents_str)
+  {
+    stamp.hash = (stamp.hash ^ static_cast<unsigned char>(byte)) * FnvPrime;
+  }
+
+  return contents_str;
+}
+
+DataProcessor::FileStamp DataProcessor::statFile(const std::string &filepath)
+{
+  std::error_code error;
+  std::uintmax_t size{std::filesystem::file_size(filepath, error)};
+  auto modified{std::filesystem::last_write_time(filepath, error)};
+
+  if(error)
+  {
+    throw std::runtime_error("Cannot read " + filepath + ": " +
+                             error.message());
+  }
+
+  return {size, static_cast<std::int64_t>(modified.time_since_epoch().count()),
+          0};
+}
+
+std::shared_ptr<const ElementXs>
+DataProcessor::parseElement(const std::string &contents,
+                            ParticleConstants::ParticleType particle_type,
+                            ElementConversion::Element element, bool check)
+{
   // Get number of columns in file based off particle type
   auto no_of_columns{FileConstants::ParticleFileColumnNumber.at(particle_type)};
 
@@ -69,14 +159,17 @@ void DataProcessor::getDataFromFile(
     throw std::invalid_argument("Invalid ParticleType");
   }
 
-  std::ifstream file(filepath);
+  std::istringstream file(contents);
 
   int xs_data_start_line{
       FileConstants::ParticleToDataStartLine.at(particle_type)};
 
   std::string line;
   int line_number{0};
-  std::vector<std::vector<double>> cross_sections;
+  auto element_xs{std::make_shared<ElementXs>()};
+  element_xs->particle_type = particle_type;
+  element_xs->element = element;
+  std::vector<std::vector<double>> &cross_sections{element_xs->rows};
 
   while(std::getline(file, line))
   {
@@ -92,15 +185,33 @@ void DataProcessor::getDataFromFile(
     cross_section_line =
         stringVecToDoubleVecScientificNotation(cross_section_line_str);
 
+    // A short row or energies going down means the file was cut short
+    if(check && (static_cast<int>(cross_section_line.size()) != no_of_columns ||
+                 (!cross_sections.empty() &&
+                  cross_section_line[FileConstants::EnergyColumn] <
+                      cross_sections.back()[FileConstants::EnergyColumn])))
+    {
+      throw std::runtime_error("Invalid row at line " +
+                               std::to_string(line_number));
+    }
+
     // Add to 2D cross section array
     cross_sections.push_back(cross_section_line);
   }
 
-  file.close();
+  if(check && cross_sections.empty())
+  {
+    throw std::runtime_error("No cross sections");
+  }
+
+  NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
 
-  // Add to the data map
-  data[particle_type][element] = cross_sections;
-  number_data_elements += 1;
+  if(numa_replicas.isEnabled())
+  {
+    element_xs->replicas = numa_replicas.replicate(cross_sections);
+  }
+
+  return element_xs;
 }
 
 std::vector<std::string> DataProcessor::manualSplit(const std::string &string,
@@ -187,164 +298,37 @@ DataProcessor::processFilePath(ParticleConstants::ParticleType particle_type,
   return filepath;
 }
 
-bool DataProcessor::inDatabase(ParticleConstants::ParticleType particle_type,
-                               ElementConversion::Element element)
+std::shared_ptr<const XsData> DataProcessor::getAllData() const
 {
-  if(data[particle_type].find(element) !=
-     data[particle_type].end()) // If an element for a given particletype is
-                                // already in the database then return true
-  {
-    return true;
-  }
+  std::shared_ptr<const XsLibrary> held{getLibrary()};
 
-  return false;
+  return {held, &held->getAllData()};
 }
 
-double DataProcessor::interpolateBetween(double value, double a1, double a2,
-                                         double b1, double b2) const
+std::shared_ptr<const std::vector<std::vector<double>>>
+DataProcessor::getData(ParticleConstants::ParticleType particle_type,
+                       ElementConversion::Element element)
 {
-  if(!(value > a1 && value < a2))
-  {
-    throw std::runtime_error("value must be between a1 and a2 (exclusively)");
-  }
-
-  // Transform to log space
-  double log_value{std::log(value)};
-  double log_a1{std::log(a1)};
-  double log_a2{std::log(a2)};
-  double log_b1{std::log(b1)};
-  double log_b2{std::log(b2)};
-
-  double proportion{(log_value - log_a1) / (log_a2 - log_a1)};
-  double log_result{log_b1 + (log_b2 - log_b1) * proportion};
-
-  // Transform back
-  double result{std::exp(log_result)};
+  // The tables of an element outlive the versions sharing them
+  std::shared_ptr<const ElementXs> element_xs{
+      getCurrent().getAllData().at(particle_type).at(element)};
 
-  return result;
+  return {element_xs, &element_xs->rows};
 }
 
-void DataProcessor::checkReaction(ParticleConstants::ParticleType particle_type,
-                                  ParticleConstants::ReactionType reaction)
+const CoherentSampler &
+DataProcessor::getCoherentSampler(ElementConversion::Element element) const
 {
-  auto particle_it{ParticleConstants::AllowedReactions.find(particle_type)};
-
-  if(particle_it != ParticleConstants::AllowedReactions.end())
-  {
-    // If in here then there are allowed reactions for the specified particle
-    if(particle_it->second.find(reaction) != particle_it->second.end())
-    {
-      return;
-    }
-  }
-
-  // Reaction not allowed
-  throw std::runtime_error("Invalid reaction: Particle enum " +
-                           std::to_string(static_cast<int>(particle_type)) +
-                           ", Reaction enum " +
-                           std::to_string(static_cast<int>(reaction)));
+  return getCurrent().getCoherentSampler(element);
 }
 
-const std::pair<size_t, size_t>
-DataProcessor::getAboveBelowIndices(double value,
-                                    std::vector<double> values) const
-{
-  // lower_bound gives first element >= target
-  auto it{std::lower_bound(values.begin(), values.end(), value)};
-
-  // If energy is too low
-  if(it == values.begin())
-  {
-    // Check for lower bound
-    if(value == values[0])
-    {
-      return std::make_pair(0, 0);
-    }
-    throw std::runtime_error("Value below range");
-  }
-  if(it == values.end())
-  {
-    throw std::runtime_error("Value above range");
-  }
-
-  size_t upper_index{static_cast<size_t>(std::distance(values.begin(), it))};
-
-  size_t max_index{values.size() - 1};
-
-  // Edge case: if at a k-edge then value == values[upper_index] ==
-  // values[upper_index + 1]
-  // First check that we're not at the end
-  if(upper_index < max_index)
-  {
-    // Check for k-edge
-    if(value == values[upper_index + 1])
-    {
-      // At k-edge so return both of the larger indices
-      upper_index += 1;
-
-      return std::make_pair(upper_index, upper_index);
-    }
-  }
-
-  // Also check if value exactly matches
-  if(value == values[upper_index])
-  {
-    return std::make_pair(upper_index, upper_index);
-  }
-
-  size_t lower_index{upper_index - 1};
-
-  return std::make_pair(upper_index, lower_index);
-}
-
-const double
+double
 DataProcessor::getAttenCoef(double energy,
                             ParticleConstants::ReactionType reaction,
                             ParticleConstants::ParticleType particle_type,
                             ElementConversion::Element element)
 {
-  // Files are formatted with energy going low to high and when there are
-  // k-edges the photon energy will be duplicated with lower mass attenuation
-  // coefs above, hence just have to search for the energy values closest to the
-  // energy we're searching and verify that their indices are +-1 of each other.
-
-  // Check that the reaction is allowed, throws if not allowed
-  checkReaction(particle_type, reaction);
-
-  const std::vector<std::vector<double>> &data_{
-      data.at(particle_type).at(element)}; // Throws if not found
-
-  size_t reaction_column{FileConstants::ReactionToColumn.at(particle_type)
-                             .at(reaction)}; // Throws if not found
-
-  std::vector<double> energies;
-
-  for(const std::vector<double> &line : data_)
-  {
-    energies.push_back(line[FileConstants::EnergyColumn]);
-  }
-
-  std::pair<size_t, size_t> above_below_indices{
-      getAboveBelowIndices(energy, energies)};
-
-  size_t index1{above_below_indices.second};
-  size_t index2{above_below_indices.first};
-
-  // Edge case
-  if(index1 == index2)
-  {
-    return data_[index1][reaction_column];
-  }
-
-  double energy1{energies[index1]};
-  double energy2{energies[index2]};
-  double mass_atten_coef1{data_[index1][reaction_column]};
-  double mass_atten_coef2{data_[index2][reaction_column]};
-
-  double interpolated_mass_atten_coef{interpolateBetween(
-      energy, energy1, energy2, mass_atten_coef1, mass_atten_coef2)};
-
-  return interpolated_mass_atten_coef;
+  return getCurrent().getAttenCoef(energy, reaction, particle_type, element);
 }
 
 const std::vector<double>
@@ -401,4 +385,228 @@ void DataProcessor::addDataMultipleFiles(
 
     addDataSingleFile(particle_type, element);
   }
-}
\ No newline at end of file
+}
+
+std::shared_ptr<const XsLibrary> DataProcessor::getLibrary() const
+{
+  std::lock_guard<std::mutex> lock(library_mutex);
+
+  return library;
+}
+
+void DataProcessor::publish(std::shared_ptr<XsLibrary> next)
+{
+  next->version = library->getVersion() + 1;
+
+  std::shared_ptr<const XsLibrary> replaced;
+
+  {
+    std::lock_guard<std::mutex> lock(library_mutex);
+
+    replaced = std::move(library);
+    library = std::move(next);
+    current.store(library.get(), std::memory_order_release);
+  }
+
+  // Freed here unless a query or a thread's lookups still hold it
+}
+
+void DataProcessor::buildMajorants(XsLibrary &library)
+{
+  library.majorants.clear();
+
+  if(library.materials.empty())
+  {
+    return;
+  }
+
+  std::vector<const Material *> materials;
+
+  for(const auto &material : library.materials)
+  {
+    materials.push_back(material.get());
+  }
+
+  for(const auto &particle_path : FileConstants::ParticleToFilePath)
+  {
+    library.majorants[particle_path.first] =
+        std::make_shared<const MajorantTable>(materials, particle_path.first);
+  }
+}
+
+size_t DataProcessor::addMaterial(const Material &material)
+{
+  std::lock_guard<std::mutex> lock(update_mutex);
+
+  // Rebuilt in case a reload came between building material and now
+  auto next{std::make_shared<XsLibrary>(*library)};
+  next->materials.push_back(
+      std::make_shared<const Material>(material.rebuiltFrom(*next)));
+  buildMajorants(*next);
+
+  size_t index{next->materials.size() - 1};
+  publish(std::move(next));
+
+  return index;
+}
+
+ReloadReport DataProcessor::reload(ReloadCheck check)
+{
+  std::lock_guard<std::mutex> lock(update_mutex);
+
+  // Only replaced under update_mutex, so stays current until the publish
+  std::shared_ptr<const XsLibrary> old_library{library};
+
+  ReloadReport report{old_library->getVersion(), {}, 0, {}};
+  std::shared_ptr<XsLibrary> next;
+
+  // Stamps are only updated once what they describe is published
+  std::vector<std::tuple<ParticleConstants::ParticleType,
+                         ElementConversion::Element, FileStamp>>
+      new_stamps;
+
+  for(const auto &[particle_type, elements] : old_library->getAllData())
+  {
+    for(const auto &[element, element_xs] : elements)
+    {
+      std::string filepath{processFilePath(particle_type, element)};
+      const FileStamp &stamp{stamps.at(particle_type).at(element)};
+
+      try
+      {
+        FileStamp new_stamp{statFile(filepath)};
+
+        if(check == ReloadCheck::MODIFIED && new_stamp.size == stamp.size &&
+           new_stamp.modified == stamp.modified)
+        {
+          continue;
+        }
+
+        std::string contents{readFile(filepath, new_stamp)};
+
+        // Touched but not changed
+        if(new_stamp.hash == stamp.hash)
+        {
+          new_stamps.emplace_back(particle_type, element, new_stamp);
+          continue;
+        }
+
+        std::shared_ptr<const ElementXs> reparsed{
+            parseElement(contents, particle_type, element, true)};
+
+        if(!next)
+        {
+          next = std::make_shared<XsLibrary>(*old_library);
+        }
+
+        next->data[particle_type][element] = std::move(reparsed);
+        new_stamps.emplace_back(particle_type, element, new_stamp);
+        report.reparsed.emplace_back(particle_type, element);
+      }
+      catch(const std::exception &error)
+      {
+        report.errors.push_back(filepath + ": " + error.what());
+      }
+    }
+  }
+
+  if(next)
+  {
+    // Materials without a reparsed element keep their tables, and if every
+    // material does the majorants stay too
+    for(auto &material : next->materials)
+    {
+      bool affected{false};
+
+      for(const auto &[particle_type, element] : report.reparsed)
+      {
+        for(const auto &element_fraction : material->getComposition())
+        {
+          affected = affected || element_fraction.first == element;
+        }
+      }
+
+      if(affected)
+      {
+        material = std::make_shared<const Material>(
+            material->rebuiltFrom(*next));
+        report.no_rebuilt_materials += 1;
+      }
+    }
+
+    if(report.no_rebuilt_materials > 0)
+    {
+      buildMajorants(*next);
+    }
+
+    publish(next);
+    report.version = next->version;
+  }
+
+  for(const auto &[particle_type, element, new_stamp] : new_stamps)
+  {
+    stamps[particle_type][element] = new_stamp;
+  }
+
+  return report;
+}
+
+void DataProcessor::startReloading(
+    double interval_seconds,
+    std::function<void(const ReloadReport &)> on_reload)
+{
+  if(!(interval_seconds > 0.0))
+  {
+    throw std::invalid_argument("Invalid reload interval: must be greater "
+                                "than 0");
+  }
+
+  stopReloading();
+  stop_reloading = false;
+
+  reloader = std::thread(
+      [this, interval_seconds, on_reload]
+      {
+        std::unique_lock<std::mutex> lock(reloader_mutex);
+
+        while(!reloader_wake.wait_for(
+            lock, std::chrono::duration<double>(interval_seconds),
+            [this] { return stop_reloading; }))
+        {
+          lock.unlock();
+
+          ReloadReport report;
+
+          try
+          {
+            report = reload();
+          }
+          catch(const std::exception &error)
+          {
+            report = {getLibrary()->getVersion(), {}, 0, {error.what()}};
+          }
+
+          if(on_reload && (!report.reparsed.empty() || !report.errors.empty()))
+          {
+            on_reload(report);
+          }
+
+          lock.lock();
+        }
+      });
+}
+
+void DataProcessor::stopReloading()
+{
+  {
+    std::lock_guard<std::mutex> lock(reloader_mutex);
+    stop_reloading = true;
+  }
+
+  reloader_wake.notify_all();
+
+  if(reloader.joinable())
+  {
+    reloader.join();
+  }
+}
@@ -0,0 +1,98 @@
+// Implementation of the GPBuildup class
+
+#include "GPBuildup.hpp"
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+GPBuildup::GPBuildup(const std::vector<GPCoefficients> &table_)
+    : table{table_}
+{
+  checkTable();
+}
+
+void GPBuildup::checkTable() const
+{
+  if(table.empty())
+  {
+    throw std::invalid_argument("Invalid GP table: table cannot be empty");
+  }
+
+  for(size_t i{0}; i < table.size(); i++)
+  {
+    if(!(table[i].energy > 0.0) ||
+       (i > 0 && !(table[i].energy > table[i - 1].energy)))
+    {
+      throw std::invalid_argument("Invalid GP table: energies must be "
+                                  "positive and strictly increasing");
+    }
+
+    if(!(table[i].b >= 1.0) || !(table[i].xk > 0.0))
+    {
+      throw std::invalid_argument("Invalid GP table: b must be at least 1 and "
+                                  "Xk greater than 0");
+    }
+  }
+}
+
+GPCoefficients GPBuildup::getCoefficients(double energy) const
+{
+  if(energy < table.front().energy || energy > table.back().energy)
+  {
+    throw std::runtime_error("Energy outside GP table range");
+  }
+
+  // First row with energy >= target
+  auto upper{std::lower_bound(table.begin(), table.end(), energy,
+                              [](const GPCoefficients &row, double target)
+                              { return row.energy < target; })};
+
+  if(upper->energy == energy)
+  {
+    return *upper;
+  }
+
+  const GPCoefficients &row1{*(upper - 1)};
+  const GPCoefficients &row2{*upper};
+
+  // Coefficients change sign across tables so interpolate lin-log
+  double proportion{std::log(energy / row1.energy) /
+                    std::log(row2.energy / row1.energy)};
+  auto interpolate{[proportion](double value1, double value2)
+                   { return value1 + (value2 - value1) * proportion; }};
+
+  return {energy,
+          interpolate(row1.b, row2.b),
+          interpolate(row1.c, row2.c),
+          interpolate(row1.a, row2.a),
+          interpolate(row1.xk, row2.xk),
+          interpolate(row1.d, row2.d)};
+}
+
+double GPBuildup::evaluate(const GPCoefficients &coefficients,
+                           double mean_free_paths)
+{
+  double x{mean_free_paths};
+
+  if(!(x > 0.0))
+  {
+    return 1.0;
+  }
+
+  const double tanh_minus_two{std::tanh(-2.0)};
+  double k{coefficients.c * std::pow(x, coefficients.a) +
+           coefficients.d * (std::tanh(x / coefficients.xk - 2.0) -
+                             tanh_minus_two) /
+               (1.0 - tanh_minus_two)};
+
+  // Limit of the progression as K tends to 1
+  if(std::abs(k - 1.0) < PointKernelConstants::GPUnitRatioTolerance)
+  {
+    return 1.0 + (coefficients.b - 1.0) * x;
+  }
+
+  return 1.0 + (coefficients.b - 1.0) * (std::pow(k, x) - 1.0) / (k - 1.0);
+}
@@ -0,0 +1,24 @@
+// Implementation of the shared Geometry methods
+
+#include "Geometry.hpp"
+
+#include <algorithm>
+
+std::vector<const Material *> Geometry::getMaterials() const
+{
+  std::vector<const Material *> materials;
+
+  for(int region{0}; region < getNumberRegions(); region++)
+  {
+    const Material *material{getMaterial(region)};
+
+    if(material != nullptr &&
+       std::find(materials.begin(), materials.end(), material) ==
+           materials.end())
+    {
+      materials.push_back(material);
+    }
+  }
+
+  return materials;
+}
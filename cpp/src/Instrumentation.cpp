@@ -0,0 +1,164 @@
+// Implementation of the Instrumentation counters
+
+#include "Instrumentation.hpp"
+
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Instrumentation
+{
+
+namespace
+{
+
+const std::array<std::string, NoCounters> CounterNames{
+    "xs_lookups",    "material_lookups", "bin_searches",
+    "k_edge_hits",   "rng_draws",        "boundary_crossings",
+    "xs_cache_hits", "xs_cache_misses"};
+
+const std::array<std::string, NoReactions> ReactionNames{
+    "coherent",      "incoherent",          "photoelectric",
+    "nuclear_pair",  "electron_pair",       "total_with_coherent",
+    "total_without_coherent"};
+
+const std::array<std::string, NoPhases> PhaseNames{"load", "lookup",
+                                                   "transport"};
+
+// Period over which the tick rate is measured
+const std::chrono::milliseconds TickCalibrationTime{20};
+
+std::mutex finished_mutex;
+Totals finished_totals;
+
+double measureTicksPerSecond()
+{
+  auto start{std::chrono::steady_clock::now()};
+  std::uint64_t start_ticks{readTicks()};
+
+  std::this_thread::sleep_for(TickCalibrationTime);
+
+  std::uint64_t ticks{readTicks() - start_ticks};
+  double seconds{
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count()};
+
+  return ticks / seconds;
+}
+
+} // namespace
+
+Totals &Totals::operator+=(const Totals &other)
+{
+  for(size_t i{0}; i < NoCounters; i++)
+  {
+    counters[i] += other.counters[i];
+  }
+
+  for(size_t i{0}; i < NoReactions; i++)
+  {
+    collisions[i] += other.collisions[i];
+  }
+
+  for(size_t i{0}; i < NoPhases; i++)
+  {
+    phase_calls[i] += other.phase_calls[i];
+    phase_ticks[i] += other.phase_ticks[i];
+  }
+
+  return *this;
+}
+
+ThreadTotals::~ThreadTotals()
+{
+  std::lock_guard<std::mutex> lock(finished_mutex);
+  finished_totals += totals;
+}
+
+Totals getTotals()
+{
+  Totals totals{ThreadTotals::get().getTotals()};
+
+  std::lock_guard<std::mutex> lock(finished_mutex);
+  totals += finished_totals;
+
+  return totals;
+}
+
+void reset()
+{
+  ThreadTotals::get().getTotals() = Totals{};
+
+  std::lock_guard<std::mutex> lock(finished_mutex);
+  finished_totals = Totals{};
+}
+
+double getTicksPerSecond()
+{
+  static const double ticks_per_second{measureTicksPerSecond()};
+
+  return ticks_per_second;
+}
+
+void writeJson(std::ostream &os, const Totals &totals)
+{
+  double ticks_per_second{getTicksPerSecond()};
+
+  os << "{\n  \"counters\": {";
+
+  for(size_t i{0}; i < NoCounters; i++)
+  {
+    os << (i == 0 ? "\n" : ",\n") << "    \"" << CounterNames[i]
+       << "\": " << totals.counters[i];
+  }
+
+  os << "\n  },\n  \"collisions\": {";
+
+  for(size_t i{0}; i < NoReactions; i++)
+  {
+    os << (i == 0 ? "\n" : ",\n") << "    \"" << ReactionNames[i]
+       << "\": " << totals.collisions[i];
+  }
+
+  os << "\n  },\n  \"phases\": {";
+
+  for(size_t i{0}; i < NoPhases; i++)
+  {
+    os << (i == 0 ? "\n" : ",\n") << "    \"" << PhaseNames[i]
+       << "\": {\"calls\": " << totals.phase_calls[i]
+       << ", \"ticks\": " << totals.phase_ticks[i]
+       << ", \"seconds\": " << totals.phase_ticks[i] / ticks_per_second << "}";
+  }
+
+  os << "\n  },\n  \"ticks_per_second\": " << ticks_per_second << "\n}\n";
+}
+
+void writeCsv(std::ostream &os, const Totals &totals)
+{
+  double ticks_per_second{getTicksPerSecond()};
+
+  os << "section,name,value\n";
+
+  for(size_t i{0}; i < NoCounters; i++)
+  {
+    os << "counter," << CounterNames[i] << "," << totals.counters[i] << "\n";
+  }
+
+  for(size_t i{0}; i < NoReactions; i++)
+  {
+    os << "collisions," << ReactionNames[i] << "," << totals.collisions[i]
+       << "\n";
+  }
+
+  for(size_t i{0}; i < NoPhases; i++)
+  {
+    os << "phase_calls," << PhaseNames[i] << "," << totals.phase_calls[i]
+       << "\n";
+    os << "phase_ticks," << PhaseNames[i] << "," << totals.phase_ticks[i]
+       << "\n";
+    os << "phase_seconds," << PhaseNames[i] << ","
+       << totals.phase_ticks[i] / ticks_per_second << "\n";
+  }
+}
+
+} // namespace Instrumentation
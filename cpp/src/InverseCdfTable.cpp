@@ -0,0 +1,145 @@
+// Implementation of the InverseCdfTable class
+
+#include "InverseCdfTable.hpp"
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+InverseCdfTable::InverseCdfTable(
+    double min_energy, double max_energy, int no_energies_, int no_quantiles_,
+    const std::function<double(double, double)> &pdf,
+    const std::function<std::pair<double, double>(double)> &support,
+    QuantileSpacing spacing_)
+    : no_energies{no_energies_}, no_quantiles{no_quantiles_},
+      spacing{spacing_}
+{
+  if(!(min_energy > 0.0 && max_energy > min_energy) || no_energies < 2 ||
+     no_quantiles < 2)
+  {
+    throw std::invalid_argument("Invalid InverseCdfTable dimensions");
+  }
+
+  log_min_energy = std::log(min_energy);
+  inverse_log_step =
+      (no_energies - 1) / (std::log(max_energy) - log_min_energy);
+
+  quantiles.resize(static_cast<size_t>(no_energies) * no_quantiles);
+
+  for(int row{0}; row < no_energies; row++)
+  {
+    double energy{std::exp(log_min_energy + row / inverse_log_step)};
+    std::pair<double, double> bounds{support(energy)};
+
+    buildRow(row, energy, pdf, bounds.first, bounds.second);
+  }
+}
+
+void InverseCdfTable::buildRow(
+    int row, double energy, const std::function<double(double, double)> &pdf,
+    double low, double high)
+{
+  const int no_points{SamplingConstants::TableIntegrationPoints};
+
+  // Offsets from both ends spaced geometrically from 1e-12 of the range up to
+  // half of it, so narrow peaks and steep edges at either end are resolved
+  std::vector<double> xs(no_points);
+  int half{no_points / 2};
+  double middle{0.5 * (low + high)};
+  double ratio{std::pow(1e-12, 1.0 / (half - 2))};
+
+  xs[0] = low;
+  xs[half - 1] = middle;
+  xs[no_points - 1] = high;
+
+  for(int i{half - 2}; i > 0; i--)
+  {
+    xs[i] = low + (xs[i + 1] - low) * ratio;
+  }
+
+  for(int i{half}; i < no_points - 1; i++)
+  {
+    xs[i] = high - (high - xs[i - 1]) * ratio;
+  }
+
+  // Trapezoidal cumulative integral
+  std::vector<double> cdf(no_points, 0.0);
+  double previous_pdf{pdf(energy, xs[0])};
+
+  for(int i{1}; i < no_points; i++)
+  {
+    double current_pdf{pdf(energy, xs[i])};
+    cdf[i] = cdf[i - 1] +
+             0.5 * (previous_pdf + current_pdf) * (xs[i] - xs[i - 1]);
+    previous_pdf = current_pdf;
+  }
+
+  if(!(cdf.back() > 0.0))
+  {
+    throw std::runtime_error("InverseCdfTable pdf integrates to zero");
+  }
+
+  // Invert at the quantiles' cumulative probabilities
+  float *row_quantiles{&quantiles[static_cast<size_t>(row) * no_quantiles]};
+  int point{1};
+
+  for(int j{0}; j < no_quantiles; j++)
+  {
+    double position{static_cast<double>(j) / (no_quantiles - 1)};
+    double probability{(spacing == QuantileSpacing::REFINED_HIGH)
+                           ? 1.0 - (1.0 - position) * (1.0 - position)
+                           : position};
+    double target{cdf.back() * probability};
+
+    while(point < no_points - 1 && cdf[point] < target)
+    {
+      point += 1;
+    }
+
+    double cell{cdf[point] - cdf[point - 1]};
+    double fraction{(cell > 0.0) ? (target - cdf[point - 1]) / cell : 0.0};
+    fraction = std::clamp(fraction, 0.0, 1.0);
+
+    row_quantiles[j] = static_cast<float>(
+        xs[point - 1] + fraction * (xs[point] - xs[point - 1]));
+  }
+}
+
+double InverseCdfTable::sample(double energy, double uniform) const
+{
+  // Position between energy rows
+  double energy_position{(std::log(energy) - log_min_energy) *
+                         inverse_log_step};
+  energy_position =
+      std::clamp(energy_position, 0.0, static_cast<double>(no_energies - 1));
+
+  int row{std::min(static_cast<int>(energy_position), no_energies - 2)};
+  double energy_fraction{energy_position - row};
+
+  // Position between quantiles, inverting the spacing of their probabilities
+  if(spacing == QuantileSpacing::REFINED_HIGH)
+  {
+    uniform = 1.0 - std::sqrt(std::max(1.0 - uniform, 0.0));
+  }
+
+  double quantile_position{uniform * (no_quantiles - 1)};
+  quantile_position = std::clamp(quantile_position, 0.0,
+                                 static_cast<double>(no_quantiles - 1));
+
+  int quantile{
+      std::min(static_cast<int>(quantile_position), no_quantiles - 2)};
+  double quantile_fraction{quantile_position - quantile};
+
+  const float *lower_row{&quantiles[static_cast<size_t>(row) * no_quantiles +
+                                    quantile]};
+  const float *upper_row{lower_row + no_quantiles};
+
+  double lower{lower_row[0] +
+               quantile_fraction * (lower_row[1] - lower_row[0])};
+  double upper{upper_row[0] +
+               quantile_fraction * (upper_row[1] - upper_row[0])};
+
+  return lower + energy_fraction * (upper - lower);
+}
@@ -0,0 +1,116 @@
+// Implementation of the MajorantTable class
+
+#include "MajorantTable.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Constructor
+MajorantTable::MajorantTable(const std::vector<const Material *> &materials,
+                             ParticleConstants::ParticleType particle_type)
+{
+  if(materials.empty())
+  {
+    throw std::invalid_argument(
+        "Invalid majorant table: must have at least one material");
+  }
+
+  for(const Material *material : materials)
+  {
+    for(const std::vector<double> &row : material->getTable(particle_type))
+    {
+      energies.push_back(row[FileConstants::EnergyColumn]);
+    }
+  }
+
+  // k-edge duplicates are dropped, the edge becomes an interval boundary
+  std::sort(energies.begin(), energies.end());
+  energies.erase(std::unique(energies.begin(), energies.end()),
+                 energies.end());
+
+  const auto &allowed_reactions{
+      ParticleConstants::AllowedReactions.at(particle_type)};
+  const auto &reaction_columns{
+      FileConstants::ReactionToColumn.at(particle_type)};
+
+  // Total coef of a material at energy, taken from one side of any k-edge
+  auto total_coef{
+      [&](const Material *material, double energy, Interpolation::Side side)
+      {
+        double total{0.0};
+
+        for(const auto &reaction : allowed_reactions)
+        {
+          total += Interpolation::interpolateColumn(
+              energy, material->getTable(particle_type),
+              reaction_columns.at(reaction), side);
+        }
+
+        return total;
+      }};
+
+  majorants.resize(energies.size() - 1, 0.0);
+
+  for(size_t i{0}; i + 1 < energies.size(); i++)
+  {
+    // Every material grid point is on the union grid, so within an interval
+    // each interpolated partial is the exponential of a linear function of
+    // log energy. That is convex, the sum of partials is too, and so the
+    // total is largest at one of the two ends of the interval.
+    for(const Material *material : materials)
+    {
+      double low_end{
+          total_coef(material, energies[i], Interpolation::Side::ABOVE)};
+      double high_end{
+          total_coef(material, energies[i + 1], Interpolation::Side::BELOW)};
+
+      majorants[i] = std::max({majorants[i], low_end, high_end});
+    }
+  }
+
+  NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
+
+  if(numa_replicas.isEnabled())
+  {
+    replica_energies = numa_replicas.replicate(energies);
+    replica_majorants = numa_replicas.replicate(majorants);
+  }
+}
+
+double MajorantTable::getMajorant(double energy) const
+{
+  const double *grid{energies.data()};
+  const double *values{majorants.data()};
+
+  // Replica local to the calling thread if there is one
+  if(!replica_energies.empty())
+  {
+    int node{NumaReplicas::getInstance().getThreadNode()};
+    grid = replica_energies[node].get();
+    values = replica_majorants[node].get();
+  }
+
+  // upper_bound gives the first grid energy > energy, the interval is the one
+  // before it
+  const double *it{std::upper_bound(grid, grid + energies.size(), energy)};
+
+  if(it == grid)
+  {
+    throw std::runtime_error("Value below range");
+  }
+
+  size_t interval{static_cast<size_t>(it - grid) - 1};
+
+  // The top of the grid belongs to the last interval
+  if(interval == majorants.size())
+  {
+    if(energy == grid[interval])
+    {
+      return values[interval - 1];
+    }
+    throw std::runtime_error("Value above range");
+  }
+
+  return values[interval];
+}
@@ -0,0 +1,305 @@
+// Implementation of the Material class
+
+#include "Material.hpp"
+#include "CrossSectionCache.hpp"
+#include "DataProcessor.hpp"
+#include "Instrumentation.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+
+// Next id handed to a Material, 0 is never used
+std::atomic<std::uint64_t> next_material_id{1};
+
+// Sum of the allowed reaction coefs at energy, reusing the bin of the last
+// lookup of the material when energy is strictly inside it. Works on the
+// tables and on their replicas.
+template <typename Table>
+double lookupTotal(std::uint64_t material_id, const Table &table,
+                   double energy, ParticleConstants::ParticleType particle_type,
+                   CrossSectionCache &cache)
+{
+  const size_t energy_column{FileConstants::EnergyColumn};
+
+  // Once found, the bin serves every reaction
+  std::pair<size_t, size_t> above_below_indices;
+  const CrossSectionCache::Entry *last{
+      cache.findBin(material_id, particle_type)};
+
+  if(last != nullptr && last->above_below_indices.first < table.size() &&
+     last->above_below_indices.first == last->above_below_indices.second + 1 &&
+     table[last->above_below_indices.second][energy_column] < energy &&
+     energy < table[last->above_below_indices.first][energy_column])
+  {
+    above_below_indices = last->above_below_indices;
+  }
+  else
+  {
+    above_below_indices = Interpolation::getAboveBelowIndices(energy, table);
+  }
+
+  double total{0.0};
+
+  for(const auto &reaction :
+      ParticleConstants::AllowedReactions.at(particle_type))
+  {
+    size_t reaction_column{
+        FileConstants::ReactionToColumn.at(particle_type).at(reaction)};
+
+    total += Interpolation::interpolateBetweenRows(energy, table,
+                                                   reaction_column,
+                                                   above_below_indices);
+  }
+
+  cache.store(
+      {energy, material_id, particle_type, above_below_indices, total});
+
+  return total;
+}
+
+} // namespace
+
+// Constructor
+Material::Material(
+    const std::string &name_, double density_,
+    const std::vector<std::pair<ElementConversion::Element, double>>
+        &composition_)
+    : name{name_}, id{next_material_id++}, density{density_},
+      composition{composition_}
+{
+  checkComposition();
+
+  // Normalise mass fractions
+  double fraction_sum{0.0};
+
+  for(const auto &element_fraction : composition)
+  {
+    fraction_sum += element_fraction.second;
+  }
+
+  for(auto &element_fraction : composition)
+  {
+    element_fraction.second /= fraction_sum;
+  }
+
+  // Build a table for every particle type that has data files, from one
+  // version of the data
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  for(const auto &particle_path : FileConstants::ParticleToFilePath)
+  {
+    for(const auto &element_fraction : composition)
+    {
+      data_processor.addDataSingleFile(particle_path.first,
+                                       element_fraction.first);
+    }
+  }
+
+  std::shared_ptr<const XsLibrary> library{data_processor.getLibrary()};
+
+  for(const auto &particle_path : FileConstants::ParticleToFilePath)
+  {
+    buildTable(particle_path.first, *library);
+  }
+}
+
+Material Material::rebuiltFrom(const XsLibrary &library) const
+{
+  Material rebuilt{*this};
+  rebuilt.id = next_material_id++;
+  rebuilt.tables.clear();
+  rebuilt.replica_tables.clear();
+
+  for(const auto &particle_path : FileConstants::ParticleToFilePath)
+  {
+    rebuilt.buildTable(particle_path.first, library);
+  }
+
+  return rebuilt;
+}
+
+Material Material::fromFormula(
+    const std::string &name_, double density_,
+    const std::vector<std::pair<ElementConversion::Element, double>>
+        &atoms_per_molecule)
+{
+  std::vector<std::pair<ElementConversion::Element, double>> mass_fractions;
+
+  for(const auto &element_atoms : atoms_per_molecule)
+  {
+    double element_mass{
+        ElementConversion::ElementalMasses.at(element_atoms.first)};
+
+    mass_fractions.push_back(
+        {element_atoms.first, element_atoms.second * element_mass});
+  }
+
+  return Material(name_, density_, mass_fractions);
+}
+
+void Material::checkComposition() const
+{
+  if(!(density > 0.0))
+  {
+    throw std::invalid_argument("Invalid material density: density must be "
+                                "greater than 0");
+  }
+
+  if(composition.empty())
+  {
+    throw std::invalid_argument(
+        "Invalid material composition: composition cannot be empty");
+  }
+
+  for(const auto &element_fraction : composition)
+  {
+    if(!(element_fraction.second > 0.0))
+    {
+      throw std::invalid_argument("Invalid material composition: fractions "
+                                  "must be greater than 0");
+    }
+  }
+}
+
+void Material::buildTable(ParticleConstants::ParticleType particle_type,
+                          const XsLibrary &library)
+{
+  // Union of all element energy grids. An energy appears as many times as it
+  // does in any single element so that k-edges stay duplicated.
+  std::map<double, int> energy_multiplicities;
+
+  for(const auto &element_fraction : composition)
+  {
+    std::map<double, int> element_multiplicities;
+
+    for(const std::vector<double> &row :
+        library.getData(particle_type, element_fraction.first))
+    {
+      element_multiplicities[row[FileConstants::EnergyColumn]] += 1;
+    }
+
+    for(const auto &energy_count : element_multiplicities)
+    {
+      int &multiplicity{energy_multiplicities[energy_count.first]};
+      multiplicity = std::max(multiplicity, energy_count.second);
+    }
+  }
+
+  auto no_of_columns{FileConstants::ParticleFileColumnNumber.at(particle_type)};
+
+  MaterialXsTable table;
+
+  for(const auto &energy_count : energy_multiplicities)
+  {
+    double energy{energy_count.first};
+
+    for(int i{0}; i < energy_count.second; i++)
+    {
+      // First of a duplicated pair takes the values below the edge
+      Interpolation::Side side{(i + 1 < energy_count.second)
+                                   ? Interpolation::Side::BELOW
+                                   : Interpolation::Side::ABOVE};
+
+      std::vector<double> row(no_of_columns, 0.0);
+      row[FileConstants::EnergyColumn] = energy;
+
+      // Linear attenuation coef is the density weighted sum of the element
+      // mass attenuation coefs
+      for(const auto &element_fraction : composition)
+      {
+        const std::vector<std::vector<double>> &element_data{
+            library.getData(particle_type, element_fraction.first)};
+
+        for(int column{0}; column < no_of_columns; column++)
+        {
+          if(column == FileConstants::EnergyColumn)
+          {
+            continue;
+          }
+
+          row[column] += density * element_fraction.second *
+                         Interpolation::interpolateColumn(energy, element_data,
+                                                          column, side);
+        }
+      }
+
+      table.push_back(row);
+    }
+  }
+
+  tables[particle_type] = table;
+
+  NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
+
+  if(numa_replicas.isEnabled())
+  {
+    replica_tables[particle_type] = numa_replicas.replicate(table);
+  }
+}
+
+const FlatTable *
+Material::getLocalReplica(ParticleConstants::ParticleType particle_type) const
+{
+  auto replicas{replica_tables.find(particle_type)};
+
+  if(replicas == replica_tables.end())
+  {
+    return nullptr;
+  }
+
+  return &replicas->second[NumaReplicas::getInstance().getThreadNode()];
+}
+
+double Material::getLinearAttenCoef(
+    double energy, ParticleConstants::ReactionType reaction,
+    ParticleConstants::ParticleType particle_type) const
+{
+  NSE_COUNT(MATERIAL_LOOKUPS);
+  NSE_TIME_SCOPE(LOOKUP);
+
+  size_t reaction_column{FileConstants::ReactionToColumn.at(particle_type)
+                             .at(reaction)}; // Throws if not found
+
+  if(const FlatTable *local{getLocalReplica(particle_type)})
+  {
+    return Interpolation::interpolateColumn(energy, *local, reaction_column);
+  }
+
+  return Interpolation::interpolateColumn(energy, getTable(particle_type),
+                                          reaction_column);
+}
+
+double Material::getTotalLinearAttenCoef(
+    double energy, ParticleConstants::ParticleType particle_type) const
+{
+  NSE_COUNT(MATERIAL_LOOKUPS);
+  NSE_TIME_SCOPE(LOOKUP);
+
+  CrossSectionCache &cache{CrossSectionCache::getThreadCache()};
+
+  const CrossSectionCache::Entry *cached{
+      cache.find(energy, id, particle_type)};
+
+  if(cached != nullptr)
+  {
+    NSE_COUNT(XS_CACHE_HITS);
+    return cached->total;
+  }
+
+  NSE_COUNT(XS_CACHE_MISSES);
+
+  if(const FlatTable *local{getLocalReplica(particle_type)})
+  {
+    return lookupTotal(id, *local, energy, particle_type, cache);
+  }
+
+  return lookupTotal(id, getTable(particle_type), energy, particle_type,
+                     cache);
+}
@@ -0,0 +1,336 @@
+// Implementation of the NumaReplicas class
+
+#include "NumaReplicas.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace
+{
+
+// Numbers of a kernel list such as "0-3,8-11", empty if unreadable
+std::vector<int> readList(const std::string &path)
+{
+  std::ifstream file(path);
+  std::string list;
+  std::vector<int> numbers;
+
+  if(!std::getline(file, list))
+  {
+    return numbers;
+  }
+
+  std::istringstream ranges(list);
+  std::string range;
+
+  while(std::getline(ranges, range, ','))
+  {
+    if(range.empty())
+    {
+      continue;
+    }
+
+    size_t dash{range.find('-')};
+    int first{std::stoi(range.substr(0, dash))};
+    int last{dash == std::string::npos ? first
+                                       : std::stoi(range.substr(dash + 1))};
+
+    for(int number{first}; number <= last; number++)
+    {
+      numbers.push_back(number);
+    }
+  }
+
+  return numbers;
+}
+
+// Chunks can outlive the singleton, in tables of other static objects
+std::atomic<size_t> mapped_bytes{0};
+
+size_t roundUp(size_t bytes, size_t multiple)
+{
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+// Best effort, replicas are still correct if the thread runs elsewhere
+void pinToCpus(const std::vector<int> &cpus)
+{
+  if(cpus.empty())
+  {
+    return;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for(int cpu : cpus)
+  {
+    if(cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &set);
+    }
+  }
+
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+} // namespace
+
+thread_local int NumaReplicas::thread_node{-1};
+
+NumaReplicas &NumaReplicas::getInstance()
+{
+  static NumaReplicas instance;
+
+  return instance;
+}
+
+// Constructor
+NumaReplicas::NumaReplicas()
+    : enabled{false}, huge_pages{false}, replicated_bytes{0},
+      huge_page_bytes{0}
+{
+  // Nodes without CPUs (e.g. memory expanders) never run lookups
+  for(int id : readList(NumaConstants::NodePath + "online"))
+  {
+    std::vector<int> cpus{readList(NumaConstants::NodePath + "node" +
+                                   std::to_string(id) + "/cpulist")};
+
+    if(!cpus.empty())
+    {
+      nodes.push_back({id, cpus, {}});
+    }
+  }
+
+  // Without topology everything is one node
+  if(nodes.empty())
+  {
+    nodes.push_back({0, {}, {}});
+  }
+
+  for(size_t node{0}; node < nodes.size(); node++)
+  {
+    for(int cpu : nodes[node].cpus)
+    {
+      if(static_cast<size_t>(cpu) >= cpu_nodes.size())
+      {
+        cpu_nodes.resize(cpu + 1, 0);
+      }
+
+      cpu_nodes[cpu] = static_cast<int>(node);
+    }
+  }
+}
+
+NumaReplicas::Chunk::Chunk(std::byte *base_, size_t size_)
+    : base{base_}, size{size_}, used{0}
+{
+  mapped_bytes += size;
+}
+
+NumaReplicas::Chunk::~Chunk()
+{
+  ::munmap(base, size);
+  mapped_bytes -= size;
+}
+
+size_t NumaReplicas::getMappedBytes() { return mapped_bytes; }
+
+void NumaReplicas::enable(bool huge_pages_)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  enabled = true;
+  huge_pages = huge_pages_;
+}
+
+std::byte *NumaReplicas::mapChunk(size_t size)
+{
+  const size_t huge_page{NumaConstants::HugePageSize};
+
+  // Reserved huge pages first, they are rarely configured
+  if(huge_pages)
+  {
+    void *mapping{::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0)};
+
+    if(mapping != MAP_FAILED)
+    {
+      huge_page_bytes += size;
+      return static_cast<std::byte *>(mapping);
+    }
+  }
+
+  // Otherwise transparent huge pages, which need a huge page aligned range
+  void *mapping{::mmap(nullptr, size + huge_page, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+
+  if(mapping == MAP_FAILED)
+  {
+    throw std::runtime_error("Cannot map replica memory: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  auto *start{static_cast<std::byte *>(mapping)};
+  auto *aligned{reinterpret_cast<std::byte *>(
+      roundUp(reinterpret_cast<std::uintptr_t>(start), huge_page))};
+
+  if(aligned != start)
+  {
+    ::munmap(start, static_cast<size_t>(aligned - start));
+  }
+
+  ::munmap(aligned + size, static_cast<size_t>(start + huge_page - aligned));
+
+  if(huge_pages && ::madvise(aligned, size, MADV_HUGEPAGE) == 0)
+  {
+    huge_page_bytes += size;
+  }
+
+  return aligned;
+}
+
+std::vector<std::shared_ptr<std::byte>> NumaReplicas::allocate(size_t bytes)
+{
+  bytes = roundUp(std::max<size_t>(bytes, 1), NumaConstants::TableAlignment);
+
+  std::vector<std::shared_ptr<std::byte>> replicas;
+
+  for(Node &node : nodes)
+  {
+    // A full chunk lives on for as long as the tables in it do
+    if(!node.chunk || node.chunk->size - node.chunk->used < bytes)
+    {
+      size_t size{roundUp(bytes, NumaConstants::HugePageSize)};
+      node.chunk = std::make_shared<Chunk>(mapChunk(size), size);
+    }
+
+    Chunk &chunk{*node.chunk};
+    replicas.emplace_back(node.chunk, chunk.base + chunk.used);
+    chunk.used += bytes;
+  }
+
+  return replicas;
+}
+
+template <typename Fill> void NumaReplicas::fillOnNodes(Fill fill)
+{
+  if(nodes.size() == 1)
+  {
+    fill(0);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+
+  for(size_t node{0}; node < nodes.size(); node++)
+  {
+    threads.emplace_back(
+        [this, &fill, node]
+        {
+          pinToCpus(nodes[node].cpus);
+          fill(node);
+        });
+  }
+
+  for(std::thread &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+std::vector<FlatTable>
+NumaReplicas::replicate(const std::vector<std::vector<double>> &rows)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  size_t no_columns{rows.empty() ? 0 : rows.front().size()};
+  size_t bytes{rows.size() * no_columns * sizeof(double)};
+  std::vector<std::shared_ptr<std::byte>> memory{allocate(bytes)};
+  std::vector<FlatTable> replicas;
+
+  fillOnNodes(
+      [&](size_t node)
+      {
+        auto *values{reinterpret_cast<double *>(memory[node].get())};
+
+        for(const std::vector<double> &row : rows)
+        {
+          values = std::copy(row.begin(), row.end(), values);
+        }
+      });
+
+  for(const std::shared_ptr<std::byte> &replica : memory)
+  {
+    replicas.push_back(
+        {std::shared_ptr<const double>(
+             replica, reinterpret_cast<const double *>(replica.get())),
+         rows.size(), no_columns});
+  }
+
+  replicated_bytes += bytes * nodes.size();
+
+  return replicas;
+}
+
+std::vector<std::shared_ptr<const double>>
+NumaReplicas::replicate(const std::vector<double> &values)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  size_t bytes{values.size() * sizeof(double)};
+  std::vector<std::shared_ptr<std::byte>> memory{allocate(bytes)};
+  std::vector<std::shared_ptr<const double>> replicas;
+
+  fillOnNodes(
+      [&](size_t node)
+      {
+        std::copy(values.begin(), values.end(),
+                  reinterpret_cast<double *>(memory[node].get()));
+      });
+
+  for(const std::shared_ptr<std::byte> &replica : memory)
+  {
+    replicas.emplace_back(replica,
+                          reinterpret_cast<const double *>(replica.get()));
+  }
+
+  replicated_bytes += bytes * nodes.size();
+
+  return replicas;
+}
+
+void NumaReplicas::bindThread(int thread)
+{
+  if(nodes.size() == 1)
+  {
+    return;
+  }
+
+  int node{thread % static_cast<int>(nodes.size())};
+  pinToCpus(nodes[node].cpus);
+  thread_node = node;
+}
+
+int NumaReplicas::findThreadNode() const
+{
+  int cpu{sched_getcpu()};
+
+  if(cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes.size())
+  {
+    return 0;
+  }
+
+  return cpu_nodes[cpu];
+}
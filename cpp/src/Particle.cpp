@@ -1,13 +1,16 @@
 // Implementation of Particle.hpp
 
 #include "Particle.hpp"
+#include "CrossSectionCache.hpp"
+#include "RandomNumberGenerator.hpp"
 #include "Vector.hpp"
 
+#include <cmath>
 #include <stdexcept>
 
 // Constructor
 Particle::Particle(ParticleConstants::ParticleType type_, double energy_,
-                   Vector3D &position_, Vector3D &direction_)
+                   const Vector3D &position_, const Vector3D &direction_)
 {
   // Set before checks
   mass = ParticleConstants::ParticleTypeToMass.at(type_);
@@ -21,23 +24,74 @@ Particle::Particle(ParticleConstants::ParticleType type_, double energy_,
   position = position_;
   type = type_;
   birth_energy = energy;
+  weight = 1.0;
+  id = 0;
+  parent_id = 0;
+  no_secondaries = 0;
 }
 
 // Setters
 void Particle::setEnergy(double energy_)
 {
   checkEnergy(energy_);
+
+  // Cached coefs of this thread were for the old energy
+  if(energy_ != energy)
+  {
+    CrossSectionCache::getThreadCache().invalidate();
+  }
+
   energy = energy_;
 }
 
-void Particle::setPosition(Vector3D &position_) { position = position_; }
+void Particle::setPosition(const Vector3D &position_) { position = position_; }
 
-void Particle::setDirection(Vector3D &direction_)
+void Particle::setDirection(const Vector3D &direction_)
 {
   checkDirection(direction_);
   direction = direction_;
 }
 
+void Particle::setWeight(double weight_)
+{
+  checkWeight(weight_);
+  weight = weight_;
+}
+
+void Particle::setID(std::uint64_t id_)
+{
+  id = id_;
+  parent_id = id_;
+  no_secondaries = 0;
+}
+
+Particle Particle::createSecondary(ParticleConstants::ParticleType type_,
+                                   double energy_, const Vector3D &direction_)
+{
+  Particle secondary(type_, energy_, position, direction_);
+
+  no_secondaries += 1;
+  secondary.id = RandomNumberGenerator::mixSeed(
+      id ^ RandomNumberGenerator::mixSeed(no_secondaries));
+  secondary.parent_id = id;
+  secondary.weight = weight;
+
+  return secondary;
+}
+
+Particle Particle::split()
+{
+  Particle copy{*this};
+
+  no_secondaries += 1;
+  copy.id = RandomNumberGenerator::mixSeed(
+      id ^ RandomNumberGenerator::mixSeed(no_secondaries));
+  copy.parent_id = id;
+  copy.no_secondaries = 0;
+
+  return copy;
+}
+
 // Validation
 void Particle::checkEnergy(double energy_) const
 {
@@ -48,11 +102,19 @@ void Particle::checkEnergy(double energy_) const
   }
 }
 
-void Particle::checkDirection(Vector3D &direction_) const
+void Particle::checkDirection(const Vector3D &direction_) const
 {
   if(direction_.isZero())
   {
     throw std::invalid_argument(
         "Invalid particle direction: direction vector cannot be {0, 0, 0}");
   }
-}
\ No newline at end of file
+}
+void Particle::checkWeight(double weight_) const
+{
+  if(!(weight_ > 0.0 && std::isfinite(weight_)))
+  {
+    throw std::invalid_argument("Invalid particle weight: weight must be "
+                                "positive and finite");
+  }
+}
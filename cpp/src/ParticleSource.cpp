@@ -0,0 +1,258 @@
+// Implementation of the SourceSpectrum and ParticleSource classes
+
+#include "ParticleSource.hpp"
+#include "DirectionKernels.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+// Constructor
+SourceSpectrum::SourceSpectrum(const std::vector<double> &line_energies,
+                               const std::vector<double> &line_intensities,
+                               const std::vector<double> &bin_edges,
+                               const std::vector<double> &bin_intensities)
+    : total_intensity{0.0}, mean_energy{0.0}
+{
+  if(line_energies.size() != line_intensities.size())
+  {
+    throw std::invalid_argument("Invalid source spectrum: " +
+                                std::to_string(line_energies.size()) +
+                                " line energies but " +
+                                std::to_string(line_intensities.size()) +
+                                " intensities");
+  }
+
+  if(bin_edges.empty() ? !bin_intensities.empty()
+                       : bin_edges.size() != bin_intensities.size() + 1)
+  {
+    throw std::invalid_argument("Invalid source spectrum: a histogram needs "
+                                "one more edge than intensities");
+  }
+
+  std::vector<double> intensities;
+
+  for(size_t line{0}; line < line_energies.size(); line++)
+  {
+    if(!(line_energies[line] > 0.0))
+    {
+      throw std::invalid_argument("Invalid source spectrum: line energies "
+                                  "must be positive");
+    }
+
+    low.push_back(line_energies[line]);
+    width.push_back(0.0);
+    intensities.push_back(line_intensities[line]);
+    mean_energy += line_intensities[line] * line_energies[line];
+  }
+
+  for(size_t bin{0}; bin < bin_intensities.size(); bin++)
+  {
+    if(!(bin_edges[bin] > 0.0) || !(bin_edges[bin + 1] > bin_edges[bin]))
+    {
+      throw std::invalid_argument("Invalid source spectrum: bin edges must be "
+                                  "positive and increasing");
+    }
+
+    low.push_back(bin_edges[bin]);
+    width.push_back(bin_edges[bin + 1] - bin_edges[bin]);
+    intensities.push_back(bin_intensities[bin]);
+    mean_energy += bin_intensities[bin] * 0.5 * (bin_edges[bin] +
+                                                 bin_edges[bin + 1]);
+  }
+
+  // Also rejects an empty spectrum and negative or all zero intensities
+  table = AliasTable(intensities);
+
+  for(double intensity : intensities)
+  {
+    total_intensity += intensity;
+  }
+
+  mean_energy /= total_intensity;
+}
+
+SourceSpectrum SourceSpectrum::fromLines(const std::vector<double> &energies,
+                                         const std::vector<double> &intensities)
+{
+  return {energies, intensities};
+}
+
+SourceSpectrum
+SourceSpectrum::fromHistogram(const std::vector<double> &edges,
+                              const std::vector<double> &intensities)
+{
+  return {{}, {}, edges, intensities};
+}
+
+SourceSpectrum SourceSpectrum::fromNuclide(const std::string &nuclide)
+{
+  auto lines{SourceConstants::NuclideLines.find(nuclide)};
+
+  if(lines == SourceConstants::NuclideLines.end())
+  {
+    throw std::invalid_argument("No gamma lines for nuclide " + nuclide);
+  }
+
+  std::vector<double> energies;
+  std::vector<double> intensities;
+
+  for(const auto &[energy, intensity] : lines->second)
+  {
+    energies.push_back(energy);
+    intensities.push_back(intensity);
+  }
+
+  return fromLines(energies, intensities);
+}
+
+// Constructor
+ParticleSource::ParticleSource(ParticleConstants::ParticleType particle_type_,
+                               const SourceSpectrum &spectrum_)
+    : particle_type{particle_type_}, spectrum{spectrum_},
+      shape{SourceShape::POINT}, centre{Vector3D::ZERO},
+      extent_u{Vector3D::ZERO}, extent_v{Vector3D::ZERO},
+      direction_mode{SourceDirection::ISOTROPIC}, axis{Vector3D::UNITZ},
+      cos_half_angle{1.0}
+{}
+
+void ParticleSource::setPoint(const Vector3D &position_)
+{
+  shape = SourceShape::POINT;
+  centre = position_;
+}
+
+void ParticleSource::setDisc(const Vector3D &centre_, const Vector3D &normal_,
+                             double radius_)
+{
+  if(normal_.isZero() || !(radius_ > 0.0))
+  {
+    throw std::invalid_argument("Invalid disc source: normal must be non-zero "
+                                "and radius positive");
+  }
+
+  // Any in-plane axis will do, taken from the coordinate axis least aligned
+  // with the normal
+  Vector3D normal{normal_.normalise()};
+  Vector3D helper{std::abs(normal.getX()) < 0.5 ? Vector3D::UNITX
+                                                : Vector3D::UNITY};
+  Vector3D u{normal.cross(helper).normalise()};
+
+  shape = SourceShape::DISC;
+  centre = centre_;
+  extent_u = u * radius_;
+  extent_v = normal.cross(u) * radius_;
+}
+
+void ParticleSource::setBox(const BoundingBox &bounds_)
+{
+  if(!bounds_.isBounded() || bounds_.max.getX() < bounds_.min.getX() ||
+     bounds_.max.getY() < bounds_.min.getY() ||
+     bounds_.max.getZ() < bounds_.min.getZ())
+  {
+    throw std::invalid_argument("Invalid box source: bounds must be finite "
+                                "and ordered");
+  }
+
+  shape = SourceShape::BOX;
+  centre = bounds_.min;
+  extent_u = bounds_.max - bounds_.min;
+}
+
+void ParticleSource::setIsotropic()
+{
+  direction_mode = SourceDirection::ISOTROPIC;
+}
+
+void ParticleSource::setBeam(const Vector3D &axis_, double half_angle_)
+{
+  if(axis_.isZero() || half_angle_ < 0.0 || half_angle_ > std::numbers::pi)
+  {
+    throw std::invalid_argument("Invalid beam source: axis must be non-zero "
+                                "and half angle in [0, pi]");
+  }
+
+  direction_mode = SourceDirection::BEAM;
+  axis = axis_.normalise();
+  cos_half_angle = std::cos(half_angle_);
+}
+
+Vector3D ParticleSource::samplePosition(RandomNumberGenerator &rng) const
+{
+  switch(shape)
+  {
+  case SourceShape::DISC:
+  {
+    // Point in the unit disc by rejection from the square, which is uniform
+    // over the area without the square root of the radius or an azimuth
+    double x;
+    double y;
+
+    do
+    {
+      x = 2.0 * rng.getUniform() - 1.0;
+      y = 2.0 * rng.getUniform() - 1.0;
+    } while(x * x + y * y >= 1.0);
+
+    return centre + x * extent_u + y * extent_v;
+  }
+  case SourceShape::BOX:
+  {
+    double x{rng.getUniform()};
+    double y{rng.getUniform()};
+    double z{rng.getUniform()};
+
+    return {centre.getX() + x * extent_u.getX(),
+            centre.getY() + y * extent_u.getY(),
+            centre.getZ() + z * extent_u.getZ()};
+  }
+  default:
+    return centre;
+  }
+}
+
+Vector3D ParticleSource::sampleDirection(RandomNumberGenerator &rng) const
+{
+  if(direction_mode == SourceDirection::ISOTROPIC)
+  {
+    return rng.getIsotropicDirection();
+  }
+
+  if(cos_half_angle == 1.0)
+  {
+    return axis;
+  }
+
+  // cos theta uniform over the cone gives equal solid angles equal weight
+  double cos_theta{1.0 - rng.getUniform() * (1.0 - cos_half_angle)};
+
+  return DirectionKernels::keepUnit(
+      DirectionKernels::rotateDirection(axis, cos_theta, rng.getAzimuth()));
+}
+
+Particle ParticleSource::sample(RandomNumberGenerator &rng) const
+{
+  // Drawn in a fixed order so that a seed gives the same particle
+  double energy{spectrum.sample(rng)};
+  Vector3D position{samplePosition(rng)};
+  Vector3D direction{sampleDirection(rng)};
+
+  return {particle_type, energy, position, direction};
+}
+
+void ParticleSource::sample(RandomNumberGenerator &rng, size_t no_particles,
+                            std::vector<Particle> &particles) const
+{
+  particles.reserve(particles.size() + no_particles);
+
+  for(size_t particle{0}; particle < no_particles; particle++)
+  {
+    particles.push_back(sample(rng));
+  }
+}
+
+std::function<Particle(RandomNumberGenerator &)>
+ParticleSource::getSource() const
+{
+  return [this](RandomNumberGenerator &rng) { return sample(rng); };
+}
@@ -0,0 +1,56 @@
+// Implementation of the PathBiasing class
+
+#include "PathBiasing.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+PathBiasing::PathBiasing(const std::vector<RegionBiasing> &regions_)
+    : regions{regions_}
+{
+  checkRegions();
+
+  for(RegionBiasing &region : regions)
+  {
+    region.preferred_direction = region.preferred_direction.normalise();
+  }
+}
+
+void PathBiasing::checkRegions() const
+{
+  for(const RegionBiasing &region : regions)
+  {
+    if(!(region.stretch >= 0.0 && region.stretch < 1.0))
+    {
+      throw std::invalid_argument("Invalid path biasing: stretch must be in "
+                                  "[0, 1)");
+    }
+
+    if(region.preferred_direction == Vector3D::ZERO)
+    {
+      throw std::invalid_argument("Invalid path biasing: preferred direction "
+                                  "cannot be zero");
+    }
+  }
+}
+
+double PathBiasing::getStretchedCoef(double atten_coef,
+                                     const Vector3D &direction,
+                                     int region) const
+{
+  const RegionBiasing &biasing{regions.at(region)};
+
+  return atten_coef *
+         (1.0 - biasing.stretch * direction.dot(biasing.preferred_direction));
+}
+
+double PathBiasing::getWeightFactor(double atten_coef, double stretched_coef,
+                                    double distance, bool collided)
+{
+  // Ratio of exp(-mu s) to exp(-mu* s), times mu / mu* for the collision
+  // density
+  double factor{std::exp(-(atten_coef - stretched_coef) * distance)};
+
+  return collided ? factor * atten_coef / stretched_coef : factor;
+}
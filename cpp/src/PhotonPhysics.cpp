@@ -0,0 +1,371 @@
+// Implementation of the PhotonPhysics class
+
+#include "PhotonPhysics.hpp"
+#include "DataProcessor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+
+// Reactions that end the photon
+bool isAbsorption(ParticleConstants::ReactionType reaction)
+{
+  return reaction ==
+             ParticleConstants::ReactionType::PHOTOELECTRIC_ABSORPTION ||
+         reaction ==
+             ParticleConstants::ReactionType::NUCLEAR_PAIR_PRODUCTION ||
+         reaction == ParticleConstants::ReactionType::ELECTRON_PAIR_PRODUCTION;
+}
+
+} // namespace
+
+// Constructor
+PhotonPhysics::PhotonPhysics(const std::vector<const Material *> &materials)
+{
+  for(const Material *material : materials)
+  {
+    reaction_samplers.try_emplace(
+        material, material->getTable(ParticleConstants::ParticleType::GAMMA),
+        ParticleConstants::ParticleType::GAMMA);
+
+    double &max_emission_probability{max_emission_probabilities[material]};
+
+    for(const auto &element_fraction : material->getComposition())
+    {
+      if(!k_shells.contains(element_fraction.first))
+      {
+        k_shells.emplace(element_fraction.first,
+                         buildKShell(element_fraction.first));
+      }
+
+      max_emission_probability =
+          std::max(max_emission_probability,
+                   k_shells.at(element_fraction.first).emission_probability);
+    }
+  }
+}
+
+KShell PhotonPhysics::buildKShell(ElementConversion::Element element)
+{
+  std::shared_ptr<const std::vector<std::vector<double>>> data{
+      DataProcessor::getInstance().getData(
+          ParticleConstants::ParticleType::GAMMA, element)};
+  const std::vector<std::vector<double>> &rows{*data};
+  const size_t energy_column{FileConstants::EnergyColumn};
+  const size_t photoelectric_column{
+      FileConstants::ReactionToColumn.at(ParticleConstants::ParticleType::GAMMA)
+          .at(ParticleConstants::ReactionType::PHOTOELECTRIC_ABSORPTION)};
+
+  // Edges are duplicated energies, highest first
+  std::vector<size_t> edges;
+
+  for(size_t i{rows.size() - 1}; i-- > 0;)
+  {
+    if(rows[i][energy_column] == rows[i + 1][energy_column])
+    {
+      edges.push_back(i);
+    }
+  }
+
+  if(edges.empty())
+  {
+    return {0.0, 0.0, 0.0};
+  }
+
+  const std::vector<double> &below{rows[edges.front()]};
+  const std::vector<double> &above{rows[edges.front() + 1]};
+  double edge{below[energy_column]};
+  double jump_ratio{above[photoelectric_column] / below[photoelectric_column]};
+
+  double z{static_cast<double>(element)};
+  double root{AtomicRelaxationConstants::KYieldA +
+              AtomicRelaxationConstants::KYieldB * z +
+              AtomicRelaxationConstants::KYieldC * z * z * z};
+  double root4{std::pow(root, 4)};
+  double yield{root4 / (1.0 + root4)};
+
+  // K alpha from the K and L3 edges, or Moseley's law when the L edges lie
+  // below the data
+  double line_energy{0.75 * ParticleConstants::RydbergEnergy * (z - 1.0) *
+                     (z - 1.0)};
+
+  if(static_cast<int>(edges.size()) > AtomicRelaxationConstants::LEdgesBelowK)
+  {
+    line_energy =
+        edge -
+        rows[edges[AtomicRelaxationConstants::LEdgesBelowK]][energy_column];
+  }
+
+  // Lines below the data range are deposited locally
+  if(!(line_energy > TransportConstants::PhotonEnergyCutoff &&
+       line_energy < edge && jump_ratio > 1.0))
+  {
+    return {edge, 0.0, 0.0};
+  }
+
+  return {edge, line_energy, (1.0 - 1.0 / jump_ratio) * yield};
+}
+
+ElementConversion::Element
+PhotonPhysics::selectElement(const Material &material, double energy,
+                             ParticleConstants::ReactionType reaction,
+                             double uniform) const
+{
+  const auto &composition{material.getComposition()};
+
+  if(composition.size() == 1)
+  {
+    return composition.front().first;
+  }
+
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+  auto weight{[&](size_t i)
+              {
+                return composition[i].second *
+                       data_processor.getAttenCoef(
+                           energy, reaction,
+                           ParticleConstants::ParticleType::GAMMA,
+                           composition[i].first);
+              }};
+
+  // On the stack, as this runs for every collision in a mixture
+  std::array<double, TransportConstants::MaxStackElements> weights;
+  bool stored{composition.size() <= weights.size()};
+  double total{0.0};
+
+  for(size_t i{0}; i < composition.size(); i++)
+  {
+    double element_weight{weight(i)};
+
+    if(stored)
+    {
+      weights[i] = element_weight;
+    }
+
+    total += element_weight;
+  }
+
+  double target{uniform * total};
+
+  for(size_t i{0}; i < composition.size(); i++)
+  {
+    target -= stored ? weights[i] : weight(i);
+
+    if(target <= 0.0)
+    {
+      return composition[i].first;
+    }
+  }
+
+  return composition.back().first; // Rounding
+}
+
+double PhotonPhysics::scatter(Particle &particle, const Material &material,
+                              ParticleConstants::ReactionType reaction,
+                              RandomNumberGenerator &rng) const
+{
+  switch(reaction)
+  {
+  case ParticleConstants::ReactionType::COHERENT_SCATTERING:
+  {
+    ElementConversion::Element element{selectElement(
+        material, particle.getEnergy(),
+        ParticleConstants::ReactionType::COHERENT_SCATTERING,
+        rng.getUniform())};
+    DataProcessor::getInstance().getCoherentSampler(element).scatter(particle,
+                                                                     rng);
+
+    return 0.0;
+  }
+
+  case ParticleConstants::ReactionType::INCOHERENT_SCATTERING:
+
+    return compton_sampler.scatter(particle, rng);
+
+  default:
+
+    throw std::runtime_error("Invalid photon scattering reaction");
+  }
+}
+
+double PhotonPhysics::absorb(Particle &particle, double weight,
+                             const Material &material,
+                             ParticleConstants::ReactionType reaction,
+                             RandomNumberGenerator &rng,
+                             ParticleBank *secondaries) const
+{
+  double energy{particle.getEnergy()};
+
+  switch(reaction)
+  {
+  case ParticleConstants::ReactionType::PHOTOELECTRIC_ABSORPTION:
+  {
+    // Drawn before the element so that most absorptions, which emit nothing,
+    // skip the element search
+    double emission_uniform{rng.getUniform()};
+
+    if(!(emission_uniform < max_emission_probabilities.at(&material)))
+    {
+      return energy;
+    }
+
+    ElementConversion::Element element{
+        selectElement(material, energy, reaction, rng.getUniform())};
+    const KShell &k_shell{k_shells.at(element)};
+
+    if(energy >= k_shell.edge &&
+       emission_uniform < k_shell.emission_probability &&
+       emit(particle, weight, k_shell.line_energy,
+            rng.getIsotropicDirection(), secondaries))
+    {
+      return energy - k_shell.line_energy;
+    }
+
+    return energy;
+  }
+
+  case ParticleConstants::ReactionType::NUCLEAR_PAIR_PRODUCTION:
+  case ParticleConstants::ReactionType::ELECTRON_PAIR_PRODUCTION:
+  {
+    // The positron annihilates at rest
+    const double rest_energy{ParticleConstants::ElectronMass};
+    Vector3D direction{rng.getIsotropicDirection()};
+    double deposit{energy - 2.0 * rest_energy};
+
+    for(const Vector3D &photon_direction : {direction, direction * -1.0})
+    {
+      if(!emit(particle, weight, rest_energy, photon_direction, secondaries))
+      {
+        deposit += rest_energy;
+      }
+    }
+
+    return deposit;
+  }
+
+  default:
+
+    throw std::runtime_error("Invalid photon absorption reaction");
+  }
+}
+
+bool PhotonPhysics::emit(Particle &particle, double weight, double energy,
+                         const Vector3D &direction, ParticleBank *secondaries)
+{
+  if(secondaries == nullptr || secondaries->getFreeSpace() == 0)
+  {
+    return false;
+  }
+
+  Particle secondary{particle.createSecondary(
+      ParticleConstants::ParticleType::GAMMA, energy, direction)};
+  secondary.setWeight(weight);
+
+  return secondaries->push(secondary);
+}
+
+CollisionResult PhotonPhysics::collide(Particle &particle,
+                                       const Material &material,
+                                       RandomNumberGenerator &rng,
+                                       bool implicit_capture,
+                                       ParticleBank *secondaries) const
+{
+  const ReactionSampler &reaction_sampler{getReactionSampler(material)};
+  double energy{particle.getEnergy()};
+  double weight{particle.getWeight()};
+
+  if(!implicit_capture)
+  {
+    ParticleConstants::ReactionType reaction{
+        reaction_sampler.sample(energy, rng.getUniform())};
+
+    if(isAbsorption(reaction))
+    {
+      return {reaction,
+              weight * absorb(particle, weight, material, reaction, rng,
+                              secondaries),
+              true};
+    }
+
+    return {reaction, weight * scatter(particle, material, reaction, rng),
+            false};
+  }
+
+  // Branching ratios as sampled by the alias tables
+  size_t interval{reaction_sampler.getInterval(energy)};
+  double fraction{reaction_sampler.getFraction(interval, energy)};
+  const std::vector<ParticleConstants::ReactionType> &channels{
+      reaction_sampler.getChannels()};
+
+  double absorption{0.0};
+
+  for(size_t channel{0}; channel < channels.size(); channel++)
+  {
+    if(isAbsorption(channels[channel]))
+    {
+      absorption +=
+          reaction_sampler.getProbability(interval, fraction, channel);
+    }
+  }
+
+  // Channel of one kind, absorbing or not, in proportion to its probability
+  auto selectChannel{
+      [&](bool absorbing, double total)
+      {
+        double target{rng.getUniform() * total};
+        size_t selected{0};
+
+        for(size_t channel{0}; channel < channels.size(); channel++)
+        {
+          if(isAbsorption(channels[channel]) != absorbing)
+          {
+            continue;
+          }
+
+          selected = channel;
+          target -=
+              reaction_sampler.getProbability(interval, fraction, channel);
+
+          if(target <= 0.0)
+          {
+            break;
+          }
+        }
+
+        return channels[selected];
+      }};
+
+  // The absorbed share of the weight carries the secondaries of one
+  // absorption channel
+  double deposit{0.0};
+
+  if(absorption > 0.0)
+  {
+    double absorbed_weight{weight * absorption};
+
+    deposit += absorbed_weight * absorb(particle, absorbed_weight, material,
+                                        selectChannel(true, absorption), rng,
+                                        secondaries);
+  }
+
+  double scattering{1.0 - absorption};
+
+  if(!(scattering > 0.0))
+  {
+    return {ParticleConstants::ReactionType::PHOTOELECTRIC_ABSORPTION, deposit,
+            true};
+  }
+
+  ParticleConstants::ReactionType reaction{selectChannel(false, scattering)};
+  double scattered_weight{weight * scattering};
+  particle.setWeight(scattered_weight);
+
+  deposit += scattered_weight * scatter(particle, material, reaction, rng);
+
+  return {reaction, deposit, false};
+}
@@ -0,0 +1,228 @@
+// Implementation of the PointKernel class
+
+#include "PointKernel.hpp"
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <optional>
+
+// Constructor
+PointKernel::PointKernel(const SlabGeometry &shield_) : shield{shield_} {}
+
+void PointKernel::setBuildup(const Material &material,
+                             const GPBuildup &buildup)
+{
+  buildups.insert_or_assign(&material, buildup);
+}
+
+std::vector<double> PointKernel::getLayerCoefs(double energy) const
+{
+  std::vector<double> coefs;
+
+  for(int layer{0}; layer < shield.getNumberRegions(); layer++)
+  {
+    const Material *material{shield.getMaterial(layer)};
+
+    coefs.push_back((material == nullptr)
+                        ? 0.0
+                        : material->getLinearAttenCoef(
+                              energy,
+                              ParticleConstants::ReactionType::
+                                  TOTAL_WITH_COHERENT,
+                              ParticleConstants::ParticleType::GAMMA));
+  }
+
+  return coefs;
+}
+
+double PointKernel::getMeanFreePaths(const Vector3D &source,
+                                     const Vector3D &detector,
+                                     const std::vector<double> &coefs) const
+{
+  const std::vector<double> &boundaries{shield.getBoundaries()};
+  Vector3D ray{detector - source};
+  double inverse_dz{1.0 / ray.getZ()};
+  double fractions{0.0}; // Coef weighted fraction of the ray in each layer
+
+  for(size_t layer{0}; layer < coefs.size(); layer++)
+  {
+    // Ray parameters where it meets the layer planes
+    double t_low{(boundaries[layer] - source.getZ()) * inverse_dz};
+    double t_high{(boundaries[layer + 1] - source.getZ()) * inverse_dz};
+    double t_in{std::max(0.0, std::min(t_low, t_high))};
+    double t_out{std::min(1.0, std::max(t_low, t_high))};
+
+    fractions += coefs[layer] * std::max(0.0, t_out - t_in);
+  }
+
+  return fractions * ray.magnitude();
+}
+
+int PointKernel::getLastLayer(double source_z, double detector_z) const
+{
+  const std::vector<double> &boundaries{shield.getBoundaries()};
+  int no_layers{shield.getNumberRegions()};
+
+  if(std::max(source_z, detector_z) <= boundaries.front() ||
+     std::min(source_z, detector_z) >= boundaries.back())
+  {
+    return -1;
+  }
+
+  // Layer containing z, clamped into the stack
+  auto layerAt{[&boundaries, no_layers](double z)
+               {
+                 auto it{std::upper_bound(boundaries.begin(), boundaries.end(),
+                                          z)};
+                 int layer{
+                     static_cast<int>(std::distance(boundaries.begin(), it)) -
+                     1};
+
+                 return std::clamp(layer, 0, no_layers - 1);
+               }};
+
+  int layer{layerAt(detector_z)};
+  int source_layer{layerAt(source_z)};
+  int step{(detector_z >= source_z) ? -1 : 1};
+
+  // Walk back towards the source over voids
+  while(shield.getMaterial(layer) == nullptr)
+  {
+    if(layer == source_layer)
+    {
+      return -1;
+    }
+
+    layer += step;
+  }
+
+  return layer;
+}
+
+double PointKernel::getFlux(const Vector3D &source, const Vector3D &detector,
+                            double energy, bool with_buildup) const
+{
+  double mean_free_paths{getMeanFreePaths(source, detector, energy)};
+  double distance_squared{(detector - source).dot(detector - source)};
+  double flux{std::exp(-mean_free_paths) /
+              (4.0 * std::numbers::pi * distance_squared)};
+
+  if(with_buildup)
+  {
+    int layer{getLastLayer(source.getZ(), detector.getZ())};
+
+    if(layer != -1)
+    {
+      auto it{buildups.find(shield.getMaterial(layer))};
+
+      if(it != buildups.end())
+      {
+        flux *= it->second.getBuildup(energy, mean_free_paths);
+      }
+    }
+  }
+
+  return flux;
+}
+
+void PointKernel::evaluate(const Vector3D &source, double energy,
+                           const DetectorPoints &detectors,
+                           std::vector<double> &fluxes,
+                           bool with_buildup) const
+{
+  using Simd::Register;
+
+  std::vector<double> coefs{getLayerCoefs(energy)};
+  const std::vector<double> &boundaries{shield.getBoundaries()};
+  size_t no_detectors{detectors.size()};
+
+  fluxes.resize(no_detectors);
+
+  // Mean free paths along the rays, whole registers first
+  size_t vector_end{no_detectors - no_detectors % Register::width};
+  Register source_x{Register::broadcast(source.getX())};
+  Register source_y{Register::broadcast(source.getY())};
+  Register source_z{Register::broadcast(source.getZ())};
+  Register zero{Register::broadcast(0.0)};
+  Register one{Register::broadcast(1.0)};
+
+  for(size_t i{0}; i < vector_end; i += Register::width)
+  {
+    Register dx{Register::load(&detectors.x[i]) - source_x};
+    Register dy{Register::load(&detectors.y[i]) - source_y};
+    Register dz{Register::load(&detectors.z[i]) - source_z};
+    Register distance{sqrt(fma(dx, dx, fma(dy, dy, dz * dz)))};
+    Register inverse_dz{one / dz};
+    Register fractions{zero};
+
+    for(size_t layer{0}; layer < coefs.size(); layer++)
+    {
+      if(coefs[layer] == 0.0)
+      {
+        continue;
+      }
+
+      Register t_low{(Register::broadcast(boundaries[layer]) - source_z) *
+                     inverse_dz};
+      Register t_high{
+          (Register::broadcast(boundaries[layer + 1]) - source_z) *
+          inverse_dz};
+      Register t_in{max(zero, min(t_low, t_high))};
+      Register t_out{min(one, max(t_low, t_high))};
+
+      fractions = fma(Register::broadcast(coefs[layer]),
+                      max(zero, t_out - t_in), fractions);
+    }
+
+    (fractions * distance).store(&fluxes[i]);
+  }
+
+  for(size_t i{vector_end}; i < no_detectors; i++)
+  {
+    fluxes[i] = getMeanFreePaths(
+        source, Vector3D(detectors.x[i], detectors.y[i], detectors.z[i]),
+        coefs);
+  }
+
+  // GP coefficients of every layer with buildup data at this energy
+  std::vector<std::optional<GPCoefficients>> layer_coefficients(coefs.size());
+
+  if(with_buildup)
+  {
+    for(size_t layer{0}; layer < coefs.size(); layer++)
+    {
+      auto it{buildups.find(shield.getMaterial(static_cast<int>(layer)))};
+
+      if(it != buildups.end())
+      {
+        layer_coefficients[layer] = it->second.getCoefficients(energy);
+      }
+    }
+  }
+
+  // Attenuated inverse square flux with buildup
+  for(size_t i{0}; i < no_detectors; i++)
+  {
+    double mean_free_paths{fluxes[i]};
+    double dx{detectors.x[i] - source.getX()};
+    double dy{detectors.y[i] - source.getY()};
+    double dz{detectors.z[i] - source.getZ()};
+    double flux{std::exp(-mean_free_paths) /
+                (4.0 * std::numbers::pi * (dx * dx + dy * dy + dz * dz))};
+
+    if(with_buildup)
+    {
+      int layer{getLastLayer(source.getZ(), detectors.z[i])};
+
+      if(layer != -1 && layer_coefficients[layer])
+      {
+        flux *= GPBuildup::evaluate(*layer_coefficients[layer],
+                                    mean_free_paths);
+      }
+    }
+
+    fluxes[i] = flux;
+  }
+}
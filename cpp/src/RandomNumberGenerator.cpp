@@ -0,0 +1,63 @@
+// Implementation of the RandomNumberGenerator class
+
+#include "RandomNumberGenerator.hpp"
+
+#include <cmath>
+#include <limits>
+
+Vector3D RandomNumberGenerator::getIsotropicDirection()
+{
+  // Point in the unit disc by rejection from the square, 4 / pi pairs on
+  // average, which maps onto the sphere without trig
+  double x;
+  double y;
+  double s;
+
+  do
+  {
+    x = 2.0 * getUniform() - 1.0;
+    y = 2.0 * getUniform() - 1.0;
+    s = x * x + y * y;
+  } while(s >= 1.0);
+
+  return DirectionKernels::isotropicFromDisc(x, y, s);
+}
+
+DirectionKernels::Azimuth RandomNumberGenerator::getAzimuth()
+{
+  // Point in the unit disc as above, whose angle doubled is uniform and has
+  // cosine and sine (x^2 - y^2) / s and 2xy / s. Its 2.5 uniforms measured
+  // cheaper than one uniform and a sincos.
+  double x;
+  double y;
+  double s;
+
+  do
+  {
+    x = 2.0 * getUniform() - 1.0;
+    y = 2.0 * getUniform() - 1.0;
+    s = x * x + y * y;
+  } while(s >= 1.0 || s == 0.0);
+
+  return {(x * x - y * y) / s, 2.0 * x * y / s};
+}
+
+double RandomNumberGenerator::getRandomStep(const Particle &particle,
+                                            const Material &material)
+{
+  double atten_coef{material.getTotalLinearAttenCoef(particle.getEnergy(),
+                                                     particle.getType())};
+
+  return getRandomStep(atten_coef);
+}
+
+double RandomNumberGenerator::getRandomStep(double atten_coef)
+{
+  // Distance to the next collision is exponentially distributed
+  if(atten_coef <= 0.0)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  return -std::log(getUniform()) / atten_coef;
+}
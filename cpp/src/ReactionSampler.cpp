@@ -0,0 +1,161 @@
+// Implementation of the ReactionSampler class
+
+#include "ReactionSampler.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+ReactionSampler::ReactionSampler(
+    const std::vector<std::vector<double>> &rows_,
+    ParticleConstants::ParticleType particle_type)
+    : rows{rows_}
+{
+  if(rows.size() < 2)
+  {
+    throw std::invalid_argument(
+        "ReactionSampler table must have at least two energies");
+  }
+
+  const auto &allowed_reactions{
+      ParticleConstants::AllowedReactions.at(particle_type)};
+
+  channels.assign(allowed_reactions.begin(), allowed_reactions.end());
+  std::sort(channels.begin(), channels.end());
+
+  for(const auto &reaction : channels)
+  {
+    channel_columns.push_back(
+        FileConstants::ReactionToColumn.at(particle_type).at(reaction));
+  }
+
+  for(const std::vector<double> &row : rows)
+  {
+    log_energies.push_back(std::log(row[FileConstants::EnergyColumn]));
+  }
+
+  size_t no_channels{channels.size()};
+  entries.resize(2 * getNoIntervals() * no_channels);
+
+  std::vector<double> weights(no_channels);
+
+  for(size_t interval{0}; interval < getNoIntervals(); interval++)
+  {
+    // Row values are already one sided at k-edges, the lower row of an
+    // interval is above any edge there and the upper row below it
+    for(int end{0}; end < 2; end++)
+    {
+      for(size_t channel{0}; channel < no_channels; channel++)
+      {
+        weights[channel] = rows[interval + end][channel_columns[channel]];
+      }
+
+      AliasTable::build(
+          weights,
+          std::span<AliasEntry>(
+              entries.data() + (2 * interval + end) * no_channels,
+              no_channels));
+    }
+  }
+}
+
+size_t ReactionSampler::getInterval(double energy) const
+{
+  std::pair<size_t, size_t> above_below_indices{
+      Interpolation::getAboveBelowIndices(energy, rows)};
+
+  // On a grid point the interval starting there is used, except at the top
+  return std::min(above_below_indices.second, getNoIntervals() - 1);
+}
+
+double ReactionSampler::getFraction(size_t interval, double energy) const
+{
+  double width{log_energies[interval + 1] - log_energies[interval]};
+
+  if(width == 0.0)
+  {
+    return 0.0;
+  }
+
+  return std::clamp((std::log(energy) - log_energies[interval]) / width, 0.0,
+                    1.0);
+}
+
+double ReactionSampler::getProbability(size_t interval, double fraction,
+                                       size_t channel) const
+{
+  double lower{AliasTable::getProbability(getEntries(interval, 0), channel)};
+  double upper{AliasTable::getProbability(getEntries(interval, 1), channel)};
+
+  return (1.0 - fraction) * lower + fraction * upper;
+}
+
+std::vector<double> ReactionSampler::branchingRatios(double energy) const
+{
+  std::vector<double> ratios;
+  double total{0.0};
+
+  for(size_t column : channel_columns)
+  {
+    ratios.push_back(Interpolation::interpolateColumn(energy, rows, column));
+    total += ratios.back();
+  }
+
+  for(double &ratio : ratios)
+  {
+    ratio /= total;
+  }
+
+  return ratios;
+}
+
+ReactionSamplerAccuracy ReactionSampler::getAccuracy() const
+{
+  size_t no_channels{channels.size()};
+
+  ReactionSamplerAccuracy accuracy{channels,
+                                   std::vector<double>(no_channels, 0.0),
+                                   std::vector<double>(no_channels, 0.0), 0.0,
+                                   0};
+
+  double error_sum{0.0};
+
+  for(size_t interval{0}; interval < getNoIntervals(); interval++)
+  {
+    if(log_energies[interval] == log_energies[interval + 1])
+    {
+      continue; // k-edge, never selected by getInterval
+    }
+
+    // Quarter points in log energy, the ends are exact by construction
+    for(double fraction : {0.25, 0.5, 0.75})
+    {
+      double energy{std::exp(log_energies[interval] +
+                             fraction * (log_energies[interval + 1] -
+                                         log_energies[interval]))};
+      std::vector<double> exact{branchingRatios(energy)};
+
+      for(size_t channel{0}; channel < no_channels; channel++)
+      {
+        double error{std::abs(getProbability(interval, fraction, channel) -
+                              exact[channel])};
+
+        error_sum += error;
+
+        if(error > accuracy.max_abs_error[channel])
+        {
+          accuracy.max_abs_error[channel] = error;
+          accuracy.max_error_energy[channel] = energy;
+        }
+      }
+
+      accuracy.no_points += 1;
+    }
+  }
+
+  accuracy.mean_abs_error = error_sum / (accuracy.no_points * no_channels);
+
+  return accuracy;
+}
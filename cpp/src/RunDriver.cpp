@@ -0,0 +1,443 @@
+// Implementation of the RunDriver class
+
+#include "RunDriver.hpp"
+#include "DataProcessor.hpp"
+#include "Instrumentation.hpp"
+#include "NumaReplicas.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+// Constructor
+RunDriver::RunDriver(const Transport &transport_,
+                     const PhotonPhysics &physics_, TallySet &tally_set_,
+                     const Source &source_, const RunSettings &settings_)
+    : transport{transport_}, physics{physics_}, tally_set{tally_set_},
+      source{source_}, settings{settings_}, histories_run{0}, batches_run{0},
+      elapsed_seconds{0.0}, last_checkpoint_seconds{0.0}
+{
+  if(settings.no_threads < 1 || settings.histories_per_batch < 1 ||
+     settings.max_histories < 1)
+  {
+    throw std::invalid_argument("Invalid run settings: threads and history "
+                                "counts must be at least 1");
+  }
+
+  if(settings.path_biasing != nullptr &&
+     (transport.getTrackingMode() != TrackingMode::SURFACE ||
+      settings.path_biasing->getNumberRegions() !=
+          transport.getGeometry().getNumberRegions()))
+  {
+    throw std::invalid_argument("Invalid run settings: path biasing needs "
+                                "surface tracking and one entry per region");
+  }
+
+  if(settings.track_recorder != nullptr &&
+     settings.track_recorder->getNoThreads() < settings.no_threads)
+  {
+    throw std::invalid_argument("Invalid run settings: track recorder needs "
+                                "a ring per thread");
+  }
+
+  if(!settings.checkpoint_path.empty())
+  {
+    checkpoint_writer =
+        std::make_unique<CheckpointWriter>(settings.checkpoint_path);
+  }
+
+  tally_set.allocate(settings.no_threads);
+  banks.reserve(settings.no_threads);
+
+  for(int thread{0}; thread < settings.no_threads; thread++)
+  {
+    banks.emplace_back(VarianceReductionConstants::ParticleBankCapacity);
+  }
+
+  for(int tally{0}; tally < tally_set.getNoTallies(); tally++)
+  {
+    statistics.emplace_back(tally_set.getTally(tally).getNoBins());
+  }
+}
+
+void RunDriver::addTarget(const ConvergenceTarget &target)
+{
+  if(target.tally < 0 || target.tally >= tally_set.getNoTallies() ||
+     target.bin < TallyStatistics::TotalBin ||
+     target.bin >= static_cast<long long>(
+                       tally_set.getTally(target.tally).getNoBins()))
+  {
+    throw std::invalid_argument("Invalid convergence target: no such tally "
+                                "bin");
+  }
+
+  if(!(target.relative_error > 0.0))
+  {
+    throw std::invalid_argument("Invalid convergence target: relative error "
+                                "must be greater than 0");
+  }
+
+  targets.push_back(target);
+}
+
+bool RunDriver::isConverged() const
+{
+  if(batches_run < TransportConstants::MinBatches)
+  {
+    return false;
+  }
+
+  for(const ConvergenceTarget &target : targets)
+  {
+    if(!(statistics[target.tally].getRelativeError(target.bin) <=
+         target.relative_error))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Checkpoint RunDriver::getCheckpoint() const
+{
+  return {settings.seed,
+          settings.no_threads,
+          settings.histories_per_batch,
+          histories_run,
+          batches_run,
+          elapsed_seconds,
+          statistics};
+}
+
+void RunDriver::restart(const Checkpoint &checkpoint)
+{
+  if(checkpoint.seed != settings.seed ||
+     checkpoint.no_threads != settings.no_threads ||
+     checkpoint.histories_per_batch != settings.histories_per_batch)
+  {
+    throw std::invalid_argument("Invalid checkpoint: seed, threads or batch "
+                                "size differ from the run settings");
+  }
+
+  if(checkpoint.statistics.size() != statistics.size())
+  {
+    throw std::invalid_argument("Invalid checkpoint: tallies differ");
+  }
+
+  for(size_t tally{0}; tally < statistics.size(); tally++)
+  {
+    if(checkpoint.statistics[tally].getNoBins() !=
+       statistics[tally].getNoBins())
+    {
+      throw std::invalid_argument("Invalid checkpoint: tally bins differ");
+    }
+  }
+
+  statistics = checkpoint.statistics;
+  histories_run = checkpoint.histories_run;
+  batches_run = checkpoint.batches_run;
+  elapsed_seconds = checkpoint.elapsed_seconds;
+  last_checkpoint_seconds = elapsed_seconds;
+}
+
+bool RunDriver::run()
+{
+  auto start{std::chrono::steady_clock::now()};
+  double previous_seconds{elapsed_seconds};
+
+  // Lookups made while setting up are done with, and the calling thread
+  // mostly waits on the workers from here
+  DataProcessor::releaseThread();
+
+  while(histories_run < settings.max_histories)
+  {
+    long long histories{std::min(settings.histories_per_batch,
+                                 settings.max_histories - histories_run)};
+
+    runBatch(histories);
+
+    const std::vector<TallyBuffer> &batch_totals{tally_set.reduce()};
+
+    for(size_t tally{0}; tally < statistics.size(); tally++)
+    {
+      statistics[tally].addBatch(batch_totals[tally], histories);
+    }
+
+    histories_run += histories;
+    batches_run += 1;
+    elapsed_seconds =
+        previous_seconds +
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    // Copying the statistics is all the batch loop pays for a checkpoint
+    double since_checkpoint{elapsed_seconds - last_checkpoint_seconds};
+
+    if(checkpoint_writer != nullptr &&
+       since_checkpoint >= settings.checkpoint_interval)
+    {
+      checkpoint_writer->submit(getCheckpoint());
+      last_checkpoint_seconds = elapsed_seconds;
+    }
+
+    if(!targets.empty() && isConverged())
+    {
+      break;
+    }
+  }
+
+  if(checkpoint_writer != nullptr)
+  {
+    checkpoint_writer->submit(getCheckpoint());
+    checkpoint_writer->flush();
+  }
+
+  return isConverged();
+}
+
+void RunDriver::runBatch(long long histories)
+{
+  auto runThread{
+      [this, histories](int thread)
+      {
+        // Reloads during the run free the versions they replace between
+        // batches
+        DataProcessor::ThreadRelease release;
+
+        long long first{histories * thread / settings.no_threads};
+        long long last{histories * (thread + 1) / settings.no_threads};
+
+        // Independent stream per batch and thread, reproducible for a given
+        // seed and thread count
+        RandomNumberGenerator rng(RandomNumberGenerator::mixSeed(
+            settings.seed ^ RandomNumberGenerator::mixSeed(batches_run) ^
+            RandomNumberGenerator::mixSeed(
+                ~static_cast<std::uint64_t>(thread))));
+
+        for(long long history{first}; history < last; history++)
+        {
+          // Source particles are numbered by history over the whole run
+          Particle particle{source(rng)};
+          particle.setID(static_cast<std::uint64_t>(histories_run + history));
+          runHistory(thread, particle, rng);
+        }
+      }};
+
+  // Single threaded runs stay on the calling thread, e.g. inside sweeps that
+  // are already parallel
+  if(settings.no_threads == 1)
+  {
+    runThread(0);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  NumaReplicas &numa_replicas{NumaReplicas::getInstance()};
+
+  for(int thread{0}; thread < settings.no_threads; thread++)
+  {
+    // With replicas, workers are spread over the NUMA nodes and stay there
+    // so that they read their local copy
+    threads.emplace_back(
+        [&runThread, &numa_replicas, thread]
+        {
+          if(numa_replicas.isEnabled())
+          {
+            numa_replicas.bindThread(thread);
+          }
+
+          runThread(thread);
+        });
+  }
+
+  for(std::thread &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void RunDriver::runHistory(int thread, Particle &particle,
+                           RandomNumberGenerator &rng)
+{
+  NSE_TIME_SCOPE(TRANSPORT);
+
+  ParticleBank &bank{banks[thread]};
+
+  transportParticle(thread, particle, rng, bank);
+
+  while(!bank.isEmpty())
+  {
+    bank.pop(particle);
+    transportParticle(thread, particle, rng, bank);
+  }
+
+  tally_set.endHistory(thread);
+}
+
+void RunDriver::transportParticle(int thread, Particle &particle,
+                                  RandomNumberGenerator &rng,
+                                  ParticleBank &bank)
+{
+  const Geometry &geometry{transport.getGeometry()};
+
+  // Recording costs nothing beyond this test when there is no recorder
+  TrackRecorder *recorder{settings.track_recorder};
+  auto record{[&](const Particle &recorded, int region, TrackEvent track_event,
+                  std::uint8_t reaction = 0)
+              {
+                if(recorder != nullptr)
+                {
+                  recorder->record(thread, recorded, region, track_event,
+                                   reaction);
+                }
+              }};
+
+  if(recorder != nullptr)
+  {
+    record(particle, geometry.findRegion(particle.getPosition()),
+           TrackEvent::START);
+  }
+
+  // With weight windows or path biasing the particle also stops on entering a
+  // region so they can act on crossings
+  bool stop_at_boundaries{settings.weight_windows != nullptr ||
+                          settings.path_biasing != nullptr};
+
+  // Set when the particle enters a region with forced collisions, which is
+  // the region of the last event
+  bool force_collision{false};
+  TransportEvent event{-1, false};
+
+  while(true)
+  {
+    Vector3D start{particle.getPosition()};
+
+    if(force_collision)
+    {
+      Particle uncollided{particle};
+      std::optional<TransportEvent> crossing{
+          transport.forceCollision(particle, uncollided, event.region, rng)};
+
+      // Nothing crosses when the uncollided part lost its roulette
+      if(crossing && crossing->region == -1)
+      {
+        record(uncollided, -1, TrackEvent::ESCAPE);
+        scoreEscape(thread, start, uncollided);
+      }
+      else if(crossing)
+      {
+        tally_set.scoreTrack(thread, start, uncollided.getPosition(),
+                             uncollided.getEnergy(), uncollided.getWeight());
+        bank.push(uncollided);
+      }
+
+      event = {geometry.findRegion(particle.getPosition()), true};
+    }
+    else if(stop_at_boundaries)
+    {
+      event = transport.moveToEvent(particle, rng, settings.path_biasing);
+    }
+    else
+    {
+      event = {transport.moveToCollision(particle, rng), true};
+    }
+
+    force_collision = false;
+    int region{event.region};
+
+    if(region == -1)
+    {
+      record(particle, -1, TrackEvent::ESCAPE);
+      scoreEscape(thread, start, particle);
+      return;
+    }
+
+    tally_set.scoreTrack(thread, start, particle.getPosition(),
+                         particle.getEnergy(), particle.getWeight());
+
+    if(!event.collided)
+    {
+      record(particle, region, TrackEvent::CROSSING);
+
+      if(settings.weight_windows != nullptr &&
+         !settings.weight_windows->apply(particle, region, rng, bank))
+      {
+        record(particle, region, TrackEvent::END);
+        return;
+      }
+
+      // Forcing needs room in the bank for the uncollided part
+      force_collision = settings.path_biasing != nullptr &&
+                        settings.path_biasing->isForced(region) &&
+                        geometry.getMaterial(region) != nullptr &&
+                        bank.getFreeSpace() > 0;
+
+      continue;
+    }
+
+    CollisionResult result{
+        physics.collide(particle, *geometry.getMaterial(region), rng,
+                        settings.implicit_capture, &bank)};
+    record(particle, region, TrackEvent::COLLISION,
+           static_cast<std::uint8_t>(result.reaction));
+    NSE_COUNT_COLLISION(result.reaction);
+
+    double deposit{result.deposited_energy};
+    bool absorbed{result.absorbed};
+
+    if(!absorbed &&
+       particle.getEnergy() < TransportConstants::PhotonEnergyCutoff)
+    {
+      deposit += particle.getWeight() * particle.getEnergy();
+      absorbed = true;
+    }
+
+    if(deposit > 0.0)
+    {
+      tally_set.scoreDeposit(thread, particle.getPosition(), region, deposit);
+    }
+
+    if(absorbed)
+    {
+      record(particle, region, TrackEvent::END);
+      return;
+    }
+
+    // Population control
+    if(settings.weight_windows != nullptr)
+    {
+      if(!settings.weight_windows->apply(particle, region, rng, bank))
+      {
+        record(particle, region, TrackEvent::END);
+        return;
+      }
+    }
+    else if(settings.implicit_capture &&
+            particle.getWeight() < VarianceReductionConstants::CutoffWeight)
+    {
+      double survival_weight{VarianceReductionConstants::CutoffSurvivalWeight};
+
+      if(rng.getUniform() * survival_weight > particle.getWeight())
+      {
+        record(particle, region, TrackEvent::END);
+        return;
+      }
+
+      particle.setWeight(survival_weight);
+    }
+  }
+}
+
+void RunDriver::scoreEscape(int thread, const Vector3D &start,
+                            const Particle &particle)
+{
+  // Escaped particles fly on forever, so tallies outside the geometry still
+  // see them
+  tally_set.scoreTrack(thread, start,
+                       particle.getPosition() +
+                           particle.getDirection() *
+                               TallyConstants::EscapeTrackLength,
+                       particle.getEnergy(), particle.getWeight());
+}
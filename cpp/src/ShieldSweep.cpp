@@ -0,0 +1,342 @@
+// Implementation of the ShieldSweep class
+
+#include "ShieldSweep.hpp"
+#include "RunDriver.hpp"
+#include "SlabGeometry.hpp"
+#include "TallySet.hpp"
+#include "Transport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+
+// Constructor
+ShieldSweep::ShieldSweep(const SweepSpace &space_,
+                         const SweepSettings &settings_)
+    : space{space_}, settings{settings_}
+{
+  checkSpace();
+
+  // Distinct materials so lookups are shared between layers
+  for(const std::vector<const Material *> &candidates : space.materials)
+  {
+    std::vector<int> indices;
+
+    for(const Material *material : candidates)
+    {
+      if(material == nullptr)
+      {
+        indices.push_back(-1);
+        continue;
+      }
+
+      auto it{std::find(materials.begin(), materials.end(), material)};
+
+      if(it == materials.end())
+      {
+        materials.push_back(material);
+        it = materials.end() - 1;
+      }
+
+      indices.push_back(static_cast<int>(std::distance(materials.begin(), it)));
+    }
+
+    layer_materials.push_back(indices);
+  }
+}
+
+void ShieldSweep::checkSpace() const
+{
+  if(space.materials.empty() ||
+     space.materials.size() != space.thicknesses.size() ||
+     space.energies.empty())
+  {
+    throw std::invalid_argument("Invalid sweep space: need candidates for at "
+                                "least one layer and one energy");
+  }
+
+  for(size_t layer{0}; layer < space.materials.size(); layer++)
+  {
+    if(space.materials[layer].empty() || space.thicknesses[layer].empty())
+    {
+      throw std::invalid_argument("Invalid sweep space: every layer needs "
+                                  "material and thickness candidates");
+    }
+
+    for(double thickness : space.thicknesses[layer])
+    {
+      if(!(thickness > 0.0))
+      {
+        throw std::invalid_argument("Invalid sweep space: thicknesses must "
+                                    "be greater than 0");
+      }
+    }
+  }
+
+  for(double energy : space.energies)
+  {
+    if(!(energy > TransportConstants::PhotonEnergyCutoff))
+    {
+      throw std::invalid_argument("Invalid sweep space: energies must be "
+                                  "above the photon energy cutoff");
+    }
+  }
+
+  if(settings.no_threads < 1 || settings.histories < 1)
+  {
+    throw std::invalid_argument("Invalid sweep settings: threads and "
+                                "histories must be at least 1");
+  }
+}
+
+void ShieldSweep::setBuildup(const Material &material,
+                             const GPBuildup &buildup)
+{
+  buildups.insert_or_assign(&material, buildup);
+}
+
+long long ShieldSweep::getNoConfigurations() const
+{
+  long long no_configurations{static_cast<long long>(space.energies.size())};
+
+  for(size_t layer{0}; layer < space.materials.size(); layer++)
+  {
+    no_configurations *=
+        static_cast<long long>(space.materials[layer].size() *
+                               space.thicknesses[layer].size());
+  }
+
+  return no_configurations;
+}
+
+void ShieldSweep::decode(long long index, std::vector<int> &material_choices,
+                         std::vector<int> &thickness_choices,
+                         int &energy_index) const
+{
+  size_t no_layers{space.materials.size()};
+
+  material_choices.resize(no_layers);
+  thickness_choices.resize(no_layers);
+
+  long long no_energies{static_cast<long long>(space.energies.size())};
+  energy_index = static_cast<int>(index % no_energies);
+  index /= no_energies;
+
+  for(size_t layer{no_layers}; layer-- > 0;)
+  {
+    long long no_thicknesses{
+        static_cast<long long>(space.thicknesses[layer].size())};
+    long long no_materials{
+        static_cast<long long>(space.materials[layer].size())};
+
+    thickness_choices[layer] = static_cast<int>(index % no_thicknesses);
+    index /= no_thicknesses;
+    material_choices[layer] = static_cast<int>(index % no_materials);
+    index /= no_materials;
+  }
+}
+
+SweepConfiguration ShieldSweep::getConfiguration(long long index) const
+{
+  if(index < 0 || index >= getNoConfigurations())
+  {
+    throw std::out_of_range("Sweep configuration index out of range");
+  }
+
+  std::vector<int> material_choices;
+  std::vector<int> thickness_choices;
+  int energy_index;
+  decode(index, material_choices, thickness_choices, energy_index);
+
+  SweepConfiguration configuration{{}, space.energies[energy_index]};
+
+  for(size_t layer{0}; layer < space.materials.size(); layer++)
+  {
+    configuration.layers.push_back(
+        {space.materials[layer][material_choices[layer]],
+         space.thicknesses[layer][thickness_choices[layer]]});
+  }
+
+  return configuration;
+}
+
+void ShieldSweep::buildLookups()
+{
+  coefs.assign(space.energies.size(),
+               std::vector<double>(materials.size(), 0.0));
+  gp_coefficients.assign(
+      space.energies.size(),
+      std::vector<std::optional<GPCoefficients>>(materials.size()));
+
+  for(size_t energy{0}; energy < space.energies.size(); energy++)
+  {
+    for(size_t material{0}; material < materials.size(); material++)
+    {
+      coefs[energy][material] = materials[material]->getLinearAttenCoef(
+          space.energies[energy],
+          ParticleConstants::ReactionType::TOTAL_WITH_COHERENT,
+          ParticleConstants::ParticleType::GAMMA);
+
+      auto it{buildups.find(materials[material])};
+
+      if(it != buildups.end())
+      {
+        gp_coefficients[energy][material] =
+            it->second.getCoefficients(space.energies[energy]);
+      }
+    }
+  }
+
+  if(settings.method == SweepMethod::MONTE_CARLO && !physics)
+  {
+    physics = std::make_unique<PhotonPhysics>(materials);
+  }
+}
+
+double
+ShieldSweep::evaluatePointKernel(const std::vector<int> &material_choices,
+                                 const std::vector<int> &thickness_choices,
+                                 int energy_index) const
+{
+  double mean_free_paths{0.0};
+  int last_material{-1};
+
+  for(size_t layer{0}; layer < material_choices.size(); layer++)
+  {
+    int material{layer_materials[layer][material_choices[layer]]};
+
+    if(material == -1)
+    {
+      continue;
+    }
+
+    mean_free_paths += coefs[energy_index][material] *
+                       space.thicknesses[layer][thickness_choices[layer]];
+    last_material = material;
+  }
+
+  double transmission{std::exp(-mean_free_paths)};
+
+  if(last_material != -1 && gp_coefficients[energy_index][last_material])
+  {
+    transmission *= GPBuildup::evaluate(
+        *gp_coefficients[energy_index][last_material], mean_free_paths);
+  }
+
+  return transmission;
+}
+
+std::pair<double, double>
+ShieldSweep::evaluateMonteCarlo(long long index,
+                                const SweepConfiguration &configuration) const
+{
+  SlabGeometry geometry(configuration.layers);
+  Transport transport(geometry, ParticleConstants::ParticleType::GAMMA,
+                      TrackingMode::SURFACE);
+
+  TallySet tally_set;
+  int behind{tally_set.addTally(std::make_unique<SurfaceTally>(
+      "transmission", Vector3D::UNITZ, geometry.getTotalThickness(),
+      std::vector<double>{TransportConstants::PhotonEnergyCutoff,
+                          2.0 * configuration.energy}))};
+
+  RunSettings run_settings;
+  run_settings.histories_per_batch =
+      std::max(1LL, settings.histories / TransportConstants::MinBatches);
+  run_settings.max_histories = settings.histories;
+  run_settings.seed = settings.seed + static_cast<std::uint64_t>(index);
+
+  double energy{configuration.energy};
+  RunDriver driver(transport, *physics, tally_set,
+                   [energy](RandomNumberGenerator &)
+                   {
+                     return Particle(ParticleConstants::ParticleType::GAMMA,
+                                     energy, Vector3D::ZERO, Vector3D::UNITZ);
+                   },
+                   run_settings);
+  driver.run();
+
+  // Bin 0 is the net current of the only energy bin
+  const TallyStatistics &statistics{driver.getStatistics(behind)};
+
+  return {statistics.getMean(0), statistics.getRelativeError(0)};
+}
+
+void ShieldSweep::run(
+    const std::function<void(const SweepResult &)> &on_result)
+{
+  buildLookups();
+
+  long long no_configurations{getNoConfigurations()};
+  long long chunk{(settings.method == SweepMethod::POINT_KERNEL)
+                      ? SweepConstants::PointKernelChunk
+                      : SweepConstants::MonteCarloChunk};
+  std::atomic<long long> next{0};
+  std::mutex result_mutex;
+
+  // Workers claim chunks of configurations until none are left
+  auto work{[&]()
+            {
+              std::vector<int> material_choices;
+              std::vector<int> thickness_choices;
+              int energy_index;
+              std::vector<SweepResult> results;
+
+              while(true)
+              {
+                long long first{next.fetch_add(chunk)};
+
+                if(first >= no_configurations)
+                {
+                  return;
+                }
+
+                long long last{std::min(first + chunk, no_configurations)};
+                results.clear();
+
+                for(long long index{first}; index < last; index++)
+                {
+                  SweepResult result{index, getConfiguration(index), 0.0,
+                                     0.0};
+
+                  if(settings.method == SweepMethod::POINT_KERNEL)
+                  {
+                    decode(index, material_choices, thickness_choices,
+                           energy_index);
+                    result.transmission = evaluatePointKernel(
+                        material_choices, thickness_choices, energy_index);
+                  }
+                  else
+                  {
+                    std::tie(result.transmission, result.relative_error) =
+                        evaluateMonteCarlo(index, result.configuration);
+                  }
+
+                  results.push_back(std::move(result));
+                }
+
+                std::lock_guard<std::mutex> lock(result_mutex);
+
+                for(const SweepResult &result : results)
+                {
+                  on_result(result);
+                }
+              }
+            }};
+
+  std::vector<std::future<void>> workers;
+
+  for(int thread{0}; thread < settings.no_threads; thread++)
+  {
+    workers.push_back(std::async(std::launch::async, work));
+  }
+
+  // Rethrows the first worker exception
+  for(std::future<void> &worker : workers)
+  {
+    worker.get();
+  }
+}
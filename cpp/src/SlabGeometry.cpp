@@ -0,0 +1,68 @@
+// Implementation of the SlabGeometry class
+
+#include "SlabGeometry.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// Constructor
+SlabGeometry::SlabGeometry(
+    const std::vector<std::pair<const Material *, double>> &layers)
+{
+  if(layers.empty())
+  {
+    throw std::invalid_argument(
+        "Invalid slab geometry: must have at least one layer");
+  }
+
+  boundaries.push_back(0.0);
+
+  for(const auto &layer : layers)
+  {
+    if(!(layer.second > 0.0))
+    {
+      throw std::invalid_argument(
+          "Invalid slab geometry: layer thickness must be greater than 0");
+    }
+
+    materials.push_back(layer.first);
+    boundaries.push_back(boundaries.back() + layer.second);
+  }
+}
+
+int SlabGeometry::findRegion(const Vector3D &position) const
+{
+  double z{position.getZ()};
+
+  // Outside the stack
+  if(z < boundaries.front() || z >= boundaries.back())
+  {
+    return -1;
+  }
+
+  // upper_bound gives the first boundary > z, the layer is the one before it
+  auto it{std::upper_bound(boundaries.begin(), boundaries.end(), z)};
+
+  return static_cast<int>(std::distance(boundaries.begin(), it)) - 1;
+}
+
+double SlabGeometry::distanceToBoundary(const Vector3D &position,
+                                        const Vector3D &direction,
+                                        int region) const
+{
+  double z{position.getZ()};
+  double direction_z{direction.getZ()};
+
+  if(direction_z > 0.0)
+  {
+    return (boundaries.at(region + 1) - z) / direction_z;
+  }
+  if(direction_z < 0.0)
+  {
+    return (boundaries.at(region) - z) / direction_z;
+  }
+
+  // Travelling parallel to the layers
+  return std::numeric_limits<double>::infinity();
+}
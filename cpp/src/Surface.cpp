@@ -0,0 +1,303 @@
+// Implementation of the Surface classes
+
+#include "Surface.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+
+const double infinity{std::numeric_limits<double>::infinity()};
+
+// Smallest positive root of a t^2 + 2 half_b t + c = 0, infinite if none
+double smallestPositiveRoot(double a, double half_b, double c)
+{
+  double discriminant{half_b * half_b - a * c};
+
+  if(discriminant < 0.0 || a == 0.0)
+  {
+    return infinity;
+  }
+
+  // Numerically stable form avoiding cancellation between half_b and the root
+  double q{-(half_b + std::copysign(std::sqrt(discriminant), half_b))};
+
+  if(q == 0.0)
+  {
+    return infinity; // Grazing at the current position
+  }
+
+  double root1{q / a};
+  double root2{c / q};
+
+  if(root1 > root2)
+  {
+    std::swap(root1, root2);
+  }
+
+  if(root1 > 0.0)
+  {
+    return root1;
+  }
+  if(root2 > 0.0)
+  {
+    return root2;
+  }
+
+  return infinity;
+}
+
+} // namespace
+
+// Plane
+Plane::Plane(const Vector3D &normal_, double offset_)
+{
+  double magnitude{normal_.magnitude()};
+
+  if(magnitude == 0.0)
+  {
+    throw std::invalid_argument(
+        "Invalid plane: normal vector cannot be {0, 0, 0}");
+  }
+
+  normal = normal_ / magnitude;
+  offset = offset_ / magnitude;
+}
+
+double Plane::evaluate(const Vector3D &position) const
+{
+  return normal.dot(position) - offset;
+}
+
+double Plane::distance(const Vector3D &position,
+                       const Vector3D &direction) const
+{
+  double denominator{normal.dot(direction)};
+
+  if(denominator == 0.0)
+  {
+    return infinity;
+  }
+
+  double t{-evaluate(position) / denominator};
+
+  return (t > 0.0) ? t : infinity;
+}
+
+BoundingBox Plane::halfSpaceBounds(const Vector3D &half_space_normal,
+                                   double half_space_offset) const
+{
+  // Half-space n.x < d is only bounded by a box if n is along an axis, in
+  // which case n is a unit vector of +-1 along that axis
+  BoundingBox bounds;
+
+  double x{half_space_normal.getX()};
+  double y{half_space_normal.getY()};
+  double z{half_space_normal.getZ()};
+
+  if(y == 0.0 && z == 0.0)
+  {
+    if(x > 0.0)
+    {
+      bounds.max.setX(half_space_offset);
+    }
+    else
+    {
+      bounds.min.setX(-half_space_offset);
+    }
+  }
+  else if(x == 0.0 && z == 0.0)
+  {
+    if(y > 0.0)
+    {
+      bounds.max.setY(half_space_offset);
+    }
+    else
+    {
+      bounds.min.setY(-half_space_offset);
+    }
+  }
+  else if(x == 0.0 && y == 0.0)
+  {
+    if(z > 0.0)
+    {
+      bounds.max.setZ(half_space_offset);
+    }
+    else
+    {
+      bounds.min.setZ(-half_space_offset);
+    }
+  }
+
+  return bounds;
+}
+
+BoundingBox Plane::getInsideBounds() const
+{
+  return halfSpaceBounds(normal, offset);
+}
+
+BoundingBox Plane::getOutsideBounds() const
+{
+  return halfSpaceBounds(normal * -1.0, -offset);
+}
+
+// Sphere
+Sphere::Sphere(const Vector3D &centre_, double radius_)
+    : centre{centre_}, radius{radius_}
+{
+  if(!(radius > 0.0))
+  {
+    throw std::invalid_argument(
+        "Invalid sphere: radius must be greater than 0");
+  }
+}
+
+double Sphere::evaluate(const Vector3D &position) const
+{
+  return (position - centre).squaredMagnitude() - radius * radius;
+}
+
+double Sphere::distance(const Vector3D &position,
+                        const Vector3D &direction) const
+{
+  Vector3D offset{position - centre};
+
+  return smallestPositiveRoot(1.0, direction.dot(offset),
+                              offset.squaredMagnitude() - radius * radius);
+}
+
+BoundingBox Sphere::getInsideBounds() const
+{
+  return {centre - Vector3D(radius), centre + Vector3D(radius)};
+}
+
+// Cylinder
+Cylinder::Cylinder(const Vector3D &point_, const Vector3D &axis_,
+                   double radius_)
+    : point{point_}, radius{radius_}
+{
+  if(axis_.isZero())
+  {
+    throw std::invalid_argument(
+        "Invalid cylinder: axis vector cannot be {0, 0, 0}");
+  }
+  if(!(radius > 0.0))
+  {
+    throw std::invalid_argument(
+        "Invalid cylinder: radius must be greater than 0");
+  }
+
+  axis = axis_.normalise();
+}
+
+double Cylinder::evaluate(const Vector3D &position) const
+{
+  // Squared distance from the axis is |(x - p) x a|^2
+  return (position - point).cross(axis).squaredMagnitude() - radius * radius;
+}
+
+double Cylinder::distance(const Vector3D &position,
+                          const Vector3D &direction) const
+{
+  // Project position and direction perpendicular to the axis
+  Vector3D offset_perp{(position - point).cross(axis)};
+  Vector3D direction_perp{direction.cross(axis)};
+
+  return smallestPositiveRoot(direction_perp.squaredMagnitude(),
+                              direction_perp.dot(offset_perp),
+                              offset_perp.squaredMagnitude() - radius * radius);
+}
+
+BoundingBox Cylinder::getInsideBounds() const
+{
+  // The cylinder runs to infinity along every coordinate the axis has a
+  // component in and is bounded by the radius along the others
+  BoundingBox bounds;
+
+  if(axis.getX() == 0.0)
+  {
+    bounds.min.setX(point.getX() - radius);
+    bounds.max.setX(point.getX() + radius);
+  }
+  if(axis.getY() == 0.0)
+  {
+    bounds.min.setY(point.getY() - radius);
+    bounds.max.setY(point.getY() + radius);
+  }
+  if(axis.getZ() == 0.0)
+  {
+    bounds.min.setZ(point.getZ() - radius);
+    bounds.max.setZ(point.getZ() + radius);
+  }
+
+  return bounds;
+}
+
+// Box
+Box::Box(const Vector3D &min_, const Vector3D &max_) : bounds{min_, max_}
+{
+  if(!(min_.getX() < max_.getX() && min_.getY() < max_.getY() &&
+       min_.getZ() < max_.getZ()))
+  {
+    throw std::invalid_argument(
+        "Invalid box: min corner must be below max corner on every axis");
+  }
+}
+
+double Box::evaluate(const Vector3D &position) const
+{
+  // Largest signed distance outside any pair of faces
+  Vector3D below{bounds.min - position};
+  Vector3D above{position - bounds.max};
+
+  return std::max({below.getX(), below.getY(), below.getZ(), above.getX(),
+                   above.getY(), above.getZ()});
+}
+
+double Box::distance(const Vector3D &position,
+                     const Vector3D &direction) const
+{
+  // Slab method
+  double t_near{-infinity};
+  double t_far{infinity};
+
+  const double positions[3]{position.getX(), position.getY(),
+                            position.getZ()};
+  const double directions[3]{direction.getX(), direction.getY(),
+                             direction.getZ()};
+  const double mins[3]{bounds.min.getX(), bounds.min.getY(),
+                       bounds.min.getZ()};
+  const double maxs[3]{bounds.max.getX(), bounds.max.getY(),
+                       bounds.max.getZ()};
+
+  for(int axis{0}; axis < 3; axis++)
+  {
+    if(directions[axis] == 0.0)
+    {
+      // Parallel to this pair of faces
+      if(positions[axis] < mins[axis] || positions[axis] > maxs[axis])
+      {
+        return infinity;
+      }
+      continue;
+    }
+
+    double t1{(mins[axis] - positions[axis]) / directions[axis]};
+    double t2{(maxs[axis] - positions[axis]) / directions[axis]};
+
+    t_near = std::max(t_near, std::min(t1, t2));
+    t_far = std::min(t_far, std::max(t1, t2));
+  }
+
+  if(t_near > t_far || t_far <= 0.0)
+  {
+    return infinity;
+  }
+
+  // Inside the box the exit is the next crossing
+  return (t_near > 0.0) ? t_near : t_far;
+}
@@ -0,0 +1,190 @@
+// Implementation of the TallyBuffer and Tally classes
+
+#include "Tally.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+TallyBuffer::TallyBuffer(size_t no_bins_, TallyStorage storage_)
+    : storage{storage_}, no_bins{no_bins_}, history_score{0.0}
+{
+  if(storage == TallyStorage::DENSE)
+  {
+    dense_scores.assign(no_bins, 0.0);
+  }
+}
+
+double TallyBuffer::get(size_t bin) const
+{
+  if(bin >= no_bins)
+  {
+    throw std::out_of_range("Tally bin out of range");
+  }
+
+  if(storage == TallyStorage::DENSE)
+  {
+    return dense_scores[bin];
+  }
+
+  auto it{sparse_scores.find(bin)};
+
+  return (it == sparse_scores.end()) ? 0.0 : it->second;
+}
+
+size_t TallyBuffer::getMemoryBytes() const
+{
+  // Sparse entries are counted with their node and bucket overhead
+  return dense_scores.capacity() * sizeof(double) +
+         sparse_scores.size() *
+             (sizeof(std::pair<const size_t, double>) + 2 * sizeof(void *)) +
+         sparse_scores.bucket_count() * sizeof(void *);
+}
+
+void TallyBuffer::merge(const TallyBuffer &other)
+{
+  if(other.no_bins != no_bins || other.storage != storage)
+  {
+    throw std::invalid_argument("Cannot merge tally buffers of different "
+                                "layouts");
+  }
+
+  if(storage == TallyStorage::DENSE)
+  {
+    for(size_t bin{0}; bin < no_bins; bin++)
+    {
+      dense_scores[bin] += other.dense_scores[bin];
+    }
+  }
+  else
+  {
+    for(const auto &bin_score : other.sparse_scores)
+    {
+      sparse_scores[bin_score.first] += bin_score.second;
+    }
+  }
+}
+
+void TallyBuffer::clear()
+{
+  std::fill(dense_scores.begin(), dense_scores.end(), 0.0);
+  sparse_scores.clear();
+  history_score = 0.0;
+}
+
+int Tally::findEnergyBin(const std::vector<double> &edges, double energy)
+{
+  if(!(energy >= edges.front() && energy < edges.back()))
+  {
+    return -1;
+  }
+
+  return static_cast<int>(
+             std::upper_bound(edges.begin(), edges.end(), energy) -
+             edges.begin()) -
+         1;
+}
+
+void Tally::checkEnergyEdges(const std::vector<double> &edges)
+{
+  if(edges.size() < 2 || !std::is_sorted(edges.begin(), edges.end()) ||
+     std::adjacent_find(edges.begin(), edges.end()) != edges.end())
+  {
+    throw std::invalid_argument("Invalid tally energy edges: need at least two "
+                                "strictly increasing edges");
+  }
+}
+
+void MeshTally::scoreDeposit(TallyBuffer &buffer, const Vector3D &position,
+                             int, double deposit) const
+{
+  long long voxel{mesh.getVoxel(position)};
+
+  if(voxel >= 0)
+  {
+    buffer.add(static_cast<size_t>(voxel), deposit);
+  }
+}
+
+// Constructor
+SurfaceTally::SurfaceTally(const std::string &name_, const Vector3D &normal_,
+                           double offset_,
+                           const std::vector<double> &energy_edges_)
+    : Tally{name_, TallyStorage::DENSE}, offset{offset_},
+      energy_edges{energy_edges_}
+{
+  if(normal_.isZero())
+  {
+    throw std::invalid_argument("Invalid surface tally: normal cannot be "
+                                "zero");
+  }
+
+  checkEnergyEdges(energy_edges);
+
+  // Keep the plane the same when normalising
+  double magnitude{normal_.magnitude()};
+  normal = normal_ / magnitude;
+  offset /= magnitude;
+}
+
+void SurfaceTally::scoreTrack(TallyBuffer &buffer, const Vector3D &start,
+                              const Vector3D &end, double energy,
+                              double weight) const
+{
+  double start_side{normal.dot(start) - offset};
+  double end_side{normal.dot(end) - offset};
+
+  // Only straight tracks that change side cross the plane
+  if((start_side < 0.0) == (end_side < 0.0))
+  {
+    return;
+  }
+
+  int energy_bin{findEnergyBin(energy_edges, energy)};
+
+  if(energy_bin < 0)
+  {
+    return;
+  }
+
+  double cos_theta{normal.dot((end - start).normalise())};
+  double abs_cos{std::max(std::abs(cos_theta), TallyConstants::MinSurfaceCos)};
+
+  buffer.add(2 * energy_bin, (cos_theta > 0.0) ? weight : -weight);
+  buffer.add(2 * energy_bin + 1, weight / abs_cos);
+}
+
+// Constructor
+PulseHeightTally::PulseHeightTally(const std::string &name_,
+                                   const std::vector<int> &regions_,
+                                   const std::vector<double> &energy_edges_)
+    : Tally{name_, TallyStorage::DENSE}, regions{regions_},
+      energy_edges{energy_edges_}
+{
+  checkEnergyEdges(energy_edges);
+}
+
+void PulseHeightTally::scoreDeposit(TallyBuffer &buffer, const Vector3D &,
+                                    int region, double deposit) const
+{
+  if(std::find(regions.begin(), regions.end(), region) != regions.end())
+  {
+    buffer.addHistoryScore(deposit);
+  }
+}
+
+void PulseHeightTally::endHistory(TallyBuffer &buffer) const
+{
+  double deposit{buffer.takeHistoryScore()};
+
+  if(deposit > 0.0)
+  {
+    int energy_bin{findEnergyBin(energy_edges, deposit)};
+
+    if(energy_bin >= 0)
+    {
+      buffer.add(energy_bin, 1.0);
+    }
+  }
+}
@@ -0,0 +1,105 @@
+// Implementation of the TallySet class
+
+#include "TallySet.hpp"
+
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+int TallySet::addTally(std::unique_ptr<Tally> tally)
+{
+  if(!thread_buffers.empty())
+  {
+    throw std::runtime_error("Tallies must be added before allocating "
+                             "buffers");
+  }
+
+  tallies.push_back(std::move(tally));
+
+  return static_cast<int>(tallies.size()) - 1;
+}
+
+void TallySet::allocate(int no_threads)
+{
+  if(no_threads < 1)
+  {
+    throw std::invalid_argument("Invalid number of threads: must be at least "
+                                "1");
+  }
+
+  thread_buffers.assign(no_threads, {});
+  batch_totals.clear();
+
+  for(const std::unique_ptr<Tally> &tally : tallies)
+  {
+    for(std::vector<TallyBuffer> &buffers : thread_buffers)
+    {
+      buffers.emplace_back(tally->getNoBins(), tally->getStorage());
+    }
+
+    batch_totals.emplace_back(tally->getNoBins(), tally->getStorage());
+  }
+}
+
+size_t TallySet::getMemoryBytes() const
+{
+  size_t bytes{0};
+
+  for(const std::vector<TallyBuffer> &buffers : thread_buffers)
+  {
+    for(const TallyBuffer &buffer : buffers)
+    {
+      bytes += buffer.getMemoryBytes();
+    }
+  }
+
+  for(const TallyBuffer &buffer : batch_totals)
+  {
+    bytes += buffer.getMemoryBytes();
+  }
+
+  return bytes;
+}
+
+const std::vector<TallyBuffer> &TallySet::reduce()
+{
+  int no_threads{getNoThreads()};
+
+  // Each round merges thread i + stride into thread i for every i that is a
+  // multiple of 2 * stride, leaving the total in thread 0
+  for(int stride{1}; stride < no_threads; stride *= 2)
+  {
+    std::vector<std::future<void>> merges;
+
+    for(int thread{0}; thread + stride < no_threads; thread += 2 * stride)
+    {
+      merges.push_back(std::async(
+          std::launch::async,
+          [this, thread, stride]()
+          {
+            std::vector<TallyBuffer> &target{thread_buffers[thread]};
+            std::vector<TallyBuffer> &source{thread_buffers[thread + stride]};
+
+            for(size_t i{0}; i < target.size(); i++)
+            {
+              target[i].merge(source[i]);
+              source[i].clear();
+            }
+          }));
+    }
+
+    for(std::future<void> &merge : merges)
+    {
+      merge.get();
+    }
+  }
+
+  // Swap the total out so no buffer is reallocated between batches
+  for(size_t i{0}; i < tallies.size(); i++)
+  {
+    std::swap(batch_totals[i], thread_buffers[0][i]);
+    thread_buffers[0][i].clear();
+  }
+
+  return batch_totals;
+}
@@ -0,0 +1,111 @@
+// Implementation of the TallyStatistics class
+
+#include "TallyStatistics.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Constructor
+TallyStatistics::TallyStatistics(size_t no_bins)
+    : no_batches{0}, no_histories{0}, means(no_bins, 0.0),
+      squared_deviations(no_bins, 0.0), total_mean{0.0},
+      total_squared_deviation{0.0}
+{}
+
+double TallyStatistics::getMean(long long bin) const
+{
+  return (bin == TotalBin) ? total_mean : means.at(bin);
+}
+
+double TallyStatistics::getRelativeError(long long bin) const
+{
+  double mean{getMean(bin)};
+  double squared_deviation{(bin == TotalBin) ? total_squared_deviation
+                                             : squared_deviations[bin]};
+
+  if(no_batches < 2 || mean == 0.0)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // Variance of the history weighted mean of no_batches batch results, with
+  // the variance of one history estimated from their spread
+  double variance{squared_deviation / (no_batches - 1) / no_histories};
+
+  return std::sqrt(variance) / std::abs(mean);
+}
+
+double TallyStatistics::getFigureOfMerit(long long bin, double seconds) const
+{
+  double relative_error{getRelativeError(bin)};
+
+  return 1.0 / (relative_error * relative_error * seconds);
+}
+
+void TallyStatistics::addBatch(const TallyBuffer &batch, long long histories)
+{
+  if(batch.getNoBins() != means.size())
+  {
+    throw std::invalid_argument("Batch does not match the tally statistics");
+  }
+
+  if(histories < 1)
+  {
+    throw std::invalid_argument("Invalid batch: must have at least 1 "
+                                "history");
+  }
+
+  no_batches += 1;
+  no_histories += histories;
+
+  // Unscored bins of a sparse batch still count as zero results
+  batch_scores.assign(means.size(), 0.0);
+  batch.forEachScore([this](size_t bin, double score)
+                     { batch_scores[bin] = score; });
+
+  double total{0.0};
+
+  for(size_t bin{0}; bin < means.size(); bin++)
+  {
+    double value{batch_scores[bin] / histories};
+    update(means[bin], squared_deviations[bin], value, histories);
+    total += value;
+  }
+
+  update(total_mean, total_squared_deviation, total, histories);
+}
+
+void TallyStatistics::writeState(std::ostream &os) const
+{
+  os.write(reinterpret_cast<const char *>(&no_batches), sizeof(no_batches));
+  os.write(reinterpret_cast<const char *>(&no_histories),
+           sizeof(no_histories));
+  os.write(reinterpret_cast<const char *>(&total_mean), sizeof(total_mean));
+  os.write(reinterpret_cast<const char *>(&total_squared_deviation),
+           sizeof(total_squared_deviation));
+  os.write(reinterpret_cast<const char *>(means.data()),
+           static_cast<std::streamsize>(means.size() * sizeof(double)));
+  os.write(reinterpret_cast<const char *>(squared_deviations.data()),
+           static_cast<std::streamsize>(squared_deviations.size() *
+                                        sizeof(double)));
+}
+
+void TallyStatistics::readState(std::istream &is)
+{
+  is.read(reinterpret_cast<char *>(&no_batches), sizeof(no_batches));
+  is.read(reinterpret_cast<char *>(&no_histories), sizeof(no_histories));
+  is.read(reinterpret_cast<char *>(&total_mean), sizeof(total_mean));
+  is.read(reinterpret_cast<char *>(&total_squared_deviation),
+          sizeof(total_squared_deviation));
+  is.read(reinterpret_cast<char *>(means.data()),
+          static_cast<std::streamsize>(means.size() * sizeof(double)));
+  is.read(reinterpret_cast<char *>(squared_deviations.data()),
+          static_cast<std::streamsize>(squared_deviations.size() *
+                                       sizeof(double)));
+
+  if(!is)
+  {
+    throw std::runtime_error("Truncated tally statistics state");
+  }
+}
@@ -0,0 +1,566 @@
+// Implementation of the TrackRecorder class
+
+#include "TrackRecorder.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+const size_t NoColumns{10};
+
+// Bytes per value of each column, in TrackColumn order
+const std::array<size_t, NoColumns> ColumnSizes{8, 8, 8, 8, 8, 8, 8, 4, 1, 1};
+
+// Longest literal or repeat run of the run length encoding
+const size_t MaxRun{128};
+
+template <typename T>
+void storeValue(std::vector<std::uint8_t> &bytes, size_t index, T value)
+{
+  std::memcpy(bytes.data() + index * sizeof(T), &value, sizeof(T));
+}
+
+template <typename T>
+T loadValue(const std::vector<std::uint8_t> &bytes, size_t index)
+{
+  T value;
+  std::memcpy(&value, bytes.data() + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+template <typename T> void writeValue(std::ofstream &file, T value)
+{
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readValue(std::ifstream &file)
+{
+  T value;
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+  return value;
+}
+
+} // namespace
+
+// Constructor
+TrackRecorder::TrackRecorder(const std::string &path, int no_threads,
+                             TrackCompression compression_,
+                             size_t ring_capacity)
+    : mask{ring_capacity - 1}, compression{compression_}
+{
+  if(no_threads < 1)
+  {
+    throw std::invalid_argument("Invalid track recorder: threads must be at "
+                                "least 1");
+  }
+
+  if(ring_capacity == 0 || (ring_capacity & mask) != 0)
+  {
+    throw std::invalid_argument("Invalid track recorder: ring capacity must "
+                                "be a power of 2");
+  }
+
+  file.open(path, std::ios::binary | std::ios::trunc);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot open track file " + path);
+  }
+
+  file.write(TrackConstants::FileMagic.data(),
+             TrackConstants::FileMagic.size());
+  writeValue(file, TrackConstants::FileVersion);
+
+  for(int thread{0}; thread < no_threads; thread++)
+  {
+    rings.push_back(std::make_unique<Ring>());
+    rings.back()->records.resize(ring_capacity);
+  }
+
+  chunk.reserve(TrackConstants::ChunkRecords);
+  free_chunks.resize(TrackConstants::ChunkBuffers - 1);
+
+  for(std::vector<TrackRecord> &free_chunk : free_chunks)
+  {
+    free_chunk.reserve(TrackConstants::ChunkRecords);
+  }
+
+  encoder = std::thread(&TrackRecorder::runEncoder, this);
+  writer = std::thread(&TrackRecorder::runWriter, this);
+}
+
+TrackRecorder::~TrackRecorder()
+{
+  try
+  {
+    close();
+  }
+  catch(...)
+  {
+    // Errors are only reported by an explicit close
+  }
+}
+
+long long TrackRecorder::getDropped() const
+{
+  long long dropped{0};
+
+  for(const std::unique_ptr<Ring> &ring : rings)
+  {
+    dropped += ring->dropped.load(std::memory_order_relaxed);
+  }
+
+  return dropped;
+}
+
+void TrackRecorder::close()
+{
+  if(closed)
+  {
+    return;
+  }
+
+  closed = true;
+  stopping.store(true, std::memory_order_release);
+  writer.join();
+  encoder.join();
+  file.close();
+
+  if(writer_error)
+  {
+    std::rethrow_exception(writer_error);
+  }
+}
+
+void TrackRecorder::runWriter()
+{
+  while(true)
+  {
+    // Read before draining so nothing recorded before close is missed
+    bool stop{stopping.load(std::memory_order_acquire)};
+    long long before{records_drained};
+
+    for(std::unique_ptr<Ring> &ring : rings)
+    {
+      if(!drain(*ring))
+      {
+        // Transport carries on, further records pile up in the rings and drop
+        return;
+      }
+    }
+
+    if(stop)
+    {
+      break;
+    }
+
+    if(records_drained == before)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(
+          TrackConstants::WriterPollMicroseconds));
+    }
+  }
+
+  if(!chunk.empty())
+  {
+    queueChunk();
+  }
+
+  std::lock_guard<std::mutex> lock{chunk_mutex};
+  drained = true;
+  chunk_ready.notify_one();
+}
+
+bool TrackRecorder::drain(Ring &ring)
+{
+  size_t tail{ring.tail.load(std::memory_order_relaxed)};
+  size_t head{ring.head.load(std::memory_order_acquire)};
+  records_drained += static_cast<long long>(head - tail);
+
+  while(tail != head)
+  {
+    chunk.push_back(ring.records[tail & mask]);
+    tail += 1;
+
+    // Free the slots before waiting for a buffer
+    if(chunk.size() == TrackConstants::ChunkRecords)
+    {
+      ring.tail.store(tail, std::memory_order_release);
+
+      if(!queueChunk())
+      {
+        return false;
+      }
+    }
+  }
+
+  ring.tail.store(tail, std::memory_order_release);
+
+  return true;
+}
+
+bool TrackRecorder::queueChunk()
+{
+  std::unique_lock<std::mutex> lock{chunk_mutex};
+  chunk_free.wait(lock,
+                  [this] { return !free_chunks.empty() || encoder_failed; });
+
+  if(encoder_failed)
+  {
+    return false;
+  }
+
+  full_chunks.push_back(std::move(chunk));
+  chunk = std::move(free_chunks.back());
+  free_chunks.pop_back();
+  chunk_ready.notify_one();
+
+  return true;
+}
+
+void TrackRecorder::runEncoder()
+{
+  try
+  {
+    while(true)
+    {
+      std::vector<TrackRecord> records;
+
+      {
+        std::unique_lock<std::mutex> lock{chunk_mutex};
+        chunk_ready.wait(lock,
+                         [this] { return !full_chunks.empty() || drained; });
+
+        if(full_chunks.empty())
+        {
+          break;
+        }
+
+        records = std::move(full_chunks.front());
+        full_chunks.pop_front();
+      }
+
+      writeChunk(records);
+      records.clear();
+
+      std::lock_guard<std::mutex> lock{chunk_mutex};
+      free_chunks.push_back(std::move(records));
+      chunk_free.notify_one();
+    }
+
+    // End of the file, with the number of records that never made it. The
+    // writer has stopped so the count is final.
+    writeValue(file, std::uint32_t{0});
+    writeValue(file, static_cast<std::uint64_t>(records_written));
+    writeValue(file, static_cast<std::uint64_t>(getDropped()));
+    file.flush();
+
+    if(!file)
+    {
+      throw std::runtime_error("Track file write failed");
+    }
+  }
+  catch(...)
+  {
+    writer_error = std::current_exception();
+
+    std::lock_guard<std::mutex> lock{chunk_mutex};
+    encoder_failed = true;
+    chunk_free.notify_one();
+  }
+}
+
+void TrackRecorder::writeChunk(const std::vector<TrackRecord> &records)
+{
+  writeValue(file, static_cast<std::uint32_t>(records.size()));
+
+  for(size_t i{0}; i < NoColumns; i++)
+  {
+    writeColumn(records, static_cast<TrackColumn>(i));
+  }
+
+  if(!file)
+  {
+    throw std::runtime_error("Track file write failed");
+  }
+
+  records_written += static_cast<long long>(records.size());
+}
+
+void TrackRecorder::writeColumn(const std::vector<TrackRecord> &records,
+                                TrackColumn track_column)
+{
+  size_t element_size{ColumnSizes[static_cast<size_t>(track_column)]};
+  column.resize(records.size() * element_size);
+
+  for(size_t i{0}; i < records.size(); i++)
+  {
+    const TrackRecord &track_record{records[i]};
+
+    switch(track_column)
+    {
+    case TrackColumn::ID:
+      storeValue(column, i, track_record.id);
+      break;
+    case TrackColumn::PARENT_ID:
+      storeValue(column, i, track_record.parent_id);
+      break;
+    case TrackColumn::X:
+      storeValue(column, i, track_record.position.getX());
+      break;
+    case TrackColumn::Y:
+      storeValue(column, i, track_record.position.getY());
+      break;
+    case TrackColumn::Z:
+      storeValue(column, i, track_record.position.getZ());
+      break;
+    case TrackColumn::ENERGY:
+      storeValue(column, i, track_record.energy);
+      break;
+    case TrackColumn::WEIGHT:
+      storeValue(column, i, track_record.weight);
+      break;
+    case TrackColumn::REGION:
+      storeValue(column, i, track_record.region);
+      break;
+    case TrackColumn::EVENT:
+      storeValue(column, i, track_record.event);
+      break;
+    case TrackColumn::REACTION:
+      storeValue(column, i, track_record.reaction);
+      break;
+    }
+  }
+
+  // Columns that do not shrink are stored as they are
+  TrackCompression codec{TrackCompression::NONE};
+  const std::vector<std::uint8_t> *output{&column};
+
+  if(compression == TrackCompression::SHUFFLE_RLE)
+  {
+    encodeShuffleRle(column, element_size, encoded);
+
+    if(encoded.size() < column.size())
+    {
+      codec = TrackCompression::SHUFFLE_RLE;
+      output = &encoded;
+    }
+  }
+
+  writeValue(file, codec);
+  writeValue(file, static_cast<std::uint64_t>(output->size()));
+  file.write(reinterpret_cast<const char *>(output->data()),
+             static_cast<std::streamsize>(output->size()));
+}
+
+void TrackRecorder::encodeShuffleRle(const std::vector<std::uint8_t> &bytes,
+                                     size_t element_size,
+                                     std::vector<std::uint8_t> &output)
+{
+  // Byte b of every value together, so the slowly varying high bytes of ids,
+  // positions and energies form long runs
+  thread_local std::vector<std::uint8_t> shuffled;
+  size_t no_values{bytes.size() / element_size};
+  size_t size{bytes.size()};
+  shuffled.resize(size);
+
+  for(size_t byte{0}; byte < element_size; byte++)
+  {
+    for(size_t value{0}; value < no_values; value++)
+    {
+      shuffled[byte * no_values + value] = bytes[value * element_size + byte];
+    }
+  }
+
+  // PackBits: a header h < 128 is followed by h + 1 literal bytes and a
+  // header h > 128 by one byte repeated 257 - h times. Sized for the worst
+  // case of all literals.
+  output.resize(size + size / MaxRun + 1);
+  size_t length{0};
+  size_t i{0};
+
+  while(i < size)
+  {
+    size_t run{1};
+
+    while(i + run < size && run < MaxRun && shuffled[i + run] == shuffled[i])
+    {
+      run++;
+    }
+
+    if(run > 1)
+    {
+      output[length++] = static_cast<std::uint8_t>(257 - run);
+      output[length++] = shuffled[i];
+      i += run;
+      continue;
+    }
+
+    // Literals up to the next pair of equal bytes, there is at least one
+    size_t start{i};
+
+    while(i < size && i - start < MaxRun &&
+          !(i + 1 < size && shuffled[i + 1] == shuffled[i]))
+    {
+      i++;
+    }
+
+    output[length++] = static_cast<std::uint8_t>(i - start - 1);
+    std::memcpy(output.data() + length, shuffled.data() + start, i - start);
+    length += i - start;
+  }
+
+  output.resize(length);
+}
+
+void TrackRecorder::decodeShuffleRle(const std::vector<std::uint8_t> &input,
+                                     size_t element_size,
+                                     std::vector<std::uint8_t> &bytes)
+{
+  std::vector<std::uint8_t> shuffled;
+  size_t i{0};
+
+  while(i < input.size())
+  {
+    std::uint8_t header{input[i++]};
+
+    if(header < 128)
+    {
+      if(i + header + 1 > input.size())
+      {
+        throw std::runtime_error("Invalid track file: truncated column");
+      }
+
+      shuffled.insert(shuffled.end(), input.begin() + i,
+                      input.begin() + i + header + 1);
+      i += header + 1;
+    }
+    else if(header > 128)
+    {
+      if(i >= input.size())
+      {
+        throw std::runtime_error("Invalid track file: truncated column");
+      }
+
+      shuffled.insert(shuffled.end(), 257 - header, input[i++]);
+    }
+  }
+
+  if(shuffled.size() % element_size != 0)
+  {
+    throw std::runtime_error("Invalid track file: column size mismatch");
+  }
+
+  size_t no_values{shuffled.size() / element_size};
+  bytes.resize(shuffled.size());
+
+  for(size_t value{0}; value < no_values; value++)
+  {
+    for(size_t byte{0}; byte < element_size; byte++)
+    {
+      bytes[value * element_size + byte] = shuffled[byte * no_values + value];
+    }
+  }
+}
+
+std::vector<TrackRecord> TrackRecorder::readFile(const std::string &path,
+                                                 long long &dropped)
+{
+  std::ifstream file(path, std::ios::binary);
+
+  if(!file)
+  {
+    throw std::runtime_error("Cannot open track file " + path);
+  }
+
+  std::string magic(TrackConstants::FileMagic.size(), '\0');
+  file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+
+  if(!file || magic != TrackConstants::FileMagic ||
+     readValue<std::uint32_t>(file) != TrackConstants::FileVersion)
+  {
+    throw std::runtime_error("Invalid track file: unknown format " + path);
+  }
+
+  std::vector<TrackRecord> records;
+  std::array<std::vector<std::uint8_t>, NoColumns> columns;
+  std::vector<std::uint8_t> encoded;
+
+  while(true)
+  {
+    std::uint32_t no_records{readValue<std::uint32_t>(file)};
+
+    if(!file)
+    {
+      throw std::runtime_error("Invalid track file: no end, the recorder was "
+                               "not closed " +
+                               path);
+    }
+
+    if(no_records == 0)
+    {
+      std::uint64_t written{readValue<std::uint64_t>(file)};
+      dropped = static_cast<long long>(readValue<std::uint64_t>(file));
+
+      if(!file || written != records.size())
+      {
+        throw std::runtime_error("Invalid track file: truncated end " + path);
+      }
+
+      break;
+    }
+
+    for(size_t i{0}; i < NoColumns; i++)
+    {
+      TrackCompression codec{readValue<TrackCompression>(file)};
+      std::uint64_t size{readValue<std::uint64_t>(file)};
+
+      encoded.resize(size);
+      file.read(reinterpret_cast<char *>(encoded.data()),
+                static_cast<std::streamsize>(size));
+
+      if(!file)
+      {
+        throw std::runtime_error("Invalid track file: truncated chunk");
+      }
+
+      if(codec == TrackCompression::SHUFFLE_RLE)
+      {
+        decodeShuffleRle(encoded, ColumnSizes[i], columns[i]);
+      }
+      else
+      {
+        columns[i] = encoded;
+      }
+
+      if(columns[i].size() != no_records * ColumnSizes[i])
+      {
+        throw std::runtime_error("Invalid track file: column size mismatch");
+      }
+    }
+
+    auto columnOf{[&](TrackColumn track_column) -> const auto &
+                  { return columns[static_cast<size_t>(track_column)]; }};
+
+    for(size_t i{0}; i < no_records; i++)
+    {
+      records.push_back(
+          {loadValue<std::uint64_t>(columnOf(TrackColumn::ID), i),
+           loadValue<std::uint64_t>(columnOf(TrackColumn::PARENT_ID), i),
+           Vector3D(loadValue<double>(columnOf(TrackColumn::X), i),
+                    loadValue<double>(columnOf(TrackColumn::Y), i),
+                    loadValue<double>(columnOf(TrackColumn::Z), i)),
+           loadValue<double>(columnOf(TrackColumn::ENERGY), i),
+           loadValue<double>(columnOf(TrackColumn::WEIGHT), i),
+           loadValue<std::int32_t>(columnOf(TrackColumn::REGION), i),
+           loadValue<TrackEvent>(columnOf(TrackColumn::EVENT), i),
+           loadValue<std::uint8_t>(columnOf(TrackColumn::REACTION), i)});
+    }
+  }
+
+  return records;
+}
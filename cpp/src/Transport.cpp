@@ -0,0 +1,256 @@
+// Implementation of the Transport class
+
+#include "Transport.hpp"
+#include "Instrumentation.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Constructor
+Transport::Transport(const Geometry &geometry_,
+                     ParticleConstants::ParticleType particle_type_,
+                     TrackingMode tracking_mode_)
+    : geometry{geometry_}, particle_type{particle_type_},
+      tracking_mode{tracking_mode_}
+{
+  if(tracking_mode == TrackingMode::DELTA)
+  {
+    majorant_table.emplace(geometry.getMaterials(), particle_type);
+  }
+}
+
+int Transport::moveToCollision(Particle &particle,
+                               RandomNumberGenerator &rng) const
+{
+  if(particle.getType() != particle_type)
+  {
+    throw std::invalid_argument(
+        "Invalid particle: particle type does not match transport");
+  }
+
+  switch(tracking_mode)
+  {
+  case TrackingMode::SURFACE:
+
+    return surfaceTrack(particle, rng);
+
+  case TrackingMode::DELTA:
+
+    return deltaTrack(particle, rng);
+
+  default:
+
+    throw std::invalid_argument("Invalid TrackingMode");
+  }
+}
+
+int Transport::surfaceTrack(Particle &particle,
+                            RandomNumberGenerator &rng) const
+{
+  TransportEvent event{geometry.findRegion(particle.getPosition()), false};
+
+  while(event.region != -1)
+  {
+    event = surfaceStep(particle, event.region, rng);
+
+    if(event.collided)
+    {
+      return event.region;
+    }
+  }
+
+  return -1;
+}
+
+TransportEvent Transport::surfaceStep(Particle &particle, int region,
+                                      RandomNumberGenerator &rng,
+                                      const PathBiasing *biasing) const
+{
+  const Material *material{geometry.getMaterial(region)};
+  double boundary_distance{geometry.distanceToBoundary(
+      particle.getPosition(), particle.getDirection(), region)};
+
+  // Void regions are crossed without sampling
+  if(material == nullptr)
+  {
+    particle.setPosition(
+        particle.getPosition() +
+        particle.getDirection() *
+            (boundary_distance + GeometryConstants::BoundaryPush));
+    NSE_COUNT(BOUNDARY_CROSSINGS);
+
+    return {geometry.findRegion(particle.getPosition()), false};
+  }
+
+  if(biasing != nullptr && biasing->isStretched(region))
+  {
+    double atten_coef{
+        material->getTotalLinearAttenCoef(particle.getEnergy(), particle_type)};
+    double stretched_coef{biasing->getStretchedCoef(
+        atten_coef, particle.getDirection(), region)};
+    double step{rng.getRandomStep(stretched_coef)};
+    bool collided{step < boundary_distance};
+
+    particle.setWeight(particle.getWeight() *
+                       PathBiasing::getWeightFactor(
+                           atten_coef, stretched_coef,
+                           collided ? step : boundary_distance, collided));
+
+    if(collided)
+    {
+      particle.setPosition(particle.getPosition() +
+                           particle.getDirection() * step);
+      return {region, true};
+    }
+  }
+  else
+  {
+    double step{rng.getRandomStep(particle, *material)};
+
+    if(step < boundary_distance)
+    {
+      particle.setPosition(particle.getPosition() +
+                           particle.getDirection() * step);
+      return {region, true};
+    }
+  }
+
+  // Cross into the next region, the step is resampled there
+  particle.setPosition(
+      particle.getPosition() +
+      particle.getDirection() *
+          (boundary_distance + GeometryConstants::BoundaryPush));
+  NSE_COUNT(BOUNDARY_CROSSINGS);
+
+  return {geometry.findRegion(particle.getPosition()), false};
+}
+
+int Transport::deltaTrack(Particle &particle, RandomNumberGenerator &rng) const
+{
+  // Energy is constant between collisions so so is the majorant
+  double majorant{majorant_table->getMajorant(particle.getEnergy())};
+
+  while(true)
+  {
+    particle.setPosition(particle.getPosition() +
+                         particle.getDirection() * rng.getRandomStep(majorant));
+
+    int region{geometry.findRegion(particle.getPosition())};
+
+    if(region == -1)
+    {
+      return -1;
+    }
+
+    const Material *material{geometry.getMaterial(region)};
+
+    if(material == nullptr)
+    {
+      continue; // Virtual collision in a void
+    }
+
+    double atten_coef{
+        material->getTotalLinearAttenCoef(particle.getEnergy(), particle_type)};
+
+    // Accept as a real collision with probability mu / mu_max
+    if(rng.getUniform() * majorant <= atten_coef)
+    {
+      return region;
+    }
+  }
+}
+
+TransportEvent Transport::moveToEvent(Particle &particle,
+                                      RandomNumberGenerator &rng,
+                                      const PathBiasing *biasing) const
+{
+  // Delta tracking does not see boundaries
+  if(tracking_mode == TrackingMode::DELTA)
+  {
+    if(biasing != nullptr)
+    {
+      throw std::invalid_argument(
+          "Invalid path biasing: biasing needs surface tracking");
+    }
+
+    int region{moveToCollision(particle, rng)};
+
+    return {region, region != -1};
+  }
+
+  if(particle.getType() != particle_type)
+  {
+    throw std::invalid_argument(
+        "Invalid particle: particle type does not match transport");
+  }
+
+  int region{geometry.findRegion(particle.getPosition())};
+
+  if(region == -1)
+  {
+    return {-1, false};
+  }
+
+  return surfaceStep(particle, region, rng, biasing);
+}
+
+std::optional<TransportEvent>
+Transport::forceCollision(Particle &particle, Particle &uncollided, int region,
+                          RandomNumberGenerator &rng) const
+{
+  const Material *material{geometry.getMaterial(region)};
+
+  if(material == nullptr)
+  {
+    throw std::invalid_argument(
+        "Invalid forced collision: region cannot be void");
+  }
+
+  double atten_coef{
+      material->getTotalLinearAttenCoef(particle.getEnergy(), particle_type)};
+  double boundary_distance{geometry.distanceToBoundary(
+      particle.getPosition(), particle.getDirection(), region)};
+
+  // Probabilities of colliding before leaving region and of crossing it,
+  // each computed directly as it can be too small to take from 1
+  double collision_probability{-std::expm1(-atten_coef * boundary_distance)};
+  double crossing_probability{std::exp(-atten_coef * boundary_distance)};
+
+  // Collision distance from the exponential truncated at the boundary
+  double step{-std::log1p(-rng.getUniform() * collision_probability) /
+              atten_coef};
+
+  // An uncollided part with little weight plays Russian roulette, and none
+  // is split off if it loses, which it always does with zero weight
+  if(crossing_probability < VarianceReductionConstants::CutoffWeight)
+  {
+    double survival_weight{VarianceReductionConstants::CutoffSurvivalWeight};
+
+    crossing_probability =
+        (rng.getUniform() * survival_weight < crossing_probability)
+            ? survival_weight
+            : 0.0;
+  }
+
+  std::optional<TransportEvent> crossing;
+
+  if(crossing_probability > 0.0)
+  {
+    uncollided = particle.split();
+    uncollided.setWeight(particle.getWeight() * crossing_probability);
+    uncollided.setPosition(
+        particle.getPosition() +
+        particle.getDirection() *
+            (boundary_distance + GeometryConstants::BoundaryPush));
+
+    crossing = TransportEvent{geometry.findRegion(uncollided.getPosition()),
+                              false};
+  }
+
+  particle.setWeight(particle.getWeight() * collision_probability);
+  particle.setPosition(particle.getPosition() +
+                       particle.getDirection() * step);
+
+  return crossing;
+}
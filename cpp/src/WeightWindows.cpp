@@ -0,0 +1,105 @@
+// Implementation of the WeightWindows class
+
+#include "WeightWindows.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Constructor
+WeightWindows::WeightWindows(const std::vector<double> &region_importances)
+    : importances{region_importances}
+{
+  checkImportances();
+}
+
+WeightWindows::WeightWindows(const CartesianMesh &mesh_,
+                             const std::vector<double> &voxel_importances)
+    : importances{voxel_importances}, mesh{mesh_}
+{
+  if(importances.size() != mesh->getSize())
+  {
+    throw std::invalid_argument("Invalid importance map: need one importance "
+                                "per voxel");
+  }
+
+  checkImportances();
+}
+
+void WeightWindows::checkImportances() const
+{
+  for(double importance : importances)
+  {
+    if(!(importance >= 0.0 && std::isfinite(importance)))
+    {
+      throw std::invalid_argument("Invalid importance map: importances must "
+                                  "be non-negative and finite");
+    }
+  }
+}
+
+double WeightWindows::getImportance(const Vector3D &position, int region) const
+{
+  if(mesh)
+  {
+    long long voxel{mesh->getVoxel(position)};
+
+    return (voxel == -1) ? -1.0 : importances[voxel];
+  }
+
+  return importances.at(region);
+}
+
+bool WeightWindows::apply(Particle &particle, int region,
+                          RandomNumberGenerator &rng, ParticleBank &bank) const
+{
+  double importance{getImportance(particle.getPosition(), region)};
+
+  if(importance < 0.0)
+  {
+    return true;
+  }
+
+  if(importance == 0.0)
+  {
+    return false;
+  }
+
+  double survival_weight{1.0 / importance};
+  double lower_weight{survival_weight /
+                      VarianceReductionConstants::WindowSurvivalRatio};
+  double upper_weight{lower_weight *
+                      VarianceReductionConstants::WindowUpperRatio};
+  double weight{particle.getWeight()};
+
+  if(weight > upper_weight)
+  {
+    // Limited by the split cap and by the free space in the bank
+    long long wanted{
+        static_cast<long long>(std::ceil(weight / survival_weight))};
+    long long copies{std::min<long long>(
+        {wanted, VarianceReductionConstants::MaxSplit,
+         static_cast<long long>(bank.getFreeSpace()) + 1})};
+
+    if(copies > 1)
+    {
+      particle.setWeight(weight / copies);
+
+      for(long long i{1}; i < copies; i++)
+      {
+        bank.push(particle.split());
+      }
+    }
+  }
+  else if(weight < lower_weight)
+  {
+    if(rng.getUniform() * survival_weight > weight)
+    {
+      return false;
+    }
+
+    particle.setWeight(survival_weight);
+  }
+
+  return true;
+}
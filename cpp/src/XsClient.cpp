@@ -0,0 +1,120 @@
+// Implementation of the XsClient class
+
+#include "XsClient.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Constructor
+XsClient::XsClient(const std::string &socket_path)
+{
+  struct sockaddr_un address{XsSocket::makeAddress(socket_path)};
+
+  fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if(fd < 0)
+  {
+    throw std::runtime_error("Cannot create socket: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  if(::connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+               sizeof(address)) != 0)
+  {
+    std::string error{std::strerror(errno)};
+    ::close(fd);
+    throw std::runtime_error("Cannot connect to " + socket_path + ": " +
+                             error);
+  }
+}
+
+XsClient::~XsClient() { ::close(fd); }
+
+std::uint32_t XsClient::send(const XsQuery &query)
+{
+  if(query.composition.size() > ServiceConstants::MaxComponentsPerRequest ||
+     query.energies.size() > ServiceConstants::MaxEnergiesPerRequest)
+  {
+    throw std::invalid_argument("Invalid query: too many elements or "
+                                "energies");
+  }
+
+  std::uint32_t id{next_id++};
+
+  XsRequestHeader header{ServiceConstants::ProtocolMagic,
+                         id,
+                         static_cast<std::uint32_t>(query.reaction),
+                         static_cast<std::uint32_t>(query.composition.size()),
+                         query.energies.size(),
+                         query.density};
+
+  std::vector<XsComponent> components;
+  components.reserve(query.composition.size());
+
+  for(const auto &[element, mass_fraction] : query.composition)
+  {
+    components.push_back(
+        {static_cast<std::uint32_t>(element), 0, mass_fraction});
+  }
+
+  if(!XsSocket::writeAll(fd, &header, sizeof(header)) ||
+     !XsSocket::writeAll(fd, components.data(),
+                         components.size() * sizeof(XsComponent)) ||
+     !XsSocket::writeAll(fd, query.energies.data(),
+                         query.energies.size() * sizeof(double)))
+  {
+    throw std::runtime_error("Lost connection to the query server");
+  }
+
+  return id;
+}
+
+XsResponse XsClient::receive()
+{
+  XsResponseHeader header;
+
+  if(!XsSocket::readAll(fd, &header, sizeof(header)) ||
+     header.magic != ServiceConstants::ProtocolMagic)
+  {
+    throw std::runtime_error("Lost connection to the query server");
+  }
+
+  XsResponse response{header.id, header.status == XsStatus::OK, {}, {}};
+  bool received;
+
+  if(response.ok)
+  {
+    response.values.resize(header.no_values);
+    received = XsSocket::readAll(fd, response.values.data(),
+                                 header.no_values * sizeof(double));
+  }
+  else
+  {
+    response.error.resize(header.no_values);
+    received = XsSocket::readAll(fd, response.error.data(), header.no_values);
+  }
+
+  if(!received)
+  {
+    throw std::runtime_error("Lost connection to the query server");
+  }
+
+  return response;
+}
+
+std::vector<double> XsClient::query(const XsQuery &query)
+{
+  send(query);
+  XsResponse response{receive()};
+
+  if(!response.ok)
+  {
+    throw std::runtime_error("Query failed: " + response.error);
+  }
+
+  return std::move(response.values);
+}
@@ -0,0 +1,109 @@
+// Implementation of the XsLibrary class
+
+#include "XsLibrary.hpp"
+#include "Instrumentation.hpp"
+#include "Interpolation.hpp"
+
+#include <stdexcept>
+#include <string>
+
+const CoherentSampler &ElementXs::getCoherentSampler() const
+{
+  if(particle_type != ParticleConstants::ParticleType::GAMMA)
+  {
+    throw std::runtime_error("Coherent samplers are for photon data only");
+  }
+
+  // Threads asking at once wait for one fit, a throw leaves it to the next
+  std::call_once(coherent_once,
+                 [this]
+                 {
+                   coherent_sampler =
+                       std::make_unique<const CoherentSampler>(rows, element);
+                 });
+
+  return *coherent_sampler;
+}
+
+int XsLibrary::getNoElements() const
+{
+  int no_elements{0};
+
+  for(const auto &particle_elements : data)
+  {
+    no_elements += static_cast<int>(particle_elements.second.size());
+  }
+
+  return no_elements;
+}
+
+bool XsLibrary::contains(ParticleConstants::ParticleType particle_type,
+                         ElementConversion::Element element) const
+{
+  auto elements{data.find(particle_type)};
+
+  return elements != data.end() &&
+         elements->second.find(element) != elements->second.end();
+}
+
+const CoherentSampler &
+XsLibrary::getCoherentSampler(ElementConversion::Element element) const
+{
+  return getElement(ParticleConstants::ParticleType::GAMMA, element)
+      .getCoherentSampler();
+}
+
+void XsLibrary::checkReaction(ParticleConstants::ParticleType particle_type,
+                              ParticleConstants::ReactionType reaction)
+{
+  auto particle_it{ParticleConstants::AllowedReactions.find(particle_type)};
+
+  if(particle_it != ParticleConstants::AllowedReactions.end())
+  {
+    // If in here then there are allowed reactions for the specified particle
+    if(particle_it->second.find(reaction) != particle_it->second.end())
+    {
+      return;
+    }
+  }
+
+  // Reaction not allowed
+  throw std::runtime_error("Invalid reaction: Particle enum " +
+                           std::to_string(static_cast<int>(particle_type)) +
+                           ", Reaction enum " +
+                           std::to_string(static_cast<int>(reaction)));
+}
+
+double XsLibrary::getAttenCoef(double energy,
+                               ParticleConstants::ReactionType reaction,
+                               ParticleConstants::ParticleType particle_type,
+                               ElementConversion::Element element) const
+{
+  // Files are formatted with energy going low to high and when there are
+  // k-edges the photon energy will be duplicated with lower mass attenuation
+  // coefs above, hence just have to search for the energy values closest to the
+  // energy we're searching and verify that their indices are +-1 of each other.
+
+  NSE_COUNT(XS_LOOKUPS);
+  NSE_TIME_SCOPE(LOOKUP);
+
+  // Check that the reaction is allowed, throws if not allowed
+  checkReaction(particle_type, reaction);
+
+  size_t reaction_column{FileConstants::ReactionToColumn.at(particle_type)
+                             .at(reaction)}; // Throws if not found
+
+  const ElementXs &element_xs{getElement(particle_type, element)};
+
+  // Replica local to the calling thread if there is one
+  if(!element_xs.replicas.empty())
+  {
+    const FlatTable &local{
+        element_xs.replicas[NumaReplicas::getInstance().getThreadNode()]};
+
+    return Interpolation::interpolateColumn(energy, local, reaction_column);
+  }
+
+  return Interpolation::interpolateColumn(energy, element_xs.rows,
+                                          reaction_column);
+}
@@ -0,0 +1,81 @@
+// Implementation of the XsSocket helpers
+
+#include "XsProtocol.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace XsSocket
+{
+
+bool readAll(int fd, void *buffer, size_t size)
+{
+  auto *bytes{static_cast<char *>(buffer)};
+
+  while(size > 0)
+  {
+    ssize_t received{::recv(fd, bytes, size, 0)};
+
+    if(received < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if(received <= 0)
+    {
+      return false;
+    }
+
+    bytes += received;
+    size -= static_cast<size_t>(received);
+  }
+
+  return true;
+}
+
+bool writeAll(int fd, const void *buffer, size_t size)
+{
+  const auto *bytes{static_cast<const char *>(buffer)};
+
+  while(size > 0)
+  {
+    // No SIGPIPE when the peer has gone, the error is returned instead
+    ssize_t sent{::send(fd, bytes, size, MSG_NOSIGNAL)};
+
+    if(sent < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if(sent <= 0)
+    {
+      return false;
+    }
+
+    bytes += sent;
+    size -= static_cast<size_t>(sent);
+  }
+
+  return true;
+}
+
+struct sockaddr_un makeAddress(const std::string &path)
+{
+  struct sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+
+  if(path.empty() || path.size() >= sizeof(address.sun_path))
+  {
+    throw std::invalid_argument("Invalid socket path: " + path);
+  }
+
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  return address;
+}
+
+} // namespace XsSocket
@@ -0,0 +1,333 @@
+// Implementation of the XsSegment class
+
+#include "XsSegment.hpp"
+#include "Interpolation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+std::string processName(const std::string &name)
+{
+  std::string processed{name.starts_with('/') ? name : '/' + name};
+
+  if(processed.size() < 2 || processed.find('/', 1) != std::string::npos)
+  {
+    throw std::invalid_argument("Invalid segment name: " + name);
+  }
+
+  return processed;
+}
+
+// Rows of a table over its columns, for the Interpolation helpers
+struct ColumnRows
+{
+  const double *columns; // Column 0
+  size_t stride;         // Doubles from one column to the next
+  size_t no_rows;
+
+  struct Row
+  {
+    const double *values; // Column 0 of the row
+    size_t stride;
+
+    double operator[](size_t column) const { return values[column * stride]; }
+  };
+
+  size_t size() const { return no_rows; }
+  Row operator[](size_t row) const { return {columns + row, stride}; }
+};
+
+size_t alignUp(size_t bytes)
+{
+  const size_t alignment{SegmentConstants::ColumnAlignment};
+
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+bool tableBefore(const XsSegment::Table &table,
+                 std::pair<std::uint32_t, std::uint32_t> key)
+{
+  return std::make_pair(table.particle_type, table.element) < key;
+}
+
+} // namespace
+
+XsSegment::XsSegment(XsSegment &&other) noexcept
+    : name{std::move(other.name)}, base{std::exchange(other.base, nullptr)},
+      size{std::exchange(other.size, 0)}
+{}
+
+XsSegment &XsSegment::operator=(XsSegment &&other) noexcept
+{
+  if(this != &other)
+  {
+    if(base != nullptr)
+    {
+      ::munmap(const_cast<std::byte *>(base), size);
+    }
+
+    name = std::move(other.name);
+    base = std::exchange(other.base, nullptr);
+    size = std::exchange(other.size, 0);
+  }
+
+  return *this;
+}
+
+XsSegment::~XsSegment()
+{
+  if(base != nullptr)
+  {
+    ::munmap(const_cast<std::byte *>(base), size);
+  }
+}
+
+XsSegment XsSegment::publish(const std::string &name_, const XsData &data)
+{
+  std::string name{processName(name_)};
+
+  // Tables sorted so that lookups can binary search them
+  std::vector<std::tuple<std::uint32_t, std::uint32_t,
+                         const std::vector<std::vector<double>> *>>
+      sources;
+
+  for(const auto &[particle_type, elements] : data)
+  {
+    for(const auto &[element, element_xs] : elements)
+    {
+      sources.emplace_back(static_cast<std::uint32_t>(particle_type),
+                           static_cast<std::uint32_t>(element),
+                           &element_xs->rows);
+    }
+  }
+
+  std::sort(sources.begin(), sources.end());
+
+  // Lay out the segment before creating it
+  std::vector<Table> tables;
+  size_t size{alignUp(sizeof(Header) + sources.size() * sizeof(Table))};
+
+  for(const auto &[particle_type, element, rows] : sources)
+  {
+    size_t no_columns{rows->empty() ? 0 : rows->front().size()};
+    size_t stride{alignUp(rows->size() * sizeof(double))};
+
+    tables.push_back({particle_type, element, rows->size(), no_columns, size,
+                      stride});
+    size += no_columns * stride;
+  }
+
+  int fd{::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644)};
+
+  if(fd < 0)
+  {
+    throw std::runtime_error("Cannot create segment " + name + ": " +
+                             std::strerror(errno));
+  }
+
+  void *mapping{MAP_FAILED};
+
+  if(::ftruncate(fd, static_cast<off_t>(size)) == 0)
+  {
+    mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+
+  std::string error{std::strerror(errno)};
+  ::close(fd);
+
+  if(mapping == MAP_FAILED)
+  {
+    ::shm_unlink(name.c_str());
+    throw std::runtime_error("Cannot map segment " + name + ": " + error);
+  }
+
+  // New shared memory is zero filled, so only the data has to be written
+  auto *bytes{static_cast<std::byte *>(mapping)};
+  auto *header{reinterpret_cast<Header *>(bytes)};
+  std::memcpy(header->magic, SegmentConstants::SegmentMagic.data(),
+              sizeof(header->magic));
+  header->version = SegmentConstants::SegmentVersion;
+  header->size = size;
+  header->no_tables = tables.size();
+  header->tables_offset = sizeof(Header);
+  std::memcpy(bytes + sizeof(Header), tables.data(),
+              tables.size() * sizeof(Table));
+
+  for(size_t i{0}; i < tables.size(); i++)
+  {
+    const std::vector<std::vector<double>> &rows{*std::get<2>(sources[i])};
+
+    for(size_t column{0}; column < tables[i].no_columns; column++)
+    {
+      auto *values{reinterpret_cast<double *>(
+          bytes + tables[i].columns_offset + column * tables[i].column_stride)};
+
+      for(size_t row{0}; row < rows.size(); row++)
+      {
+        values[row] = rows[row][column];
+      }
+    }
+  }
+
+  // Attachers only trust the segment once ready is seen
+  std::atomic_ref<std::uint32_t>(header->ready)
+      .store(1, std::memory_order_release);
+  ::mprotect(mapping, size, PROT_READ);
+
+  return XsSegment(name, bytes, size);
+}
+
+XsSegment XsSegment::attach(const std::string &name_)
+{
+  std::string name{processName(name_)};
+
+  int fd{::shm_open(name.c_str(), O_RDONLY, 0)};
+
+  if(fd < 0)
+  {
+    throw std::runtime_error("Cannot open segment " + name + ": " +
+                             std::strerror(errno));
+  }
+
+  struct stat status{};
+  void *mapping{MAP_FAILED};
+
+  if(::fstat(fd, &status) == 0 &&
+     static_cast<size_t>(status.st_size) >= sizeof(Header))
+  {
+    mapping = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ,
+                     MAP_SHARED, fd, 0);
+  }
+
+  ::close(fd);
+
+  if(mapping == MAP_FAILED)
+  {
+    throw std::runtime_error("Cannot map segment " + name);
+  }
+
+  // Owns the mapping from here, so it is unmapped if the checks throw
+  XsSegment segment(name, static_cast<const std::byte *>(mapping),
+                    static_cast<size_t>(status.st_size));
+  const Header &header{segment.getHeader()};
+
+  if(std::memcmp(header.magic, SegmentConstants::SegmentMagic.data(),
+                 sizeof(header.magic)) != 0 ||
+     std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t &>(header.ready))
+             .load(std::memory_order_acquire) != 1)
+  {
+    throw std::runtime_error("Segment " + name + " is incomplete");
+  }
+
+  if(header.version != SegmentConstants::SegmentVersion)
+  {
+    throw std::runtime_error("Segment " + name + " has version " +
+                             std::to_string(header.version) + ", expected " +
+                             std::to_string(SegmentConstants::SegmentVersion));
+  }
+
+  if(header.size != segment.size)
+  {
+    throw std::runtime_error("Segment " + name + " is truncated");
+  }
+
+  return segment;
+}
+
+bool XsSegment::remove(const std::string &name_)
+{
+  return ::shm_unlink(processName(name_).c_str()) == 0;
+}
+
+const XsSegment::Table &
+XsSegment::getTable(ParticleConstants::ParticleType particle_type,
+                    ElementConversion::Element element) const
+{
+  const Header &header{getHeader()};
+  const auto *begin{
+      reinterpret_cast<const Table *>(base + header.tables_offset)};
+  const auto *end{begin + header.no_tables};
+  std::pair<std::uint32_t, std::uint32_t> key{
+      static_cast<std::uint32_t>(particle_type),
+      static_cast<std::uint32_t>(element)};
+
+  const Table *table{std::lower_bound(begin, end, key, tableBefore)};
+
+  if(table == end || table->particle_type != key.first ||
+     table->element != key.second)
+  {
+    throw std::out_of_range("Element not in segment " + name);
+  }
+
+  return *table;
+}
+
+bool XsSegment::contains(ParticleConstants::ParticleType particle_type,
+                         ElementConversion::Element element) const
+{
+  try
+  {
+    getTable(particle_type, element);
+    return true;
+  }
+  catch(const std::out_of_range &)
+  {
+    return false;
+  }
+}
+
+std::span<const double>
+XsSegment::getColumn(ParticleConstants::ParticleType particle_type,
+                     ElementConversion::Element element, size_t column) const
+{
+  const Table &table{getTable(particle_type, element)};
+
+  if(column >= table.no_columns)
+  {
+    throw std::out_of_range("Column not in segment " + name);
+  }
+
+  return {reinterpret_cast<const double *>(base + table.columns_offset +
+                                           column * table.column_stride),
+          table.no_rows};
+}
+
+double XsSegment::getAttenCoef(double energy,
+                               ParticleConstants::ReactionType reaction,
+                               ParticleConstants::ParticleType particle_type,
+                               ElementConversion::Element element) const
+{
+  if(!ParticleConstants::AllowedReactions.at(particle_type).contains(reaction))
+  {
+    throw std::runtime_error("Invalid reaction: Reaction enum " +
+                             std::to_string(static_cast<int>(reaction)));
+  }
+
+  const Table &table{getTable(particle_type, element)};
+  size_t column{FileConstants::ReactionToColumn.at(particle_type).at(reaction)};
+
+  if(column >= table.no_columns)
+  {
+    throw std::out_of_range("Column not in segment " + name);
+  }
+
+  ColumnRows rows{
+      reinterpret_cast<const double *>(base + table.columns_offset),
+      table.column_stride / sizeof(double), table.no_rows};
+
+  return Interpolation::interpolateColumn(energy, rows, column);
+}
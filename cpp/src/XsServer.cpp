@@ -0,0 +1,423 @@
+// Implementation of the XsServer class
+
+#include "XsServer.hpp"
+#include "DataProcessor.hpp"
+#include "Interpolation.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+// Highest atomic number with a photon data file
+const std::uint32_t MaxAtomicNumber{100};
+
+} // namespace
+
+XsServer::Connection::~Connection() { ::close(fd); }
+
+// Constructor
+XsServer::XsServer(const std::string &socket_path_, int no_workers)
+    : socket_path{socket_path_}, listen_fd{-1}
+{
+  if(no_workers < 1)
+  {
+    throw std::invalid_argument("Invalid query server: workers must be at "
+                                "least 1");
+  }
+
+  // Everything is loaded up front so that no request waits on a parse
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  for(std::uint32_t z{1}; z <= MaxAtomicNumber; z++)
+  {
+    data_processor.addDataSingleFile(
+        ParticleConstants::ParticleType::GAMMA,
+        static_cast<ElementConversion::Element>(z));
+  }
+
+  struct sockaddr_un address{XsSocket::makeAddress(socket_path)};
+
+  listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if(listen_fd < 0)
+  {
+    throw std::runtime_error("Cannot create socket: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  ::unlink(socket_path.c_str());
+
+  if(::bind(listen_fd, reinterpret_cast<struct sockaddr *>(&address),
+            sizeof(address)) != 0 ||
+     ::listen(listen_fd, SOMAXCONN) != 0)
+  {
+    std::string error{std::strerror(errno)};
+    ::close(listen_fd);
+    throw std::runtime_error("Cannot listen on " + socket_path + ": " + error);
+  }
+
+  for(int worker{0}; worker < no_workers; worker++)
+  {
+    workers.emplace_back(&XsServer::runWorker, this);
+  }
+
+  acceptor = std::thread(&XsServer::runAcceptor, this);
+}
+
+XsServer::~XsServer() { stop(); }
+
+void XsServer::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+
+    if(stopping)
+    {
+      return;
+    }
+
+    stopping = true;
+  }
+
+  queue_not_empty.notify_all();
+  queue_not_full.notify_all();
+
+  // Wakes the acceptor from accept
+  ::shutdown(listen_fd, SHUT_RDWR);
+  acceptor.join();
+  ::close(listen_fd);
+  ::unlink(socket_path.c_str());
+
+  // Wakes the readers from recv or from waiting for room
+  {
+    std::lock_guard<std::mutex> lock(readers_mutex);
+
+    for(Reader &reader : readers)
+    {
+      Connection &connection{*reader.connection};
+      ::shutdown(connection.fd, SHUT_RDWR);
+
+      std::lock_guard<std::mutex> connection_lock(connection.mutex);
+      connection.closing = true;
+      connection.wake.notify_all();
+    }
+  }
+
+  for(Reader &reader : readers)
+  {
+    reader.thread.join();
+  }
+
+  readers.clear();
+
+  for(std::thread &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+void XsServer::runAcceptor()
+{
+  while(true)
+  {
+    int fd{::accept(listen_fd, nullptr, nullptr)};
+
+    if(fd < 0)
+    {
+      if(errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+
+      return; // Listening socket shut down
+    }
+
+    auto connection{std::make_shared<Connection>(fd)};
+
+    reapReaders();
+
+    std::lock_guard<std::mutex> lock(readers_mutex);
+    readers.push_back({connection, std::thread(&XsServer::runReader, this,
+                                               connection)});
+  }
+}
+
+void XsServer::reapReaders()
+{
+  std::lock_guard<std::mutex> lock(readers_mutex);
+
+  for(auto reader{readers.begin()}; reader != readers.end();)
+  {
+    if(reader->connection->finished)
+    {
+      reader->thread.join();
+      reader = readers.erase(reader);
+    }
+    else
+    {
+      ++reader;
+    }
+  }
+}
+
+void XsServer::runReader(std::shared_ptr<Connection> connection)
+{
+  connection->writer = std::thread(&XsServer::runWriter,
+                                   std::ref(*connection));
+
+  while(true)
+  {
+    Request request{connection, {}, {}, {}};
+    XsRequestHeader &header{request.header};
+
+    if(!XsSocket::readAll(connection->fd, &header, sizeof(header)))
+    {
+      break;
+    }
+
+    // Every request gets a response, which holds a place until it is sent
+    {
+      std::unique_lock<std::mutex> lock(connection->mutex);
+      connection->wake.wait(lock, [&connection] {
+        return connection->closing ||
+               connection->pending < ServiceConstants::MaxPendingResponses;
+      });
+
+      if(connection->closing)
+      {
+        break;
+      }
+
+      connection->pending += 1;
+    }
+
+    // The stream cannot be resynchronised after a bad header, so the
+    // connection is dropped
+    if(header.magic != ServiceConstants::ProtocolMagic ||
+       header.no_components > ServiceConstants::MaxComponentsPerRequest ||
+       header.no_energies > ServiceConstants::MaxEnergiesPerRequest)
+    {
+      std::string error{"Invalid request header"};
+      respond(*connection, header.id, XsStatus::ERROR, error.data(),
+              error.size(), 1);
+      break;
+    }
+
+    request.components.resize(header.no_components);
+    request.energies.resize(header.no_energies);
+
+    if(!XsSocket::readAll(connection->fd, request.components.data(),
+                          request.components.size() * sizeof(XsComponent)) ||
+       !XsSocket::readAll(connection->fd, request.energies.data(),
+                          request.energies.size() * sizeof(double)))
+    {
+      releasePending(*connection);
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_not_full.wait(lock, [this] {
+      return stopping || queue.size() < ServiceConstants::MaxQueuedRequests;
+    });
+
+    if(stopping)
+    {
+      lock.unlock();
+      releasePending(*connection);
+      break;
+    }
+
+    queue.push_back(std::move(request));
+    lock.unlock();
+    queue_not_empty.notify_one();
+  }
+
+  // The writer finishes once every request read has been answered
+  {
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    connection->closing = true;
+  }
+
+  connection->wake.notify_all();
+  connection->writer.join();
+  connection->finished = true;
+}
+
+void XsServer::runWriter(Connection &connection)
+{
+  std::unique_lock<std::mutex> lock(connection.mutex);
+
+  while(true)
+  {
+    connection.wake.wait(lock, [&connection] {
+      return !connection.responses.empty() ||
+             (connection.closing && connection.pending == 0);
+    });
+
+    if(connection.responses.empty())
+    {
+      return;
+    }
+
+    std::vector<char> response{std::move(connection.responses.front())};
+    connection.responses.pop_front();
+    lock.unlock();
+
+    // A failed write means the client has gone, its reader notices too
+    bool written{
+        XsSocket::writeAll(connection.fd, response.data(), response.size())};
+
+    lock.lock();
+    connection.pending -= 1;
+
+    if(!written && !connection.broken)
+    {
+      connection.broken = true;
+      connection.pending -= connection.responses.size();
+      connection.responses.clear();
+    }
+
+    connection.wake.notify_all();
+  }
+}
+
+void XsServer::runWorker()
+{
+  std::vector<double> values;
+
+  while(true)
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_not_empty.wait(lock, [this] { return stopping || !queue.empty(); });
+
+    if(queue.empty())
+    {
+      return; // Stopping with nothing left to answer
+    }
+
+    Request request{std::move(queue.front())};
+    queue.pop_front();
+    lock.unlock();
+    queue_not_full.notify_one();
+
+    try
+    {
+      evaluate(request, values);
+      respond(*request.connection, request.header.id, XsStatus::OK,
+              values.data(), values.size(), sizeof(double));
+
+      requests_served += 1;
+      values_served += static_cast<long long>(values.size());
+    }
+    catch(const std::exception &error)
+    {
+      std::string message{error.what()};
+      respond(*request.connection, request.header.id, XsStatus::ERROR,
+              message.data(), message.size(), 1);
+    }
+  }
+}
+
+void XsServer::evaluate(const Request &request, std::vector<double> &values)
+{
+  // Nothing looked up stays held while the worker waits for the next request
+  DataProcessor::ThreadRelease release;
+
+  const XsRequestHeader &header{request.header};
+  auto reaction{static_cast<ParticleConstants::ReactionType>(header.reaction)};
+  const auto &columns{FileConstants::ReactionToColumn.at(
+      ParticleConstants::ParticleType::GAMMA)};
+
+  // Totals are tabulated too, so any column can be queried
+  if(!columns.contains(reaction))
+  {
+    throw std::invalid_argument("Invalid request: unknown reaction");
+  }
+
+  if(request.components.empty() || !(header.density > 0.0))
+  {
+    throw std::invalid_argument("Invalid request: needs at least one element "
+                                "and a density greater than 0");
+  }
+
+  double fraction_sum{0.0};
+
+  for(const XsComponent &component : request.components)
+  {
+    if(component.atomic_number < 1 ||
+       component.atomic_number > MaxAtomicNumber ||
+       !(component.mass_fraction > 0.0))
+    {
+      throw std::invalid_argument("Invalid request: unknown element or "
+                                  "fraction not greater than 0");
+    }
+
+    fraction_sum += component.mass_fraction;
+  }
+
+  // Held for the whole request, so a reload publishing meanwhile does not
+  // mix old and new tables in one answer
+  std::shared_ptr<const XsLibrary> library{
+      DataProcessor::getInstance().getLibrary()};
+  size_t column{columns.at(reaction)};
+
+  values.assign(request.energies.size(), 0.0);
+
+  // Tables are resolved once per element rather than once per energy
+  for(const XsComponent &component : request.components)
+  {
+    const std::vector<std::vector<double>> &rows{library->getData(
+        ParticleConstants::ParticleType::GAMMA,
+        static_cast<ElementConversion::Element>(component.atomic_number))};
+    double scale{header.density * component.mass_fraction / fraction_sum};
+
+    for(size_t i{0}; i < request.energies.size(); i++)
+    {
+      values[i] += scale * Interpolation::interpolateColumn(
+                               request.energies[i], rows, column);
+    }
+  }
+}
+
+void XsServer::respond(Connection &connection, std::uint32_t id,
+                       XsStatus status, const void *payload,
+                       std::uint64_t no_values, size_t value_size)
+{
+  XsResponseHeader header{ServiceConstants::ProtocolMagic, id, status, 0,
+                          no_values};
+  std::vector<char> response(sizeof(header) + no_values * value_size);
+
+  std::memcpy(response.data(), &header, sizeof(header));
+  std::memcpy(response.data() + sizeof(header), payload,
+              no_values * value_size);
+
+  std::unique_lock<std::mutex> lock(connection.mutex);
+
+  if(connection.broken)
+  {
+    lock.unlock();
+    releasePending(connection);
+    return;
+  }
+
+  connection.responses.push_back(std::move(response));
+  lock.unlock();
+  connection.wake.notify_all();
+}
+
+void XsServer::releasePending(Connection &connection)
+{
+  {
+    std::lock_guard<std::mutex> lock(connection.mutex);
+    connection.pending -= 1;
+  }
+
+  connection.wake.notify_all();
+}
@@ -1,12 +1,98 @@
 #include "DataProcessor.hpp"
+#include "XsSegment.hpp"
+#include "XsServer.hpp"
 
+#include <algorithm>
+#include <csignal>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
-int main()
+// Answers queries on socket_path until SIGINT or SIGTERM
+int serve(const std::string &socket_path, int no_workers)
 {
+  // Blocked before any thread starts so that only sigwait sees them
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
 
-  DataProcessor dp{DataProcessor::getInstance(
+  XsServer server{socket_path, no_workers};
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  // Changed data files are picked up without a restart
+  data_processor.startReloading(
+      ReloadConstants::DefaultIntervalSeconds,
+      [](const ReloadReport &report)
+      {
+        std::cout << "Reloaded " << report.reparsed.size()
+                  << " elements into version " << report.version << "\n";
+
+        for(const std::string &error : report.errors)
+        {
+          std::cout << "Kept old data for " << error << "\n";
+        }
+      });
+
+  std::cout << "Serving cross sections on " << socket_path << " with "
+            << no_workers << " workers\n";
+
+  int signal;
+  sigwait(&signals, &signal);
+
+  data_processor.stopReloading();
+  server.stop();
+
+  std::cout << "Served " << server.getRequestsServed() << " requests, "
+            << server.getValuesServed() << " coefs\n";
+
+  return 0;
+}
+
+// Publishes every element to the shared memory segment name, replacing any
+// earlier one. Processes that attached before keep the old data.
+int publish(const std::string &name)
+{
+  DataProcessor &data_processor{DataProcessor::getInstance()};
+
+  for(int z{1}; z <= 100; z++)
+  {
+    data_processor.addDataSingleFile(
+        ParticleConstants::ParticleType::GAMMA,
+        static_cast<ElementConversion::Element>(z));
+  }
+
+  XsSegment::remove(name);
+  XsSegment segment{XsSegment::publish(name, *data_processor.getAllData())};
+
+  std::cout << "Published " << segment.getNoTables() << " tables ("
+            << segment.getSize() << " bytes) to " << segment.getName() << "\n";
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  // nse --serve <socket> [workers]
+  if(argc >= 3 && std::strcmp(argv[1], "--serve") == 0)
+  {
+    int no_workers{argc >= 4 ? std::stoi(argv[3])
+                             : static_cast<int>(std::max(
+                                   1u, std::thread::hardware_concurrency()))};
+
+    return serve(argv[2], no_workers);
+  }
+
+  // nse --publish <name>
+  if(argc >= 3 && std::strcmp(argv[1], "--publish") == 0)
+  {
+    return publish(argv[2]);
+  }
+
+  DataProcessor &dp{DataProcessor::getInstance(
       ParticleConstants::ParticleType::GAMMA, ElementConversion::Element::Sn)};
 
   std::cout << "Enter photon energy (MeV): \n";
@@ -22,4 +108,4 @@ int main()
   std::cout << attencoef << "\n";
 
   return 0;
-}
\ No newline at end of file
+}